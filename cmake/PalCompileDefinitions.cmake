@@ -147,6 +147,16 @@ function(pal_compile_definitions TARGET)
         >
     )
 
+    if(PAL_MEMTRACK_SAMPLE_BYTES)
+        # Track a random sample of allocations instead of all of them
+        target_compile_definitions(${TARGET} PUBLIC PAL_MEMTRACK_SAMPLE_BYTES=${PAL_MEMTRACK_SAMPLE_BYTES})
+    endif()
+
+    if(PAL_THREAD_ALLOC_CACHE)
+        # Keep small system memory allocations in per-thread caches instead of returning them to the client
+        target_compile_definitions(${TARGET} PUBLIC PAL_THREAD_ALLOC_CACHE=1)
+    endif()
+
     if(PAL_AMDGPU_BUILD AND PAL_DISPLAY_DCC)
         target_compile_definitions(${TARGET} PRIVATE PAL_DISPLAY_DCC=1)
     endif()
@@ -34,3 +34,9 @@ option(PAL_ENABLE_PRINTS_ASSERTS_DEBUG "Enable print assertions on debug builds?
 
 option(PAL_MEMTRACK "Enable PAL memory tracker?")
 
+set(PAL_MEMTRACK_SAMPLE_BYTES 0 CACHE STRING "Mean bytes between allocations sampled by the memory tracker (0 tracks all).")
+
+option(PAL_THREAD_ALLOC_CACHE "Cache small system memory allocations per thread?" OFF)
+
+option(PAL_BUILD_TESTS "Build PAL's unit and stress tests?" OFF)
+
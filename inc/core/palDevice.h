@@ -654,6 +654,16 @@ struct PalPublicSettings
     /// the ACE.
     bool disableExecuteIndirectAceOffload;
 #endif
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    /// Allows client pipelines with identical, position-independent shader code to share a single copy of that code in
+    /// GPU memory.  Shared code is always uploaded to a CPU visible heap, ignoring @ref pipelinePreferredHeap.  This is
+    /// ignored when developer mode is enabled.  The default is false.
+    bool enableShaderCodeDeduplication;
+    /// Selects the allocator which hands out shared virtual memory addresses.  When true, a two-level segregated fit
+    /// allocator with constant-time allocation and free is used.  When false, the original best-fit allocator, which
+    /// searches every block, is used.  The default is false.
+    bool enableTlsfSvmAllocator;
+#endif
 };
 
 /// Defines the modes that the GPU Profiling layer can use when its buffer fills.
@@ -2396,6 +2406,22 @@ typedef void (PAL_STDCALL *CreateBvhSrdsFunc)(
     const BvhInfo*  pBvhInfo,
     void*           pOut);
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+/// Specifies one of the pipelines to be created by IDevice::CreatePipelinesBatch().
+struct PipelineBatchCreateInfo
+{
+    PipelineBindPoint                 bindPoint;       ///< Selects whether pComputeInfo or pGraphicsInfo is used.
+    const ComputePipelineCreateInfo*  pComputeInfo;    ///< Compute pipeline properties.  Used if bindPoint is Compute.
+    const GraphicsPipelineCreateInfo* pGraphicsInfo;   ///< Graphics pipeline properties.  Used if bindPoint is
+                                                       ///  Graphics.
+    void*                             pPlacementAddr;  ///< Location where PAL should construct this pipeline.  Must be
+                                                       ///  at least as large as reported by GetComputePipelineSize() or
+                                                       ///  GetGraphicsPipelineSize() for the same create info.
+    IPipeline**                       ppPipeline;      ///< [out] Constructed pipeline object, or null if creation of
+                                                       ///  this pipeline failed.
+};
+#endif
+
 /// Specifies output arguments for IDevice::QueryWorkstationCaps(), returning worksation feature information
 /// on this device workstation board.
 union WorkStationCaps
@@ -4020,6 +4046,32 @@ public:
         void*                             pPlacementAddr,
         IPipeline**                       ppPipeline) = 0;
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    /// Creates many compute and/or graphics @ref IPipeline objects at once.
+    ///
+    /// This is intended for bulk pipeline creation, such as at application load time.  The resulting pipelines are
+    /// identical to ones created by CreateComputePipeline() or CreateGraphicsPipeline(), but PAL may pack their code
+    /// and data into a few large GPU memory allocations and upload all of them with a single DMA submission.
+    /// Pipelines may be created in parallel on up to maxWorkerThreads additional threads.
+    ///
+    /// @param [in] pipelineCount   Number of entries in pCreateInfos.
+    /// @param [in] pCreateInfos    Array of pipelines to create.  The ppPipeline of each entry receives the pipeline,
+    ///                             or null if that pipeline could not be created.
+    /// @param [in] maxWorkerThreads Maximum number of threads PAL may spawn to create these pipelines.  If zero, all
+    ///                             pipelines are created on the calling thread.
+    ///
+    /// @returns Success if all pipelines were successfully created.  Otherwise, the first error returned while creating
+    ///          any of the pipelines.  Other pipelines in the batch may still have been created successfully, and must
+    ///          be destroyed by the client as usual.
+    ///
+    /// @note The default implementation simply creates each pipeline in turn through CreateComputePipeline() or
+    ///       CreateGraphicsPipeline(), so implementations of IDevice outside of PAL need not provide their own.
+    virtual Result CreatePipelinesBatch(
+        uint32                         pipelineCount,
+        const PipelineBatchCreateInfo* pCreateInfos,
+        uint32                         maxWorkerThreads);
+#endif
+
     /// Determines the amount of system memory required for a MSAA state object.  An allocation of this amount of memory
     /// must be provided in the pPlacementAddr parameter of CreateMsaaState().
     ///
@@ -34,6 +34,9 @@
 #include "pal.h"
 #include "palSysMemory.h"
 #include "palMemTrackerImpl.h"
+#if PAL_THREAD_ALLOC_CACHE
+#include "palThreadCacheAllocatorImpl.h"
+#endif
 #include "palDestroyable.h"
 #include "palDeveloperHooks.h"
 
@@ -108,6 +111,21 @@ struct PlatformProperties
     };
 };
 
+/// Reports the effectiveness of the platform-wide cache of decoded pipeline metadata.  Every pipeline and shader
+/// library created from a PAL ABI binary looks up its metadata in this cache.  Times are in the units reported by
+/// Util::GetPerfFrequency().
+///
+/// @see IPlatform::GetPipelineMetadataCacheStats
+struct PipelineMetadataCacheStats
+{
+    uint64 hitCount;       ///< Number of lookups which found previously decoded metadata.
+    uint64 missCount;      ///< Number of lookups which had to decode the binary's metadata.
+    uint64 evictionCount;  ///< Number of entries discarded to keep the cache within its size limit.
+    uint64 hitTime;        ///< Total CPU time spent servicing lookups which hit.
+    uint64 missTime;       ///< Total CPU time spent servicing lookups which missed, including the decode.
+    uint32 entryCount;     ///< Number of binaries currently in the cache.
+};
+
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION < 682
 /// Enumerates the GPU affinity modes which can be selected by an application profile. This determines the preference
 /// of which Device(s) an application profile would like us to use for a specific application.
@@ -416,6 +434,21 @@ public:
     virtual Result GetProperties(
         PlatformProperties* pProperties) = 0;
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    /// Reports hit rate and lookup latency statistics for the platform's pipeline metadata cache.
+    ///
+    /// PAL caches the decoded metadata of each pipeline binary it sees, so creating a pipeline from a binary which was
+    /// used before (on any device) skips decoding its metadata.
+    ///
+    /// @param [out] pStats  Statistics gathered since the platform was created.
+    ///
+    /// @returns Success if the statistics were successfully returned in pStats.  Otherwise, one of the following
+    ///          errors may be returned:
+    ///          + ErrorInvalidPointer if pStats is null.
+    virtual Result GetPipelineMetadataCacheStats(
+        PipelineMetadataCacheStats* pStats) = 0;
+#endif
+
     /// Installs the callback into the specified platform.
     ///
     /// @param [in] pPlatform        The platform to install the callback into.
@@ -508,6 +541,8 @@ public:
     {
 #if PAL_MEMTRACK
         return m_memTracker.Alloc(allocInfo);
+#elif PAL_THREAD_ALLOC_CACHE
+        return m_allocCache.Alloc(allocInfo);
 #else
         return m_allocator.Alloc(allocInfo);
 #endif
@@ -520,11 +555,35 @@ public:
     {
 #if PAL_MEMTRACK
         m_memTracker.Free(freeInfo);
+#elif PAL_THREAD_ALLOC_CACHE
+        m_allocCache.Free(freeInfo);
 #else
         m_allocator.Free(freeInfo);
 #endif
     }
 
+#if PAL_THREAD_ALLOC_CACHE
+    /// Reports how many system memory allocations and frees PAL made and how many of them reached the client's
+    /// allocation callbacks instead of being served by PAL's per-thread caches.
+    ///
+    /// @param [out] pStats Receives the counters.
+    void GetAllocCacheStats(Util::ThreadCacheStats* pStats) const
+    {
+        m_allocCache.GetStats(pStats);
+    }
+#endif
+
+#if PAL_MEMTRACK
+    /// Writes the memory tracker's live system memory totals per SystemAllocType and per call site as a JSON map. When
+    /// PAL is built with PAL_MEMTRACK_SAMPLE_BYTES these are estimates from a sample of the allocations.
+    ///
+    /// @param [in] pWriter JSON writer which receives the snapshot.
+    void WriteMemTrackerSnapshot(Util::JsonWriter* pWriter)
+    {
+        m_memTracker.WriteSnapshot(pWriter);
+    }
+#endif
+
     /// Logs a text string via the developer driver bus if it is currently connected.
     ///
     /// @param [in] level        Log priority level associated with the message.
@@ -569,10 +628,15 @@ protected:
     IPlatform(
         const Util::AllocCallbacks& allocCb)
         :
-#if PAL_MEMTRACK
+        m_allocator(allocCb),
+#if PAL_THREAD_ALLOC_CACHE
+        m_allocCache(&m_allocator),
+#endif
+#if PAL_MEMTRACK && PAL_THREAD_ALLOC_CACHE
+        m_memTracker(&m_allocCache),
+#elif PAL_MEMTRACK
         m_memTracker(&m_allocator),
 #endif
-        m_allocator(allocCb),
         m_pClientData(nullptr) { }
 
     /// @internal Destructor. Prevent use of delete operator on this interface.  Client must destroy objects by
@@ -599,14 +663,24 @@ protected:
         Developer::Callback pfnDeveloperCb,
         void*               pPrivateData) = 0;
 
+    /// @internal Memory allocator. Calls to Alloc() and Free() are chained down to the allocator's counterparts.
+    Util::ForwardAllocator m_allocator;
+
+#if PAL_THREAD_ALLOC_CACHE
+    /// @internal Per-thread caches of small allocations in front of the forward allocator.
+    Util::ThreadCacheAllocator<Util::ForwardAllocator> m_allocCache;
+#endif
+
 #if PAL_MEMTRACK
     /// @internal Memory leak tracker. Requires an allocator in order to perform the actual allocations. We can't
-    /// provide this platform because that would result in a stack overflow. We must give it our forward allocator.
+    /// provide this platform because that would result in a stack overflow. We must give it our forward allocator,
+    /// or the thread caches in front of it.  Declared last so that it is destroyed before the allocators it uses.
+#if PAL_THREAD_ALLOC_CACHE
+    Util::MemTracker<Util::ThreadCacheAllocator<Util::ForwardAllocator>> m_memTracker;
+#else
     Util::MemTracker<Util::ForwardAllocator> m_memTracker;
 #endif
-
-    /// @internal Memory allocator. Calls to Alloc() and Free() are chained down to the allocator's counterparts.
-    Util::ForwardAllocator m_allocator;
+#endif
 
 private:
     /// @internal Client data pointer. This can have an arbitrary value and can be returned by calling GetClientData()
@@ -0,0 +1,142 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+***********************************************************************************************************************
+* @file  palCodeObjectStore.h
+* @brief PAL GPU utility CodeObjectStore class.
+***********************************************************************************************************************
+*/
+
+#pragma once
+
+#include "palHashMap.h"
+#include "palMutex.h"
+#include "palPlatform.h"
+
+// Forward declarations.
+namespace Pal
+{
+class IPipeline;
+class IShaderLibrary;
+}
+
+struct SqttCodeObjectDatabaseRecord;
+
+namespace GpuUtil
+{
+
+/**
+***********************************************************************************************************************
+* @class CodeObjectStore
+* @brief Helper class providing refcounted, deduplicated storage of code object binaries for RGP traces.
+*
+* GpaSession keeps a copy of every registered pipeline binary so it can be written into the code object database of an
+* RGP file.  Each binary is only stored once per CodeObjectStore, keyed by its internal hash, no matter how many
+* sessions or registrations reference it.  A single store may be shared by any number of GpaSessions that use the
+* same platform.
+*
+* All functions are thread safe.
+***********************************************************************************************************************
+*/
+class CodeObjectStore
+{
+public:
+    /// Constructor.
+    ///
+    /// @param [in] pPlatform The platform used to allocate the stored code objects.
+    explicit CodeObjectStore(Pal::IPlatform* pPlatform);
+
+    /// Destructor.  All code objects acquired from the store must have been released.
+    ~CodeObjectStore();
+
+    /// Initializes the store.
+    ///
+    /// @returns Success if the store was successfully initialized, or ErrorOutOfMemory upon failure.
+    Pal::Result Init();
+
+    /// Acquires a reference to the code object of a pipeline, copying the pipeline binary if the store does not hold
+    /// a code object with the same hash yet.
+    ///
+    /// @param [in]  hash        Hash uniquely identifying the pipeline binary.
+    /// @param [in]  pPipeline   Pipeline to copy the binary from.
+    /// @param [out] ppRecord    RGP code object record followed by the binary.  Must be released with Release().
+    ///
+    /// @returns Success if the record was returned, otherwise the error returned by IPipeline::GetCodeObject or
+    ///          ErrorOutOfMemory.
+    Pal::Result Acquire(
+        Pal::uint64                    hash,
+        const Pal::IPipeline*          pPipeline,
+        SqttCodeObjectDatabaseRecord** ppRecord);
+
+    /// Acquires a reference to the code object of a shader library.  @see Acquire.
+    Pal::Result Acquire(
+        Pal::uint64                    hash,
+        const Pal::IShaderLibrary*     pLibrary,
+        SqttCodeObjectDatabaseRecord** ppRecord);
+
+    /// Acquires a reference to the code object of a raw ELF binary.  @see Acquire.
+    Pal::Result Acquire(
+        Pal::uint64                    hash,
+        const void*                    pBinary,
+        size_t                         binarySize,
+        SqttCodeObjectDatabaseRecord** ppRecord);
+
+    /// Acquires a reference to the code object of a record owned by this or any other CodeObjectStore.  @see Acquire.
+    Pal::Result Acquire(
+        const SqttCodeObjectDatabaseRecord* pSrcRecord,
+        SqttCodeObjectDatabaseRecord**      ppRecord);
+
+    /// Adds another reference to a record previously returned by Acquire().
+    void AddRef(SqttCodeObjectDatabaseRecord* pRecord);
+
+    /// Releases a reference to a record previously returned by Acquire().  The code object is freed once the last
+    /// reference is released.
+    void Release(SqttCodeObjectDatabaseRecord* pRecord);
+
+private:
+    struct Entry;
+
+    static SqttCodeObjectDatabaseRecord* GetRecord(Entry* pEntry);
+
+    // Returns the entry for hash with an additional reference, or nullptr if the store doesn't hold it.
+    SqttCodeObjectDatabaseRecord* FindAndAddRef(Pal::uint64 hash);
+
+    // Allocates an unpublished entry large enough for a binary of the given size.
+    Entry* CreateEntry(Pal::uint64 hash, size_t binarySize);
+
+    // Publishes a new entry, or discards it in favor of an identical entry another thread published first.
+    SqttCodeObjectDatabaseRecord* Publish(Entry* pEntry);
+
+    Pal::IPlatform* const m_pPlatform;
+
+    // Map from code object hash to the entry holding its binary.
+    Util::HashMap<Pal::uint64, Entry*, Pal::IPlatform, Util::JenkinsHashFunc> m_entries;
+    Util::Mutex                                                              m_lock;
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(CodeObjectStore);
+    PAL_DISALLOW_DEFAULT_CTOR(CodeObjectStore);
+};
+
+} // GpuUtil
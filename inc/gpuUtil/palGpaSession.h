@@ -66,6 +66,8 @@ struct GpuMemoryInfo;
 
 namespace GpuUtil
 {
+class CodeObjectStore;
+
 // Sample id initialization value.
 constexpr Pal::uint32 InvalidSampleId = 0xFFFFFFFF;
 
@@ -373,6 +375,15 @@ enum class ApiType : Pal::uint32
     OpenCl    = 3,    ///< Represents OpenCL API type.
 };
 
+/// Client callback used to stream out RGP file data.
+///
+/// @param [in] pUserData Client data provided to GpaSession::GetResults().
+/// @param [in] pData     Next piece of the RGP file.  Only valid for the duration of the call.
+/// @param [in] dataSize  Size of the data pointed to by pData in bytes.
+///
+/// @returns Success if the data was consumed.  Any other result aborts the stream and is returned by GetResults().
+typedef Pal::Result (PAL_STDCALL *RgpWriteFunc)(void* pUserData, const void* pData, size_t dataSize);
+
 /**
 ***********************************************************************************************************************
 * @class GpaSession
@@ -415,6 +426,10 @@ public:
     typedef Util::Deque<PerfExperimentMemory, GpaAllocator> PerfExpMemDeque;
 
     /// Constructor.
+    ///
+    /// @param [in] pCodeObjectStore Optional store for the code objects of registered pipelines.  Sessions sharing a
+    ///                              store keep only one copy of each binary.  The store must outlive the session.  If
+    ///                              nullptr, the session creates a private store.
     GpaSession(
         Pal::IPlatform*      pPlatform,
         Pal::IDevice*        pDevice,
@@ -423,7 +438,8 @@ public:
         ApiType              apiType,
         Pal::uint16          rgpInstrumentationSpecVer = 0,
         Pal::uint16          rgpInstrumentationApiVer  = 0,
-        PerfExpMemDeque*     pAvailablePerfExpMem      = nullptr);
+        PerfExpMemDeque*     pAvailablePerfExpMem      = nullptr,
+        CodeObjectStore*     pCodeObjectStore          = nullptr);
 
     ~GpaSession();
 
@@ -621,6 +637,26 @@ public:
         size_t*     pSizeInBytes,
         void*       pData) const;
 
+    /// Streams the RGP file of a trace sample through a client callback.  Only valid for sessions in the _ready_ state.
+    ///
+    /// Unlike the buffer based GetResults(), the client does not need to allocate space for the whole RGP file up
+    /// front.  The file is produced in a single pass and handed to pfnWrite in order, in pieces no larger than one RGP
+    /// chunk.  The SQ thread trace data is passed to the callback directly from the mapped trace memory.
+    ///
+    /// @param [in] sampleId  Sample to be reported.  Corresponds to value returned by BeginSample() and must refer to a
+    ///                       trace sample.
+    /// @param [in] pfnWrite  Callback that consumes the RGP file data, e.g. by writing it into a Util::File.
+    /// @param [in] pUserData Client data passed through to pfnWrite.
+    ///
+    /// @returns Success if the whole RGP file was passed to pfnWrite.  Otherwise, possible errors include:
+    ///          + ErrorInvalidPointer if pfnWrite is nullptr.
+    ///          + ErrorInvalidObjectType if the sample is not a trace sample.
+    ///          + Any error returned by pfnWrite, which stops the stream.
+    Pal::Result GetResults(
+        Pal::uint32  sampleId,
+        RgpWriteFunc pfnWrite,
+        void*        pUserData) const;
+
     /// Moves the session to the _reset_ state, marking all sessions resources as unused and available for reuse when
     /// the session is re-built.
     ///
@@ -650,10 +686,26 @@ public:
     /// @param [in] pPipeline   The PAL pipeline to be tracked.
     /// @param [in] clientInfo  API-dependent information for this pipeline to also be recorded.
     ///
+    /// The pipeline binary is copied into the session's code object store, which keeps a single copy of each binary.
+    ///
     /// @returns Success if the pipeline has been registered with GpaSession successfully.
     ///          + AlreadyExists if a duplicate pipeline is provided.
     Pal::Result RegisterPipeline(const Pal::IPipeline* pPipeline, const RegisterPipelineInfo& clientInfo);
 
+    /// Registers a batch of pipelines with GpaSession.  This is equivalent to calling RegisterPipeline() for each
+    /// pipeline, but only synchronizes with other threads once for the whole batch.
+    ///
+    /// @param [in] pipelineCount Number of pipelines in ppPipelines and pClientInfo.
+    /// @param [in] ppPipelines   The PAL pipelines to be tracked.
+    /// @param [in] pClientInfo   API-dependent information for each pipeline to also be recorded.
+    ///
+    /// @returns Success if all pipelines have been registered with GpaSession successfully.  Duplicate pipelines are
+    ///          skipped and do not cause a failure.
+    Pal::Result RegisterPipelines(
+        Pal::uint32                  pipelineCount,
+        const Pal::IPipeline* const* ppPipelines,
+        const RegisterPipelineInfo*  pClientInfo);
+
     /// Unregister pipeline with GpaSession for obtaining unload events in the RGP file.
     /// This should be called immediately before destroying the PAL pipeline object.
     ///
@@ -779,6 +831,7 @@ private:
     class TraceSample;
     class TimingSample;
     class QuerySample;
+    class RgpWriter;
 
     Util::Vector<SampleItem*, 16, GpaAllocator> m_sampleItemArray;
     PerfExpMemDeque* m_pAvailablePerfExpMem;
@@ -788,6 +841,10 @@ private:
     // Unique API PSOs registered with this GpaSession.
     Util::HashSet<Pal::uint64, GpaAllocator, Util::JenkinsHashFunc> m_registeredApiHashes;
 
+    // Refcounted store which owns the code object records referenced below.
+    CodeObjectStore* m_pCodeObjectStore;
+    bool             m_ownsCodeObjectStore;
+
     // List of cached pipeline code object records that will be copied to the final database at the end of a trace
     Util::Deque<SqttCodeObjectDatabaseRecord*, GpaAllocator>  m_codeObjectRecordsCache;
     // List of pipeline code object records that were registered during a trace
@@ -949,13 +1006,20 @@ private:
         Pal::IQueryPool**       ppQuery);
 
     // Dump SQ thread trace data in rgp format
-    Pal::Result DumpRgpData(TraceSample* pTraceSample, void* pRgpOutput, size_t* pTraceSize) const;
-
-    // Dumps the spm trace data in the buffer provided.
-    Pal::Result AppendSpmTraceData(TraceSample*  pTraceSample,
-                                   size_t        bufferSize,
-                                   void*         pData,
-                                   Pal::gpusize* pSizeInBytes) const;
+    Pal::Result DumpRgpData(TraceSample* pTraceSample, RgpWriter* pWriter) const;
+
+    // Dumps the spm trace data into the RGP output.
+    void AppendSpmTraceData(TraceSample* pTraceSample, RgpWriter* pWriter) const;
+
+    Pal::Result BuildCodeObjectLoadEvent(
+        const Pal::IPipeline*      pPipeline,
+        CodeObjectLoadEventType    eventType,
+        CodeObjectLoadEventRecord* pRecord) const;
+    Pal::Result RegisterPipelineLocked(
+        const Pal::IPipeline*            pPipeline,
+        const RegisterPipelineInfo&      clientInfo,
+        const CodeObjectLoadEventRecord& loadEvent,
+        SqttCodeObjectDatabaseRecord*    pRecord);
 
     Pal::Result AddCodeObjectLoadEvent(const Pal::IPipeline* pPipeline, CodeObjectLoadEventType eventType);
     Pal::Result AddCodeObjectLoadEvent(const Pal::IShaderLibrary* pLibrary, CodeObjectLoadEventType eventType);
@@ -280,14 +280,30 @@ public:
     ///          + ErrorUnavailable if there is a trace in progress already and a new one cannot be started
     Pal::Result RequestTrace();
 
+    /// Selects where the trace data of the next trace operation is written.
+    ///
+    /// By default, the session accumulates all trace data in memory and CollectTrace copies it out once the trace
+    /// is complete. When a file path is provided, each data chunk is instead streamed into the file as soon as it's
+    /// written so host memory usage doesn't grow with the size of the trace.
+    ///
+    /// This function will only succeed if there is currently no trace in progress.
+    ///
+    /// @param [in] pFilePath Null terminated path of the RDF file to create, or nullptr to return to in-memory mode
+    ///
+    /// @returns Success if the trace destination was successfully updated.
+    ///          Otherwise, one of the following errors may be returned:
+    ///          + ErrorUnavailable if a trace is currently in progress
+    ///          + ErrorInvalidValue if pFilePath does not fit within MaxPathStrLen characters
+    Pal::Result SetTraceFile(const char* pFilePath);
+
     /// Attempts to consume any trace data stored within the trace session.
     ///
     /// This function will only successfully return trace data after a trace operation is completed on the session.
     ///
-    /// TODO: This function should be replaced with one that uses a callback so we can avoid needing to store the trace
-    ///       data into memory twice.
+    /// If a trace file was selected through SetTraceFile, the trace data has already been streamed to disk. In that
+    /// case this function completes the file and returns its null terminated path instead of the trace data.
     ///
-    /// @param [out]    pData     (Optional) Destination buffer to copy the trace data into
+    /// @param [out]    pData     (Optional) Destination buffer to copy the trace data (or trace file path) into
     ///                                      If this parameter is nullptr, the size of the trace data in bytes will be
     ///                                      returned via pDataSize instead of consuming any trace data.
     /// @param [in/out] pDataSize            If pData is nullptr, then this parameter is used to return the trace data
@@ -460,6 +476,9 @@ private:
     rdfStream* m_pCurrentStream;
     int m_currentChunkIndex;
 
+    // Destination file of the trace data when streaming to disk, or an empty string when tracing into memory.
+    char m_traceFilePath[Pal::MaxPathStrLen];
+
     Util::RWLock m_chunkAppendLock;
 };
 } // GpuUtil
@@ -77,7 +77,7 @@ struct ArchiveFileOpenInfo
     bool                useStrictVersionControl;  ///< Forbid minor version number differences in archive format
     bool                allowCreateFile;          ///< Create the file if one does not exist
     bool                allowWriteAccess;         ///< Open file with write access
-    bool                allowAsyncFileIo;         ///< Allow use of OS specific asynchronous file routines
+    bool                allowAsyncFileIo;         ///< Allow read buffer pages to be loaded by background threads
     bool                useBufferedReadMemory;    ///< Allow preloading/read-ahead of file into memory
     size_t              maxReadBufferMem;         ///< Maximum size allowed for read buffer
     void*               pSecurity;                ///< Pointer to an os-specific security attribute to use for file ops.
@@ -139,6 +139,9 @@ Result DeleteArchiveFile(
 /**
 ***********************************************************************************************************************
 * @brief Interface for reading and writing to a file adhering to the PAL Archive file format
+*
+* Implementations are not required to be thread-safe.  The archive files returned by OpenArchiveFile() are, and
+* concurrent reads of entry data from them don't serialize on each other.
 ***********************************************************************************************************************
 */
 class IArchiveFile
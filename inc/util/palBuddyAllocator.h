@@ -32,7 +32,7 @@
 #pragma once
 
 #include "pal.h"
-#include "palList.h"
+#include "palInlineFuncs.h"
 
 namespace Util
 {
@@ -44,6 +44,12 @@ namespace Util
  * Responsible for managing small GPU memory requests by allocating a large base allocation and dividing it into
  * appropriately sized suballocation blocks.
  *
+ * Each block size keeps a bitmap of its free blocks plus a summary bitmap of the non-zero words in it, so finding a
+ * free block is two bit scans rather than a list walk.  Split blocks are tracked in a second bitmap per size, which
+ * lets Free() find an allocation's size from its offset alone and coalesce buddies with single bit tests.  A block
+ * size's bitmaps are only allocated once a block of that size is first split off, so pools which never see small
+ * allocations don't pay for the (large) bitmaps of the smallest block sizes.
+ *
  * @warning The buddy allocator is not thread-safe so thread-safety has to be handled on the caller side.
  ***********************************************************************************************************************
  */
@@ -101,33 +107,61 @@ public:
     /// Returns the size of the largest allocation that can be suballocated with this buddy allocator.
     Pal::gpusize MaximumAllocationSize() const;
 
+    /// Returns the size of the largest block which is currently free, or zero if there are none. Any allocation whose
+    /// size and alignment are both no larger than this is guaranteed to find space.
+    Pal::gpusize LargestFreeBlockSize() const;
+
 private:
-    struct Block
+    // Bookkeeping for all blocks of one size. Blocks are numbered by their offset divided by their size.
+    struct BlockLevel
     {
-        bool            isFree; // Indicates the in-use status of the block
-        Pal::gpusize    offset; // Byte offset from the base allocation address where this block begins
+        uint64* pFree;      // One bit per block, set if the block is free.  Null until a block of this size exists;
+                            // the other bitmaps live in the same allocation.
+        uint64* pFreeWords; // One bit per word of pFree, set if that word has any bit set.
+        uint64* pSplit;     // One bit per block, set if the block is split into two smaller blocks.  Unused for the
+                            // smallest block size.
+        uint32  numFree;    // Number of bits set in pFree.
     };
 
-    typedef Util::List<Block, Allocator> BlockList;
+    Result InitLevel(uint32 kval);
+
+    void MarkFree(uint32 kval, uint32 block);
+    void MarkUsed(uint32 kval, uint32 block);
+    uint32 FindFree(uint32 kval) const;
+
+    bool IsFree(uint32 kval, uint32 block) const
+    {
+        return ((m_pLevels[kval - m_minKval].pFree[block / 64] & (1ull << (block % 64))) != 0);
+    }
+
+    bool IsSplit(uint32 kval, uint32 block) const
+    {
+        return ((m_pLevels[kval - m_minKval].pSplit[block / 64] & (1ull << (block % 64))) != 0);
+    }
 
-    Result GetNextFreeBlock(
-        uint32              kval,
-        Pal::gpusize*       pOffset);
+    void SetSplit(uint32 kval, uint32 block)
+    {
+        m_pLevels[kval - m_minKval].pSplit[block / 64] |= (1ull << (block % 64));
+    }
 
-    Result FreeBlock(
-        uint32              kval,
-        Pal::gpusize        offset);
+    void ClearSplit(uint32 kval, uint32 block)
+    {
+        m_pLevels[kval - m_minKval].pSplit[block / 64] &= ~(1ull << (block % 64));
+    }
 
     static constexpr Pal::gpusize KvalToSize(uint32 kVal) { return (1ull << kVal); }
 
     static uint32 SizeToKval(Pal::gpusize size) { return Log2(size); }
 
+    static constexpr uint32 NumWords(uint32 numBits) { return ((numBits + 63) / 64); }
+
     Allocator* const    m_pAllocator;
 
     const uint32        m_baseAllocKval;
     const uint32        m_minKval;
 
-    BlockList*          m_pBlockLists;
+    BlockLevel*         m_pLevels;          // One entry per block size, indexed by k-value minus m_minKval.
+    uint64              m_nonEmptyLevels;   // One bit per block size, set if the level has a free block.
 
     uint32              m_numSuballocations;
 
@@ -33,7 +33,6 @@
 
 #include "palBuddyAllocator.h"
 #include "palInlineFuncs.h"
-#include "palListImpl.h"
 #include "palSysMemory.h"
 
 namespace Util
@@ -49,7 +48,8 @@ BuddyAllocator<Allocator>::BuddyAllocator(
     m_pAllocator(pAllocator),
     m_baseAllocKval(SizeToKval(baseAllocSize)),
     m_minKval(SizeToKval(minAllocSize)),
-    m_pBlockLists(nullptr),
+    m_pLevels(nullptr),
+    m_nonEmptyLevels(0),
     m_numSuballocations(0)
 {
     // Allocator must be non-null
@@ -60,29 +60,23 @@ BuddyAllocator<Allocator>::BuddyAllocator(
 
     // Minimum allocation size must be POT
     PAL_ASSERT(KvalToSize(m_minKval) == minAllocSize);
+
+    // Block numbers of the smallest blocks must fit in 32 bits.
+    PAL_ASSERT((m_baseAllocKval > m_minKval) && ((m_baseAllocKval - m_minKval) < 32));
 }
 
 // =====================================================================================================================
 template <typename Allocator>
 BuddyAllocator<Allocator>::~BuddyAllocator()
 {
-    if (m_pBlockLists != nullptr)
+    if (m_pLevels != nullptr)
     {
-        const uint32 numKvals = m_baseAllocKval - m_minKval;
-
-        for (uint32 i = 0; i < numKvals; ++i)
+        for (uint32 kval = m_minKval; kval < m_baseAllocKval; ++kval)
         {
-            for (auto it = m_pBlockLists[i].Begin(); it.Get() != nullptr;)
-            {
-                m_pBlockLists[i].Erase(&it);
-            }
-
-            // Call the destructor
-            m_pBlockLists[i].~List();
+            PAL_SAFE_FREE(m_pLevels[kval - m_minKval].pFree, m_pAllocator);
         }
 
-        // Free the block list array
-        PAL_SAFE_FREE(m_pBlockLists, m_pAllocator);
+        PAL_SAFE_FREE(m_pLevels, m_pAllocator);
     }
 }
 
@@ -96,52 +90,150 @@ Pal::gpusize BuddyAllocator<Allocator>::MaximumAllocationSize() const
     return KvalToSize(m_baseAllocKval - 1);
 }
 
+// =====================================================================================================================
+// Gets the size of the largest free block, or zero if every block is in use.
+template <typename Allocator>
+Pal::gpusize BuddyAllocator<Allocator>::LargestFreeBlockSize() const
+{
+    uint32 level = 0;
+    return BitMaskScanReverse(&level, m_nonEmptyLevels) ? KvalToSize(m_minKval + level) : 0;
+}
+
 // =====================================================================================================================
 // Initializes the buddy allocator.
 template <typename Allocator>
 Result BuddyAllocator<Allocator>::Init()
 {
-    PAL_ASSERT(m_pBlockLists == nullptr);
+    PAL_ASSERT(m_pLevels == nullptr);
 
     Result result = Result::ErrorOutOfMemory;
 
-    const uint32 numKvals = m_baseAllocKval - m_minKval;
+    m_pLevels = static_cast<BlockLevel*>(PAL_CALLOC(sizeof(BlockLevel) * (m_baseAllocKval - m_minKval),
+                                                    m_pAllocator,
+                                                    AllocInternal));
 
-    // Allocate the block lists
-    m_pBlockLists = static_cast<BlockList*>(PAL_MALLOC(sizeof(BlockList) * numKvals,
-                                                       m_pAllocator,
-                                                       AllocInternal));
+    if (m_pLevels != nullptr)
+    {
+        result = InitLevel(m_baseAllocKval - 1);
+    }
 
-    if (m_pBlockLists != nullptr)
+    if (result == Result::Success)
     {
-        for (uint32 i = 0; i < numKvals; ++i)
+        // The base allocation starts out as the two largest-size blocks, both free.
+        MarkFree(m_baseAllocKval - 1, 0);
+        MarkFree(m_baseAllocKval - 1, 1);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Allocates the bitmaps of the given block size if they don't exist yet.  All of them start out clear.
+template <typename Allocator>
+Result BuddyAllocator<Allocator>::InitLevel(
+    uint32 kval)
+{
+    BlockLevel*const pLevel = &m_pLevels[kval - m_minKval];
+    Result           result = Result::Success;
+
+    if (pLevel->pFree == nullptr)
+    {
+        const uint32 freeWords  = NumWords(1u << (m_baseAllocKval - kval));
+        const uint32 splitWords = (kval > m_minKval) ? freeWords : 0;
+
+        uint64*const pWords = static_cast<uint64*>(
+            PAL_CALLOC(sizeof(uint64) * (freeWords + NumWords(freeWords) + splitWords), m_pAllocator, AllocInternal));
+
+        if (pWords != nullptr)
+        {
+            pLevel->pFree      = pWords;
+            pLevel->pFreeWords = pWords + freeWords;
+            pLevel->pSplit     = (splitWords > 0) ? (pLevel->pFreeWords + NumWords(freeWords)) : nullptr;
+        }
+        else
         {
-            PAL_PLACEMENT_NEW(&m_pBlockLists[i]) BlockList(m_pAllocator);
+            result = Result::ErrorOutOfMemory;
         }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Marks a block as free.
+template <typename Allocator>
+void BuddyAllocator<Allocator>::MarkFree(
+    uint32 kval,
+    uint32 block)
+{
+    BlockLevel*const pLevel = &m_pLevels[kval - m_minKval];
+    const uint32     word   = block / 64;
+
+    PAL_ASSERT(IsFree(kval, block) == false);
+
+    pLevel->pFree[word]           |= (1ull << (block % 64));
+    pLevel->pFreeWords[word / 64] |= (1ull << (word % 64));
+
+    if (pLevel->numFree++ == 0)
+    {
+        m_nonEmptyLevels |= (1ull << (kval - m_minKval));
+    }
+}
+
+// =====================================================================================================================
+// Marks a free block as used, either because it was allocated, split or merged with its buddy.
+template <typename Allocator>
+void BuddyAllocator<Allocator>::MarkUsed(
+    uint32 kval,
+    uint32 block)
+{
+    BlockLevel*const pLevel = &m_pLevels[kval - m_minKval];
+    const uint32     word   = block / 64;
 
-        // We need to create the first two largest-size blocks and add them to the last block list
-        const uint32        blockKval = (m_baseAllocKval - 1);
-        const Pal::gpusize  blockSize = KvalToSize(blockKval);
+    PAL_ASSERT(IsFree(kval, block));
 
-        BlockList* pBlockList = &m_pBlockLists[blockKval - m_minKval];
+    pLevel->pFree[word] &= ~(1ull << (block % 64));
 
-        Block block = {};
-        block.isFree = true;
-        block.offset = 0;
+    if (pLevel->pFree[word] == 0)
+    {
+        pLevel->pFreeWords[word / 64] &= ~(1ull << (word % 64));
+    }
+
+    if (--pLevel->numFree == 0)
+    {
+        m_nonEmptyLevels &= ~(1ull << (kval - m_minKval));
+    }
+}
 
-        result = pBlockList->PushBack(block);
-        PAL_ALERT(result != Result::Success);
+// =====================================================================================================================
+// Returns the lowest-numbered free block of the given size. The caller must ensure that there is one.
+template <typename Allocator>
+uint32 BuddyAllocator<Allocator>::FindFree(
+    uint32 kval
+    ) const
+{
+    const BlockLevel& level      = m_pLevels[kval - m_minKval];
+    const uint32      summaryEnd = NumWords(NumWords(1u << (m_baseAllocKval - kval)));
 
-        block.offset = blockSize;
+    PAL_ASSERT(level.numFree > 0);
 
-        if (result == Result::Success)
+    uint32 block = 0;
+    for (uint32 summary = 0; summary < summaryEnd; ++summary)
+    {
+        uint32 wordBit = 0;
+        if (BitMaskScanForward(&wordBit, level.pFreeWords[summary]))
         {
-            result = pBlockList->PushBack(block);
-            PAL_ALERT(result != Result::Success);
+            const uint32 word = (summary * 64) + wordBit;
+
+            uint32 blockBit = 0;
+            BitMaskScanForward(&blockBit, level.pFree[word]);
+
+            block = (word * 64) + blockBit;
+            break;
         }
     }
 
-    return result;
+    return block;
 }
 
 // =====================================================================================================================
@@ -153,71 +245,50 @@ Result BuddyAllocator<Allocator>::Allocate(
     Pal::gpusize    alignment,
     Pal::gpusize*   pOffset)
 {
-    PAL_ASSERT(m_pBlockLists != nullptr);
+    PAL_ASSERT(m_pLevels != nullptr);
 
     PAL_ASSERT(size <= MaximumAllocationSize());
 
+    Result result = Result::ErrorOutOfGpuMemory;
+
     // Pad the requested allocation size to the nearest POT of the size and alignment
     const uint32 kval = Max(SizeToKval(Pow2Pad(Max(size, alignment))), m_minKval);
 
-    Result result = GetNextFreeBlock(kval, pOffset);
+    // Find the smallest block size at least as big as the request which has a free block.
+    uint32 level = 0;
+    if ((kval < m_baseAllocKval) &&
+        BitMaskScanForward(&level, m_nonEmptyLevels & ~((1ull << (kval - m_minKval)) - 1)))
+    {
+        // Make sure every block size we're about to split the block into has its bitmaps before changing anything.
+        result = Result::Success;
+        for (uint32 splitKval = kval; (splitKval < (m_minKval + level)) && (result == Result::Success); ++splitKval)
+        {
+            result = InitLevel(splitKval);
+        }
+    }
 
     if (result == Result::Success)
     {
-        // Increment the number of suballocations this buddy allocator manages
-        m_numSuballocations++;
-    }
+        uint32 blockKval = m_minKval + level;
+        uint32 block     = FindFree(blockKval);
 
-    return result;
-}
+        MarkUsed(blockKval, block);
 
-// =====================================================================================================================
-// Gets the next free block of the provided size and marks it as used.
-template <typename Allocator>
-Result BuddyAllocator<Allocator>::GetNextFreeBlock(
-    uint32          kval,
-    Pal::gpusize*   pOffset)
-{
-    Result result = Result::ErrorOutOfGpuMemory;
+        // Split the block down to the requested size, keeping the lower half and freeing the upper half each time.
+        while (blockKval > kval)
+        {
+            SetSplit(blockKval, block);
 
-    if (kval < m_baseAllocKval)
-    {
-        BlockList* pBlockList = &m_pBlockLists[kval - m_minKval];
+            blockKval--;
+            block *= 2;
 
-        for (auto it = pBlockList->Begin(); it.Get() != nullptr; it.Next())
-        {
-            if (it.Get()->isFree)
-            {
-                // Allocate this block and return it
-                it.Get()->isFree = false;
-                *pOffset = it.Get()->offset;
-
-                result = Result::Success;
-                break;
-            }
+            MarkFree(blockKval, block + 1);
         }
 
-        if (result != Result::Success)
-        {
-            // If we didn't find any free blocks in the list then we need to get a block one size bigger and split it
-            result = GetNextFreeBlock(kval + 1, pOffset); // Determine the offset for the larger block
-            if (result == Result::Success)
-            {
-                // Now we need to create two blocks in that larger block's space. First, the block we'll return
-                Block block = {};
-                block.isFree = false;
-                block.offset = *pOffset;
-                result = pBlockList->PushBack(block);
-
-                if (result == Result::Success)
-                {
-                    // ... and its buddy which starts out as free
-                    block.isFree = true;
-                    block.offset = *pOffset + KvalToSize(kval);
-                    result = pBlockList->PushBack(block);
-                }
-            }
-        }
+        *pOffset = KvalToSize(kval) * block;
+
+        // Increment the number of suballocations this buddy allocator manages
+        m_numSuballocations++;
     }
 
     return result;
@@ -231,87 +302,42 @@ void BuddyAllocator<Allocator>::Free(
     Pal::gpusize    size,
     Pal::gpusize    alignment)
 {
-    PAL_ASSERT(m_pBlockLists != nullptr);
+    PAL_ASSERT(m_pLevels != nullptr);
 
-    uint32 startKval = Max(SizeToKval(Pow2Pad(Max(size, alignment))), m_minKval);
+    const uint32 startKval = Max(SizeToKval(Pow2Pad(Max(size, alignment))), m_minKval);
 
-    Result result = FreeBlock(startKval, offset);
-
-    // Freeing should always succeed unless something went wrong with the allocation scheme
-    PAL_ASSERT(result == Result::Success);
-
-    // Decrement the number of suballocations this buddy allocator manages
-    m_numSuballocations--;
-}
+    // Every block containing the allocation is split, so walk down through the split blocks from the largest size to
+    // find the block which was allocated.
+    uint32 kval = m_baseAllocKval - 1;
+    while ((kval > startKval) && IsSplit(kval, static_cast<uint32>(offset >> kval)))
+    {
+        kval--;
+    }
 
-// =====================================================================================================================
-// Frees a block with the matching offset.
-template <typename Allocator>
-Result BuddyAllocator<Allocator>::FreeBlock(
-    uint32          kval,
-    Pal::gpusize    offset)
-{
-    Result result = Result::ErrorInvalidValue;
+    uint32 block = static_cast<uint32>(offset >> kval);
 
     // If this assert is hit then something went wrong with the allocation patterns
-    PAL_ASSERT((kval >= m_minKval) && (kval < m_baseAllocKval));
-
-    for (; (kval < m_baseAllocKval) && (result != Result::Success); ++kval)
+    PAL_ASSERT((KvalToSize(kval) * block == offset) &&
+               (IsFree(kval, block) == false)      &&
+               ((kval == m_minKval) || (IsSplit(kval, block) == false)));
+
+    // Merge the block with its buddy for as long as the buddy is free, unless we're at the largest block size.
+    // Because all offsets are zero relative and aligned to block size, the buddy's block number only differs in the
+    // lowest bit.
+    while ((kval < (m_baseAllocKval - 1)) && IsFree(kval, block ^ 1))
     {
-        BlockList* pBlockList = &m_pBlockLists[kval - m_minKval];
+        MarkUsed(kval, block ^ 1);
 
-        for (auto it = pBlockList->Begin(); it.Get() != nullptr; it.Next())
-        {
-            Block* pBlock = it.Get();
-            if (pBlock->offset == offset)
-            {
-                // At this point this block should not be free
-                PAL_ASSERT(pBlock->isFree == false);
-
-                pBlock->isFree = true;
-
-                // Find the buddy block to see if it is free, and if so remove the blocks and free the next size up.
-                // Because all offsets are zero relative and aligned to block size, buddy offset can be simply
-                // calculated by XOR-ing the block offset with its size.
-                Pal::gpusize buddyOffset = (offset ^ KvalToSize(kval));
-
-                // Because buddies are always consecutive in the block list we can find the buddy block next to the
-                // current one.
-                if (buddyOffset > offset)
-                {
-                    it.Next();
-                }
-                else
-                {
-                    it.Prev();
-                }
-                PAL_ASSERT(it.Get() != nullptr && it.Get()->offset == buddyOffset);
-
-                // If the buddy is free then remove both blocks from the list, unless we're at the largest block size
-                if (it.Get()->isFree && (kval < m_baseAllocKval - 1))
-                {
-                    pBlockList->Erase(&it);
-
-                    // Erasing a node advances the iterator, if the next node is not our block, then we need to move
-                    // back one node
-                    if (it.Get() != pBlock)
-                    {
-                        it.Prev();
-                    }
-                    pBlockList->Erase(&it);
-
-                    // Recursively call this method again to free the next block size up
-                    FreeBlock(kval + 1, Min(offset, buddyOffset));
-                }
-
-                // Finished successfully
-                result = Result::Success;
-                break;
-            }
-        }
+        kval++;
+        block /= 2;
+
+        ClearSplit(kval, block);
     }
 
-    return result;
+    MarkFree(kval, block);
+
+    // Decrement the number of suballocations this buddy allocator manages
+    m_numSuballocations--;
 }
 
-} // Pal
+} // Util
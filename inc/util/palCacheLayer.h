@@ -434,6 +434,12 @@ struct ArchiveFileCacheCreateInfo
                                            ///  to be keyed to a specific driver/platform fingerprint.
     uint32                   dataTypeId;   ///< Optional 32-bit data type identifier, allows heterogenous data to be
                                            ///  stored within an archive file.
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    bool                     threadSafeFile; ///< True if pFile may be read by several threads at once, as is the
+                                             ///  case for archive files returned by OpenArchiveFile().  Loads then
+                                             ///  read from the file concurrently.  Otherwise the layer serializes all
+                                             ///  of its accesses to pFile.
+#endif
 };
 
 /// Get the memory size for a archive file backed cache layer
@@ -0,0 +1,233 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palConcurrentHashMap.h
+ * @brief PAL utility collection ConcurrentHashMap class declaration.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palHashBase.h"
+#include "palMutex.h"
+
+namespace Util
+{
+
+/**
+ ***********************************************************************************************************************
+ * @brief Templated hash map container which can be searched without taking any lock.
+ *
+ * The map is split into NumShards shards, selected by the low bits of the key's hash.  Each shard owns a mutex, a
+ * bucket array and a singly linked chain of nodes per bucket.  Writers lock only the key's shard, so writers of
+ * different shards run in parallel.  Readers never lock: a node is fully written before it's linked into a chain,
+ * links are published with release stores, and nodes are never modified once linked.  Updating a value replaces the
+ * whole node and growing a shard copies its nodes into a new bucket array, so a reader always sees either the old or
+ * the new state of an entry.
+ *
+ * Unlinked nodes and bucket arrays can't be freed while a reader may still be walking them.  They're reclaimed using
+ * epochs: a reader announces the global epoch in one of NumReaderSlots reader slots for the duration of a search, and
+ * the epoch only advances once every active reader has announced the current one.  Memory retired in epoch E is
+ * returned to the allocator by a later writer of the same shard once the epoch has advanced twice past E, at which
+ * point no reader can still see it.
+ *
+ * Supported operations:
+ *
+ * - Searching (lock-free)
+ * - Insertion
+ * - Replacing a value
+ * - Deletion
+ *
+ * HashFunc and EqualFunc are the same functors which @ref HashMap takes.
+ *
+ * @warning Keys and values are copied in and out of the map and their destructors are never called, so they should be
+ *          plain data.
+ * @warning Init() must be called before using this container, and the map must not be used by any other thread while
+ *          it's being destroyed.
+ ***********************************************************************************************************************
+ */
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc  = DefaultHashFunc,
+         template<typename> class EqualFunc = DefaultEqualFunc>
+class ConcurrentHashMap
+{
+public:
+    /// Number of independently locked shards.
+    static constexpr uint32 NumShards      = 16;
+    /// Number of readers which can search the map at the same time.  Further readers spin until a slot is released.
+    static constexpr uint32 NumReaderSlots = 64;
+
+    /// Constructor.
+    ///
+    /// @param [in] numBuckets Total number of buckets the map starts with, which is divided among the shards.  Each
+    ///                        shard doubles its bucket count whenever it holds more entries than buckets.
+    /// @param [in] pAllocator Pointer to an allocator that will create system memory requested by this hash container.
+    ConcurrentHashMap(uint32 numBuckets, Allocator*const pAllocator);
+    ~ConcurrentHashMap();
+
+    /// Allocates the shards, reader slots and initial bucket arrays.
+    ///
+    /// @returns @ref Success if the map was initialized, or @ref ErrorOutOfMemory if an allocation failed.
+    Result Init();
+
+    /// Searches for the value that matches the specified key without taking any lock.
+    ///
+    /// @param [in]  key    Key to search for.
+    /// @param [out] pValue Optional.  Receives a copy of the value if an entry for the key exists.
+    ///
+    /// @returns True if an entry for the key exists.
+    bool Find(const Key& key, Value* pValue) const;
+
+    /// Returns true if an entry for the specified key exists.  Takes no lock.
+    bool Contains(const Key& key) const { return Find(key, nullptr); }
+
+    /// Inserts a key/value pair entry if the key doesn't already exist in the hash map.
+    ///
+    /// @param [in] key   Key of the new entry to insert.
+    /// @param [in] value Value of the new entry to insert.
+    ///
+    /// @returns @ref Success if the entry was inserted, @ref AlreadyExists if an entry for the key already exists (its
+    ///          value is left untouched), or @ref ErrorOutOfMemory if an internal memory allocation failed.
+    Result Insert(const Key& key, const Value& value);
+
+    /// Replaces the value of an existing entry.  Concurrent readers see either the old or the new value.
+    ///
+    /// @param [in] key   Key of the entry to update.
+    /// @param [in] value New value of the entry.
+    ///
+    /// @returns @ref Success if the value was replaced, @ref NotFound if no entry for the key exists, or
+    ///          @ref ErrorOutOfMemory if an internal memory allocation failed.
+    Result Replace(const Key& key, const Value& value);
+
+    /// Removes an entry that matches the specified key.
+    ///
+    /// @param [in] key Key of the entry to erase.
+    ///
+    /// @returns True if the erase completed successfully, false if an entry for this key did not exist.
+    bool Erase(const Key& key);
+
+    /// Returns the number of entries in the map.  The count is only exact if no writer is running concurrently.
+    uint32 GetNumEntries() const;
+
+private:
+    static constexpr uint32 ShardShift    = 4;
+    static constexpr uint32 InactiveEpoch = 0;
+    // Epochs are odd, so an active reader slot is never mistaken for an inactive one.  Retired memory is checked with
+    // wrapping arithmetic, so the epoch may overflow.
+    static constexpr uint32 FirstEpoch    = 1;
+    static constexpr uint32 EpochStep     = 2;
+
+    // Number of objects a shard accumulates before its writers try to advance the epoch.
+    static constexpr uint32 ReclaimBatchSize = 32;
+
+    static_assert((1u << ShardShift) == NumShards, "ShardShift and NumShards must agree!");
+    static_assert(IsPowerOfTwo(NumReaderSlots), "NumReaderSlots must be a power of two!");
+
+    // Header of anything a writer unlinks while readers may still reference it.
+    struct Retired
+    {
+        Retired* pNext;          // Next retired object of the same shard, retired in the same or a later epoch.
+        uint32   epoch;          // Epoch in which this object was unlinked.
+        bool     isBucketArray;  // If set, this is a BucketArray whose chains are freed along with it.
+    };
+
+    struct Node
+    {
+        Retired        retired;
+        Node* volatile pNext;
+        uint32         hash;
+        Key            key;
+        Value          value;
+    };
+
+    struct BucketArray
+    {
+        Retired        retired;
+        uint32         numBuckets;
+        Node* volatile pHeads[1];  // Actually numBuckets entries.
+    };
+
+    struct Shard
+    {
+        Mutex                 lock;
+        BucketArray* volatile pBuckets;
+        volatile uint32       numEntries;
+        Retired*              pRetiredHead;  // Oldest retired object.
+        Retired*              pRetiredTail;  // Newest retired object.
+        uint32                numRetired;
+    };
+
+    // Shards and reader slots are padded to a cache line each so threads working on different ones don't share lines.
+    struct PaddedShard : Shard
+    {
+        uint8 padding[PAL_CACHE_LINE_BYTES - (sizeof(Shard) % PAL_CACHE_LINE_BYTES)];
+    };
+
+    struct ReaderSlot
+    {
+        volatile uint32 epoch;
+        uint8           padding[PAL_CACHE_LINE_BYTES - sizeof(uint32)];
+    };
+
+    static Node* ReadNode(Node*const volatile* ppNode)
+        { return static_cast<Node*>(AtomicReadAcquirePointer(reinterpret_cast<void*const volatile*>(ppNode))); }
+    static void PublishNode(Node* volatile* ppNode, Node* pNode)
+        { AtomicWriteReleasePointer(reinterpret_cast<void*volatile*>(ppNode), pNode); }
+
+    uint32 HashKey(const Key& key) const { return m_hashFunc(&key, sizeof(Key)); }
+    Shard* GetShard(uint32 hash) const { return &m_pShards[hash & (NumShards - 1)]; }
+    static Node* volatile* GetBucket(BucketArray* pBuckets, uint32 hash)
+        { return &pBuckets->pHeads[(hash >> ShardShift) & (pBuckets->numBuckets - 1)]; }
+
+    ReaderSlot* EnterReader() const;
+    void ExitReader(ReaderSlot* pSlot) const { AtomicWriteRelease(&pSlot->epoch, InactiveEpoch); }
+
+    Node* volatile* FindLink(Shard* pShard, const Key& key, uint32 hash) const;
+    Node* CreateNode(const Key& key, const Value& value, uint32 hash);
+    BucketArray* CreateBucketArray(uint32 numBuckets);
+    void Grow(Shard* pShard);
+
+    void Retire(Shard* pShard, Retired* pRetired);
+    void Reclaim(Shard* pShard);
+    void TryAdvanceEpoch();
+    void FreeRetired(Retired* pRetired);
+
+    const uint32         m_numBuckets;    // Initial total number of buckets.
+    Allocator*const      m_pAllocator;
+    const HashFunc<Key>  m_hashFunc;
+    const EqualFunc<Key> m_equalFunc;
+
+    PaddedShard*         m_pShards;
+    ReaderSlot*          m_pReaderSlots;
+    volatile uint32      m_epoch;         // Current reclamation epoch.  Always odd.
+
+    PAL_DISALLOW_DEFAULT_CTOR(ConcurrentHashMap);
+    PAL_DISALLOW_COPY_AND_ASSIGN(ConcurrentHashMap);
+};
+
+} // Util
@@ -0,0 +1,627 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palConcurrentHashMapImpl.h
+ * @brief PAL utility collection ConcurrentHashMap class implementation.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palConcurrentHashMap.h"
+#include "palHashBaseImpl.h"
+#include "palInlineFuncs.h"
+#include "palSysMemory.h"
+
+namespace Util
+{
+
+// =====================================================================================================================
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::ConcurrentHashMap(
+    uint32          numBuckets,
+    Allocator*const pAllocator)
+    :
+    m_numBuckets(numBuckets),
+    m_pAllocator(pAllocator),
+    m_hashFunc(),
+    m_equalFunc(),
+    m_pShards(nullptr),
+    m_pReaderSlots(nullptr),
+    m_epoch(FirstEpoch)
+{
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::~ConcurrentHashMap()
+{
+    if (m_pShards != nullptr)
+    {
+        for (uint32 i = 0; i < NumShards; i++)
+        {
+            Shard*const pShard = &m_pShards[i];
+
+            // No reader can be left, so everything retired can go along with the live bucket array.
+            while (pShard->pRetiredHead != nullptr)
+            {
+                Retired*const pRetired = pShard->pRetiredHead;
+                pShard->pRetiredHead   = pRetired->pNext;
+
+                FreeRetired(pRetired);
+            }
+
+            if (pShard->pBuckets != nullptr)
+            {
+                FreeRetired(&pShard->pBuckets->retired);
+            }
+
+            pShard->~Shard();
+        }
+
+        PAL_SAFE_FREE(m_pShards, m_pAllocator);
+    }
+
+    PAL_SAFE_FREE(m_pReaderSlots, m_pAllocator);
+}
+
+// =====================================================================================================================
+// Allocates the shards, the reader slots and an initial bucket array for each shard.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+Result ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::Init()
+{
+    PAL_ASSERT(m_pShards == nullptr);
+
+    Result result = Result::ErrorOutOfMemory;
+
+    m_pReaderSlots = static_cast<ReaderSlot*>(PAL_CALLOC_ALIGNED(sizeof(ReaderSlot) * NumReaderSlots,
+                                                                 PAL_CACHE_LINE_BYTES,
+                                                                 m_pAllocator,
+                                                                 AllocInternal));
+
+    if (m_pReaderSlots != nullptr)
+    {
+        m_pShards = static_cast<PaddedShard*>(PAL_MALLOC_ALIGNED(sizeof(PaddedShard) * NumShards,
+                                                                 PAL_CACHE_LINE_BYTES,
+                                                                 m_pAllocator,
+                                                                 AllocInternal));
+    }
+
+    if (m_pShards != nullptr)
+    {
+        const uint32 numBuckets = Pow2Pad(Max(m_numBuckets / NumShards, 1u));
+
+        result = Result::Success;
+
+        for (uint32 i = 0; i < NumShards; i++)
+        {
+            Shard*const pShard = PAL_PLACEMENT_NEW(&m_pShards[i]) Shard();
+
+            pShard->pBuckets     = CreateBucketArray(numBuckets);
+            pShard->numEntries   = 0;
+            pShard->pRetiredHead = nullptr;
+            pShard->pRetiredTail = nullptr;
+            pShard->numRetired   = 0;
+
+            if (pShard->pBuckets == nullptr)
+            {
+                result = Result::ErrorOutOfMemory;
+            }
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Claims a reader slot and announces the current epoch in it.  Until the slot is released no writer can free anything
+// which is still reachable from the map at this point.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+typename ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::ReaderSlot*
+    ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::EnterReader() const
+{
+    // Threads have their stacks far apart, so the address of a local spreads concurrent readers over the slots.
+    const uint32 stackMarker = 0;
+    const uint32 stackHash   = static_cast<uint32>(reinterpret_cast<size_t>(&stackMarker) >> 12) * 0x9E3779B9u;
+
+    uint32      index = (stackHash >> 16) & (NumReaderSlots - 1);
+    ReaderSlot* pSlot = nullptr;
+
+    for (uint32 attempt = 1; pSlot == nullptr; attempt++)
+    {
+        const uint32 epoch = AtomicReadAcquire(&m_epoch);
+
+        // The compare-and-swap is a full barrier, so none of this reader's loads from the map can happen before the
+        // epoch is visible to writers.
+        if (AtomicCompareAndSwap(&m_pReaderSlots[index].epoch, InactiveEpoch, epoch) == InactiveEpoch)
+        {
+            pSlot = &m_pReaderSlots[index];
+        }
+        else
+        {
+            index = (index + 1) & (NumReaderSlots - 1);
+
+            if ((attempt % NumReaderSlots) == 0)
+            {
+                YieldThread();
+            }
+        }
+    }
+
+    return pSlot;
+}
+
+// =====================================================================================================================
+// Searches for the value that matches the key without taking any lock.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+bool ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::Find(
+    const Key& key,
+    Value*     pValue
+    ) const
+{
+    PAL_ASSERT(m_pShards != nullptr);
+
+    const uint32 hash   = HashKey(key);
+    Shard*const  pShard = GetShard(hash);
+    bool         found  = false;
+
+    ReaderSlot*const pSlot = EnterReader();
+
+    BucketArray*const pBuckets =
+        static_cast<BucketArray*>(AtomicReadAcquirePointer(reinterpret_cast<void*const volatile*>(&pShard->pBuckets)));
+
+    for (const Node* pNode = ReadNode(GetBucket(pBuckets, hash)); pNode != nullptr; pNode = ReadNode(&pNode->pNext))
+    {
+        if ((pNode->hash == hash) && m_equalFunc(pNode->key, key))
+        {
+            if (pValue != nullptr)
+            {
+                *pValue = pNode->value;
+            }
+
+            found = true;
+            break;
+        }
+    }
+
+    ExitReader(pSlot);
+
+    return found;
+}
+
+// =====================================================================================================================
+// Returns the link which points to the node of the key in the shard's current bucket array, or the link at the end of
+// its bucket's chain if there's no such node.  The caller must hold the shard's lock.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+typename ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::Node* volatile*
+    ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::FindLink(
+        Shard*     pShard,
+        const Key& key,
+        uint32     hash
+        ) const
+{
+    Node* volatile* ppLink = GetBucket(pShard->pBuckets, hash);
+
+    while ((*ppLink != nullptr) && (((*ppLink)->hash != hash) || (m_equalFunc((*ppLink)->key, key) == false)))
+    {
+        ppLink = &(*ppLink)->pNext;
+    }
+
+    return ppLink;
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+typename ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::Node*
+    ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::CreateNode(
+        const Key&   key,
+        const Value& value,
+        uint32       hash)
+{
+    Node*const pNode = static_cast<Node*>(PAL_MALLOC(sizeof(Node), m_pAllocator, AllocInternal));
+
+    if (pNode != nullptr)
+    {
+        pNode->retired.pNext         = nullptr;
+        pNode->retired.epoch         = InactiveEpoch;
+        pNode->retired.isBucketArray = false;
+        pNode->pNext                 = nullptr;
+        pNode->hash                  = hash;
+        pNode->key                   = key;
+        pNode->value                 = value;
+    }
+
+    return pNode;
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+typename ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::BucketArray*
+    ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::CreateBucketArray(
+        uint32 numBuckets)
+{
+    PAL_ASSERT(IsPowerOfTwo(numBuckets));
+
+    BucketArray*const pBuckets = static_cast<BucketArray*>(
+        PAL_CALLOC(offsetof(BucketArray, pHeads) + (sizeof(Node*) * numBuckets), m_pAllocator, AllocInternal));
+
+    if (pBuckets != nullptr)
+    {
+        pBuckets->retired.isBucketArray = true;
+        pBuckets->numBuckets            = numBuckets;
+    }
+
+    return pBuckets;
+}
+
+// =====================================================================================================================
+// Doubles the number of buckets of a shard.  Readers may still be walking the old chains, so the nodes are copied into
+// the new bucket array instead of being relinked, and the old array is retired along with its chains.  If memory runs
+// out the shard simply keeps its current buckets.  The caller must hold the shard's lock.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+void ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::Grow(
+    Shard* pShard)
+{
+    BucketArray*const pOldBuckets = pShard->pBuckets;
+    BucketArray*const pNewBuckets = CreateBucketArray(pOldBuckets->numBuckets * 2);
+    bool              success     = (pNewBuckets != nullptr);
+
+    for (uint32 i = 0; success && (i < pOldBuckets->numBuckets); i++)
+    {
+        for (const Node* pNode = pOldBuckets->pHeads[i]; success && (pNode != nullptr); pNode = pNode->pNext)
+        {
+            Node*const pCopy = CreateNode(pNode->key, pNode->value, pNode->hash);
+
+            if (pCopy != nullptr)
+            {
+                Node* volatile*const ppBucket = GetBucket(pNewBuckets, pCopy->hash);
+
+                pCopy->pNext = *ppBucket;
+                *ppBucket    = pCopy;
+            }
+            else
+            {
+                success = false;
+            }
+        }
+    }
+
+    if (success)
+    {
+        AtomicWriteReleasePointer(reinterpret_cast<void*volatile*>(&pShard->pBuckets), pNewBuckets);
+        Retire(pShard, &pOldBuckets->retired);
+    }
+    else if (pNewBuckets != nullptr)
+    {
+        // Nothing has seen the new array yet, so it can be freed right away.
+        FreeRetired(&pNewBuckets->retired);
+    }
+}
+
+// =====================================================================================================================
+// Inserts a key/value pair if the key isn't present yet.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+Result ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::Insert(
+    const Key&   key,
+    const Value& value)
+{
+    PAL_ASSERT(m_pShards != nullptr);
+
+    const uint32 hash   = HashKey(key);
+    Shard*const  pShard = GetShard(hash);
+    Result       result = Result::Success;
+
+    MutexAuto lock(&pShard->lock);
+
+    if (*FindLink(pShard, key, hash) != nullptr)
+    {
+        result = Result::AlreadyExists;
+    }
+    else
+    {
+        if (pShard->numEntries >= pShard->pBuckets->numBuckets)
+        {
+            Grow(pShard);
+        }
+
+        Node*const pNode = CreateNode(key, value, hash);
+
+        if (pNode != nullptr)
+        {
+            Node* volatile*const ppBucket = GetBucket(pShard->pBuckets, hash);
+
+            pNode->pNext = *ppBucket;
+            PublishNode(ppBucket, pNode);
+            AtomicWriteRelease(&pShard->numEntries, pShard->numEntries + 1);
+        }
+        else
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+    }
+
+    Reclaim(pShard);
+
+    return result;
+}
+
+// =====================================================================================================================
+// Replaces the value of an existing entry by linking a new node in place of the old one.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+Result ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::Replace(
+    const Key&   key,
+    const Value& value)
+{
+    PAL_ASSERT(m_pShards != nullptr);
+
+    const uint32 hash   = HashKey(key);
+    Shard*const  pShard = GetShard(hash);
+    Result       result = Result::NotFound;
+
+    MutexAuto lock(&pShard->lock);
+
+    Node* volatile*const ppLink = FindLink(pShard, key, hash);
+    Node*const           pOld   = *ppLink;
+
+    if (pOld != nullptr)
+    {
+        Node*const pNode = CreateNode(key, value, hash);
+
+        if (pNode != nullptr)
+        {
+            pNode->pNext = pOld->pNext;
+            PublishNode(ppLink, pNode);
+            Retire(pShard, &pOld->retired);
+
+            result = Result::Success;
+        }
+        else
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+    }
+
+    Reclaim(pShard);
+
+    return result;
+}
+
+// =====================================================================================================================
+// Unlinks the entry of the key.  Readers which already reached the node can still follow its link to the rest of the
+// chain until it's reclaimed.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+bool ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::Erase(
+    const Key& key)
+{
+    PAL_ASSERT(m_pShards != nullptr);
+
+    const uint32 hash   = HashKey(key);
+    Shard*const  pShard = GetShard(hash);
+
+    MutexAuto lock(&pShard->lock);
+
+    Node* volatile*const ppLink = FindLink(pShard, key, hash);
+    Node*const           pNode  = *ppLink;
+
+    if (pNode != nullptr)
+    {
+        PublishNode(ppLink, pNode->pNext);
+        AtomicWriteRelease(&pShard->numEntries, pShard->numEntries - 1);
+        Retire(pShard, &pNode->retired);
+    }
+
+    Reclaim(pShard);
+
+    return (pNode != nullptr);
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+uint32 ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::GetNumEntries() const
+{
+    uint32 numEntries = 0;
+
+    for (uint32 i = 0; i < NumShards; i++)
+    {
+        numEntries += AtomicReadAcquire(&m_pShards[i].numEntries);
+    }
+
+    return numEntries;
+}
+
+// =====================================================================================================================
+// Stamps an unlinked object with the current epoch and queues it on the shard.  The caller must hold the shard's lock.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+void ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::Retire(
+    Shard*   pShard,
+    Retired* pRetired)
+{
+    // Read the epoch with a full barrier: if the read could move ahead of the store which unlinked the object, a reader
+    // announcing a newer epoch could still find the object while we stamp it with an older one.
+    pRetired->epoch = AtomicOr(&m_epoch, 0);
+    pRetired->pNext = nullptr;
+
+    if (pShard->pRetiredTail != nullptr)
+    {
+        pShard->pRetiredTail->pNext = pRetired;
+    }
+    else
+    {
+        pShard->pRetiredHead = pRetired;
+    }
+
+    pShard->pRetiredTail = pRetired;
+    pShard->numRetired++;
+}
+
+// =====================================================================================================================
+// Frees the shard's retired objects which no reader can reach anymore.  Advancing the epoch means scanning every reader
+// slot, so that's only attempted once enough objects are waiting.  The caller must hold the shard's lock.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+void ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::Reclaim(
+    Shard* pShard)
+{
+    if (pShard->numRetired >= ReclaimBatchSize)
+    {
+        TryAdvanceEpoch();
+    }
+
+    const uint32 epoch = AtomicReadAcquire(&m_epoch);
+
+    // A reader which can still reach an object announced the epoch it was retired in or an older one, so it keeps the
+    // epoch from advancing twice.  Readers which announce a later epoch started after the unlink.
+    while ((pShard->pRetiredHead != nullptr) && ((epoch - pShard->pRetiredHead->epoch) >= (2 * EpochStep)))
+    {
+        Retired*const pRetired = pShard->pRetiredHead;
+        pShard->pRetiredHead   = pRetired->pNext;
+        pShard->numRetired--;
+
+        FreeRetired(pRetired);
+    }
+
+    if (pShard->pRetiredHead == nullptr)
+    {
+        pShard->pRetiredTail = nullptr;
+    }
+}
+
+// =====================================================================================================================
+// Advances the global epoch if every active reader has announced the current one.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+void ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::TryAdvanceEpoch()
+{
+    const uint32 epoch      = AtomicReadAcquire(&m_epoch);
+    bool         canAdvance = true;
+
+    for (uint32 i = 0; canAdvance && (i < NumReaderSlots); i++)
+    {
+        const uint32 readerEpoch = AtomicReadAcquire(&m_pReaderSlots[i].epoch);
+
+        canAdvance = ((readerEpoch == InactiveEpoch) || (readerEpoch == epoch));
+    }
+
+    if (canAdvance)
+    {
+        // Another shard's writer may have advanced the epoch already, in which case this does nothing.
+        AtomicCompareAndSwap(&m_epoch, epoch, epoch + EpochStep);
+    }
+}
+
+// =====================================================================================================================
+// Returns a retired object's memory to the allocator.  A bucket array takes its chains with it.
+template<typename Key,
+         typename Value,
+         typename Allocator,
+         template<typename> class HashFunc,
+         template<typename> class EqualFunc>
+void ConcurrentHashMap<Key, Value, Allocator, HashFunc, EqualFunc>::FreeRetired(
+    Retired* pRetired)
+{
+    if (pRetired->isBucketArray)
+    {
+        BucketArray*const pBuckets = reinterpret_cast<BucketArray*>(pRetired);
+
+        for (uint32 i = 0; i < pBuckets->numBuckets; i++)
+        {
+            Node* pNode = pBuckets->pHeads[i];
+
+            while (pNode != nullptr)
+            {
+                Node*const pNext = pNode->pNext;
+                PAL_FREE(pNode, m_pAllocator);
+                pNode = pNext;
+            }
+        }
+    }
+
+    PAL_FREE(pRetired, m_pAllocator);
+}
+
+} // Util
@@ -34,7 +34,7 @@
 #include "palUtil.h"
 #include "palMutex.h"
 
-#if   defined(__unix__)
+#if   defined(__unix__) && (PAL_CLIENT_INTERFACE_MAJOR_VERSION < 692)
 #include <pthread.h>
 #endif
 
@@ -50,7 +50,10 @@ class ConditionVariable
 {
 public:
 
-#if   defined(__unix__)
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    ConditionVariable() noexcept : m_sequence(0), m_numWaiters(0) { }
+    ~ConditionVariable() noexcept { }
+#elif defined(__unix__)
     /// Defines ConditionVariableData as a unix pthread_cond_t
     typedef pthread_cond_t ConditionVariableData;
     /// @note pthread_cond_init will not fail as called
@@ -76,7 +79,14 @@ public:
     void WakeAll();
 
 private:
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    void Wake(bool wakeAll);
+
+    volatile uint32 m_sequence;   // Incremented by every wake which finds a waiter.  Waiters sleep on it.
+    volatile uint32 m_numWaiters; // Number of threads inside Wait().
+#else
     ConditionVariableData m_osCondVariable; // os-specific ConditionVariable structure.
+#endif
 
     PAL_DISALLOW_COPY_AND_ASSIGN(ConditionVariable);
 };
@@ -33,6 +33,7 @@
 
 #include "palAssert.h"
 #include "palSysMemory.h"
+#include <type_traits>
 
 namespace Util
 {
@@ -100,9 +101,8 @@ private:
  *
  * @warning This class is not thread-safe for push, pop, or iteration!
  *
- * @note This class is only designed to work with native types and POD-style structures. If it is needed to have a Deque
- *       of complex objects with nontrivial destructors, copy constructors or assign operators, then a specialized
- *       implementation of CleanupElement() will need to be explicitly defined.
+ * @note Elements are constructed in place and destroyed when they're popped, and popped elements are moved out, so the
+ *       deque also works with objects which have nontrivial destructors or can only be moved.
  ***********************************************************************************************************************
  */
 template<typename T, typename Allocator>
@@ -161,6 +161,14 @@ public:
     ///          failed because of an internal failure to allocate system memory.
     Result PushFront(const T& data);
 
+    /// Moves the specified item onto the front of the deque.
+    ///
+    /// @param [in] data Item to be added to the front of the deque.
+    ///
+    /// @returns @ref Success if the item was successfully added to the deque or @ref ErrorOutOfMemory if the operation
+    ///          failed because of an internal failure to allocate system memory.
+    Result PushFront(T&& data) { return EmplaceFront(Move(data)); }
+
     /// Emplaces a newly constructed item onto the front of the deque.
     ///
     /// @param [in] args arguments used to construct the new item.
@@ -178,6 +186,14 @@ public:
     ///          failed because of an internal failure to allocate system memory.
     Result PushBack(const T& data);
 
+    /// Moves the specified item onto the back of the deque.
+    ///
+    /// @param [in] data Item to be added to the back of the deque.
+    ///
+    /// @returns @ref Success if the item was successfully added to the deque or @ref ErrorOutOfMemory if the operation
+    ///          failed because of an internal failure to allocate system memory.
+    Result PushBack(T&& data) { return EmplaceBack(Move(data)); }
+
     /// Emplaces a newly constructed item onto the back of the deque.
     ///
     /// @param [in] args arguments used to construct the new item.
@@ -204,6 +220,9 @@ public:
     Result PopBack(T* pOut);
 
 private:
+    // Maximum number of empty blocks kept around for reuse.
+    static constexpr uint32 MaxFreeBlocks = 4;
+
     Result AllocateFront(T**);
     Result AllocateBack(T**);
     DequeBlockHeader* AllocateNewBlock();
@@ -218,7 +237,8 @@ private:
     T*                m_pFront;              // First data element, null for empty deques.
     T*                m_pBack;               // Last data element, null for empty deques.
 
-    DequeBlockHeader* m_pLazyFreeHeader;     // Cached pointer to the most-recently freed block.
+    DequeBlockHeader* m_pFreeHeaders;        // Empty blocks kept for reuse, linked through pNext.
+    uint32            m_numFreeHeaders;      // Number of blocks in m_pFreeHeaders.
 
     Allocator*const   m_pAllocator;          // Pointer to the allocator for this deque.
 
@@ -242,7 +262,8 @@ Deque<T, Allocator>::Deque(
     m_pBackHeader(nullptr),
     m_pFront(nullptr),
     m_pBack(nullptr),
-    m_pLazyFreeHeader(nullptr),
+    m_pFreeHeaders(nullptr),
+    m_numFreeHeaders(0),
     m_pAllocator(pAllocator)
 {
 }
@@ -255,7 +276,7 @@ Deque<T, Allocator>::~Deque()
     while (m_pFrontHeader != nullptr)
     {
         // Explicitly destroy the removed value if it's non-trivial.
-        if (!std::is_pod<T>::value)
+        if (std::is_trivially_destructible<T>::value == false)
         {
             m_pFront->~T();
         }
@@ -276,9 +297,11 @@ Deque<T, Allocator>::~Deque()
         }
     }
 
-    if (m_pLazyFreeHeader != nullptr)
+    while (m_pFreeHeaders != nullptr)
     {
-        PAL_SAFE_FREE(m_pLazyFreeHeader, m_pAllocator);
+        DequeBlockHeader* pBlockToFree = m_pFreeHeaders;
+        m_pFreeHeaders = m_pFreeHeaders->pNext;
+        PAL_SAFE_FREE(pBlockToFree, m_pAllocator);
     }
 }
 
@@ -39,17 +39,18 @@ namespace Util
 {
 
 // =====================================================================================================================
-// Allocates a new block for storing additional data elements.  If the lazy-free block is present, just use that instead
-// of allocating more memory.
+// Allocates a new block for storing additional data elements.  If a previously freed block is available, just use that
+// instead of allocating more memory.
 template<typename T, typename Allocator>
 DequeBlockHeader* Deque<T, Allocator>::AllocateNewBlock()
 {
     DequeBlockHeader* pNewBlock = nullptr;
 
-    if (m_pLazyFreeHeader != nullptr)
+    if (m_pFreeHeaders != nullptr)
     {
-        pNewBlock         = m_pLazyFreeHeader;
-        m_pLazyFreeHeader = nullptr;
+        pNewBlock      = m_pFreeHeaders;
+        m_pFreeHeaders = m_pFreeHeaders->pNext;
+        --m_numFreeHeaders;
 
         // Fill in the newly allocated header. The caller is responsible for properly attaching the new block's header
         // to the list.
@@ -81,18 +82,20 @@ DequeBlockHeader* Deque<T, Allocator>::AllocateNewBlock()
 }
 
 // =====================================================================================================================
-// If there is currently no lazy-free block, cache the given block so that the next block allocation will be faster. If
-// the lazy-free block already exists, actually frees the block's memory.
+// If fewer than MaxFreeBlocks blocks are cached, cache the given block so that a later block allocation will be faster.
+// Otherwise, actually frees the block's memory.
 //
-// The reason for this is because some use cases might cause us to ping-pong between N and N+1 blocks, which would
-// result in excessive calls to PAL_MALLOC & PAL_FREE.
+// The reason for this is because some use cases might cause us to ping-pong between N and N+1 blocks, or drain and
+// refill a deque of a few blocks over and over, which would result in excessive calls to PAL_MALLOC & PAL_FREE.
 template<typename T, typename Allocator>
 void Deque<T, Allocator>::FreeUnusedBlock(
     DequeBlockHeader* pHeader)
 {
-    if (m_pLazyFreeHeader == nullptr)
+    if (m_numFreeHeaders < MaxFreeBlocks)
     {
-        m_pLazyFreeHeader = pHeader;
+        pHeader->pNext = m_pFreeHeaders;
+        m_pFreeHeaders = pHeader;
+        ++m_numFreeHeaders;
     }
     else
     {
@@ -277,11 +280,11 @@ Result Deque<T, Allocator>::PopFront(
         // First, copy the front element into the output buffer and clean up our copy of it.
         if (pOut != nullptr)
         {
-            *pOut = *m_pFront;
+            *pOut = Move(*m_pFront);
         }
 
         // Explicitly destroy the removed value if it's non-trivial.
-        if (!std::is_pod<T>::value)
+        if (std::is_trivially_destructible<T>::value == false)
         {
             m_pFront->~T();
         }
@@ -338,11 +341,11 @@ Result Deque<T, Allocator>::PopBack(
         // First, copy the back element into the output buffer and clean up our copy of it.
         if (pOut != nullptr)
         {
-            *pOut = *m_pBack;
+            *pOut = Move(*m_pBack);
         }
 
         // Explicitly destroy the removed value if it's non-trivial.
-        if (!std::is_pod<T>::value)
+        if (std::is_trivially_destructible<T>::value == false)
         {
             m_pBack->~T();
         }
@@ -0,0 +1,111 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palEventCount.h
+ * @brief PAL utility collection EventCount class declaration.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palMutex.h"
+
+namespace Util
+{
+
+/**
+ ***********************************************************************************************************************
+ * @brief Lets threads sleep until a lock-free condition may have changed, without costing the signaling side a system
+ *        call unless somebody is actually asleep.
+ *
+ * A waiter calls BeginWait() once, then loops: it reads a key through PrepareWait(), rechecks its condition and, if the
+ * condition still doesn't hold, calls Wait() with that key.  It calls EndWait() once it's done.  The signaling thread
+ * makes the condition true and then calls Notify(), which is only a memory barrier and a load when nobody waits.
+ *
+ * Notify() bumps the key before waking anyone, so a Notify() which lands between a waiter's PrepareWait() and Wait()
+ * makes that Wait() return immediately instead of being lost.
+ ***********************************************************************************************************************
+ */
+class EventCount
+{
+public:
+    /// Wait time which never times out.
+    static constexpr uint32 Infinite = 0xFFFFFFFF;
+    /// Number of times a waiter should yield and recheck its condition before it registers and goes to sleep.
+    static constexpr uint32 SpinCount = 16;
+
+    EventCount() : m_key(0), m_numWaiters(0) { }
+    ~EventCount() { PAL_ASSERT(m_numWaiters == 0); }
+
+    /// Registers the calling thread as a waiter.  Must be called before the waiter first checks its condition.
+    void BeginWait() { AtomicIncrement(&m_numWaiters); }
+
+    /// Unregisters the calling thread as a waiter.
+    void EndWait() { AtomicDecrement(&m_numWaiters); }
+
+    /// Returns the key to pass to Wait().  Must be read before the waiter rechecks its condition.
+    uint32 PrepareWait() const { return AtomicReadAcquire(&m_key); }
+
+    /// Sleeps until Notify() is called after the key was read, or until the deadline passes.
+    ///
+    /// @param [in] key      Key returned by PrepareWait().
+    /// @param [in] deadline Deadline returned by ComputeDeadline().
+    ///
+    /// @returns @ref Timeout if the deadline has passed, otherwise @ref Success.  Success doesn't guarantee that the
+    ///          condition holds, so the caller must recheck it.
+    Result Wait(uint32 key, int64 deadline);
+
+    /// Wakes threads sleeping in Wait().  Must be called after the condition has been made true.
+    ///
+    /// @param [in] wakeAll Wakes every sleeping thread if true, otherwise at most one.
+    void Notify(bool wakeAll)
+    {
+        // Order the write which made the condition true before the read of the waiter count.  A waiter increments the
+        // count before checking the condition, so either it sees the condition or we see the waiter.
+        AtomicThreadFence();
+
+        if (AtomicReadAcquire(&m_numWaiters) != 0)
+        {
+            AtomicIncrement(&m_key);
+            WakeOnAddress(&m_key, wakeAll);
+        }
+    }
+
+    /// Converts a wait time into a deadline for Wait().
+    ///
+    /// @param [in] milliseconds Wait time, or @ref Infinite.
+    ///
+    /// @returns The deadline, in GetPerfCpuTime() ticks, or -1 if it never passes.
+    static int64 ComputeDeadline(uint32 milliseconds);
+
+private:
+    volatile uint32 m_key;        // Bumped by every Notify() which finds a waiter.  Waiters sleep on it.
+    volatile uint32 m_numWaiters; // Number of threads between BeginWait() and EndWait().
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(EventCount);
+};
+
+} // Util
@@ -0,0 +1,401 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palFlatHashBase.h
+ * @brief PAL utility collection shared structures and class declarations used by the FlatHashMap and FlatHashSet
+ *        containers.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palHashBase.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define PAL_FLAT_HASH_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define PAL_FLAT_HASH_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Util
+{
+
+// Forward declarations.
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc> class FlatHashBase;
+
+/// Control byte values for the slots of a flat hash container.  A full slot stores the low 7 bits of its key's hash
+/// instead, so full slots are exactly the ones with the high bit clear.
+enum FlatHashCtrl : uint8
+{
+    FlatHashCtrlEmpty   = 0x80,  ///< The slot has never held an entry since the table was last cleared.
+    FlatHashCtrlDeleted = 0xFE,  ///< The slot held an entry which was erased.  Probes must continue past it.
+};
+
+/**
+ ***********************************************************************************************************************
+ * @brief  Bit mask of the slots in a @ref FlatHashGroup which matched a query.
+ *
+ * Each slot owns (1 << LaneShift) bits of the mask, of which only the lowest is ever set.
+ ***********************************************************************************************************************
+ */
+template<uint32 LaneShift>
+class FlatHashMask
+{
+public:
+    /// Constructor.
+    explicit FlatHashMask(uint64 mask) : m_mask(mask) { }
+
+    /// Returns true if any slot is left in the mask.
+    bool HasAny() const { return (m_mask != 0); }
+
+    /// Returns the index of the lowest slot left in the mask.  The mask must not be empty.
+    uint32 Lowest() const
+    {
+        uint32 bit = 0;
+        BitMaskScanForward(&bit, m_mask);
+
+        return (bit >> LaneShift);
+    }
+
+    /// Removes the lowest slot from the mask.
+    void ClearLowest() { m_mask &= (m_mask - 1); }
+
+    /// Removes every slot below the given slot index from the mask.
+    void ClearBelow(uint32 slot) { m_mask &= ~((1ull << (slot << LaneShift)) - 1); }
+
+private:
+    uint64 m_mask;
+};
+
+/**
+ ***********************************************************************************************************************
+ * @brief  One probing group of control bytes of a flat hash container.
+ *
+ * All control bytes of a group are compared against a hash tag at once: with SSE2 or NEON the group is 16 slots wide,
+ * otherwise it is 8 slots wide and compared with 64-bit integer math.
+ ***********************************************************************************************************************
+ */
+class FlatHashGroup
+{
+public:
+#if PAL_FLAT_HASH_SSE2
+    static constexpr uint32 Width     = 16;  ///< Number of slots in a group.
+    static constexpr uint32 LaneShift = 0;   ///< Log2 of the number of mask bits per slot.
+
+    /// Loads the control bytes of the group at pCtrl.
+    explicit FlatHashGroup(const uint8* pCtrl)
+        : m_ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pCtrl))) { }
+
+    /// Returns the slots whose control byte equals tag.
+    FlatHashMask<LaneShift> Match(uint8 tag) const
+    {
+        const __m128i match = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(tag)), m_ctrl);
+        return FlatHashMask<LaneShift>(static_cast<uint32>(_mm_movemask_epi8(match)));
+    }
+
+    /// Returns the slots which are empty.
+    FlatHashMask<LaneShift> MatchEmpty() const { return Match(FlatHashCtrlEmpty); }
+
+    /// Returns the slots which are empty or deleted; they are the only control bytes with the high bit set.
+    FlatHashMask<LaneShift> MatchEmptyOrDeleted() const
+        { return FlatHashMask<LaneShift>(static_cast<uint32>(_mm_movemask_epi8(m_ctrl))); }
+
+    /// Returns the slots which hold an entry.
+    FlatHashMask<LaneShift> MatchFull() const
+        { return FlatHashMask<LaneShift>(static_cast<uint32>(_mm_movemask_epi8(m_ctrl)) ^ 0xFFFF); }
+
+private:
+    __m128i m_ctrl;
+#elif PAL_FLAT_HASH_NEON
+    static constexpr uint32 Width     = 16;  ///< Number of slots in a group.
+    static constexpr uint32 LaneShift = 2;   ///< Log2 of the number of mask bits per slot.
+
+    /// Loads the control bytes of the group at pCtrl.
+    explicit FlatHashGroup(const uint8* pCtrl) : m_ctrl(vld1q_u8(pCtrl)) { }
+
+    /// Returns the slots whose control byte equals tag.
+    FlatHashMask<LaneShift> Match(uint8 tag) const { return ToMask(vceqq_u8(m_ctrl, vdupq_n_u8(tag))); }
+
+    /// Returns the slots which are empty.
+    FlatHashMask<LaneShift> MatchEmpty() const { return Match(FlatHashCtrlEmpty); }
+
+    /// Returns the slots which are empty or deleted; they are the only control bytes with the high bit set.
+    FlatHashMask<LaneShift> MatchEmptyOrDeleted() const
+        { return ToMask(vcltq_s8(vreinterpretq_s8_u8(m_ctrl), vdupq_n_s8(0))); }
+
+    /// Returns the slots which hold an entry.
+    FlatHashMask<LaneShift> MatchFull() const
+        { return ToMask(vcgeq_s8(vreinterpretq_s8_u8(m_ctrl), vdupq_n_s8(0))); }
+
+private:
+    // Narrows a vector of 0x00/0xFF bytes to 4 bits per slot and keeps one bit of each.
+    static FlatHashMask<LaneShift> ToMask(uint8x16_t match)
+    {
+        const uint8x8_t narrow = vshrn_n_u16(vreinterpretq_u16_u8(match), 4);
+        return FlatHashMask<LaneShift>(vget_lane_u64(vreinterpret_u64_u8(narrow), 0) & 0x1111111111111111ull);
+    }
+
+    uint8x16_t m_ctrl;
+#else
+    static constexpr uint32 Width     = 8;   ///< Number of slots in a group.
+    static constexpr uint32 LaneShift = 3;   ///< Log2 of the number of mask bits per slot.
+
+    /// Loads the control bytes of the group at pCtrl.  Slot i always lands in byte i of m_ctrl, whatever the
+    /// endianness of the CPU.
+    explicit FlatHashGroup(const uint8* pCtrl)
+        : m_ctrl(0)
+    {
+        for (uint32 i = 0; i < Width; ++i)
+        {
+            m_ctrl |= (static_cast<uint64>(pCtrl[i]) << (i * 8));
+        }
+    }
+
+    /// Returns the slots whose control byte equals tag.  This may report a false match in the byte following a true
+    /// match, which only costs an extra key comparison.
+    FlatHashMask<LaneShift> Match(uint8 tag) const
+    {
+        const uint64 x = m_ctrl ^ (Lsbs * tag);
+        return FlatHashMask<LaneShift>((x - Lsbs) & ~x & Msbs);
+    }
+
+    /// Returns the slots which are empty: the high bit is set and bit 1 is clear.
+    FlatHashMask<LaneShift> MatchEmpty() const { return FlatHashMask<LaneShift>(m_ctrl & ~(m_ctrl << 6) & Msbs); }
+
+    /// Returns the slots which are empty or deleted; they are the only control bytes with the high bit set.
+    FlatHashMask<LaneShift> MatchEmptyOrDeleted() const { return FlatHashMask<LaneShift>(m_ctrl & Msbs); }
+
+    /// Returns the slots which hold an entry.
+    FlatHashMask<LaneShift> MatchFull() const { return FlatHashMask<LaneShift>(~m_ctrl & Msbs); }
+
+private:
+    static constexpr uint64 Lsbs = 0x0101010101010101ull;
+    static constexpr uint64 Msbs = 0x8080808080808080ull;
+
+    uint64 m_ctrl;
+#endif
+};
+
+/**
+ ***********************************************************************************************************************
+ * @brief  Iterator for traversal of elements in a flat hash container.
+ *
+ * Any insertion or erasure invalidates the iterator.
+ ***********************************************************************************************************************
+ */
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+class FlatHashIterator
+{
+public:
+    /// Convenience typedef for the associated container for this templated iterator.
+    typedef FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc> Container;
+
+    ~FlatHashIterator() { }
+
+    /// Returns a pointer to current entry.  Will return null if the iterator has been advanced off the end of the
+    /// container.
+    Entry* Get() const { return m_pCurrentEntry; }
+
+    /// Advances the iterator to the next position (move forward).
+    void Next();
+
+private:
+    explicit FlatHashIterator(const Container* pContainer);
+
+    // Moves to the first full slot at or after m_slot, switching from the old table to the current one at its end.
+    void Advance();
+
+    const Container* const m_pContainer;     // Hash container that we're iterating over.
+    uint32                 m_table;          // Table we're iterating: 0 for the old table, 1 for the current one.
+    uint32                 m_slot;           // Index of the current slot in that table.
+    Entry*                 m_pCurrentEntry;  // Current entry we're at now.
+
+    PAL_DISALLOW_DEFAULT_CTOR(FlatHashIterator);
+
+    // Although this is a transgression of coding standards, it means that Container does not need to have a public
+    // interface specifically to implement this class. The added encapsulation this provides is worthwhile.
+    friend class FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>;
+};
+
+/**
+ ***********************************************************************************************************************
+ * @brief Templated base class for FlatHashMap and FlatHashSet, supporting the ability to store, find, and remove
+ *        entries.
+ *
+ * This is an open-addressing ("Swiss table") hash container which grows as entries are added.  Every slot has a one
+ * byte control tag which is either empty, deleted, or 7 bits of the hash of the key stored in the slot.  The tags are
+ * kept apart from the entries and probed a group at a time with SIMD compares (see @ref FlatHashGroup), so a lookup
+ * usually compares a single key and touches one line of tags and one line of entries, even at high load.  Groups are
+ * probed triangularly, which visits every group of a power-of-two table.
+ *
+ * The table grows by doubling once 7/8 of its slots are in use.  Growth is incremental: the old table is kept, lookups
+ * check both tables, and each later insertion or erasure moves a couple of old groups into the new table.  This bounds
+ * the cost of any one insertion instead of rehashing every entry at once.  Tables which are mostly deleted slots are
+ * rehashed at the same size instead of growing.
+ *
+ * Compared to @ref HashBase:
+ *
+ * - The container grows with its contents, so the initial capacity is only a hint.
+ * - Pointers to entries are invalidated by any insertion or erasure, since entries may be moved between tables.
+ * - The Key and Value must be POD-style types; entries are moved with memcpy.
+ * - The hash functors of @ref HashBase are reused.  Their 32-bit result is mixed further, so weak hashes such as
+ *   DefaultHashFunc are fine.
+ *
+ * @warning This class is not thread-safe!
+ ***********************************************************************************************************************
+ */
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+class FlatHashBase
+{
+public:
+    /// Convenience typedef for iterators of this templated FlatHashBase.
+    typedef FlatHashIterator<Key, Entry, Allocator, HashFunc, EqualFunc> Iterator;
+
+    /// Initializes the hash container by allocating a table for the initial capacity.
+    ///
+    /// @returns @ref Success if the initialization completed successfully, or ErrorOutOfMemory if the operation failed
+    ///          due to an internal failure to allocate system memory.
+    Result Init();
+
+    /// Returns number of entries in the container.
+    uint32 GetNumEntries() const { return m_numEntries; }
+
+    /// Returns the number of entries the container can hold before it must grow.
+    uint32 GetCapacity() const { return m_numEntries + m_cur.growthLeft; }
+
+    /// Returns an iterator pointing to the first entry.
+    Iterator Begin() const { return Iterator(this); }
+
+    /// Empty the hash container.  The current table is kept for reuse.
+    void Reset();
+
+protected:
+    /// @internal Constructor
+    ///
+    /// @param [in] numEntries Number of entries the container should be able to hold without growing.
+    /// @param [in] pAllocator The allocator that will allocate memory if required.
+    FlatHashBase(uint32 numEntries, Allocator*const pAllocator);
+    virtual ~FlatHashBase();
+
+    /// @internal Finds the entry that matches the specified key.
+    ///
+    /// @param [in] key Key to search for.
+    ///
+    /// @returns Pointer to the matching entry or null if there is none.
+    Entry* FindEntry(const Key& key) const;
+
+    /// @internal Finds the entry that matches the specified key and allocates a zero-initialized one if there is none.
+    ///
+    /// @param [in]  key      Key to search for.
+    /// @param [out] pExisted True if the entry existed before this call.
+    /// @param [out] ppEntry  Matching or new entry.
+    ///
+    /// @returns @ref Success, or ErrorOutOfMemory if the container had to grow and failed to allocate memory.
+    Result FindAllocateEntry(const Key& key, bool* pExisted, Entry** ppEntry);
+
+    /// @internal Removes the entry that matches the specified key.
+    ///
+    /// @param [in] key Key of the entry to erase.
+    ///
+    /// @returns True if an entry was erased, false if there was no entry for this key.
+    bool EraseEntry(const Key& key);
+
+    const HashFunc  m_hashFunc;   ///< @internal Hash functor object.
+    const EqualFunc m_equalFunc;  ///< @internal Key compare function object.
+
+private:
+    // One table of slots.  The control bytes come first, followed by the entries.
+    struct Table
+    {
+        void*  pMemory;     // Base address of the allocation holding the control bytes and entries.
+        uint8* pCtrl;       // One control byte per slot.
+        Entry* pSlots;      // Entry storage, one per slot.
+        uint32 groupMask;   // Number of groups minus one; the number of groups is a power of two.
+        uint32 numFull;     // Number of slots holding an entry.
+        uint32 growthLeft;  // Number of empty slots which may still be filled before the table is full.
+    };
+
+    // A key's hash split into the group where probing starts and the tag stored in the control byte.
+    struct HashInfo
+    {
+        uint32 group;
+        uint8  tag;
+    };
+
+    static constexpr uint32 GroupWidth = FlatHashGroup::Width;
+
+    // Number of old groups moved into the new table by each insertion or erasure while growing.  Moving one group per
+    // operation always finishes before the new table fills, this just finishes sooner.
+    static constexpr uint32 MigrateGroupsPerOp = 2;
+
+    // Old tables this small are moved in one go; it's cheaper than checking two tables for a while.
+    static constexpr uint32 MinIncrementalGroups = 8;
+
+    HashInfo ComputeHash(const Key& key) const;
+
+    static uint32 NumSlots(const Table& table) { return (table.groupMask + 1) * GroupWidth; }
+    static uint32 MaxFull(uint32 numSlots) { return (numSlots - (numSlots / 8)); }
+
+    Entry* FindInTable(const Table& table, const Key& key, const HashInfo& hash) const;
+    uint32 FindInsertSlot(const Table& table, const HashInfo& hash) const;
+    static void SetCtrl(Table* pTable, uint32 slot, uint8 ctrl) { pTable->pCtrl[slot] = ctrl; }
+    void   EraseSlot(Table* pTable, uint32 slot);
+
+    Result AllocTable(Table* pTable, uint32 numSlots);
+    void   FreeTable(Table* pTable);
+    Result Grow();
+    void   MigrateGroups(uint32 numGroups);
+
+    Allocator*const m_pAllocator;    // Allocator for the tables.
+    uint32          m_initialSlots;  // Number of slots of the table allocated by Init().
+    uint32          m_numEntries;    // Entries in both tables.
+    Table           m_cur;           // Table which new entries are inserted into.
+    Table           m_old;           // Table being moved into m_cur, or all zeros if none is.
+    uint32          m_migrateGroup;  // Next group of m_old to move into m_cur.
+
+    PAL_DISALLOW_DEFAULT_CTOR(FlatHashBase);
+    PAL_DISALLOW_COPY_AND_ASSIGN(FlatHashBase);
+
+    // Although this is a transgression of coding standards, it prevents FlatHashIterator requiring a public
+    // constructor.
+    friend class FlatHashIterator<Key, Entry, Allocator, HashFunc, EqualFunc>;
+};
+
+} // Util
@@ -0,0 +1,593 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palFlatHashBaseImpl.h
+ * @brief PAL utility collection shared class implementations used by the FlatHashMap and FlatHashSet containers.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palFlatHashBase.h"
+#include "palHashBaseImpl.h"
+
+namespace Util
+{
+
+// =====================================================================================================================
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+FlatHashIterator<Key, Entry, Allocator, HashFunc, EqualFunc>::FlatHashIterator(
+    const Container* pContainer)  ///< [retained] The hash container to iterate over
+    :
+    m_pContainer(pContainer),
+    m_table(0),
+    m_slot(0),
+    m_pCurrentEntry(nullptr)
+{
+    Advance();
+}
+
+// =====================================================================================================================
+// Proceeds to the next entry, null if to the end.
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+void FlatHashIterator<Key, Entry, Allocator, HashFunc, EqualFunc>::Next()
+{
+    if (m_pCurrentEntry != nullptr)
+    {
+        m_slot++;
+        Advance();
+    }
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+void FlatHashIterator<Key, Entry, Allocator, HashFunc, EqualFunc>::Advance()
+{
+    m_pCurrentEntry = nullptr;
+
+    for (; m_table < 2; ++m_table)
+    {
+        const auto& table = (m_table == 0) ? m_pContainer->m_old : m_pContainer->m_cur;
+
+        if (table.pMemory != nullptr)
+        {
+            const uint32 numSlots = Container::NumSlots(table);
+
+            // Scan a group at a time, skipping the slots of the first group which come before m_slot.
+            while ((m_pCurrentEntry == nullptr) && (m_slot < numSlots))
+            {
+                const uint32 groupBase = m_slot & ~(Container::GroupWidth - 1);
+
+                auto full = FlatHashGroup(&table.pCtrl[groupBase]).MatchFull();
+                full.ClearBelow(m_slot - groupBase);
+
+                if (full.HasAny())
+                {
+                    m_slot          = groupBase + full.Lowest();
+                    m_pCurrentEntry = &table.pSlots[m_slot];
+                }
+                else
+                {
+                    m_slot = groupBase + Container::GroupWidth;
+                }
+            }
+
+            if (m_pCurrentEntry != nullptr)
+            {
+                break;
+            }
+        }
+
+        m_slot = 0;
+    }
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::FlatHashBase(
+    uint32          numEntries,
+    Allocator*const pAllocator)
+    :
+    m_hashFunc(),
+    m_equalFunc(),
+    m_pAllocator(pAllocator),
+    m_initialSlots(Pow2Pad(Max(GroupWidth, numEntries + (numEntries / 7)))),
+    m_numEntries(0),
+    m_cur(),
+    m_old(),
+    m_migrateGroup(0)
+{
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::~FlatHashBase()
+{
+    FreeTable(&m_old);
+    FreeTable(&m_cur);
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+Result FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::Init()
+{
+    // The hash is mixed before use, so only the 7 tag bits are required to be meaningful.
+    m_hashFunc.Init(7);
+
+    Result result = Result::Success;
+
+    if (m_cur.pMemory == nullptr)
+    {
+        result = AllocTable(&m_cur, m_initialSlots);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Empty the hash table.
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+void FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::Reset()
+{
+    FreeTable(&m_old);
+
+    if (m_cur.pMemory != nullptr)
+    {
+        const uint32 numSlots = NumSlots(m_cur);
+
+        memset(m_cur.pCtrl, FlatHashCtrlEmpty, numSlots);
+        m_cur.numFull    = 0;
+        m_cur.growthLeft = MaxFull(numSlots);
+    }
+
+    m_numEntries = 0;
+}
+
+// =====================================================================================================================
+// Mixes the result of the hash functor with a multiplicative hash and splits it into a group index and a tag. Both
+// come from the high half of the product, which depends on every bit of the functor's result.
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+typename FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::HashInfo
+FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::ComputeHash(
+    const Key& key
+    ) const
+{
+    const uint64 mixed = m_hashFunc(&key, sizeof(Key)) * 0x9E3779B97F4A7C15ull;
+
+    HashInfo hash;
+    hash.group = static_cast<uint32>(mixed >> 32);
+    hash.tag   = static_cast<uint8>((mixed >> 25) & 0x7F);
+
+    return hash;
+}
+
+// =====================================================================================================================
+// Probes one table for the key.  Probing stops at the first group which has an empty slot, since an insertion would
+// have used it.
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+Entry* FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::FindInTable(
+    const Table&    table,
+    const Key&      key,
+    const HashInfo& hash
+    ) const
+{
+    Entry* pFound = nullptr;
+
+    uint32 group = hash.group & table.groupMask;
+
+    for (uint32 probe = 1; table.pMemory != nullptr; ++probe)
+    {
+        const FlatHashGroup ctrl(&table.pCtrl[group * GroupWidth]);
+
+        for (auto match = ctrl.Match(hash.tag); match.HasAny(); match.ClearLowest())
+        {
+            Entry*const pEntry = &table.pSlots[(group * GroupWidth) + match.Lowest()];
+
+            if (m_equalFunc(pEntry->key, key))
+            {
+                pFound = pEntry;
+                break;
+            }
+        }
+
+        if ((pFound != nullptr) || ctrl.MatchEmpty().HasAny())
+        {
+            break;
+        }
+
+        // Tables always keep some empty slots, so this terminates.
+        PAL_ASSERT(probe <= table.groupMask);
+        group = (group + probe) & table.groupMask;
+    }
+
+    return pFound;
+}
+
+// =====================================================================================================================
+// Returns the first empty or deleted slot in the key's probe sequence.  The table must have room.
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+uint32 FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::FindInsertSlot(
+    const Table&    table,
+    const HashInfo& hash
+    ) const
+{
+    uint32 group = hash.group & table.groupMask;
+
+    for (uint32 probe = 1; ; ++probe)
+    {
+        const auto match = FlatHashGroup(&table.pCtrl[group * GroupWidth]).MatchEmptyOrDeleted();
+
+        if (match.HasAny())
+        {
+            return (group * GroupWidth) + match.Lowest();
+        }
+
+        PAL_ASSERT(probe <= table.groupMask);
+        group = (group + probe) & table.groupMask;
+    }
+}
+
+// =====================================================================================================================
+// Frees a full slot.  The slot can go back to empty if its group still has an empty slot: that means no probe ever
+// went past this group, so nothing depends on it being occupied.
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+void FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::EraseSlot(
+    Table* pTable,
+    uint32 slot)
+{
+    const uint32 groupBase = slot & ~(GroupWidth - 1);
+
+    if (FlatHashGroup(&pTable->pCtrl[groupBase]).MatchEmpty().HasAny())
+    {
+        SetCtrl(pTable, slot, FlatHashCtrlEmpty);
+        pTable->growthLeft++;
+    }
+    else
+    {
+        SetCtrl(pTable, slot, FlatHashCtrlDeleted);
+    }
+
+    PAL_ASSERT(pTable->numFull > 0);
+    pTable->numFull--;
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+Entry* FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::FindEntry(
+    const Key& key
+    ) const
+{
+    const HashInfo hash = ComputeHash(key);
+
+    Entry* pEntry = FindInTable(m_cur, key, hash);
+
+    if ((pEntry == nullptr) && (m_old.pMemory != nullptr))
+    {
+        pEntry = FindInTable(m_old, key, hash);
+    }
+
+    return pEntry;
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+Result FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::FindAllocateEntry(
+    const Key& key,
+    bool*      pExisted,
+    Entry**    ppEntry)
+{
+    PAL_ASSERT(pExisted != nullptr);
+    PAL_ASSERT(ppEntry != nullptr);
+
+    Result result = Result::Success;
+
+    if (m_old.pMemory != nullptr)
+    {
+        MigrateGroups(MigrateGroupsPerOp);
+    }
+
+    const HashInfo hash = ComputeHash(key);
+
+    Entry* pEntry = FindInTable(m_cur, key, hash);
+
+    if ((pEntry == nullptr) && (m_old.pMemory != nullptr))
+    {
+        pEntry = FindInTable(m_old, key, hash);
+    }
+
+    *pExisted = (pEntry != nullptr);
+
+    if (pEntry == nullptr)
+    {
+        if (m_cur.growthLeft == 0)
+        {
+            result = Grow();
+        }
+
+        if (result == Result::Success)
+        {
+            const uint32 slot = FindInsertSlot(m_cur, hash);
+
+            if (m_cur.pCtrl[slot] == FlatHashCtrlEmpty)
+            {
+                m_cur.growthLeft--;
+            }
+
+            SetCtrl(&m_cur, slot, hash.tag);
+            m_cur.numFull++;
+            m_numEntries++;
+
+            pEntry = &m_cur.pSlots[slot];
+            memset(pEntry, 0, sizeof(Entry));
+            pEntry->key = key;
+        }
+    }
+
+    *ppEntry = pEntry;
+
+    PAL_ASSERT(result == Result::Success);
+
+    return result;
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+bool FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::EraseEntry(
+    const Key& key)
+{
+    if (m_old.pMemory != nullptr)
+    {
+        MigrateGroups(MigrateGroupsPerOp);
+    }
+
+    const HashInfo hash   = ComputeHash(key);
+    Table*         pTable = &m_cur;
+    Entry*         pEntry = FindInTable(m_cur, key, hash);
+
+    if ((pEntry == nullptr) && (m_old.pMemory != nullptr))
+    {
+        pTable = &m_old;
+        pEntry = FindInTable(m_old, key, hash);
+    }
+
+    if (pEntry != nullptr)
+    {
+        EraseSlot(pTable, static_cast<uint32>(pEntry - pTable->pSlots));
+
+        PAL_ASSERT(m_numEntries > 0);
+        m_numEntries--;
+    }
+
+    return (pEntry != nullptr);
+}
+
+// =====================================================================================================================
+// Allocates a table with every slot empty.  numSlots must be a power of two and at least one group.
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+Result FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::AllocTable(
+    Table* pTable,
+    uint32 numSlots)
+{
+    PAL_ASSERT(IsPowerOfTwo(numSlots) && (numSlots >= GroupWidth));
+
+    constexpr size_t Alignment = Max<size_t>(alignof(Entry), GroupWidth);
+
+    const size_t ctrlSize = Pow2Align<size_t>(numSlots, Alignment);
+
+    Result result = Result::ErrorOutOfMemory;
+
+    void* pMemory = PAL_MALLOC_ALIGNED(ctrlSize + (numSlots * sizeof(Entry)), Alignment, m_pAllocator, AllocInternal);
+    PAL_ALERT(pMemory == nullptr);
+
+    if (pMemory != nullptr)
+    {
+        pTable->pMemory    = pMemory;
+        pTable->pCtrl      = static_cast<uint8*>(pMemory);
+        pTable->pSlots     = static_cast<Entry*>(VoidPtrInc(pMemory, ctrlSize));
+        pTable->groupMask  = (numSlots / GroupWidth) - 1;
+        pTable->numFull    = 0;
+        pTable->growthLeft = MaxFull(numSlots);
+
+        memset(pTable->pCtrl, FlatHashCtrlEmpty, numSlots);
+
+        result = Result::Success;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+void FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::FreeTable(
+    Table* pTable)
+{
+    PAL_SAFE_FREE(pTable->pMemory, m_pAllocator);
+    memset(pTable, 0, sizeof(*pTable));
+}
+
+// =====================================================================================================================
+// Starts moving the current table into a new one.  The new table is twice as big unless at least half of the used
+// slots of the current one are deleted, in which case it is the same size.
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+Result FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::Grow()
+{
+    // The current table can only fill up during a migration if it started out nearly full of deleted slots. Just
+    // finish that migration before starting the next one.
+    if (m_old.pMemory != nullptr)
+    {
+        MigrateGroups(m_old.groupMask + 1);
+    }
+
+    Result result = Result::Success;
+
+    if (m_cur.pMemory == nullptr)
+    {
+        result = AllocTable(&m_cur, m_initialSlots);
+    }
+    else
+    {
+        const uint32 curSlots = NumSlots(m_cur);
+        const uint32 newSlots = (m_cur.numFull >= (MaxFull(curSlots) / 2)) ? (curSlots * 2) : curSlots;
+
+        Table newTable = {};
+        result = AllocTable(&newTable, newSlots);
+
+        if (result == Result::Success)
+        {
+            m_old          = m_cur;
+            m_cur          = newTable;
+            m_migrateGroup = 0;
+
+            if (m_old.groupMask < MinIncrementalGroups)
+            {
+                MigrateGroups(m_old.groupMask + 1);
+            }
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Moves the entries of the next numGroups groups of the old table into the current one, and frees the old table once
+// it is empty.
+template<typename Key,
+         typename Entry,
+         typename Allocator,
+         typename HashFunc,
+         typename EqualFunc>
+void FlatHashBase<Key, Entry, Allocator, HashFunc, EqualFunc>::MigrateGroups(
+    uint32 numGroups)
+{
+    const uint32 endGroup = Min(m_migrateGroup + numGroups, m_old.groupMask + 1);
+
+    for (; (m_migrateGroup < endGroup) && (m_old.numFull > 0); ++m_migrateGroup)
+    {
+        const uint32 groupBase = m_migrateGroup * GroupWidth;
+
+        for (uint32 slot = groupBase; slot < (groupBase + GroupWidth); ++slot)
+        {
+            if ((m_old.pCtrl[slot] & FlatHashCtrlEmpty) == 0)
+            {
+                const Entry&   entry = m_old.pSlots[slot];
+                const HashInfo hash  = ComputeHash(entry.key);
+                const uint32   dst   = FindInsertSlot(m_cur, hash);
+
+                // The new table is always big enough to take the rest of the old one.
+                if (m_cur.pCtrl[dst] == FlatHashCtrlEmpty)
+                {
+                    PAL_ASSERT(m_cur.growthLeft > 0);
+                    m_cur.growthLeft--;
+                }
+
+                m_cur.numFull++;
+
+                SetCtrl(&m_cur, dst, hash.tag);
+                memcpy(&m_cur.pSlots[dst], &entry, sizeof(Entry));
+
+                // The rest of the old table may still be probed, so leave a deleted slot behind.
+                SetCtrl(&m_old, slot, FlatHashCtrlDeleted);
+                m_old.numFull--;
+            }
+        }
+    }
+
+    if (m_old.numFull == 0)
+    {
+        FreeTable(&m_old);
+        m_migrateGroup = 0;
+    }
+}
+
+} // Util
@@ -0,0 +1,121 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palHwHash.h
+ * @brief PAL utility collection hashing functions which use CPU hashing instructions when they're available.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palUtil.h"
+
+namespace Util
+{
+
+/// Namespace containing hashing functions which use the CRC32 (SSE4.2) and AES (AES-NI) instructions of the CPU.
+///
+/// Support for the instructions is detected once at runtime.  Every function has a portable fallback which computes
+/// bit-identical results, so values may be compared across machines.  None of these hashes are suitable for
+/// cryptographic purposes.
+namespace HwHash
+{
+
+/// 128-bit hash structure
+struct Hash
+{
+    union
+    {
+        uint32 dwords[4]; ///< Output hash in dwords.
+        uint64 qwords[2]; ///< Output hash in qwords.
+        uint8  bytes[16]; ///< Output hash in bytes.
+    };
+};
+
+/// Returns true if the CRC32C functions use the SSE4.2 CRC32 instruction.
+extern bool HasHardwareCrc32c();
+
+/// Returns true if the 64-bit and 128-bit hashes use the AES-NI instructions.
+extern bool HasHardwareAes();
+
+/// Computes the CRC32C (Castagnoli) checksum of a buffer.
+///
+/// @param [in] pData    Data to checksum.  May be null if dataSize is zero.
+/// @param [in] dataSize Size of the data in bytes.
+/// @param [in] crc      Checksum of any preceding data, which allows checksumming a buffer in pieces.
+///
+/// @returns The CRC32C of the data.
+extern uint32 Crc32c(const void* pData, size_t dataSize, uint32 crc = 0);
+
+/// Computes the CRC32C checksums of several independent buffers.  The checksums are interleaved so that the CPU can
+/// overlap the latency of each CRC32 instruction, which makes this faster than calling @ref Crc32c once per buffer.
+///
+/// @param [in]  count      Number of buffers.
+/// @param [in]  ppData     Array of count pointers to the data of each buffer.
+/// @param [in]  pDataSizes Array of count sizes of each buffer in bytes.
+/// @param [out] pCrcs      Array of count checksums, receiving the CRC32C of each buffer.
+extern void Crc32cMulti(uint32 count, const void*const* ppData, const size_t* pDataSizes, uint32* pCrcs);
+
+/// Computes a 128-bit hash of a buffer, using AES rounds to mix the data.
+///
+/// @param [in]  pData    Data to hash.  May be null if dataSize is zero.
+/// @param [in]  dataSize Size of the data in bytes.
+/// @param [in]  seed     Seed value, which selects an independent hash function.
+/// @param [out] pHash    Receives the hash.
+extern void Hash128(const void* pData, size_t dataSize, uint64 seed, Hash* pHash);
+
+/// Computes a 64-bit hash of a buffer by folding the result of @ref Hash128.
+///
+/// @param [in] pData    Data to hash.  May be null if dataSize is zero.
+/// @param [in] dataSize Size of the data in bytes.
+/// @param [in] seed     Seed value, which selects an independent hash function.
+///
+/// @returns 64-bit hash value.
+extern uint64 Hash64(const void* pData, size_t dataSize, uint64 seed = 0);
+
+} // HwHash
+
+/// CRC32C hash functor.
+///
+/// A drop-in replacement for @ref JenkinsHashFunc for hash containers with binary keys.  With the SSE4.2 CRC32
+/// instruction each 8 bytes of key take a single instruction.  Like JenkinsHashFunc, its values are only meant for
+/// in-memory lookups.
+template<typename Key>
+struct Crc32cHashFunc
+{
+    /// Hashes the specified key value with CRC32C.
+    ///
+    /// @param [in] pVoidKey Pointer to the key to be hashed.
+    /// @param [in] keyLen   Amount of data at pVoidKey to hash, in bytes.
+    ///
+    /// @returns 32-bit uint hash value.
+    uint32 operator()(const void* pVoidKey, uint32 keyLen) const { return HwHash::Crc32c(pVoidKey, keyLen); }
+
+    /// No init job. Defined to be compatible with default hash func.
+    void Init(uint32) const { }
+};
+
+} // Util
@@ -0,0 +1,126 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palIntervalSet.h
+ * @brief PAL utility collection IntervalSet class declaration.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palIntervalTree.h"
+#include "palVector.h"
+
+namespace Util
+{
+
+/**
+ ***********************************************************************************************************************
+ * @brief Set of closed intervals stored as a sorted array of disjoint ranges.
+ *
+ * This answers the same "does anything overlap [low, high]?" question as @ref IntervalTree, but it only remembers which
+ * values are covered, not the individual intervals: overlapping or adjacent intervals are merged into one range when
+ * they're inserted, and interval values are ignored.  In exchange, the ranges live in one contiguous array which is
+ * searched linearly while it's small and with a binary search after that, and inserting a run of consecutive
+ * intervals - the common pattern for query slots and other suballocations - just extends the last range.
+ *
+ * Insert(), Overlap(), Clear() and GetCount() take the same arguments as their @ref IntervalTree counterparts, so a
+ * tree which is only used to detect overlaps can be swapped for this class.
+ ***********************************************************************************************************************
+ */
+template<typename T, typename Allocator>
+class IntervalSet
+{
+public:
+    /// A closed range of values in the set.
+    struct Range
+    {
+        T low;  ///< Lowest value in the range.
+        T high; ///< Highest value in the range.
+    };
+
+    /// Maximum number of ranges which are searched linearly and stored without a heap allocation.
+    static constexpr uint32 LinearSearchLimit = 8;
+
+    /// Constructor.
+    ///
+    /// @param [in] pAllocator The allocator that will allocate memory if required.
+    IntervalSet(Allocator*const pAllocator) : m_ranges(pAllocator) { }
+    ~IntervalSet() { }
+
+    /// Returns the number of disjoint ranges in the set, after merging.
+    size_t GetCount() const { return m_ranges.NumElements(); }
+
+    /// Returns the low and high bound of the range at the given index.  Ranges are sorted in increasing order.
+    const Range& GetRange(uint32 index) const { return m_ranges.At(index); }
+
+    /// Returns true if any value in [low, high] is in the set.
+    bool Overlap(T low, T high) const;
+
+    /// Returns true if any value in the specified interval is in the set.
+    template<typename K>
+    bool Overlap(const Interval<T, K>* pInterval) const { return Overlap(pInterval->low, pInterval->high); }
+
+    /// Adds every value in [low, high] to the set, merging it with the ranges it overlaps or touches.
+    ///
+    /// @returns @ref Success, or @ref ErrorOutOfMemory if the range array couldn't grow.
+    Result Insert(T low, T high);
+
+    /// Adds every value in the specified interval to the set.  Its value is ignored.
+    ///
+    /// @returns @ref Success, or @ref ErrorOutOfMemory if the range array couldn't grow.
+    template<typename K>
+    Result Insert(const Interval<T, K>* pInterval) { return Insert(pInterval->low, pInterval->high); }
+
+    /// Adds every value in each of the specified intervals to the set.  If the intervals are sorted by their low bound,
+    /// they're merged with the existing ranges in a single pass instead of being inserted one at a time.
+    ///
+    /// @param [in] pIntervals Array of intervals to insert.  Their values are ignored.
+    /// @param [in] count      Number of intervals in pIntervals.
+    ///
+    /// @returns @ref Success, or @ref ErrorOutOfMemory if the range array couldn't grow.
+    template<typename K>
+    Result Insert(const Interval<T, K>* pIntervals, uint32 count);
+
+    /// Removes every range from the set.  Memory is kept for reuse.
+    void Clear() { m_ranges.Clear(); }
+
+private:
+    // Returns true if the range ends before the given value, and so can't be merged with an interval starting there.
+    static bool EndsBefore(const Range& range, T value) { return (range.high < value) && ((value - range.high) > 1); }
+
+    // Returns true if the range starts after the given value, and so can't be merged with an interval ending there.
+    static bool StartsAfter(const Range& range, T value) { return (range.low > value) && ((range.low - value) > 1); }
+
+    uint32 FindFirstNotEndingBefore(T value) const;
+    Result AppendMerged(Vector<Range, LinearSearchLimit, Allocator>* pRanges, T low, T high) const;
+
+    Vector<Range, LinearSearchLimit, Allocator> m_ranges; // Sorted, disjoint and non-adjacent ranges.
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(IntervalSet);
+};
+
+} // Util
@@ -0,0 +1,270 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palIntervalSetImpl.h
+ * @brief PAL utility collection IntervalSet class implementation.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palIntervalSet.h"
+#include "palInlineFuncs.h"
+#include "palVectorImpl.h"
+#include <cstring>
+
+namespace Util
+{
+
+// =====================================================================================================================
+// Returns the index of the first range which ends at, just before or after the given value, or the number of ranges if
+// there is none.  Small sets are scanned linearly, larger ones are binary searched.
+template<typename T, typename Allocator>
+uint32 IntervalSet<T, Allocator>::FindFirstNotEndingBefore(
+    T value
+    ) const
+{
+    const Range*const pRanges   = m_ranges.Data();
+    const uint32      numRanges = m_ranges.NumElements();
+
+    uint32 first = 0;
+
+    if (numRanges <= LinearSearchLimit)
+    {
+        while ((first < numRanges) && EndsBefore(pRanges[first], value))
+        {
+            ++first;
+        }
+    }
+    else
+    {
+        uint32 count = numRanges;
+
+        while (count > 0)
+        {
+            const uint32 half = count / 2;
+
+            if (EndsBefore(pRanges[first + half], value))
+            {
+                first += half + 1;
+                count -= half + 1;
+            }
+            else
+            {
+                count = half;
+            }
+        }
+    }
+
+    return first;
+}
+
+// =====================================================================================================================
+template<typename T, typename Allocator>
+bool IntervalSet<T, Allocator>::Overlap(
+    T low,
+    T high
+    ) const
+{
+    PAL_ASSERT(low <= high);
+
+    const uint32 numRanges = m_ranges.NumElements();
+    uint32       index     = FindFirstNotEndingBefore(low);
+
+    // The search also stops at a range which ends right before low, which touches the interval without overlapping it.
+    if ((index < numRanges) && (m_ranges.At(index).high < low))
+    {
+        ++index;
+    }
+
+    return (index < numRanges) && (m_ranges.At(index).low <= high);
+}
+
+// =====================================================================================================================
+// Replaces every range which overlaps or touches [low, high] with a single range covering all of them.
+template<typename T, typename Allocator>
+Result IntervalSet<T, Allocator>::Insert(
+    T low,
+    T high)
+{
+    PAL_ASSERT(low <= high);
+
+    Result       result    = Result::Success;
+    const uint32 numRanges = m_ranges.NumElements();
+
+    if ((numRanges == 0) || EndsBefore(m_ranges.Back(), low))
+    {
+        // Fast path: the interval goes after every existing range.
+        const Range range = { low, high };
+        result = m_ranges.PushBack(range);
+    }
+    else if (m_ranges.Back().low <= low)
+    {
+        // Fast path: the interval overlaps or extends the last range, and every earlier range ends before it.
+        m_ranges.Back().high = Max(m_ranges.Back().high, high);
+    }
+    else
+    {
+        const uint32 first = FindFirstNotEndingBefore(low);
+        uint32       end   = first;
+
+        while ((end < numRanges) && (StartsAfter(m_ranges.At(end), high) == false))
+        {
+            ++end;
+        }
+
+        if (first == end)
+        {
+            // Nothing to merge with, so shift the later ranges up to make room.
+            const Range range = { low, high };
+            result = m_ranges.PushBack(range);
+
+            if (result == Result::Success)
+            {
+                Range*const pRanges = m_ranges.Data();
+
+                memmove(static_cast<void*>(&pRanges[first + 1]), &pRanges[first], (numRanges - first) * sizeof(Range));
+                pRanges[first] = range;
+            }
+        }
+        else
+        {
+            // Grow the first merged range to cover the rest, then close the gap they leave.
+            Range*const pRanges = m_ranges.Data();
+
+            pRanges[first].low  = Min(pRanges[first].low, low);
+            pRanges[first].high = Max(pRanges[end - 1].high, high);
+
+            const uint32 numMerged = end - first - 1;
+
+            if (numMerged > 0)
+            {
+                memmove(static_cast<void*>(&pRanges[first + 1]), &pRanges[end], (numRanges - end) * sizeof(Range));
+                m_ranges.Resize(numRanges - numMerged);
+            }
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Appends [low, high] to a sorted range array, merging it into the last range if they overlap or touch.  The interval
+// must not start before the last range does.
+template<typename T, typename Allocator>
+Result IntervalSet<T, Allocator>::AppendMerged(
+    Vector<Range, LinearSearchLimit, Allocator>* pRanges,
+    T                                            low,
+    T                                            high
+    ) const
+{
+    Result result = Result::Success;
+
+    if (pRanges->IsEmpty() || EndsBefore(pRanges->Back(), low))
+    {
+        const Range range = { low, high };
+        result = pRanges->PushBack(range);
+    }
+    else
+    {
+        pRanges->Back().high = Max(pRanges->Back().high, high);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Inserts a batch of intervals.  A batch which is sorted by low bound is merged with the existing ranges in one linear
+// pass; otherwise the intervals are inserted one at a time.
+template<typename T, typename Allocator>
+template<typename K>
+Result IntervalSet<T, Allocator>::Insert(
+    const Interval<T, K>* pIntervals,
+    uint32                count)
+{
+    Result result = Result::Success;
+    bool   sorted = true;
+
+    for (uint32 idx = 1; sorted && (idx < count); ++idx)
+    {
+        sorted = (pIntervals[idx - 1].low <= pIntervals[idx].low);
+    }
+
+    if ((sorted == false) || (count <= 1) || m_ranges.IsEmpty())
+    {
+        // Without existing ranges, inserting a sorted batch one at a time takes the append path for every interval.
+        for (uint32 idx = 0; (result == Result::Success) && (idx < count); ++idx)
+        {
+            result = Insert(pIntervals[idx].low, pIntervals[idx].high);
+        }
+    }
+    else
+    {
+        Vector<Range, LinearSearchLimit, Allocator> merged(m_ranges.GetAllocator());
+
+        const uint32 numRanges = m_ranges.NumElements();
+        result = merged.Reserve(numRanges + count);
+
+        uint32 rangeIdx    = 0;
+        uint32 intervalIdx = 0;
+
+        while ((result == Result::Success) && ((rangeIdx < numRanges) || (intervalIdx < count)))
+        {
+            if ((intervalIdx == count) ||
+                ((rangeIdx < numRanges) && (m_ranges.At(rangeIdx).low <= pIntervals[intervalIdx].low)))
+            {
+                const Range& range = m_ranges.At(rangeIdx++);
+                result = AppendMerged(&merged, range.low, range.high);
+            }
+            else
+            {
+                PAL_ASSERT(pIntervals[intervalIdx].low <= pIntervals[intervalIdx].high);
+                result = AppendMerged(&merged, pIntervals[intervalIdx].low, pIntervals[intervalIdx].high);
+                ++intervalIdx;
+            }
+        }
+
+        if (result == Result::Success)
+        {
+            // Reserve first so that copying the merged ranges back can't fail halfway through.
+            result = m_ranges.Reserve(merged.NumElements());
+        }
+
+        if (result == Result::Success)
+        {
+            m_ranges.Clear();
+
+            for (const Range& range : merged)
+            {
+                m_ranges.PushBack(range);
+            }
+        }
+    }
+
+    return result;
+}
+
+} // Util
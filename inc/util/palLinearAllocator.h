@@ -62,8 +62,12 @@ public:
     VirtualLinearAllocator(size_t size) :
         m_pStart(nullptr),
         m_pCurrent(nullptr),
+        m_pCommittedToPage(nullptr),
+        m_pHighWaterMark(nullptr),
         m_size(size),
-        m_pageSize(0) {}
+        m_pageSize(0),
+        m_numCommits(0),
+        m_numDecommits(0) {}
 
     /// Destructor.
     virtual ~VirtualLinearAllocator()
@@ -94,7 +98,9 @@ public:
         if (result == Result::_Success)
         {
             m_pCurrent         = m_pStart;
+            m_pHighWaterMark   = m_pStart;
             m_pCommittedToPage = VoidPtrInc(m_pCurrent, m_pageSize);
+            m_numCommits++;
         }
 
         return result;
@@ -109,26 +115,13 @@ public:
     {
         void* pAlignedCurrent = VoidPtrAlign(m_pCurrent, allocInfo.alignment);
         void* pNextCurrent    = VoidPtrInc(pAlignedCurrent, allocInfo.bytes);
-        void* pAlignedEnd     = VoidPtrAlign(pNextCurrent, m_pageSize);
 
-        if (pAlignedEnd > m_pCommittedToPage)
+        if (pNextCurrent > m_pCommittedToPage)
         {
-            const size_t commitBytes = VoidPtrDiff(pAlignedEnd, m_pCommittedToPage);
-
-            const Result result = VirtualCommit(m_pCommittedToPage, commitBytes);
-
-            if (result == Result::_Success)
-            {
-                m_pCommittedToPage = VoidPtrInc(m_pCommittedToPage, commitBytes);
-                m_pCurrent         = pNextCurrent;
-            }
-            else
-            {
-                // Return nullptr if allocation fails.
-                pAlignedCurrent = nullptr;
-            }
+            pAlignedCurrent = (GrowCommitted(pNextCurrent) == Result::_Success) ? pAlignedCurrent : nullptr;
         }
-        else
+
+        if (pAlignedCurrent != nullptr)
         {
             m_pCurrent = pNextCurrent;
         }
@@ -144,26 +137,31 @@ public:
     /// Rewinds the current pointer to the specified location to reuse already allocated memory.
     ///
     /// @param pStart   Where to reset the m_pCurrent to.
-    /// @param decommit If true, pages that are rewound are freed/decommitted.
+    /// @param decommit If true, committed pages past pStart are freed/decommitted.  Prefer Trim() for memory which is
+    ///                 likely to be needed again.
     void   Rewind(void* pStart, bool decommit)
     {
         PAL_ASSERT((m_pStart <= pStart) && (pStart <= m_pCurrent));
 
         if (pStart != m_pCurrent)
         {
+            m_pHighWaterMark = Max(m_pHighWaterMark, m_pCurrent);
+
             if (decommit)
             {
-                void*        pStartPage   = VoidPtrAlign(VoidPtrInc(pStart, 1), m_pageSize);
-                void*        pCurrentPage = VoidPtrAlign(m_pCurrent, m_pageSize);
-                const size_t numPages     = VoidPtrDiff(pCurrentPage, pStartPage) / m_pageSize;
+                // Commits can run ahead of the current pointer, so release everything up to the committed end.
+                void* pStartPage = VoidPtrAlign(VoidPtrInc(pStart, 1), m_pageSize);
 
-                if (numPages > 0)
+                if (pStartPage < m_pCommittedToPage)
                 {
-                    Result result = VirtualDecommit(pStartPage, m_pageSize * numPages);
+                    Result result = VirtualDecommit(pStartPage, VoidPtrDiff(m_pCommittedToPage, pStartPage));
                     PAL_ASSERT(result == Result::_Success);
 
                     m_pCommittedToPage = pStartPage;
+                    m_numDecommits++;
                 }
+
+                m_pHighWaterMark = pStart;
             }
 #if DEBUG
             else
@@ -204,14 +202,89 @@ public:
     /// @returns The size of the remaining unallocated space in bytes.
     size_t Remaining() const { return m_size - VoidPtrDiff(m_pCurrent, m_pStart); }
 
+    /// Decommits pages which lie beyond the highest point this allocator has reached since it was last trimmed, then
+    /// restarts that high-water mark from the current pointer.  Pages are only released once more than twice the
+    /// high-water mark is committed, so an allocator whose usage is steady keeps its pages instead of committing and
+    /// decommitting them on every use.  The first page always stays committed.
+    ///
+    /// @returns The number of bytes decommitted.
+    size_t Trim()
+    {
+        size_t trimmedBytes = 0;
+
+        void*const pHighWaterMark = Max(m_pHighWaterMark, m_pCurrent);
+        void*const pKeepEnd       = Max(VoidPtrAlign(pHighWaterMark, m_pageSize), VoidPtrInc(m_pStart, m_pageSize));
+
+        if (VoidPtrDiff(m_pCommittedToPage, m_pStart) > (2 * VoidPtrDiff(pKeepEnd, m_pStart)))
+        {
+            trimmedBytes = VoidPtrDiff(m_pCommittedToPage, pKeepEnd);
+
+            Result result = VirtualDecommit(pKeepEnd, trimmedBytes);
+            PAL_ASSERT(result == Result::_Success);
+
+            m_pCommittedToPage = pKeepEnd;
+            m_numDecommits++;
+        }
+
+        m_pHighWaterMark = m_pCurrent;
+
+        return trimmedBytes;
+    }
+
+    /// Returns the number of bytes currently backed by committed pages.
+    ///
+    /// @returns Number of committed bytes.
+    size_t BytesCommitted() const { return VoidPtrDiff(m_pCommittedToPage, m_pStart); }
+
+    /// Returns how many times this allocator has asked the OS to commit pages.  Useful for tuning allocator sizes.
+    ///
+    /// @returns Number of VirtualCommit() calls made by this allocator.
+    uint32 NumCommits() const { return m_numCommits; }
+
+    /// Returns how many times this allocator has asked the OS to decommit pages.
+    ///
+    /// @returns Number of VirtualDecommit() calls made by this allocator.
+    uint32 NumDecommits() const { return m_numDecommits; }
+
 private:
+    // Commits enough pages to back everything up to pEnd.  The committed size at least doubles each time, so an
+    // allocator which grows a little at a time makes a logarithmic number of commits rather than one per page.
+    Result GrowCommitted(void* pEnd)
+    {
+        Result result = Result::ErrorOutOfMemory;
+
+        void*const pReservedEnd = VoidPtrInc(m_pStart, m_size);
+
+        if (pEnd <= pReservedEnd)
+        {
+            const size_t requiredBytes  = VoidPtrDiff(VoidPtrAlign(pEnd, m_pageSize), m_pCommittedToPage);
+            const size_t committedBytes = VoidPtrDiff(m_pCommittedToPage, m_pStart);
+            const size_t commitBytes    = Min(Max(requiredBytes, committedBytes),
+                                              VoidPtrDiff(pReservedEnd, m_pCommittedToPage));
+
+            result = VirtualCommit(m_pCommittedToPage, commitBytes);
+
+            if (result == Result::_Success)
+            {
+                m_pCommittedToPage = VoidPtrInc(m_pCommittedToPage, commitBytes);
+                m_numCommits++;
+            }
+        }
+
+        return result;
+    }
+
     void*  m_pStart;            ///< Pointer to where the backing allocation starts.
     void*  m_pCurrent;          ///< Pointer to the current position of backing memory.
     void*  m_pCommittedToPage;  ///< Pointer to the end of the last committed page.
+    void*  m_pHighWaterMark;    ///< Highest point m_pCurrent was rewound from since the last Trim().
 
     size_t m_size;              ///< Size of the allocation.
     size_t m_pageSize;          ///< OS' defined page size.
 
+    uint32 m_numCommits;        ///< Number of VirtualCommit() calls.
+    uint32 m_numDecommits;      ///< Number of VirtualDecommit() calls.
+
     PAL_DISALLOW_DEFAULT_CTOR(VirtualLinearAllocator);
     PAL_DISALLOW_COPY_AND_ASSIGN(VirtualLinearAllocator);
 };
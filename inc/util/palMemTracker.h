@@ -36,6 +36,11 @@
 #include "palIntrusiveList.h"
 #include "palMutex.h"
 
+#if !defined(PAL_MEMTRACK_SAMPLE_BYTES)
+/// Mean number of bytes allocated between the allocations which MemTracker samples. Zero tracks every allocation.
+#define PAL_MEMTRACK_SAMPLE_BYTES 0
+#endif
+
 namespace Util
 {
 
@@ -43,6 +48,7 @@ namespace Util
 struct AllocInfo;
 struct FreeInfo;
 struct MemTrackerElem;
+class  JsonWriter;
 enum   SystemAllocType : uint32;
 
 /// @internal
@@ -74,6 +80,29 @@ struct MemTrackerElem
     void*           pOrigMem;   ///< Original address of the allocation returned from our underlying allocator.
     size_t          allocNum;   ///< The number of the memory allocation. 1 based.
     MemTrackerList* pList;      ///< The list this struct is in. It helps check which MemTracker owns this struct.
+    SystemAllocType allocType;  ///< Type of allocation request.
+    size_t          weight;     ///< Estimated number of bytes this allocation stands for when sampling, else size.
+};
+
+/// @internal
+///
+/// Placed immediately before every client allocation when MemTracker samples allocations, so that Free() can tell
+/// whether the allocation was sampled.
+struct MemTrackerTag
+{
+    void*  pOrigMem;    ///< Original address of an unsampled allocation, or null for a sampled allocation.
+    size_t magic;       ///< Identifies a live tag. Anything else means a bad pointer, a double free or an underrun.
+};
+
+/// @internal
+///
+/// Live allocations from one call site, as tracked by MemTracker.
+struct MemTrackerCallSite
+{
+    const char* pFilename;  ///< File that requested the allocations, or null if this table entry is unused.
+    uint32      lineNumber; ///< Line number that requested the allocations.
+    size_t      liveBytes;  ///< Bytes currently allocated, estimated from the samples when sampling.
+    size_t      liveAllocs; ///< Number of allocations currently live, estimated from the samples when sampling.
 };
 
 /**
@@ -81,6 +110,17 @@ struct MemTrackerElem
  * @brief Class responsible for tracking allocations and frees to notify the developer of memory leaks.
  *
  * Tracking is enabled/disabled via the PAL_MEMTRACK define.
+ *
+ * By default every allocation is tracked, which takes a global lock on every allocation and free.  Defining
+ * PAL_MEMTRACK_SAMPLE_BYTES to a nonzero value N instead tracks a sample of allocations: each thread counts down the
+ * bytes it allocates from a random, exponentially distributed interval with a mean of N bytes and samples the
+ * allocation which reaches zero, so the chance of sampling an allocation grows with its size.  Unsampled allocations
+ * only get a small tag in front of them and never take the lock.  Sampled allocations are tracked exactly as in the
+ * default mode, along with an estimate of how many bytes they stand for.
+ *
+ * In both modes, live bytes and allocation counts are kept per SystemAllocType and per call site and can be written
+ * out with WriteSnapshot().  When sampling, these are unbiased estimates, and the leak report only lists sampled
+ * allocations.
  ***********************************************************************************************************************
  */
 template <typename Allocator>
@@ -112,17 +152,34 @@ public:
     void Free(
         const FreeInfo& freeInfo);
 
+    /// Writes the live bytes and allocation counts per SystemAllocType and per call site as a JSON map.
+    ///
+    /// @param [in] pWriter JSON writer to write the map to.
+    void WriteSnapshot(
+        JsonWriter* pWriter);
+
 private:
     void* AddMemElement(
-        void*       pMem,
-        size_t      bytes,
-        size_t      align,
-        MemBlkType  blockType,
-        const char* pFilename,
-        uint32      lineNumber);
+        void*           pMem,
+        size_t          bytes,
+        size_t          align,
+        MemBlkType      blockType,
+        SystemAllocType allocType,
+        size_t          weight,
+        const char*     pFilename,
+        uint32          lineNumber);
 
     void* RemoveMemElement(void* pMem, MemBlkType blockType);
 
+    void* AllocTracked(const AllocInfo& allocInfo, size_t weight);
+    void* AllocUntracked(const AllocInfo& allocInfo);
+
+    static bool ShouldSample(size_t bytes, size_t* pWeight);
+    static int64 NextSampleInterval(uint64* pRngState);
+
+    void UpdateStats(const MemTrackerElem& elem, bool add);
+    MemTrackerCallSite* FindCallSite(const char* pFilename, uint32 lineNumber);
+
     void MemoryReport();
     void FreeLeakedMemory();
 
@@ -137,6 +194,25 @@ private:
     // Size of underrun/overrun markers in bytes.
     static constexpr size_t MarkerSizeBytes = MarkerSizeUints * sizeof(uint32);
 
+    // Mean number of bytes between sampled allocations, or zero to track every allocation.
+    static constexpr size_t SampleBytes = PAL_MEMTRACK_SAMPLE_BYTES;
+
+    // Mean of the sampling intervals as a divisor which is safe to use when sampling is disabled.
+    static constexpr double MeanSampleBytes = (SampleBytes != 0) ? static_cast<double>(SampleBytes) : 1.0;
+
+    // Size of the tag in front of every allocation when sampling.
+    static constexpr size_t TagSizeBytes = (SampleBytes != 0) ? sizeof(MemTrackerTag) : 0;
+
+    // Magic values for MemTrackerTag.
+    static constexpr size_t SampledTag   = 0x5A3D1E5A;
+    static constexpr size_t UnsampledTag = 0x0E5A3D1E;
+
+    // Number of SystemAllocType values, which start at AllocObject.
+    static constexpr uint32 NumAllocTypes = 4;
+
+    // Initial number of entries in the call site table, which doubles whenever it becomes half full.
+    static constexpr uint32 MinCallSiteTableSize = 256;
+
     MemTrackerList     m_trackerList;      // The list of active allocations.
     Mutex              m_mutex;            // Serializes access to list of active allocations.
 
@@ -150,6 +226,13 @@ private:
     size_t             m_nextAllocNum;     // The allocation number that the next allocated block will receive.
     const size_t       m_breakOnAllocNum;  // The allocation number to trigger a debug break on.
 
+    size_t             m_liveBytes[NumAllocTypes];  // Live bytes per SystemAllocType.
+    size_t             m_liveAllocs[NumAllocTypes]; // Live allocations per SystemAllocType.
+
+    MemTrackerCallSite* m_pCallSites;      // Open-addressed table of call sites, allocated on first use.
+    uint32              m_callSiteTableSize;
+    uint32              m_numCallSites;
+
     PAL_DISALLOW_COPY_AND_ASSIGN(MemTracker);
 };
 
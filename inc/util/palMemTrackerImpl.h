@@ -34,9 +34,11 @@
 #if PAL_MEMTRACK
 
 #include "palIntrusiveListImpl.h"
+#include "palJsonWriter.h"
 #include "palMemTracker.h"
 #include "palSysMemory.h"
 
+#include <cmath>
 #include <cstring>
 
 namespace Util
@@ -50,6 +52,15 @@ static const char*const MemBlkTypeStr[] =
     "NewArray",     ///< MemBlkType::NewArray
 };
 
+/// Table to convert a SystemAllocType to a string, indexed from AllocObject. Used by WriteSnapshot().
+static const char*const SystemAllocTypeStr[] =
+{
+    "AllocObject",          ///< SystemAllocType::AllocObject
+    "AllocInternal",        ///< SystemAllocType::AllocInternal
+    "AllocInternalTemp",    ///< SystemAllocType::AllocInternalTemp
+    "AllocInternalShader",  ///< SystemAllocType::AllocInternalShader
+};
+
 // =====================================================================================================================
 template <typename Allocator>
 MemTracker<Allocator>::MemTracker(
@@ -59,8 +70,14 @@ MemTracker<Allocator>::MemTracker(
     m_markerSizeBytes(MarkerSizeBytes),
     m_pAllocator(pAllocator),
     m_nextAllocNum(1),
-    m_breakOnAllocNum(0)
+    m_breakOnAllocNum(0),
+    m_liveBytes(),
+    m_liveAllocs(),
+    m_pCallSites(nullptr),
+    m_callSiteTableSize(0),
+    m_numCallSites(0)
 {
+    static_assert(NumAllocTypes == (AllocInternalShader - AllocObject + 1), "NumAllocTypes is out of date.");
 }
 
 // =====================================================================================================================
@@ -78,6 +95,11 @@ MemTracker<Allocator>::~MemTracker()
         MemoryReport();
 
     }
+
+    if (m_pCallSites != nullptr)
+    {
+        m_pAllocator->Free(FreeInfo(m_pCallSites, MemBlkType::Malloc));
+    }
 }
 
 // =====================================================================================================================
@@ -96,19 +118,21 @@ Result MemTracker<Allocator>::Init()
 // See MemTracker::Alloc() which is used to allocate memory that is being tracked.
 template <typename Allocator>
 void* MemTracker<Allocator>::AddMemElement(
-    void*       pMem,        // [in,out] Original pointer allocated by MemTracker::Alloc.
-    size_t      bytes,       // Client requested allocation size in bytes.
-    size_t      align,       // The max of the client-requested alignment or the internal alignment, in bytes.
-    MemBlkType  blockType,   // Block type based on calling allocation routine.
-    const char* pFilename,   // Client filename that is requesting the memory.
-    uint32      lineNumber)  // Line number in client file that is requesting the memory.
+    void*           pMem,        // [in,out] Original pointer allocated by MemTracker::Alloc.
+    size_t          bytes,       // Client requested allocation size in bytes.
+    size_t          align,       // The max of the client-requested alignment or the internal alignment, in bytes.
+    MemBlkType      blockType,   // Block type based on calling allocation routine.
+    SystemAllocType allocType,   // Allocation type of the client request.
+    size_t          weight,      // Estimated number of bytes this allocation stands for.
+    const char*     pFilename,   // Client filename that is requesting the memory.
+    uint32          lineNumber)  // Line number in client file that is requesting the memory.
 {
-    // Our internal data is all relative to the client pointer so find that first. See Alloc for more details.
-    //   (align1)(MemTrackerList::Node)(MemTrackerElem)(underflow tracker)(client allocation)(align2)(overflow tracker)
+    // Our internal data is all relative to the client pointer so find that first. See AllocTracked for more details.
+    //   (align1)(Node)(MemTrackerElem)(underflow tracker)(tag)(client allocation)(align2)(overflow tracker)
     constexpr size_t InternalSize = sizeof(MemTrackerList::Node) + sizeof(MemTrackerElem);
 
-    void*const pClientMem = VoidPtrAlign(VoidPtrInc(pMem, m_markerSizeBytes + InternalSize), align);
-    uint32*    pUnderrun  = static_cast<uint32*>(VoidPtrDec(pClientMem, m_markerSizeBytes));
+    void*const pClientMem = VoidPtrAlign(VoidPtrInc(pMem, m_markerSizeBytes + InternalSize + TagSizeBytes), align);
+    uint32*    pUnderrun  = static_cast<uint32*>(VoidPtrDec(pClientMem, m_markerSizeBytes + TagSizeBytes));
     uint32*    pOverrun   = static_cast<uint32*>(VoidPtrInc(pClientMem, Pow2Align(bytes, sizeof(uint32))));
 
     auto*const pNewElement = static_cast<MemTrackerElem*>(VoidPtrDec(pUnderrun, sizeof(MemTrackerElem)));
@@ -129,6 +153,16 @@ void* MemTracker<Allocator>::AddMemElement(
     pNewElement->pClientMem = pClientMem;
     pNewElement->pOrigMem   = pMem;
     pNewElement->pList      = &m_trackerList;
+    pNewElement->allocType  = allocType;
+    pNewElement->weight     = weight;
+
+    if (SampleBytes != 0)
+    {
+        auto*const pTag = static_cast<MemTrackerTag*>(VoidPtrDec(pClientMem, sizeof(MemTrackerTag)));
+
+        pTag->pOrigMem = nullptr;
+        pTag->magic    = SampledTag;
+    }
 
     MutexAuto lock(&m_mutex);
 
@@ -143,6 +177,8 @@ void* MemTracker<Allocator>::AddMemElement(
 
     m_trackerList.PushFront(pNewNode);
 
+    UpdateStats(*pNewElement, true);
+
     return pClientMem;
 }
 
@@ -161,9 +197,9 @@ void* MemTracker<Allocator>::RemoveMemElement(
 {
     void* pOrigPtr = nullptr;
 
-    // Recall that this is our internal memory layout. See Alloc for more details.
-    //   (align1)(MemTrackerList::Node)(MemTrackerElem)(underflow tracker)(client allocation)(align2)(overflow tracker)
-    uint32*    pUnderrun    = static_cast<uint32*>(VoidPtrDec(pClientMem, m_markerSizeBytes));
+    // Recall that this is our internal memory layout. See AllocTracked for more details.
+    //   (align1)(Node)(MemTrackerElem)(underflow tracker)(tag)(client allocation)(align2)(overflow tracker)
+    uint32*    pUnderrun    = static_cast<uint32*>(VoidPtrDec(pClientMem, m_markerSizeBytes + TagSizeBytes));
     auto*const pCurrent     = static_cast<MemTrackerElem*>(VoidPtrDec(pUnderrun, sizeof(MemTrackerElem)));
     auto*const pCurrentNode = static_cast<MemTrackerList::Node*>(VoidPtrDec(pCurrent, sizeof(MemTrackerList::Node)));
     uint32*    pOverrun     = static_cast<uint32*>(VoidPtrInc(pClientMem, Pow2Align(pCurrent->size, sizeof(uint32))));
@@ -199,6 +235,8 @@ void* MemTracker<Allocator>::RemoveMemElement(
 
         m_trackerList.Erase(pCurrentNode);
 
+        UpdateStats(*pCurrent, false);
+
         pCurrent->pList = nullptr;
         pOrigPtr        = pCurrent->pOrigMem;
     }
@@ -216,24 +254,49 @@ void* MemTracker<Allocator>::Alloc(
     // Allocating zero bytes of memory results in undefined behavior.
     PAL_ASSERT(allocInfo.bytes > 0);
 
+    void*  pMem   = nullptr;
+    size_t weight = allocInfo.bytes;
+
+    if ((SampleBytes == 0) || ShouldSample(allocInfo.bytes, &weight))
+    {
+        pMem = AllocTracked(allocInfo, weight);
+    }
+    else
+    {
+        pMem = AllocUntracked(allocInfo);
+    }
+
+    return pMem;
+}
+
+// =====================================================================================================================
+// Allocates a block of memory which is added to the list of tracked allocations.
+template <typename Allocator>
+void* MemTracker<Allocator>::AllocTracked(
+    const AllocInfo& allocInfo,
+    size_t           weight)    // Estimated number of bytes this allocation stands for.
+{
     void* pMem = nullptr;
 
     // We want to allocate extra memory from the caller's allocator, in this layout:
-    //   (align1)(MemTrackerList::Node)(MemTrackerElem)(underflow tracker)(client allocation)(align2)(overflow tracker)
+    //   (align1)(MemTrackerList::Node)(MemTrackerElem)(underflow tracker)(tag)(client allocation)(align2)
+    //   (overflow tracker)
     // Here's why we need each of those sections:
     //   1. align1 is zero or more bytes needed to align the client allocation and our internal data.
     //   2. The MemTrackerList::Node object, which is used to link this allocation into m_trackerList.
     //   3. The MemTrackerElem struct contains bookkeeping data we need to report memory errors.
     //   4. The underflow and overflow trackers detect out of bounds writes. They are optional.
-    //   5. The client allocation, which is actually returned to the caller.
-    //   6. align2 is zero or more bytes needed to DWORD-align the overflow tracker.
+    //   5. The MemTrackerTag, which tells Free() that this allocation is tracked. Only present when sampling.
+    //   6. The client allocation, which is actually returned to the caller.
+    //   7. align2 is zero or more bytes needed to DWORD-align the overflow tracker.
     constexpr size_t InternalAlignment = Max(alignof(MemTrackerList::Node), alignof(MemTrackerElem));
     const size_t     paddedAlignBytes  = Max(allocInfo.alignment, InternalAlignment);
     const size_t     paddedSizeBytes   = (paddedAlignBytes +                            // 1
                                           sizeof(MemTrackerList::Node) +                // 2
                                           sizeof(MemTrackerElem) +                      // 3
                                           m_markerSizeBytes +                           // 4.a
-                                          Pow2Align(allocInfo.bytes, sizeof(uint32)) +  // 5 & 6
+                                          TagSizeBytes +                                // 5
+                                          Pow2Align(allocInfo.bytes, sizeof(uint32)) +  // 6 & 7
                                           m_markerSizeBytes);                           // 4.b
 
     const AllocInfo memTrackerInfo(paddedSizeBytes, paddedAlignBytes, allocInfo.zeroMem, allocInfo.allocType,
@@ -248,6 +311,8 @@ void* MemTracker<Allocator>::Alloc(
                              allocInfo.bytes,
                              paddedAlignBytes,
                              allocInfo.blockType,
+                             allocInfo.allocType,
+                             weight,
                              allocInfo.pFilename,
                              allocInfo.lineNumber);
     }
@@ -255,6 +320,90 @@ void* MemTracker<Allocator>::Alloc(
     return pMem;
 }
 
+// =====================================================================================================================
+// Allocates a block of memory which isn't sampled when sampling allocations. Only a tag is added in front of the client
+// allocation, and no lock is taken:
+//   (align)(MemTrackerTag)(client allocation)
+template <typename Allocator>
+void* MemTracker<Allocator>::AllocUntracked(
+    const AllocInfo& allocInfo)
+{
+    const size_t paddedAlignBytes = Max(allocInfo.alignment, alignof(MemTrackerTag));
+    const size_t paddedSizeBytes  = paddedAlignBytes + sizeof(MemTrackerTag) + allocInfo.bytes;
+
+    const AllocInfo memTrackerInfo(paddedSizeBytes, paddedAlignBytes, allocInfo.zeroMem, allocInfo.allocType,
+                                   allocInfo.blockType, allocInfo.pFilename, allocInfo.lineNumber);
+
+    void* pMem = m_pAllocator->Alloc(memTrackerInfo);
+
+    if (pMem != nullptr)
+    {
+        void*const pClientMem = VoidPtrAlign(VoidPtrInc(pMem, sizeof(MemTrackerTag)), paddedAlignBytes);
+        auto*const pTag       = static_cast<MemTrackerTag*>(VoidPtrDec(pClientMem, sizeof(MemTrackerTag)));
+
+        pTag->pOrigMem = pMem;
+        pTag->magic    = UnsampledTag;
+
+        pMem = pClientMem;
+    }
+
+    return pMem;
+}
+
+// =====================================================================================================================
+// Decides whether to sample an allocation. Each thread counts down the bytes it allocates from an exponentially
+// distributed interval, which samples the bytes allocated as a Poisson process. An allocation of B bytes is then
+// sampled with probability 1 - e^(-B / SampleBytes), so each sample stands for B divided by that probability bytes.
+template <typename Allocator>
+bool MemTracker<Allocator>::ShouldSample(
+    size_t  bytes,
+    size_t* pWeight)
+{
+    // These are constant-initialized, so they are cheap to access from any thread.
+    static thread_local int64  bytesUntilSample = 0;
+    static thread_local uint64 rngState         = 0;
+
+    if (rngState == 0)
+    {
+        // Seed each thread differently; the address of a thread-local is unique among live threads.
+        rngState         = reinterpret_cast<uint64>(&rngState) | 1;
+        bytesUntilSample = NextSampleInterval(&rngState);
+    }
+
+    bytesUntilSample -= static_cast<int64>(bytes);
+
+    const bool sample = (bytesUntilSample <= 0);
+
+    if (sample)
+    {
+        // The Poisson process is memoryless, so the next interval can start from the end of this allocation.
+        bytesUntilSample = NextSampleInterval(&rngState);
+
+        const double probability = -std::expm1(-static_cast<double>(bytes) / MeanSampleBytes);
+        *pWeight = static_cast<size_t>(static_cast<double>(bytes) / probability);
+    }
+
+    return sample;
+}
+
+// =====================================================================================================================
+// Returns an exponentially distributed number of bytes with a mean of SampleBytes, using a xorshift64* generator.
+template <typename Allocator>
+int64 MemTracker<Allocator>::NextSampleInterval(
+    uint64* pRngState)
+{
+    uint64 x = *pRngState;
+    x ^= (x >> 12);
+    x ^= (x << 25);
+    x ^= (x >> 27);
+    *pRngState = x;
+
+    // Take the top 53 bits as a uniform double in (0, 1].
+    const double uniform = (static_cast<double>((x * 2685821657736338717ull) >> 11) + 1.0) / 9007199254740992.0;
+
+    return static_cast<int64>(-std::log(uniform) * MeanSampleBytes) + 1;
+}
+
 // =====================================================================================================================
 // Frees a block of memory.  The routine is called with the pointer to the client usable memory.
 //
@@ -266,7 +415,36 @@ void MemTracker<Allocator>::Free(
     // Don't want to call RemoveMemElement if the ptr is null.
     if (freeInfo.pClientMem != nullptr)
     {
-        void* pMem = RemoveMemElement(freeInfo.pClientMem, freeInfo.blockType);
+        void* pMem = nullptr;
+
+        if (SampleBytes == 0)
+        {
+            pMem = RemoveMemElement(freeInfo.pClientMem, freeInfo.blockType);
+        }
+        else
+        {
+            auto*const pTag = static_cast<MemTrackerTag*>(VoidPtrDec(freeInfo.pClientMem, sizeof(MemTrackerTag)));
+
+            if (pTag->magic == UnsampledTag)
+            {
+                pMem = pTag->pOrigMem;
+            }
+            else if (pTag->magic == SampledTag)
+            {
+                pMem = RemoveMemElement(freeInfo.pClientMem, freeInfo.blockType);
+            }
+            else
+            {
+                // A free was attempted on an unrecognized or already freed pointer, or the tag was overwritten.
+                PAL_DPERROR("Invalid Free Attempted with ptr = : (%#x)", freeInfo.pClientMem);
+            }
+
+            if (pMem != nullptr)
+            {
+                // Invalidate the tag to catch double frees.
+                pTag->magic = 0;
+            }
+        }
 
         // If this free call is valid (RemoveMemElement doesn't return nullptr), release the memory.
         if (pMem != nullptr)
@@ -276,6 +454,184 @@ void MemTracker<Allocator>::Free(
     }
 }
 
+// =====================================================================================================================
+// Adds or removes a tracked allocation from the per-type and per-call site totals. The caller must hold m_mutex.
+template <typename Allocator>
+void MemTracker<Allocator>::UpdateStats(
+    const MemTrackerElem& elem,
+    bool                  add)
+{
+    // A sample of B bytes standing for W bytes stands for W / B allocations.
+    const size_t bytes  = elem.weight;
+    const size_t allocs = Max<size_t>(elem.weight / Max<size_t>(elem.size, 1), 1);
+
+    const uint32 typeIndex = static_cast<uint32>(elem.allocType) - static_cast<uint32>(AllocObject);
+
+    if (typeIndex < NumAllocTypes)
+    {
+        m_liveBytes[typeIndex]  = add ? (m_liveBytes[typeIndex]  + bytes)  : (m_liveBytes[typeIndex]  - bytes);
+        m_liveAllocs[typeIndex] = add ? (m_liveAllocs[typeIndex] + allocs) : (m_liveAllocs[typeIndex] - allocs);
+    }
+
+    MemTrackerCallSite*const pCallSite = FindCallSite(elem.pFilename, elem.lineNumber);
+
+    if (pCallSite != nullptr)
+    {
+        pCallSite->liveBytes  = add ? (pCallSite->liveBytes  + bytes)  : (pCallSite->liveBytes  - bytes);
+        pCallSite->liveAllocs = add ? (pCallSite->liveAllocs + allocs) : (pCallSite->liveAllocs - allocs);
+    }
+}
+
+// =====================================================================================================================
+// Finds the call site table entry for a file and line, adding one if needed. Returns null if the table couldn't be
+// allocated, in which case the call site isn't counted. The caller must hold m_mutex.
+//
+// Call sites are identified by the address of their filename string, so a call site in a header may show up once per
+// translation unit which uses it.
+template <typename Allocator>
+MemTrackerCallSite* MemTracker<Allocator>::FindCallSite(
+    const char* pFilename,
+    uint32      lineNumber)
+{
+    // A null filename marks unused entries.
+    if (pFilename == nullptr)
+    {
+        pFilename = "Unknown";
+    }
+
+    // Keep the table at most half full so that probe sequences stay short.
+    if (((m_numCallSites + 1) * 2) > m_callSiteTableSize)
+    {
+        const uint32 newTableSize = Max(m_callSiteTableSize * 2, MinCallSiteTableSize);
+
+        // The table is allocated from the underlying allocator, so it isn't tracked itself.
+        auto*const pNewTable = static_cast<MemTrackerCallSite*>(m_pAllocator->Alloc(
+            AllocInfo(sizeof(MemTrackerCallSite) * newTableSize, alignof(MemTrackerCallSite), true, AllocInternal,
+                      MemBlkType::Malloc, __FILE__, __LINE__)));
+
+        if (pNewTable != nullptr)
+        {
+            MemTrackerCallSite*const pOldTable     = m_pCallSites;
+            const uint32             oldTableSize  = m_callSiteTableSize;
+
+            m_pCallSites        = pNewTable;
+            m_callSiteTableSize = newTableSize;
+            m_numCallSites      = 0;
+
+            for (uint32 i = 0; i < oldTableSize; ++i)
+            {
+                if (pOldTable[i].pFilename != nullptr)
+                {
+                    *FindCallSite(pOldTable[i].pFilename, pOldTable[i].lineNumber) = pOldTable[i];
+                }
+            }
+
+            if (pOldTable != nullptr)
+            {
+                m_pAllocator->Free(FreeInfo(pOldTable, MemBlkType::Malloc));
+            }
+        }
+    }
+
+    MemTrackerCallSite* pCallSite = nullptr;
+
+    if ((m_pCallSites != nullptr) && ((m_numCallSites + 1) < m_callSiteTableSize))
+    {
+        const uint64 hash = (reinterpret_cast<uint64>(pFilename) + lineNumber) * 0x9E3779B97F4A7C15ull;
+
+        for (uint32 index = static_cast<uint32>(hash >> 32) & (m_callSiteTableSize - 1); ;
+             index = (index + 1) & (m_callSiteTableSize - 1))
+        {
+            pCallSite = &m_pCallSites[index];
+
+            if (pCallSite->pFilename == nullptr)
+            {
+                pCallSite->pFilename  = pFilename;
+                pCallSite->lineNumber = lineNumber;
+                m_numCallSites++;
+                break;
+            }
+            else if ((pCallSite->pFilename == pFilename) && (pCallSite->lineNumber == lineNumber))
+            {
+                break;
+            }
+        }
+    }
+
+    return pCallSite;
+}
+
+// =====================================================================================================================
+// Writes the live allocation totals per SystemAllocType and per call site as a JSON map. The totals are copied under
+// the lock and then written without it, because the JSON stream may itself allocate memory through this tracker.
+template <typename Allocator>
+void MemTracker<Allocator>::WriteSnapshot(
+    JsonWriter* pWriter)
+{
+    size_t              liveBytes[NumAllocTypes]  = {};
+    size_t              liveAllocs[NumAllocTypes] = {};
+    MemTrackerCallSite* pCallSites                = nullptr;
+    uint32              numCallSites              = 0;
+
+    {
+        MutexAuto lock(&m_mutex);
+
+        memcpy(liveBytes,  m_liveBytes,  sizeof(liveBytes));
+        memcpy(liveAllocs, m_liveAllocs, sizeof(liveAllocs));
+
+        if (m_numCallSites > 0)
+        {
+            pCallSites = static_cast<MemTrackerCallSite*>(m_pAllocator->Alloc(
+                AllocInfo(sizeof(MemTrackerCallSite) * m_numCallSites, alignof(MemTrackerCallSite), false,
+                          AllocInternalTemp, MemBlkType::Malloc, __FILE__, __LINE__)));
+        }
+
+        if (pCallSites != nullptr)
+        {
+            for (uint32 i = 0; i < m_callSiteTableSize; ++i)
+            {
+                if ((m_pCallSites[i].pFilename != nullptr) && (m_pCallSites[i].liveAllocs != 0))
+                {
+                    pCallSites[numCallSites++] = m_pCallSites[i];
+                }
+            }
+        }
+    }
+
+    pWriter->BeginMap(false);
+    pWriter->KeyAndValue("sampleBytes", static_cast<uint64>(SampleBytes));
+
+    pWriter->KeyAndBeginList("allocTypes", false);
+    for (uint32 i = 0; i < NumAllocTypes; ++i)
+    {
+        pWriter->BeginMap(true);
+        pWriter->KeyAndValue("allocType", SystemAllocTypeStr[i]);
+        pWriter->KeyAndValue("liveBytes", static_cast<uint64>(liveBytes[i]));
+        pWriter->KeyAndValue("liveAllocs", static_cast<uint64>(liveAllocs[i]));
+        pWriter->EndMap();
+    }
+    pWriter->EndList();
+
+    pWriter->KeyAndBeginList("callSites", false);
+    for (uint32 i = 0; i < numCallSites; ++i)
+    {
+        pWriter->BeginMap(true);
+        pWriter->KeyAndValue("file", pCallSites[i].pFilename);
+        pWriter->KeyAndValue("line", pCallSites[i].lineNumber);
+        pWriter->KeyAndValue("liveBytes", static_cast<uint64>(pCallSites[i].liveBytes));
+        pWriter->KeyAndValue("liveAllocs", static_cast<uint64>(pCallSites[i].liveAllocs));
+        pWriter->EndMap();
+    }
+    pWriter->EndList();
+
+    pWriter->EndMap();
+
+    if (pCallSites != nullptr)
+    {
+        m_pAllocator->Free(FreeInfo(pCallSites, MemBlkType::Malloc));
+    }
+}
+
 // =====================================================================================================================
 // Frees all memory that has not been explicitly freed (in other words, memory that has leaked).  This function is only
 // expected to be called when the memory tracker is being destroyed.
@@ -0,0 +1,138 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palMpmcQueue.h
+ * @brief PAL utility collection MpmcQueue class declaration.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palEventCount.h"
+
+namespace Util
+{
+
+/**
+ ***********************************************************************************************************************
+ * @brief Bounded lock-free queue which any number of threads can push to and pop from concurrently.
+ *
+ * The queue is a power-of-two sized array of cells, each tagged with a sequence number.  A cell whose sequence equals
+ * the enqueue position is free for that position, and a cell whose sequence is one past the dequeue position holds
+ * the value for that position.  Producers and consumers claim positions with a compare-and-swap on their own counter,
+ * then publish the cell by advancing its sequence with a release store, so neither side ever takes a lock or makes a
+ * system call on its fast path.
+ *
+ * If blocking is enabled, Enqueue() and Dequeue() can also sleep on a futex while the queue is full or empty.  Every
+ * push and pop then pays for one memory barrier to check whether anybody sleeps; the system call to wake a thread is
+ * only made when somebody does.  TryEnqueue() and TryDequeue() never sleep.
+ *
+ * Values are copied in and moved out.  Every cell holds a default-constructed T while it's empty.
+ *
+ * @warning Init() must be called before using this container, and the queue must not be used by any other thread
+ *          while it's being destroyed.
+ ***********************************************************************************************************************
+ */
+template <typename T, typename Allocator>
+class MpmcQueue
+{
+public:
+    /// Constructor.
+    ///
+    /// @param [in] capacity       Maximum number of values the queue holds, which is rounded up to a power of two.
+    /// @param [in] enableBlocking True to allow Enqueue() and Dequeue() to wait for space or values.
+    /// @param [in] pAllocator     The allocator that will allocate memory if required.
+    MpmcQueue(uint32 capacity, bool enableBlocking, Allocator*const pAllocator);
+    ~MpmcQueue();
+
+    /// Allocates the cells of the queue.
+    ///
+    /// @returns @ref Success if successful, or @ref ErrorOutOfMemory if the allocation failed.
+    Result Init();
+
+    /// Pushes a value onto the back of the queue if there's room for it.  Never blocks.
+    ///
+    /// @param [in] value Value to push.
+    ///
+    /// @returns True if the value was pushed, false if the queue was full.
+    bool TryEnqueue(const T& value);
+
+    /// Pops the value at the front of the queue if there is one.  Never blocks.
+    ///
+    /// @param [out] pValue Receives the value.
+    ///
+    /// @returns True if a value was popped, false if the queue was empty.
+    bool TryDequeue(T* pValue);
+
+    /// Pushes a value onto the back of the queue, waiting for room if it's full.
+    ///
+    /// @param [in] value      Value to push.
+    /// @param [in] waitTimeMs Number of milliseconds to wait for room, or @ref EventCount::Infinite.  Must be zero
+    ///                        unless blocking is enabled.
+    ///
+    /// @returns @ref Success if the value was pushed, @ref NotReady if the queue was full and waitTimeMs was zero, or
+    ///          @ref Timeout if the queue stayed full for the whole wait time.
+    Result Enqueue(const T& value, uint32 waitTimeMs);
+
+    /// Pops the value at the front of the queue, waiting for one if it's empty.
+    ///
+    /// @param [out] pValue     Receives the value.
+    /// @param [in]  waitTimeMs Number of milliseconds to wait for a value, or @ref EventCount::Infinite.  Must be zero
+    ///                         unless blocking is enabled.
+    ///
+    /// @returns @ref Success if a value was popped, @ref NotReady if the queue was empty and waitTimeMs was zero, or
+    ///          @ref Timeout if the queue stayed empty for the whole wait time.
+    Result Dequeue(T* pValue, uint32 waitTimeMs);
+
+    /// Returns the maximum number of values the queue holds.
+    uint32 Capacity() const { return m_mask + 1; }
+
+private:
+    struct Cell
+    {
+        volatile uint32 sequence; // Position this cell is ready for: pos if it's free, pos + 1 if it holds a value.
+        T               value;
+    };
+
+    Allocator*const m_pAllocator;
+    const uint32    m_mask;        // Capacity minus one.
+    const bool      m_blocking;
+    Cell*           m_pCells;
+
+    // The counters which producers and consumers contend on, and the wait lists, each get their own cache line.
+    uint8           m_padding0[PAL_CACHE_LINE_BYTES];
+    volatile uint32 m_enqueuePos;  // Next position to push to.
+    uint8           m_padding1[PAL_CACHE_LINE_BYTES - sizeof(uint32)];
+    volatile uint32 m_dequeuePos;  // Next position to pop from.
+    uint8           m_padding2[PAL_CACHE_LINE_BYTES - sizeof(uint32)];
+    EventCount      m_notEmpty;    // Consumers wait here while the queue is empty.
+    uint8           m_padding3[PAL_CACHE_LINE_BYTES - sizeof(EventCount)];
+    EventCount      m_notFull;     // Producers wait here while the queue is full.
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(MpmcQueue);
+};
+
+} // Util
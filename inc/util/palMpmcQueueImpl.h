@@ -0,0 +1,296 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palMpmcQueueImpl.h
+ * @brief PAL utility collection MpmcQueue class implementation.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palMpmcQueue.h"
+#include "palInlineFuncs.h"
+#include "palSysMemory.h"
+
+namespace Util
+{
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+MpmcQueue<T, Allocator>::MpmcQueue(
+    uint32          capacity,
+    bool            enableBlocking,
+    Allocator*const pAllocator)
+    :
+    m_pAllocator(pAllocator),
+    m_mask(Pow2Pad(Max(capacity, 2u)) - 1),
+    m_blocking(enableBlocking),
+    m_pCells(nullptr),
+    m_enqueuePos(0),
+    m_dequeuePos(0)
+{
+    // Positions are compared as signed differences, so the capacity must stay well below 2^31.
+    PAL_ASSERT((capacity > 0) && (capacity <= (1u << 30)));
+}
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+MpmcQueue<T, Allocator>::~MpmcQueue()
+{
+    if (m_pCells != nullptr)
+    {
+        for (uint32 i = 0; i <= m_mask; i++)
+        {
+            m_pCells[i].value.~T();
+        }
+
+        PAL_FREE(m_pCells, m_pAllocator);
+    }
+}
+
+// =====================================================================================================================
+// Allocates the cells and marks each of them as free for the first lap through the queue.
+template <typename T, typename Allocator>
+Result MpmcQueue<T, Allocator>::Init()
+{
+    Result result = Result::ErrorOutOfMemory;
+
+    m_pCells = static_cast<Cell*>(PAL_MALLOC_ALIGNED(sizeof(Cell) * (m_mask + 1),
+                                                     Max<size_t>(alignof(Cell), PAL_CACHE_LINE_BYTES),
+                                                     m_pAllocator,
+                                                     AllocInternal));
+
+    if (m_pCells != nullptr)
+    {
+        for (uint32 i = 0; i <= m_mask; i++)
+        {
+            m_pCells[i].sequence = i;
+            PAL_PLACEMENT_NEW(&m_pCells[i].value) T();
+        }
+
+        result = Result::Success;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Claims the next enqueue position if its cell has been freed by the consumer of the previous lap, then fills the cell
+// and hands it to the consumers of this lap.
+template <typename T, typename Allocator>
+bool MpmcQueue<T, Allocator>::TryEnqueue(
+    const T& value)
+{
+    bool   pushed = false;
+    bool   done   = false;
+    uint32 pos    = AtomicReadAcquire(&m_enqueuePos);
+
+    while (done == false)
+    {
+        Cell*const   pCell    = &m_pCells[pos & m_mask];
+        const uint32 sequence = AtomicReadAcquire(&pCell->sequence);
+        const int32  diff     = static_cast<int32>(sequence - pos);
+
+        if (diff == 0)
+        {
+            const uint32 prevPos = AtomicCompareAndSwap(&m_enqueuePos, pos, pos + 1);
+
+            if (prevPos == pos)
+            {
+                pCell->value = value;
+                AtomicWriteRelease(&pCell->sequence, pos + 1);
+
+                pushed = true;
+                done   = true;
+            }
+            else
+            {
+                pos = prevPos;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The cell still holds the value from the previous lap, so the queue is full.
+            done = true;
+        }
+        else
+        {
+            // Another producer claimed this position since we read the counter.
+            pos = AtomicReadAcquire(&m_enqueuePos);
+        }
+    }
+
+    if (pushed && m_blocking)
+    {
+        m_notEmpty.Notify(false);
+    }
+
+    return pushed;
+}
+
+// =====================================================================================================================
+// Claims the next dequeue position if its cell has been filled, then empties the cell and hands it to the producers of
+// the next lap.
+template <typename T, typename Allocator>
+bool MpmcQueue<T, Allocator>::TryDequeue(
+    T* pValue)
+{
+    PAL_ASSERT(pValue != nullptr);
+
+    bool   popped = false;
+    bool   done   = false;
+    uint32 pos    = AtomicReadAcquire(&m_dequeuePos);
+
+    while (done == false)
+    {
+        Cell*const   pCell    = &m_pCells[pos & m_mask];
+        const uint32 sequence = AtomicReadAcquire(&pCell->sequence);
+        const int32  diff     = static_cast<int32>(sequence - (pos + 1));
+
+        if (diff == 0)
+        {
+            const uint32 prevPos = AtomicCompareAndSwap(&m_dequeuePos, pos, pos + 1);
+
+            if (prevPos == pos)
+            {
+                *pValue = Move(pCell->value);
+                AtomicWriteRelease(&pCell->sequence, pos + m_mask + 1);
+
+                popped = true;
+                done   = true;
+            }
+            else
+            {
+                pos = prevPos;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The cell hasn't been filled for this lap yet, so the queue is empty.
+            done = true;
+        }
+        else
+        {
+            // Another consumer claimed this position since we read the counter.
+            pos = AtomicReadAcquire(&m_dequeuePos);
+        }
+    }
+
+    if (popped && m_blocking)
+    {
+        m_notFull.Notify(false);
+    }
+
+    return popped;
+}
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+Result MpmcQueue<T, Allocator>::Enqueue(
+    const T& value,
+    uint32   waitTimeMs)
+{
+    Result result = TryEnqueue(value) ? Result::Success : Result::NotReady;
+
+    if ((result == Result::NotReady) && (waitTimeMs != 0))
+    {
+        PAL_ASSERT(m_blocking);
+
+        // Give the other side a chance to catch up before paying for a sleep and a wake.
+        for (uint32 i = 0; (i < EventCount::SpinCount) && (result == Result::NotReady); i++)
+        {
+            YieldThread();
+            result = TryEnqueue(value) ? Result::Success : Result::NotReady;
+        }
+
+        const int64 deadline = EventCount::ComputeDeadline(waitTimeMs);
+
+        m_notFull.BeginWait();
+
+        while (result == Result::NotReady)
+        {
+            const uint32 key = m_notFull.PrepareWait();
+
+            if (TryEnqueue(value))
+            {
+                result = Result::Success;
+            }
+            else if (m_notFull.Wait(key, deadline) == Result::Timeout)
+            {
+                result = Result::Timeout;
+            }
+        }
+
+        m_notFull.EndWait();
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+Result MpmcQueue<T, Allocator>::Dequeue(
+    T*     pValue,
+    uint32 waitTimeMs)
+{
+    Result result = TryDequeue(pValue) ? Result::Success : Result::NotReady;
+
+    if ((result == Result::NotReady) && (waitTimeMs != 0))
+    {
+        PAL_ASSERT(m_blocking);
+
+        // Give the other side a chance to catch up before paying for a sleep and a wake.
+        for (uint32 i = 0; (i < EventCount::SpinCount) && (result == Result::NotReady); i++)
+        {
+            YieldThread();
+            result = TryDequeue(pValue) ? Result::Success : Result::NotReady;
+        }
+
+        const int64 deadline = EventCount::ComputeDeadline(waitTimeMs);
+
+        m_notEmpty.BeginWait();
+
+        while (result == Result::NotReady)
+        {
+            const uint32 key = m_notEmpty.PrepareWait();
+
+            if (TryDequeue(pValue))
+            {
+                result = Result::Success;
+            }
+            else if (m_notEmpty.Wait(key, deadline) == Result::Timeout)
+            {
+                result = Result::Timeout;
+            }
+        }
+
+        m_notEmpty.EndWait();
+    }
+
+    return result;
+}
+
+} // Util
@@ -423,6 +423,12 @@ public:
     /// Returns the position (in bytes) of the next item the reader would unpack.
     uint32 Tell() const { return static_cast<uint32>(VoidPtrDiff(m_context.current, m_context.start)); }
 
+    /// Returns a pointer to the start of the MsgPack blob the reader was initialized with.
+    const void* GetBuffer() const { return m_context.start; }
+
+    /// Returns the size (in bytes) of the MsgPack blob the reader was initialized with.
+    uint32 GetSize() const { return static_cast<uint32>(VoidPtrDiff(m_context.end, m_context.start)); }
+
     /// Seeks the reader's position to the specified offset (in bytes) and attempts to unpack the next item there.
     ///
     /// @param [in] offset  Offset in bytes to seek to. Valid values may be obtained from @ref Tell().
@@ -0,0 +1,165 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palMsgPackView.h
+ * @brief PAL random-access MessagePack view utility class declaration.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palSysMemory.h"
+#include "palVector.h"
+
+#include "cwpack.h"
+
+namespace Util
+{
+
+/**
+ ***********************************************************************************************************************
+ * @brief Random-access, read-only view of a MsgPack blob.
+ *
+ * Unlike MsgPackReader, which walks a blob strictly item by item, a MsgPackView makes one pass over the blob up front
+ * and records where every map and array ends.  Afterwards, any item can be decoded directly from its byte offset, and
+ * stepping over an item (however large) is a binary search instead of a walk over all of its children.  This suits
+ * metadata sections that are looked up sparsely and repeatedly, such as a shader library's per-function tables.
+ *
+ * Nothing is copied out of the blob: strings and binary items are returned as pointers into it, so the blob must
+ * outlive the view.
+ *
+ * Offsets are byte offsets from the start of the blob, and are compatible with MsgPackReader::Tell()/Seek().
+ ***********************************************************************************************************************
+ */
+class MsgPackView
+{
+public:
+    /// Constructor.
+    ///
+    /// @param [in] pAllocator  The allocator used for the structural index.
+    template <typename Allocator>
+    explicit MsgPackView(Allocator*const pAllocator)
+        :
+        m_allocator(pAllocator),
+        m_pBuffer(nullptr),
+        m_sizeInBytes(0),
+        m_containers(&m_allocator)
+    { }
+
+    /// Builds the structural index of a MsgPack blob in a single pass.
+    ///
+    /// @param [in] pBuffer      The MsgPack blob.  It must remain valid for the lifetime of the view.
+    /// @param [in] sizeInBytes  Size of the blob in bytes.
+    ///
+    /// @returns Success if successful, ErrorInvalidValue if the blob is not valid MsgPack, or ErrorOutOfMemory if the
+    ///          index could not be allocated.
+    Result Init(const void* pBuffer, uint32 sizeInBytes);
+
+    /// Returns true if Init() has completed successfully.
+    bool IsValid() const { return (m_pBuffer != nullptr); }
+
+    /// Returns a pointer to the start of the MsgPack blob the view was initialized with.
+    const void* GetBuffer() const { return m_pBuffer; }
+
+    /// Returns the size (in bytes) of the MsgPack blob the view was initialized with.
+    uint32 GetSize() const { return m_sizeInBytes; }
+
+    /// Decodes the header of the item at the given offset.  For maps and arrays, this is just the element count.
+    ///
+    /// @param [in]  offset  Byte offset of the item.
+    /// @param [out] pItem   The decoded item.  String, binary and extension items point into the blob.
+    ///
+    /// @returns Success if successful, Eof if offset is at or past the end of the blob, ErrorInvalidValue otherwise.
+    Result GetItem(uint32 offset, cwpack_item* pItem) const;
+
+    /// Finds the offset just past the item at the given offset, including all of its children.
+    ///
+    /// @param [in]  offset       Byte offset of the item.
+    /// @param [out] pNextOffset  Byte offset of the following item.
+    ///
+    /// @returns Success if successful, ErrorInvalidValue otherwise.
+    Result SkipItem(uint32 offset, uint32* pNextOffset) const;
+
+    /// Looks up a string key in a map.
+    ///
+    /// @param [in]  mapOffset     Byte offset of the map item.
+    /// @param [in]  pKey          The key to look for.  It need not be null-terminated.
+    /// @param [in]  keyLength     Length of the key in bytes.
+    /// @param [out] pValueOffset  Byte offset of the value associated with the key.
+    ///
+    /// @returns Success if the key was found, NotFound if it was not, ErrorInvalidValue if mapOffset does not refer
+    ///          to a map or the blob is malformed.
+    Result FindMapValue(uint32 mapOffset, const char* pKey, uint32 keyLength, uint32* pValueOffset) const;
+
+    /// Returns the string item at the given offset without copying it.
+    ///
+    /// @param [in]  offset     Byte offset of the string item.
+    /// @param [out] ppString   Pointer into the blob where the string begins.  It is not null-terminated.
+    /// @param [out] pLength    Length of the string in bytes.
+    ///
+    /// @returns Success if successful, ErrorInvalidValue if the item is not a string.
+    Result GetString(uint32 offset, const char** ppString, uint32* pLength) const;
+
+    /// Unpacks the scalar item at the given offset as an unsigned integer.
+    ///
+    /// @param [in]  offset  Byte offset of the item.
+    /// @param [out] pValue  The item's value.
+    ///
+    /// @returns Success if successful, ErrorInvalidValue if the item is not a non-negative integer or boolean.
+    Result GetUint(uint32 offset, uint64* pValue) const;
+
+    /// Finds the offset of the first child of a map or array, i.e., the first key of a map or first element of an
+    /// array.  Subsequent children can be reached with SkipItem().
+    ///
+    /// @param [in]  offset        Byte offset of the map or array item.
+    /// @param [out] pChildOffset  Byte offset of the first child.
+    /// @param [out] pNumChildren  Number of direct children (twice the number of entries for a map).
+    ///
+    /// @returns Success if successful, ErrorInvalidValue if the item is not a map or array.
+    Result GetFirstChild(uint32 offset, uint32* pChildOffset, uint32* pNumChildren) const;
+
+private:
+    // Extent of one map or array, in byte offsets.  Containers are recorded in the order they begin, so the index is
+    // sorted by begin offset.
+    struct Container
+    {
+        uint32 begin;
+        uint32 end;
+    };
+
+    Result DecodeItem(uint32 offset, cwpack_item* pItem, uint32* pHeaderEnd) const;
+    const Container* FindContainer(uint32 offset) const;
+
+    IndirectAllocator                        m_allocator;
+    const uint8*                             m_pBuffer;
+    uint32                                   m_sizeInBytes;
+    Vector<Container, 16, IndirectAllocator> m_containers;
+
+    PAL_DISALLOW_DEFAULT_CTOR(MsgPackView);
+    PAL_DISALLOW_COPY_AND_ASSIGN(MsgPackView);
+};
+
+} // Util
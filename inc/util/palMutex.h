@@ -33,24 +33,48 @@
 
 #include "palAssert.h"
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION < 692
 #include <pthread.h>
+#endif
 #include <string.h>
 
 namespace Util
 {
 
+#if (PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692) && PAL_DEVELOPER_BUILD
+/// Contention counters kept by each @ref Mutex and @ref RWLock in developer builds.  They're meant for finding hot
+/// locks: dump them from a tool or a debugger after running a workload, then reset them between runs.
+struct LockContentionStats
+{
+    uint64 acquireCount;   ///< Number of times the lock was acquired, in any mode.
+    uint64 contendedCount; ///< Number of acquisitions which found the lock held and had to spin or sleep.
+    uint64 sleepCount;     ///< Number of contended acquisitions which gave up spinning and slept in the kernel.
+    uint64 waitTicks;      ///< Total time spent in contended acquisitions, in @ref GetPerfCpuTime ticks.
+};
+#endif
+
 /**
  ***********************************************************************************************************************
  * @brief Platform-agnostic mutex primitive.
+ *
+ * Starting with interface version 692, an uncontended Lock() or Unlock() is a single atomic operation.  A contended
+ * Lock() first spins for a while, with a spin budget that adapts to how long the lock has recently been held, and only
+ * then sleeps in the kernel.  Unlock() only calls into the kernel when some thread is actually asleep.  Older interface
+ * versions wrap a pthread mutex.
  ***********************************************************************************************************************
  */
 class Mutex
 {
 public:
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    Mutex() noexcept : m_state(0), m_spinCount(0) { ResetContentionStats(); }
+    ~Mutex() { PAL_ASSERT(m_state == 0); }
+#else
     /// Defines MutexData as a unix pthread_mutex_t
     typedef pthread_mutex_t MutexData;
     Mutex() noexcept : m_osMutex {} { pthread_mutex_init(&m_osMutex, nullptr); }
     ~Mutex() { pthread_mutex_destroy(&m_osMutex); };
+#endif
 
     /// Enters the critical section if it is not contended.  If it is contended, wait for the critical section to become
     /// available, then enter it.
@@ -65,11 +89,38 @@ public:
     /// Leaves the critical section.
     void Unlock();
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+#if PAL_DEVELOPER_BUILD
+    /// Returns this mutex's contention counters.  They're only updated while the mutex is held, so read them while
+    /// holding it or once other threads are done with it.
+    const LockContentionStats& GetContentionStats() const { return m_stats; }
+#endif
+
+    /// Zeroes this mutex's contention counters.  Does nothing unless PAL_DEVELOPER_BUILD is set.
+    void ResetContentionStats()
+    {
+#if PAL_DEVELOPER_BUILD
+        m_stats = { };
+#endif
+    }
+#else
     /// Returns the OS specific mutex data.
     MutexData* GetMutexData() { return &m_osMutex; }
+#endif
 
 private:
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    void LockContended();
+
+    volatile uint32 m_state;     // Unlocked, locked, or locked with threads (maybe) asleep waiting for it.
+    uint32          m_spinCount; // Running average of how long recent contended Lock() calls spun before succeeding.
+
+#if PAL_DEVELOPER_BUILD
+    LockContentionStats m_stats;
+#endif
+#else
     MutexData m_osMutex;     ///< Opaque structure to the OS-specific Mutex data
+#endif
 
     PAL_DISALLOW_COPY_AND_ASSIGN(Mutex);
 };
@@ -120,16 +171,30 @@ private:
 /**
  ***********************************************************************************************************************
  * @brief Platform-agnostic rw lock primitive.
+ *
+ * Starting with interface version 692, the lock prefers writers: once a writer is waiting, new readers wait behind it,
+ * so a steady stream of readers can't starve writers.  Uncontended reads and writes are a single atomic operation, and
+ * contended ones spin briefly before sleeping.  Older interface versions wrap a pthread rwlock.
+ *
+ * @warning Starting with interface version 692, the lock is not recursive for readers.  A thread which already holds
+ *          the lock for read and calls LockForRead() again deadlocks as soon as a writer is waiting, because the nested
+ *          read queues behind that writer, which in turn waits for the outer read to be released.  The pthread rwlock
+ *          used by older interface versions allows such nested reads.
  ***********************************************************************************************************************
  */
 class RWLock
 {
 public:
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    RWLock() noexcept : m_state(0) { ResetContentionStats(); }
+    ~RWLock() noexcept { PAL_ASSERT(m_state == 0); }
+#else
     /// Defines RWLockData as a unix pthread_rwlock_t
     typedef pthread_rwlock_t  RWLockData;
     /// @note pthread_rwlock_init will not fail as called
     RWLock() noexcept : m_osRWLock {} { pthread_rwlock_init(&m_osRWLock, nullptr); }
     ~RWLock() noexcept { pthread_rwlock_destroy(&m_osRWLock); };
+#endif
 
     /// Enumerates the lock type of RWLockAuto
     enum LockType
@@ -140,6 +205,7 @@ public:
 
     /// Acquires a rw lock in shared mode if it is not contended in exclusive mode.
     /// If it is contended, wait for rw lock to become available, then enter it.
+    /// Must not be called by a thread which already holds the lock (see the class notes).
     void LockForRead();
 
     /// Acquires a rw lock in exclusive mode if it is not contended.
@@ -162,11 +228,41 @@ public:
     /// Release the rw lock which is previously contended in exclusive mode.
     void UnlockForWrite();
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+#if PAL_DEVELOPER_BUILD
+    /// Returns this lock's contention counters.  Readers update them atomically, so they can be read at any time, but
+    /// they're only consistent with each other once other threads are done with the lock.
+    const LockContentionStats& GetContentionStats() const { return m_stats; }
+#endif
+
+    /// Zeroes this lock's contention counters.  Does nothing unless PAL_DEVELOPER_BUILD is set.
+    void ResetContentionStats()
+    {
+#if PAL_DEVELOPER_BUILD
+        m_stats = { };
+#endif
+    }
+#else
     /// Returns the OS specific RWLOCK data.
     RWLockData* GetRWLockData() { return &m_osRWLock; }
+#endif
 
 private:
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    void LockForReadContended();
+    void LockForWriteContended();
+    void WakeSleepers(uint32 state);
+
+    // Number of readers holding the lock, number of writers waiting for it, whether a writer holds it, and whether any
+    // thread is (maybe) asleep waiting for it, all packed in one word so they can be updated together.
+    volatile uint32 m_state;
+
+#if PAL_DEVELOPER_BUILD
+    LockContentionStats m_stats;
+#endif
+#else
     RWLockData m_osRWLock;    ///< Opaque structure to the OS-specific RWLock data
+#endif
 
     PAL_DISALLOW_COPY_AND_ASSIGN(RWLock);
 };
@@ -232,6 +328,29 @@ private:
 /// Yields the current thread to another thread in the ready state (if available).
 extern void YieldThread();
 
+/// Blocks the calling thread as long as *pAddress holds the expected value, until another thread wakes it through
+/// @ref WakeOnAddress or the timeout expires.  The comparison and the sleep happen atomically, so a wake which follows
+/// a change of *pAddress can't be missed.  The thread may also wake spuriously, so callers must recheck their
+/// condition.
+///
+/// @param [in] pAddress     Address to wait on.
+/// @param [in] expected     Value *pAddress must hold for the thread to go to sleep.
+/// @param [in] milliseconds Maximum time to sleep, or UINT32_MAX to sleep without a timeout.
+///
+/// @returns @ref Success if the thread was woken or *pAddress didn't hold the expected value, or @ref Timeout if the
+///          timeout expired first.
+extern Result WaitOnAddress(volatile uint32* pAddress, uint32 expected, uint32 milliseconds);
+
+/// Wakes threads blocked in @ref WaitOnAddress on the given address.
+///
+/// @param [in] pAddress Address the threads are waiting on.
+/// @param [in] wakeAll  Wakes every waiting thread if true, otherwise at most one.
+extern void WakeOnAddress(volatile uint32* pAddress, bool wakeAll);
+
+/// Issues a full memory barrier: no read or write which precedes this call can be reordered with one which follows it.
+/// Unlike the acquire and release operations, this also orders a write with a later read of a different address.
+extern void AtomicThreadFence();
+
 /// Atomic write of 64-bit unsigned integer, using a relaxed memory ordering policy.
 /// If you need to synchronize more than just pTarget, you may need a new function.
 ///
@@ -248,6 +367,34 @@ extern void AtomicWriteRelaxed64(volatile uint64* pTarget, uint64 newValue);
 /// @returns The original value of *pTarget.
 extern uint64 AtomicReadRelaxed64(const volatile uint64* pTarget);
 
+/// Atomic read of 32-bit unsigned integer, using an acquire memory ordering policy.  Reads and writes which follow
+/// this call can't be reordered before it, so data published by a matching @ref AtomicWriteRelease is visible.
+///
+/// @param [in] pTarget Pointer to the value to be read.
+///
+/// @returns The value of *pTarget.
+extern uint32 AtomicReadAcquire(const volatile uint32* pTarget);
+
+/// Atomic write of 32-bit unsigned integer, using a release memory ordering policy.  Reads and writes which precede
+/// this call can't be reordered after it.
+///
+/// @param [in,out] pTarget  Pointer to the value to be written.
+/// @param [in]     newValue New value to be stored in *pTarget.
+extern void AtomicWriteRelease(volatile uint32* pTarget, uint32 newValue);
+
+/// Atomic read of a pointer, using an acquire memory ordering policy.  See @ref AtomicReadAcquire.
+///
+/// @param [in] ppTarget Pointer to the pointer to be read.
+///
+/// @returns The value of *ppTarget.
+extern void* AtomicReadAcquirePointer(void*const volatile* ppTarget);
+
+/// Atomic write of a pointer, using a release memory ordering policy.  See @ref AtomicWriteRelease.
+///
+/// @param [in,out] ppTarget Pointer to the pointer to be written.
+/// @param [in]     pValue   New pointer to be stored in *ppTarget.
+extern void AtomicWriteReleasePointer(void*volatile* ppTarget, void* pValue);
+
 /// Atomically increments the specified 32-bit unsigned integer.
 ///
 /// @param [in,out] pValue Pointer to the value to be incremented.
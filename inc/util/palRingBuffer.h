@@ -31,7 +31,7 @@
 
 #pragma once
 
-#include "palSemaphore.h"
+#include "palEventCount.h"
 
 namespace Util
 {
@@ -41,7 +41,9 @@ typedef bool (PAL_STDCALL *RingBufferSlotFunc)(uint32 slotIdx, void* pData, void
 
 /**
 ************************************************************************************************************************
-* @brief  Simple container for a ring buffer, useful for multithreaded operations.
+* @brief  Simple container for a ring buffer, useful for handing buffers from one writer thread to one reader thread.
+*
+* Handing a buffer over is an atomic store; a system call is only made when the other thread is asleep waiting for it.
 ************************************************************************************************************************
 */
 template <typename Allocator>
@@ -95,13 +97,23 @@ public:
     void ReleaseReadBuffer();
 
 private:
+    // Returns true if the writer has a free buffer.  Writer thread only.
+    bool IsWritable() const { return ((m_writeCount - AtomicReadAcquire(&m_readCount)) < m_numElements); }
+
+    // Returns true if the reader has a written buffer.  Reader thread only.
+    bool IsReadable() const { return (AtomicReadAcquire(&m_writeCount) != m_readCount); }
+
+    void WaitFor(EventCount* pEvent, bool (RingBuffer::*pfnCondition)() const, uint32 waitTimeMs);
+
     void*             m_pRingBuffer;  // Allocated ring buffer memory.
     const uint32      m_numElements;  // Number of elements in the ring buffer.
     const size_t      m_elementSize;  // Size of each element in the ring buffer.
     uint32            m_writePointer; // The write pointer of the ring buffer.
     uint32            m_readPointer;  // The read pointer of the ring buffer.
-    Semaphore         m_semaWrite;    // Semaphore of the writer of the ring buffer.
-    Semaphore         m_semaRead;     // Semaphore of the reader of the ring buffer.
+    volatile uint32   m_writeCount;   // Number of buffers released by the writer.  Only written by the writer.
+    volatile uint32   m_readCount;    // Number of buffers released by the reader.  Only written by the reader.
+    EventCount        m_notFull;      // The writer waits here while every buffer is written but not yet read.
+    EventCount        m_notEmpty;     // The reader waits here while no buffer is written.
     Allocator*const   m_pAllocator;    // Allocator for this ring buffer.
 
     PAL_DISALLOW_COPY_AND_ASSIGN(RingBuffer);
@@ -43,8 +43,10 @@ RingBuffer<Allocator>::RingBuffer(
     m_elementSize(elementSize),
     m_writePointer(0),
     m_readPointer(0),
-    m_semaWrite(),
-    m_semaRead(),
+    m_writeCount(0),
+    m_readCount(0),
+    m_notFull(),
+    m_notEmpty(),
     m_pAllocator(pAllocator)
 {
     PAL_ASSERT(numElements > 0);
@@ -63,12 +65,7 @@ Result RingBuffer<Allocator>::Init(
 
     if (m_pRingBuffer != nullptr)
     {
-        result = m_semaWrite.Init(m_numElements, m_numElements);
-    }
-
-    if (result == Result::Success)
-    {
-        result = m_semaRead.Init(m_numElements, 0);
+        result = Result::Success;
     }
 
     if ((result == Result::Success) && (pfnInit != nullptr))
@@ -127,7 +124,12 @@ Result RingBuffer<Allocator>::GetBufferForWriting(
 {
     Result result = Result::Timeout;
 
-    if (m_semaWrite.Wait(waitTimeMs) == Result::Success)
+    if (IsWritable() == false)
+    {
+        WaitFor(&m_notFull, &RingBuffer::IsWritable, waitTimeMs);
+    }
+
+    if (IsWritable())
     {
         (*ppBuffer) = VoidPtrInc(m_pRingBuffer, m_writePointer * m_elementSize);
         result = Result::Success;
@@ -143,7 +145,8 @@ void RingBuffer<Allocator>::ReleaseWriteBuffer()
 {
     m_writePointer = (m_writePointer + 1) % m_numElements;
 
-    m_semaRead.Post();
+    AtomicWriteRelease(&m_writeCount, m_writeCount + 1);
+    m_notEmpty.Notify(false);
 }
 
 // =====================================================================================================================
@@ -155,7 +158,12 @@ Result RingBuffer<Allocator>::GetBufferForReading(
 {
     Result result = Result::Timeout;
 
-    if (m_semaRead.Wait(waitTimeMs) == Result::Success)
+    if (IsReadable() == false)
+    {
+        WaitFor(&m_notEmpty, &RingBuffer::IsReadable, waitTimeMs);
+    }
+
+    if (IsReadable())
     {
         (*ppBuffer) = VoidPtrInc(m_pRingBuffer, m_readPointer * m_elementSize);
         result = Result::Success;
@@ -171,7 +179,42 @@ void RingBuffer<Allocator>::ReleaseReadBuffer()
 {
     m_readPointer = (m_readPointer + 1) % m_numElements;
 
-    m_semaWrite.Post();
+    AtomicWriteRelease(&m_readCount, m_readCount + 1);
+    m_notFull.Notify(false);
+}
+
+// =====================================================================================================================
+// Sleeps on the given event count until the condition holds or the wait time elapses.
+template <typename Allocator>
+void RingBuffer<Allocator>::WaitFor(
+    EventCount* pEvent,
+    bool        (RingBuffer::*pfnCondition)() const,
+    uint32      waitTimeMs)
+{
+    if (waitTimeMs != 0)
+    {
+        bool done = false;
+
+        // Give the other thread a chance to catch up before paying for a sleep and a wake.
+        for (uint32 i = 0; (i < EventCount::SpinCount) && (done == false); i++)
+        {
+            YieldThread();
+            done = (this->*pfnCondition)();
+        }
+
+        const int64 deadline = EventCount::ComputeDeadline(waitTimeMs);
+
+        pEvent->BeginWait();
+
+        while (done == false)
+        {
+            const uint32 key = pEvent->PrepareWait();
+
+            done = (this->*pfnCondition)() || (pEvent->Wait(key, deadline) == Result::Timeout);
+        }
+
+        pEvent->EndWait();
+    }
 }
 
 } // Util
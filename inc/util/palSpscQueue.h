@@ -0,0 +1,132 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palSpscQueue.h
+ * @brief PAL utility collection SpscQueue class declaration.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palEventCount.h"
+
+namespace Util
+{
+
+/**
+ ***********************************************************************************************************************
+ * @brief Bounded lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ * This is the same interface as @ref MpmcQueue, without the compare-and-swap loops: the producer alone advances the
+ * tail and the consumer alone advances the head, each with a release store.  Each side also keeps a private copy of
+ * the other side's counter and only rereads the shared one when the copy says the queue is full or empty, so in the
+ * steady state the two threads don't touch each other's cache lines at all.
+ *
+ * If blocking is enabled, Enqueue() and Dequeue() can sleep on a futex while the queue is full or empty; see
+ * @ref EventCount for what that costs the other side.
+ *
+ * Values are copied in and moved out.  Every slot holds a default-constructed T while it's empty.
+ *
+ * @warning Init() must be called before using this container.  At most one thread may push and one thread may pop at
+ *          any time.
+ ***********************************************************************************************************************
+ */
+template <typename T, typename Allocator>
+class SpscQueue
+{
+public:
+    /// Constructor.
+    ///
+    /// @param [in] capacity       Maximum number of values the queue holds, which is rounded up to a power of two.
+    /// @param [in] enableBlocking True to allow Enqueue() and Dequeue() to wait for space or values.
+    /// @param [in] pAllocator     The allocator that will allocate memory if required.
+    SpscQueue(uint32 capacity, bool enableBlocking, Allocator*const pAllocator);
+    ~SpscQueue();
+
+    /// Allocates the slots of the queue.
+    ///
+    /// @returns @ref Success if successful, or @ref ErrorOutOfMemory if the allocation failed.
+    Result Init();
+
+    /// Pushes a value onto the back of the queue if there's room for it.  Never blocks.  Producer thread only.
+    ///
+    /// @param [in] value Value to push.
+    ///
+    /// @returns True if the value was pushed, false if the queue was full.
+    bool TryEnqueue(const T& value);
+
+    /// Pops the value at the front of the queue if there is one.  Never blocks.  Consumer thread only.
+    ///
+    /// @param [out] pValue Receives the value.
+    ///
+    /// @returns True if a value was popped, false if the queue was empty.
+    bool TryDequeue(T* pValue);
+
+    /// Pushes a value onto the back of the queue, waiting for room if it's full.  Producer thread only.
+    ///
+    /// @param [in] value      Value to push.
+    /// @param [in] waitTimeMs Number of milliseconds to wait for room, or @ref EventCount::Infinite.  Must be zero
+    ///                        unless blocking is enabled.
+    ///
+    /// @returns @ref Success if the value was pushed, @ref NotReady if the queue was full and waitTimeMs was zero, or
+    ///          @ref Timeout if the queue stayed full for the whole wait time.
+    Result Enqueue(const T& value, uint32 waitTimeMs);
+
+    /// Pops the value at the front of the queue, waiting for one if it's empty.  Consumer thread only.
+    ///
+    /// @param [out] pValue     Receives the value.
+    /// @param [in]  waitTimeMs Number of milliseconds to wait for a value, or @ref EventCount::Infinite.  Must be zero
+    ///                         unless blocking is enabled.
+    ///
+    /// @returns @ref Success if a value was popped, @ref NotReady if the queue was empty and waitTimeMs was zero, or
+    ///          @ref Timeout if the queue stayed empty for the whole wait time.
+    Result Dequeue(T* pValue, uint32 waitTimeMs);
+
+    /// Returns the maximum number of values the queue holds.
+    uint32 Capacity() const { return m_mask + 1; }
+
+private:
+    Allocator*const m_pAllocator;
+    const uint32    m_mask;        // Capacity minus one.
+    const bool      m_blocking;
+    T*              m_pSlots;
+
+    // Each side's counters live on their own cache line, as do the wait lists.
+    uint8           m_padding0[PAL_CACHE_LINE_BYTES];
+    volatile uint32 m_tail;        // Next position to push to.  Only written by the producer.
+    uint32          m_cachedHead;  // The producer's last read of m_head.
+    uint8           m_padding1[PAL_CACHE_LINE_BYTES - (2 * sizeof(uint32))];
+    volatile uint32 m_head;        // Next position to pop from.  Only written by the consumer.
+    uint32          m_cachedTail;  // The consumer's last read of m_tail.
+    uint8           m_padding2[PAL_CACHE_LINE_BYTES - (2 * sizeof(uint32))];
+    EventCount      m_notEmpty;    // The consumer waits here while the queue is empty.
+    uint8           m_padding3[PAL_CACHE_LINE_BYTES - sizeof(EventCount)];
+    EventCount      m_notFull;     // The producer waits here while the queue is full.
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(SpscQueue);
+};
+
+} // Util
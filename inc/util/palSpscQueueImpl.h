@@ -0,0 +1,247 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palSpscQueueImpl.h
+ * @brief PAL utility collection SpscQueue class implementation.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palSpscQueue.h"
+#include "palInlineFuncs.h"
+#include "palSysMemory.h"
+
+namespace Util
+{
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+SpscQueue<T, Allocator>::SpscQueue(
+    uint32          capacity,
+    bool            enableBlocking,
+    Allocator*const pAllocator)
+    :
+    m_pAllocator(pAllocator),
+    m_mask(Pow2Pad(Max(capacity, 2u)) - 1),
+    m_blocking(enableBlocking),
+    m_pSlots(nullptr),
+    m_tail(0),
+    m_cachedHead(0),
+    m_head(0),
+    m_cachedTail(0)
+{
+    PAL_ASSERT((capacity > 0) && (capacity <= (1u << 30)));
+}
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+SpscQueue<T, Allocator>::~SpscQueue()
+{
+    if (m_pSlots != nullptr)
+    {
+        for (uint32 i = 0; i <= m_mask; i++)
+        {
+            m_pSlots[i].~T();
+        }
+
+        PAL_FREE(m_pSlots, m_pAllocator);
+    }
+}
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+Result SpscQueue<T, Allocator>::Init()
+{
+    Result result = Result::ErrorOutOfMemory;
+
+    m_pSlots = static_cast<T*>(PAL_MALLOC_ALIGNED(sizeof(T) * (m_mask + 1),
+                                                  Max<size_t>(alignof(T), PAL_CACHE_LINE_BYTES),
+                                                  m_pAllocator,
+                                                  AllocInternal));
+
+    if (m_pSlots != nullptr)
+    {
+        for (uint32 i = 0; i <= m_mask; i++)
+        {
+            PAL_PLACEMENT_NEW(&m_pSlots[i]) T();
+        }
+
+        result = Result::Success;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+bool SpscQueue<T, Allocator>::TryEnqueue(
+    const T& value)
+{
+    const uint32 tail   = m_tail;
+    bool         pushed = false;
+
+    if ((tail - m_cachedHead) > m_mask)
+    {
+        // Our copy of the head says the queue is full; see how far the consumer has really got.
+        m_cachedHead = AtomicReadAcquire(&m_head);
+    }
+
+    if ((tail - m_cachedHead) <= m_mask)
+    {
+        m_pSlots[tail & m_mask] = value;
+        AtomicWriteRelease(&m_tail, tail + 1);
+
+        pushed = true;
+
+        if (m_blocking)
+        {
+            m_notEmpty.Notify(false);
+        }
+    }
+
+    return pushed;
+}
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+bool SpscQueue<T, Allocator>::TryDequeue(
+    T* pValue)
+{
+    PAL_ASSERT(pValue != nullptr);
+
+    const uint32 head   = m_head;
+    bool         popped = false;
+
+    if (head == m_cachedTail)
+    {
+        // Our copy of the tail says the queue is empty; see how far the producer has really got.
+        m_cachedTail = AtomicReadAcquire(&m_tail);
+    }
+
+    if (head != m_cachedTail)
+    {
+        *pValue = Move(m_pSlots[head & m_mask]);
+        AtomicWriteRelease(&m_head, head + 1);
+
+        popped = true;
+
+        if (m_blocking)
+        {
+            m_notFull.Notify(false);
+        }
+    }
+
+    return popped;
+}
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+Result SpscQueue<T, Allocator>::Enqueue(
+    const T& value,
+    uint32   waitTimeMs)
+{
+    Result result = TryEnqueue(value) ? Result::Success : Result::NotReady;
+
+    if ((result == Result::NotReady) && (waitTimeMs != 0))
+    {
+        PAL_ASSERT(m_blocking);
+
+        // Give the other side a chance to catch up before paying for a sleep and a wake.
+        for (uint32 i = 0; (i < EventCount::SpinCount) && (result == Result::NotReady); i++)
+        {
+            YieldThread();
+            result = TryEnqueue(value) ? Result::Success : Result::NotReady;
+        }
+
+        const int64 deadline = EventCount::ComputeDeadline(waitTimeMs);
+
+        m_notFull.BeginWait();
+
+        while (result == Result::NotReady)
+        {
+            const uint32 key = m_notFull.PrepareWait();
+
+            if (TryEnqueue(value))
+            {
+                result = Result::Success;
+            }
+            else if (m_notFull.Wait(key, deadline) == Result::Timeout)
+            {
+                result = Result::Timeout;
+            }
+        }
+
+        m_notFull.EndWait();
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+template <typename T, typename Allocator>
+Result SpscQueue<T, Allocator>::Dequeue(
+    T*     pValue,
+    uint32 waitTimeMs)
+{
+    Result result = TryDequeue(pValue) ? Result::Success : Result::NotReady;
+
+    if ((result == Result::NotReady) && (waitTimeMs != 0))
+    {
+        PAL_ASSERT(m_blocking);
+
+        // Give the other side a chance to catch up before paying for a sleep and a wake.
+        for (uint32 i = 0; (i < EventCount::SpinCount) && (result == Result::NotReady); i++)
+        {
+            YieldThread();
+            result = TryDequeue(pValue) ? Result::Success : Result::NotReady;
+        }
+
+        const int64 deadline = EventCount::ComputeDeadline(waitTimeMs);
+
+        m_notEmpty.BeginWait();
+
+        while (result == Result::NotReady)
+        {
+            const uint32 key = m_notEmpty.PrepareWait();
+
+            if (TryDequeue(pValue))
+            {
+                result = Result::Success;
+            }
+            else if (m_notEmpty.Wait(key, deadline) == Result::Timeout)
+            {
+                result = Result::Timeout;
+            }
+        }
+
+        m_notEmpty.EndWait();
+    }
+
+    return result;
+}
+
+} // Util
@@ -0,0 +1,200 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palThreadCacheAllocator.h
+ * @brief PAL utility collection ThreadCacheAllocator class declaration.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palInlineFuncs.h"
+#include "palIntrusiveList.h"
+#include "palMutex.h"
+#include "palSysMemory.h"
+
+namespace Util
+{
+
+/// Allocation counters reported by ThreadCacheAllocator::GetStats().
+struct ThreadCacheStats
+{
+    uint64 numAllocs;            ///< Number of allocations requested from the ThreadCacheAllocator.
+    uint64 numFrees;             ///< Number of frees requested from the ThreadCacheAllocator.
+    uint64 numClientAllocs;      ///< Number of those allocations which were passed on to the underlying allocator.
+    uint64 numClientFrees;       ///< Number of frees which were passed on to the underlying allocator.
+    uint64 clientBytesAllocated; ///< Total bytes ever allocated from the underlying allocator.
+    uint64 cachedBytes;          ///< Bytes currently held in the thread caches.
+};
+
+/**
+ ***********************************************************************************************************************
+ * @brief Allocator which keeps a per-thread cache of small blocks in front of another allocator.
+ *
+ * Small allocations with at most the default alignment are rounded up to a power-of-two size class.  Freed blocks are
+ * kept on a free list for their SystemAllocType and size class in the freeing thread's cache, and later allocations of
+ * the same type and class on that thread reuse them without calling the underlying allocator.  Each thread holds on to
+ * at most MaxCachedBytes, and every TrimInterval frees it returns the blocks which it didn't need since the last trim.
+ * Any memory still cached is returned when its thread exits or when the ThreadCacheAllocator is destroyed.
+ *
+ * A thread serves at most one ThreadCacheAllocator of a given type; its allocations from any other go straight to the
+ * underlying allocator.  Every allocation carries a small header so that Free() can tell how it was allocated.
+ *
+ * The ThreadCacheAllocator must not be destroyed while other threads are allocating from it.
+ ***********************************************************************************************************************
+ */
+template <typename Allocator>
+class ThreadCacheAllocator
+{
+public:
+    /// Constructor.
+    ///
+    /// @param [in] pAllocator The allocator which provides the memory that is cached.
+    ThreadCacheAllocator(Allocator*const pAllocator);
+    ~ThreadCacheAllocator();
+
+    /// Allocates a block of memory, from the current thread's cache if possible.
+    ///
+    /// @param [in] allocInfo Contains information about the requested allocation.
+    ///
+    /// @returns Pointer to the allocated memory, nullptr if the allocation failed.
+    void* Alloc(
+        const AllocInfo& allocInfo);
+
+    /// Frees a block of memory, keeping it in the current thread's cache if possible.
+    ///
+    /// @param [in] freeInfo Contains information about the requested free.
+    void Free(
+        const FreeInfo& freeInfo);
+
+    /// Reports how many allocations and frees were requested and how many reached the underlying allocator.  Counters
+    /// of threads which are allocating concurrently may be slightly out of date.
+    ///
+    /// @param [out] pStats Receives the counters.
+    void GetStats(
+        ThreadCacheStats* pStats) const;
+
+private:
+    // Size classes are the powers of two from MinBlockBytes to MaxBlockBytes.
+    static constexpr size_t MinBlockBytes  = 16;
+    static constexpr size_t MaxBlockBytes  = 4096;
+    static constexpr uint32 NumSizeClasses = 9;
+    static constexpr uint32 UncachedClass  = NumSizeClasses;
+
+    // Number of SystemAllocType values, which start at AllocObject.
+    static constexpr uint32 NumAllocTypes  = 4;
+
+    // Most memory a thread caches at once.
+    static constexpr size_t MaxCachedBytes = 256 * 1024;
+
+    // Number of frees between trims of a thread cache.
+    static constexpr uint32 TrimInterval   = 4096;
+
+    // Placed immediately before every client allocation.
+    struct BlockHeader
+    {
+        void*  pOrigMem;    // Original address of the allocation returned from the underlying allocator.
+        uint32 sizeClass;   // Size class of a cached block, or UncachedClass.
+        uint32 typeIndex;   // SystemAllocType of a cached block, relative to AllocObject.
+    };
+
+    // Cached blocks are aligned to this, and so is the client memory which follows their header.
+    static constexpr size_t BlockAlignment = Max<size_t>(PAL_DEFAULT_MEM_ALIGN, sizeof(BlockHeader));
+
+    // A block on a thread cache's free list.  Overlays the client memory of the block.
+    struct CachedBlock
+    {
+        CachedBlock* pNext;
+    };
+
+    struct FreeList
+    {
+        CachedBlock* pHead;
+        uint32       count;
+        uint32       lowWater;    // Lowest count since the last trim.
+    };
+
+    struct ThreadCache;
+
+    typedef IntrusiveList<ThreadCache> ThreadCacheList;
+
+    // Per-thread state.  Only its thread touches it, except for when it is attached or detached under the global lock.
+    struct ThreadCache
+    {
+        ThreadCache()
+            :
+            pOwner(nullptr),
+            freeLists(),
+            cachedBytes(0),
+            freesUntilTrim(0),
+            exited(false),
+            stats(),
+            node(this)
+        { }
+        ~ThreadCache();
+
+        ThreadCacheAllocator* volatile pOwner;          // The allocator this thread caches blocks for, if any.
+        FreeList                       freeLists[NumAllocTypes][NumSizeClasses];
+        size_t                         cachedBytes;     // Total size of the blocks on the free lists.
+        uint32                         freesUntilTrim;
+        bool                           exited;          // The thread has exited, so the cache can't be attached.
+        ThreadCacheStats               stats;
+        typename ThreadCacheList::Node node;
+    };
+
+    ThreadCache* AttachThreadCache();
+    void DetachThreadCache(ThreadCache* pCache);
+    void ReleaseBlocks(ThreadCache* pCache, FreeList* pList, uint32 sizeClass, uint32 count);
+    void Trim(ThreadCache* pCache);
+
+    void* AllocBlock(const AllocInfo& allocInfo, uint32 typeIndex, uint32 sizeClass, ThreadCache* pCache);
+    void* AllocUncached(const AllocInfo& allocInfo, ThreadCache* pCache);
+    void  FreeBlock(void* pOrigMem, ThreadCache* pCache);
+
+    static uint32 SizeClass(size_t bytes);
+    static size_t SizeClassBytes(uint32 sizeClass) { return MinBlockBytes << sizeClass; }
+
+    // Serializes attaching and detaching thread caches to and from every ThreadCacheAllocator of this type.
+    static Mutex* GlobalMutex();
+
+    static thread_local ThreadCache s_threadCache;
+
+    Allocator*const  m_pAllocator;
+    ThreadCacheList  m_threadCaches;    // Thread caches attached to this allocator.  Protected by GlobalMutex().
+    ThreadCacheStats m_detachedStats;   // Counters of detached threads.  Protected by GlobalMutex().
+
+    // Counters of threads which aren't attached to this allocator; updated atomically.
+    volatile uint64  m_numUnattachedAllocs;
+    volatile uint64  m_numUnattachedFrees;
+    volatile uint64  m_numUnattachedClientAllocs;
+    volatile uint64  m_numUnattachedClientFrees;
+    volatile uint64  m_unattachedClientBytes;
+
+    PAL_DISALLOW_DEFAULT_CTOR(ThreadCacheAllocator);
+    PAL_DISALLOW_COPY_AND_ASSIGN(ThreadCacheAllocator);
+};
+
+} // Util
@@ -0,0 +1,485 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palThreadCacheAllocatorImpl.h
+ * @brief PAL utility collection ThreadCacheAllocator class implementation.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palIntrusiveListImpl.h"
+#include "palThreadCacheAllocator.h"
+
+#include <cstring>
+
+namespace Util
+{
+
+template <typename Allocator>
+thread_local typename ThreadCacheAllocator<Allocator>::ThreadCache ThreadCacheAllocator<Allocator>::s_threadCache;
+
+// =====================================================================================================================
+template <typename Allocator>
+ThreadCacheAllocator<Allocator>::ThreadCacheAllocator(
+    Allocator*const pAllocator)
+    :
+    m_pAllocator(pAllocator),
+    m_detachedStats(),
+    m_numUnattachedAllocs(0),
+    m_numUnattachedFrees(0),
+    m_numUnattachedClientAllocs(0),
+    m_numUnattachedClientFrees(0),
+    m_unattachedClientBytes(0)
+{
+    static_assert(NumAllocTypes == (AllocInternalShader - AllocObject + 1), "NumAllocTypes is out of date.");
+    static_assert((MinBlockBytes << (NumSizeClasses - 1)) == MaxBlockBytes, "NumSizeClasses is out of date.");
+}
+
+// =====================================================================================================================
+// Returns the memory cached by every thread to the underlying allocator.
+template <typename Allocator>
+ThreadCacheAllocator<Allocator>::~ThreadCacheAllocator()
+{
+    MutexAuto lock(GlobalMutex());
+
+    while (m_threadCaches.IsEmpty() == false)
+    {
+        DetachThreadCache(m_threadCaches.Begin().Get());
+    }
+}
+
+// =====================================================================================================================
+// Returns the memory cached by an exiting thread to the underlying allocator.
+template <typename Allocator>
+ThreadCacheAllocator<Allocator>::ThreadCache::~ThreadCache()
+{
+    exited = true;
+
+    // Only this thread attaches the cache, but another thread may be detaching it, so check again under the lock.
+    if (pOwner != nullptr)
+    {
+        MutexAuto lock(GlobalMutex());
+
+        if (pOwner != nullptr)
+        {
+            pOwner->DetachThreadCache(this);
+        }
+    }
+}
+
+// =====================================================================================================================
+template <typename Allocator>
+Mutex* ThreadCacheAllocator<Allocator>::GlobalMutex()
+{
+    static Mutex mutex;
+    return &mutex;
+}
+
+// =====================================================================================================================
+// Attaches the current thread's cache to this allocator if it isn't caching blocks for another allocator.  Returns
+// null if it can't be attached.
+template <typename Allocator>
+typename ThreadCacheAllocator<Allocator>::ThreadCache* ThreadCacheAllocator<Allocator>::AttachThreadCache()
+{
+    ThreadCache*const pCache = &s_threadCache;
+    ThreadCache*      pResult = nullptr;
+
+    // This thread's cache can only become attached on this thread, so it is safe to skip the lock if it is attached.
+    if ((pCache->pOwner == nullptr) && (pCache->exited == false))
+    {
+        MutexAuto lock(GlobalMutex());
+
+        if (pCache->pOwner == nullptr)
+        {
+            pCache->pOwner         = this;
+            pCache->freesUntilTrim = TrimInterval;
+            m_threadCaches.PushBack(&pCache->node);
+
+            pResult = pCache;
+        }
+    }
+
+    return pResult;
+}
+
+// =====================================================================================================================
+// Returns every block in a thread cache to the underlying allocator and detaches the cache from this allocator.  The
+// caller must hold GlobalMutex().
+template <typename Allocator>
+void ThreadCacheAllocator<Allocator>::DetachThreadCache(
+    ThreadCache* pCache)
+{
+    PAL_ASSERT(pCache->pOwner == this);
+
+    for (uint32 typeIndex = 0; typeIndex < NumAllocTypes; ++typeIndex)
+    {
+        for (uint32 sizeClass = 0; sizeClass < NumSizeClasses; ++sizeClass)
+        {
+            FreeList*const pList = &pCache->freeLists[typeIndex][sizeClass];
+
+            ReleaseBlocks(pCache, pList, sizeClass, pList->count);
+            pList->lowWater = 0;
+        }
+    }
+
+    m_detachedStats.numAllocs            += pCache->stats.numAllocs;
+    m_detachedStats.numFrees             += pCache->stats.numFrees;
+    m_detachedStats.numClientAllocs      += pCache->stats.numClientAllocs;
+    m_detachedStats.numClientFrees       += pCache->stats.numClientFrees;
+    m_detachedStats.clientBytesAllocated += pCache->stats.clientBytesAllocated;
+    memset(&pCache->stats, 0, sizeof(pCache->stats));
+
+    m_threadCaches.Erase(&pCache->node);
+    pCache->pOwner = nullptr;
+}
+
+// =====================================================================================================================
+// Returns the given number of blocks from the front of a free list to the underlying allocator.
+template <typename Allocator>
+void ThreadCacheAllocator<Allocator>::ReleaseBlocks(
+    ThreadCache* pCache,
+    FreeList*    pList,
+    uint32       sizeClass,
+    uint32       count)
+{
+    PAL_ASSERT(count <= pList->count);
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        CachedBlock*const pBlock = pList->pHead;
+        pList->pHead = pBlock->pNext;
+
+        FreeBlock(static_cast<BlockHeader*>(VoidPtrDec(pBlock, sizeof(BlockHeader)))->pOrigMem, pCache);
+    }
+
+    pList->count        -= count;
+    pList->lowWater      = Min(pList->lowWater, pList->count);
+    pCache->cachedBytes -= count * SizeClassBytes(sizeClass);
+}
+
+// =====================================================================================================================
+// Returns half of the blocks that each free list of a thread cache didn't need since the last trim.
+template <typename Allocator>
+void ThreadCacheAllocator<Allocator>::Trim(
+    ThreadCache* pCache)
+{
+    for (uint32 typeIndex = 0; typeIndex < NumAllocTypes; ++typeIndex)
+    {
+        for (uint32 sizeClass = 0; sizeClass < NumSizeClasses; ++sizeClass)
+        {
+            FreeList*const pList = &pCache->freeLists[typeIndex][sizeClass];
+
+            if (pList->lowWater > 0)
+            {
+                ReleaseBlocks(pCache, pList, sizeClass, (pList->lowWater + 1) / 2);
+            }
+
+            pList->lowWater = pList->count;
+        }
+    }
+
+    pCache->freesUntilTrim = TrimInterval;
+}
+
+// =====================================================================================================================
+// Returns the size class which fits an allocation of the given size, which must be no larger than MaxBlockBytes.
+template <typename Allocator>
+uint32 ThreadCacheAllocator<Allocator>::SizeClass(
+    size_t bytes)
+{
+    return (bytes <= MinBlockBytes) ? 0 : (Log2(static_cast<uint32>(bytes - 1)) + 1 - Log2(MinBlockBytes));
+}
+
+// =====================================================================================================================
+// Allocates a new block of the given size class from the underlying allocator.
+template <typename Allocator>
+void* ThreadCacheAllocator<Allocator>::AllocBlock(
+    const AllocInfo& allocInfo,
+    uint32           typeIndex,
+    uint32           sizeClass,
+    ThreadCache*     pCache)       // The current thread's cache if it is attached to this allocator, otherwise null.
+{
+    const size_t paddedSizeBytes = BlockAlignment + SizeClassBytes(sizeClass);
+
+#if PAL_MEMTRACK
+    const AllocInfo blockInfo(paddedSizeBytes, BlockAlignment, allocInfo.zeroMem, allocInfo.allocType,
+                              allocInfo.blockType, allocInfo.pFilename, allocInfo.lineNumber);
+#else
+    const AllocInfo blockInfo(paddedSizeBytes, BlockAlignment, allocInfo.zeroMem, allocInfo.allocType);
+#endif
+
+    void* pMem = m_pAllocator->Alloc(blockInfo);
+
+    if (pMem != nullptr)
+    {
+        void*const        pClientMem = VoidPtrInc(pMem, BlockAlignment);
+        BlockHeader*const pHeader    = static_cast<BlockHeader*>(VoidPtrDec(pClientMem, sizeof(BlockHeader)));
+
+        pHeader->pOrigMem  = pMem;
+        pHeader->sizeClass = sizeClass;
+        pHeader->typeIndex = typeIndex;
+
+        pMem = pClientMem;
+
+        if (pCache != nullptr)
+        {
+            pCache->stats.numClientAllocs++;
+            pCache->stats.clientBytesAllocated += paddedSizeBytes;
+        }
+        else
+        {
+            AtomicIncrement64(&m_numUnattachedClientAllocs);
+            AtomicAdd64(&m_unattachedClientBytes, paddedSizeBytes);
+        }
+    }
+
+    return pMem;
+}
+
+// =====================================================================================================================
+// Allocates memory which is too large or too aligned to be cached directly from the underlying allocator.
+template <typename Allocator>
+void* ThreadCacheAllocator<Allocator>::AllocUncached(
+    const AllocInfo& allocInfo,
+    ThreadCache*     pCache)       // The current thread's cache if it is attached to this allocator, otherwise null.
+{
+    const size_t paddedAlignBytes = Max(allocInfo.alignment, BlockAlignment);
+    const size_t paddedSizeBytes  = paddedAlignBytes + allocInfo.bytes;
+
+#if PAL_MEMTRACK
+    const AllocInfo uncachedInfo(paddedSizeBytes, paddedAlignBytes, allocInfo.zeroMem, allocInfo.allocType,
+                                 allocInfo.blockType, allocInfo.pFilename, allocInfo.lineNumber);
+#else
+    const AllocInfo uncachedInfo(paddedSizeBytes, paddedAlignBytes, allocInfo.zeroMem, allocInfo.allocType);
+#endif
+
+    void* pMem = m_pAllocator->Alloc(uncachedInfo);
+
+    if (pMem != nullptr)
+    {
+        void*const        pClientMem = VoidPtrInc(pMem, paddedAlignBytes);
+        BlockHeader*const pHeader    = static_cast<BlockHeader*>(VoidPtrDec(pClientMem, sizeof(BlockHeader)));
+
+        pHeader->pOrigMem  = pMem;
+        pHeader->sizeClass = UncachedClass;
+        pHeader->typeIndex = 0;
+
+        pMem = pClientMem;
+
+        if (pCache != nullptr)
+        {
+            pCache->stats.numClientAllocs++;
+            pCache->stats.clientBytesAllocated += paddedSizeBytes;
+        }
+        else
+        {
+            AtomicIncrement64(&m_numUnattachedClientAllocs);
+            AtomicAdd64(&m_unattachedClientBytes, paddedSizeBytes);
+        }
+    }
+
+    return pMem;
+}
+
+// =====================================================================================================================
+// Returns an allocation to the underlying allocator.
+template <typename Allocator>
+void ThreadCacheAllocator<Allocator>::FreeBlock(
+    void*        pOrigMem,
+    ThreadCache* pCache)       // The current thread's cache if it is attached to this allocator, otherwise null.
+{
+#if PAL_MEMTRACK
+    m_pAllocator->Free(FreeInfo(pOrigMem, MemBlkType::Malloc));
+#else
+    m_pAllocator->Free(FreeInfo(pOrigMem));
+#endif
+
+    if (pCache != nullptr)
+    {
+        pCache->stats.numClientFrees++;
+    }
+    else
+    {
+        AtomicIncrement64(&m_numUnattachedClientFrees);
+    }
+}
+
+// =====================================================================================================================
+// Allocates a block of memory.  Small allocations come from the current thread's cache when it has a block of the
+// right type and size class.
+template <typename Allocator>
+void* ThreadCacheAllocator<Allocator>::Alloc(
+    const AllocInfo& allocInfo)
+{
+    // Allocating zero bytes of memory results in undefined behavior.
+    PAL_ASSERT(allocInfo.bytes > 0);
+
+    ThreadCache* pCache = &s_threadCache;
+
+    if (pCache->pOwner != this)
+    {
+        pCache = AttachThreadCache();
+    }
+
+    if (pCache != nullptr)
+    {
+        pCache->stats.numAllocs++;
+    }
+    else
+    {
+        AtomicIncrement64(&m_numUnattachedAllocs);
+    }
+
+    // Client-defined allocation types aren't cached.
+    const uint32 typeIndex = static_cast<uint32>(allocInfo.allocType) - static_cast<uint32>(AllocObject);
+
+    void* pMem = nullptr;
+
+    if ((allocInfo.bytes <= MaxBlockBytes) && (allocInfo.alignment <= BlockAlignment) && (typeIndex < NumAllocTypes))
+    {
+        const uint32 sizeClass = SizeClass(allocInfo.bytes);
+
+        if (pCache != nullptr)
+        {
+            FreeList*const pList = &pCache->freeLists[typeIndex][sizeClass];
+
+            if (pList->pHead != nullptr)
+            {
+                CachedBlock*const pBlock = pList->pHead;
+
+                pList->pHead = pBlock->pNext;
+                pList->count--;
+                pList->lowWater      = Min(pList->lowWater, pList->count);
+                pCache->cachedBytes -= SizeClassBytes(sizeClass);
+
+                if (allocInfo.zeroMem)
+                {
+                    memset(pBlock, 0, allocInfo.bytes);
+                }
+
+                pMem = pBlock;
+            }
+        }
+
+        if (pMem == nullptr)
+        {
+            pMem = AllocBlock(allocInfo, typeIndex, sizeClass, pCache);
+        }
+    }
+    else
+    {
+        pMem = AllocUncached(allocInfo, pCache);
+    }
+
+    return pMem;
+}
+
+// =====================================================================================================================
+// Frees a block of memory.  Small blocks are kept in the current thread's cache unless it is full.
+template <typename Allocator>
+void ThreadCacheAllocator<Allocator>::Free(
+    const FreeInfo& freeInfo)
+{
+    if (freeInfo.pClientMem != nullptr)
+    {
+        ThreadCache* pCache = &s_threadCache;
+
+        if (pCache->pOwner != this)
+        {
+            pCache = AttachThreadCache();
+        }
+
+        if (pCache != nullptr)
+        {
+            pCache->stats.numFrees++;
+        }
+        else
+        {
+            AtomicIncrement64(&m_numUnattachedFrees);
+        }
+
+        const BlockHeader*const pHeader   = static_cast<const BlockHeader*>(VoidPtrDec(freeInfo.pClientMem,
+                                                                                       sizeof(BlockHeader)));
+        const uint32            sizeClass = pHeader->sizeClass;
+
+        if ((sizeClass != UncachedClass) &&
+            (pCache != nullptr)          &&
+            ((pCache->cachedBytes + SizeClassBytes(sizeClass)) <= MaxCachedBytes))
+        {
+            PAL_ASSERT((sizeClass < NumSizeClasses) && (pHeader->typeIndex < NumAllocTypes));
+
+            FreeList*const    pList  = &pCache->freeLists[pHeader->typeIndex][sizeClass];
+            CachedBlock*const pBlock = static_cast<CachedBlock*>(freeInfo.pClientMem);
+
+            pBlock->pNext = pList->pHead;
+            pList->pHead  = pBlock;
+            pList->count++;
+            pCache->cachedBytes += SizeClassBytes(sizeClass);
+
+            if (--pCache->freesUntilTrim == 0)
+            {
+                Trim(pCache);
+            }
+        }
+        else
+        {
+            PAL_ASSERT(sizeClass <= UncachedClass);
+
+            FreeBlock(pHeader->pOrigMem, pCache);
+        }
+    }
+}
+
+// =====================================================================================================================
+template <typename Allocator>
+void ThreadCacheAllocator<Allocator>::GetStats(
+    ThreadCacheStats* pStats) const
+{
+    MutexAuto lock(GlobalMutex());
+
+    *pStats = m_detachedStats;
+
+    pStats->numAllocs            += m_numUnattachedAllocs;
+    pStats->numFrees             += m_numUnattachedFrees;
+    pStats->numClientAllocs      += m_numUnattachedClientAllocs;
+    pStats->numClientFrees       += m_numUnattachedClientFrees;
+    pStats->clientBytesAllocated += m_unattachedClientBytes;
+
+    for (auto iter = m_threadCaches.Begin(); iter.IsValid(); iter.Next())
+    {
+        const ThreadCache*const pCache = iter.Get();
+
+        pStats->numAllocs            += pCache->stats.numAllocs;
+        pStats->numFrees             += pCache->stats.numFrees;
+        pStats->numClientAllocs      += pCache->stats.numClientAllocs;
+        pStats->numClientFrees       += pCache->stats.numClientFrees;
+        pStats->clientBytesAllocated += pCache->stats.clientBytesAllocated;
+        pStats->cachedBytes          += pCache->cachedBytes;
+    }
+}
+
+} // Util
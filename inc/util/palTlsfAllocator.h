@@ -0,0 +1,172 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palTlsfAllocator.h
+ * @brief PAL utility TlsfAllocator class declaration.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "pal.h"
+#include "palHashMap.h"
+#include "palHwHash.h"
+#include "palVector.h"
+
+namespace Util
+{
+
+/**
+ ***********************************************************************************************************************
+ * @brief  Two-level segregated fit allocator.
+ *
+ * Suballocates a large base allocation with the same interface as BestFitAllocator, usually in constant time.  Free
+ * blocks are binned by size: the first level picks the power of two below the block size and the second level splits
+ * that range into linear steps.  One bitmask over the first level and one per first-level entry over the second let
+ * Allocate() find a non-empty bin holding blocks big enough for the request with two bit scans.  Freed blocks are
+ * merged with free neighbours immediately.  If those searches miss, because the only blocks which fit are too close to
+ * the request's size for the rounding to find them, Allocate() walks the candidate bins instead, so it only fails when
+ * no free block can hold the request.
+ *
+ * The managed range is usually GPU virtual address space, so block headers can't be stored inside it.  They are kept in
+ * separately allocated nodes instead, and allocated blocks are found by offset through a hash map.
+ *
+ * @warning The TLSF allocator is not thread-safe so thread-safety has to be handled on the caller side.
+ ***********************************************************************************************************************
+ */
+template<typename Allocator>
+class TlsfAllocator
+{
+public:
+    /// Constructor.
+    ///
+    /// @param [in]  pAllocator     The allocator that will allocate memory if required.
+    /// @param [in]  baseAllocSize  The size of the base allocation this allocator suballocates.
+    ///                             Must be a power of two.
+    /// @param [in]  minAllocSize   The size of the smallest block this allocator can allocate.
+    ///                             Must be a power of two.
+    TlsfAllocator(
+        Allocator*   pAllocator,
+        Pal::gpusize baseAllocSize,
+        Pal::gpusize minAllocSize);
+    ~TlsfAllocator();
+
+    /// Initializes the allocator.
+    ///
+    /// @returns Success if the allocator has been successfully initialized.
+    Result Init();
+
+    /// Suballocates a block from the base allocation that this allocator manages.
+    ///
+    /// @param [in]  size           The size of the requested suballocation.
+    /// @param [in]  alignment      The alignment requirements of the requested suballocation.
+    /// @param [out] pOffset        The offset the suballocated block starts within the base allocation.
+    ///
+    /// @returns Success if the allocation succeeded, @ref ErrorOutOfMemory if there isn't enough system memory to
+    ///          fulfill the request, or @ref ErrorOutOfGpuMemory if there isn't a large enough block free in the
+    ///          base allocation to fulfill the request.
+    Result Allocate(
+        Pal::gpusize  size,
+        Pal::gpusize  alignment,
+        Pal::gpusize* pOffset);
+
+    /// Frees a previously allocated suballocation.
+    ///
+    /// @param [in]  offset         The offset the suballocated block starts within the base allocation.
+    /// @param [in]  size           Optional parameter specifying the size of the original allocation.
+    /// @param [in]  alignment      Optional parameter specifying the alignment of the original allocation.
+    void Free(
+        Pal::gpusize offset,
+        Pal::gpusize size = 0,
+        Pal::gpusize alignment = 0);
+
+    /// Tells whether the base allocation is completely free. If the returned value is true then the caller is safe
+    /// to deallocate the base allocation.
+    bool IsEmpty() const { return (m_freeBytes == m_totalBytes); }
+
+    /// Returns the size of the largest allocation that can be suballocated with this allocator.
+    Pal::gpusize MaximumAllocationSize() const { return m_totalBytes; }
+
+private:
+    // Each first-level size range is split into this many second-level bins.
+    static constexpr uint32 SecondLevelBits  = 4;
+    static constexpr uint32 SecondLevelCount = (1u << SecondLevelBits);
+    static constexpr uint32 FirstLevelCount  = 64;
+
+    // Block nodes are allocated this many at a time.
+    static constexpr uint32 NodesPerChunk = 64;
+
+    // Number of buckets in the allocated block map.
+    static constexpr uint32 NumBusyBlockBuckets = 1024;
+
+    struct Block
+    {
+        Pal::gpusize offset;    // Offset in bytes from the base allocation address where this block begins
+        Pal::gpusize size;      // Size in bytes of the block
+        Block*       pPrevPhys; // Block immediately before this one in the base allocation, or null
+        Block*       pNextPhys; // Block immediately after this one in the base allocation, or null
+        Block*       pPrevFree; // Previous block in this block's bin, or null. Only valid for free blocks.
+        Block*       pNextFree; // Next block in this block's bin, or in the spare node list, or null.
+        bool         isFree;    // Indicates the in-use status of the block
+    };
+
+    void MapSize(Pal::gpusize size, uint32* pFirstLevel, uint32* pSecondLevel) const;
+    Block* FindFreeBlock(Pal::gpusize size) const;
+    Block* FindFittingFreeBlock(Pal::gpusize size, Pal::gpusize alignment) const;
+    static bool BlockFits(const Block* pBlock, Pal::gpusize size, Pal::gpusize alignment);
+    void InsertFreeBlock(Block* pBlock);
+    void RemoveFreeBlock(Block* pBlock);
+    Block* SplitBlock(Block* pBlock, Pal::gpusize size);
+    void MergeBlocks(Block* pFront, Block* pBack);
+
+    Result ReserveNodes(uint32 count);
+    Block* AcquireNode();
+    void ReleaseNode(Block* pBlock);
+
+    // Offset zero is a valid block, but a key of zero is not valid in a HashMap.
+    Pal::gpusize BlockKey(Pal::gpusize offset) const { return (offset >> m_minBlockShift) + 1; }
+
+    Allocator* const   m_pAllocator;
+    Pal::gpusize const m_totalBytes;
+    Pal::gpusize const m_minBlockSize;
+    uint32 const       m_minBlockShift;
+    Pal::gpusize       m_freeBytes;
+
+    uint64             m_firstLevelMask;                                    // Non-empty first-level ranges
+    uint32             m_secondLevelMasks[FirstLevelCount];                 // Non-empty bins in each range
+    Block*             m_pFreeLists[FirstLevelCount][SecondLevelCount];     // Free blocks in each bin
+
+    HashMap<Pal::gpusize, Block*, Allocator, Crc32cHashFunc> m_busyBlocks;  // Allocated blocks, by BlockKey()
+
+    Vector<Block*, 8, Allocator> m_nodeChunks;  // Every chunk of nodes, so they can be freed
+    Block*                       m_pSpareNodes; // Unused nodes, linked through pNextFree
+    uint32                       m_numSpareNodes;
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(TlsfAllocator);
+    PAL_DISALLOW_DEFAULT_CTOR(TlsfAllocator);
+};
+
+} // Util
@@ -0,0 +1,543 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palTlsfAllocatorImpl.h
+ * @brief PAL utility TlsfAllocator class implementation.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palTlsfAllocator.h"
+#include "palHashMapImpl.h"
+#include "palInlineFuncs.h"
+#include "palVectorImpl.h"
+
+namespace Util
+{
+
+// =====================================================================================================================
+template<typename Allocator>
+TlsfAllocator<Allocator>::TlsfAllocator(
+    Allocator*   pAllocator,
+    Pal::gpusize baseAllocSize,
+    Pal::gpusize minAllocSize)
+    :
+    m_pAllocator(pAllocator),
+    m_totalBytes(baseAllocSize),
+    m_minBlockSize(minAllocSize),
+    m_minBlockShift(Log2(minAllocSize)),
+    m_freeBytes(baseAllocSize),
+    m_firstLevelMask(0),
+    m_secondLevelMasks(),
+    m_pFreeLists(),
+    m_busyBlocks(NumBusyBlockBuckets, pAllocator),
+    m_nodeChunks(pAllocator),
+    m_pSpareNodes(nullptr),
+    m_numSpareNodes(0)
+{
+    // Allocator must be non-null
+    PAL_ASSERT(m_pAllocator != nullptr);
+
+    // baseAllocSize and minAllocSize must be POT
+    PAL_ASSERT(IsPowerOfTwo(baseAllocSize) && IsPowerOfTwo(minAllocSize));
+
+    // baseAllocSize must be aligned to minAllocsize
+    PAL_ASSERT((baseAllocSize % minAllocSize) == 0);
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+TlsfAllocator<Allocator>::~TlsfAllocator()
+{
+    // If the whole range isn't free then the user didn't free all of the memory
+    PAL_ALERT(IsEmpty() == false);
+
+    for (uint32 i = 0; i < m_nodeChunks.NumElements(); ++i)
+    {
+        PAL_FREE(m_nodeChunks[i], m_pAllocator);
+    }
+}
+
+// =====================================================================================================================
+// Initializes the allocator.
+template<typename Allocator>
+Result TlsfAllocator<Allocator>::Init()
+{
+    Result result = m_busyBlocks.Init();
+
+    if (result == Result::Success)
+    {
+        result = ReserveNodes(1);
+    }
+
+    if (result == Result::Success)
+    {
+        // The whole base allocation starts out as one free block.
+        Block*const pBlock = AcquireNode();
+
+        pBlock->offset    = 0;
+        pBlock->size      = m_totalBytes;
+        pBlock->pPrevPhys = nullptr;
+        pBlock->pNextPhys = nullptr;
+
+        InsertFreeBlock(pBlock);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Computes the bin holding free blocks of the given size: the first level is the power of two at or below the size,
+// and the second level is the next SecondLevelBits bits of the size. Sizes smaller than SecondLevelCount minimum
+// blocks all land in first-level range zero, one bin per size.
+template<typename Allocator>
+void TlsfAllocator<Allocator>::MapSize(
+    Pal::gpusize size,
+    uint32*      pFirstLevel,
+    uint32*      pSecondLevel
+    ) const
+{
+    const Pal::gpusize units = (size >> m_minBlockShift);
+
+    if (units < SecondLevelCount)
+    {
+        *pFirstLevel  = 0;
+        *pSecondLevel = static_cast<uint32>(units);
+    }
+    else
+    {
+        const uint32 log2Units = Log2(units);
+
+        *pFirstLevel  = log2Units - SecondLevelBits + 1;
+        *pSecondLevel = static_cast<uint32>(units >> (log2Units - SecondLevelBits)) - SecondLevelCount;
+    }
+}
+
+// =====================================================================================================================
+// Returns a free block of at least the given size, or null if none was found. Rounding the size up to the next bin
+// boundary means that every block in the bins searched is big enough, so the first one found can be used.
+template<typename Allocator>
+typename TlsfAllocator<Allocator>::Block* TlsfAllocator<Allocator>::FindFreeBlock(
+    Pal::gpusize size
+    ) const
+{
+    Block* pBlock = nullptr;
+
+    const Pal::gpusize units = (size >> m_minBlockShift);
+
+    if (units >= SecondLevelCount)
+    {
+        size += (1ull << (Log2(units) - SecondLevelBits + m_minBlockShift)) - 1;
+    }
+
+    // No block is bigger than the whole base allocation, and the bin holding a block of exactly that size holds
+    // nothing else, so a size rounded past it can search that bin instead.
+    size = Min(size, m_totalBytes);
+
+    uint32 firstLevel  = 0;
+    uint32 secondLevel = 0;
+    MapSize(size, &firstLevel, &secondLevel);
+
+    // Look for a non-empty bin in this first-level range, and then for the next non-empty range above it.
+    uint32 secondLevelMask = m_secondLevelMasks[firstLevel] & (~0u << secondLevel);
+
+    if (secondLevelMask == 0)
+    {
+        const uint64 firstLevelMask = ((firstLevel + 1) < FirstLevelCount)
+                                      ? (m_firstLevelMask & (~0ull << (firstLevel + 1)))
+                                      : 0;
+
+        if (BitMaskScanForward(&firstLevel, firstLevelMask))
+        {
+            secondLevelMask = m_secondLevelMasks[firstLevel];
+        }
+    }
+
+    if (BitMaskScanForward(&secondLevel, secondLevelMask))
+    {
+        pBlock = m_pFreeLists[firstLevel][secondLevel];
+    }
+
+    return pBlock;
+}
+
+// =====================================================================================================================
+// Searches every free block which might be big enough for an allocation of the given size and alignment, starting in
+// the bin a block of that size would be placed in, and returns the first one that can hold it. This is only used once
+// FindFreeBlock() has failed, which either skipped bins holding blocks that fit at their own offset or rounded the size
+// past the only block which fits, so it never fails while any free block can hold the allocation.
+template<typename Allocator>
+typename TlsfAllocator<Allocator>::Block* TlsfAllocator<Allocator>::FindFittingFreeBlock(
+    Pal::gpusize size,
+    Pal::gpusize alignment
+    ) const
+{
+    Block* pBlock = nullptr;
+
+    uint32 firstFirstLevel  = 0;
+    uint32 firstSecondLevel = 0;
+    MapSize(size, &firstFirstLevel, &firstSecondLevel);
+
+    uint64 firstLevelMask = m_firstLevelMask & (~0ull << firstFirstLevel);
+    uint32 firstLevel     = 0;
+
+    while ((pBlock == nullptr) && BitMaskScanForward(&firstLevel, firstLevelMask))
+    {
+        firstLevelMask &= ~(1ull << firstLevel);
+
+        uint32 secondLevelMask = m_secondLevelMasks[firstLevel];
+        uint32 secondLevel     = 0;
+
+        if (firstLevel == firstFirstLevel)
+        {
+            secondLevelMask &= (~0u << firstSecondLevel);
+        }
+
+        while ((pBlock == nullptr) && BitMaskScanForward(&secondLevel, secondLevelMask))
+        {
+            secondLevelMask &= ~(1u << secondLevel);
+
+            for (Block* pFree = m_pFreeLists[firstLevel][secondLevel]; pFree != nullptr; pFree = pFree->pNextFree)
+            {
+                if (BlockFits(pFree, size, alignment))
+                {
+                    pBlock = pFree;
+                    break;
+                }
+            }
+        }
+    }
+
+    return pBlock;
+}
+
+// =====================================================================================================================
+// Tells whether an allocation of the given size and alignment fits in a block once its start has been aligned.
+template<typename Allocator>
+bool TlsfAllocator<Allocator>::BlockFits(
+    const Block* pBlock,
+    Pal::gpusize size,
+    Pal::gpusize alignment)
+{
+    return (pBlock->size >= (size + Pow2Align(pBlock->offset, alignment) - pBlock->offset));
+}
+
+// =====================================================================================================================
+// Adds a block to the front of the list of free blocks in its bin.
+template<typename Allocator>
+void TlsfAllocator<Allocator>::InsertFreeBlock(
+    Block* pBlock)
+{
+    uint32 firstLevel  = 0;
+    uint32 secondLevel = 0;
+    MapSize(pBlock->size, &firstLevel, &secondLevel);
+
+    Block*const pHead = m_pFreeLists[firstLevel][secondLevel];
+
+    pBlock->isFree    = true;
+    pBlock->pPrevFree = nullptr;
+    pBlock->pNextFree = pHead;
+
+    if (pHead != nullptr)
+    {
+        pHead->pPrevFree = pBlock;
+    }
+
+    m_pFreeLists[firstLevel][secondLevel] = pBlock;
+    m_secondLevelMasks[firstLevel]       |= (1u << secondLevel);
+    m_firstLevelMask                     |= (1ull << firstLevel);
+}
+
+// =====================================================================================================================
+// Removes a block from the list of free blocks in its bin.
+template<typename Allocator>
+void TlsfAllocator<Allocator>::RemoveFreeBlock(
+    Block* pBlock)
+{
+    PAL_ASSERT(pBlock->isFree);
+
+    uint32 firstLevel  = 0;
+    uint32 secondLevel = 0;
+    MapSize(pBlock->size, &firstLevel, &secondLevel);
+
+    if (pBlock->pPrevFree != nullptr)
+    {
+        pBlock->pPrevFree->pNextFree = pBlock->pNextFree;
+    }
+    else
+    {
+        m_pFreeLists[firstLevel][secondLevel] = pBlock->pNextFree;
+
+        if (pBlock->pNextFree == nullptr)
+        {
+            // The bin is now empty, and so might be its whole first-level range.
+            m_secondLevelMasks[firstLevel] &= ~(1u << secondLevel);
+
+            if (m_secondLevelMasks[firstLevel] == 0)
+            {
+                m_firstLevelMask &= ~(1ull << firstLevel);
+            }
+        }
+    }
+
+    if (pBlock->pNextFree != nullptr)
+    {
+        pBlock->pNextFree->pPrevFree = pBlock->pPrevFree;
+    }
+
+    pBlock->isFree = false;
+}
+
+// =====================================================================================================================
+// Shrinks a block to the given size and returns a new block holding the remainder. The caller must have reserved a
+// node and is responsible for putting the remainder in a free list.
+template<typename Allocator>
+typename TlsfAllocator<Allocator>::Block* TlsfAllocator<Allocator>::SplitBlock(
+    Block*       pBlock,
+    Pal::gpusize size)
+{
+    PAL_ASSERT(pBlock->size > size);
+
+    Block*const pRemainder = AcquireNode();
+
+    pRemainder->offset    = pBlock->offset + size;
+    pRemainder->size      = pBlock->size - size;
+    pRemainder->pPrevPhys = pBlock;
+    pRemainder->pNextPhys = pBlock->pNextPhys;
+    pRemainder->isFree    = false;
+
+    if (pBlock->pNextPhys != nullptr)
+    {
+        pBlock->pNextPhys->pPrevPhys = pRemainder;
+    }
+
+    pBlock->size      = size;
+    pBlock->pNextPhys = pRemainder;
+
+    return pRemainder;
+}
+
+// =====================================================================================================================
+// Absorbs a block into the block immediately before it. Neither block may be in a free list.
+template<typename Allocator>
+void TlsfAllocator<Allocator>::MergeBlocks(
+    Block* pFront,
+    Block* pBack)
+{
+    PAL_ASSERT(pFront->pNextPhys == pBack);
+
+    pFront->size     += pBack->size;
+    pFront->pNextPhys = pBack->pNextPhys;
+
+    if (pBack->pNextPhys != nullptr)
+    {
+        pBack->pNextPhys->pPrevPhys = pFront;
+    }
+
+    ReleaseNode(pBack);
+}
+
+// =====================================================================================================================
+// Makes sure at least the given number of spare nodes are available, so that an operation can't fail half-way.
+template<typename Allocator>
+Result TlsfAllocator<Allocator>::ReserveNodes(
+    uint32 count)
+{
+    Result result = Result::Success;
+
+    if (m_numSpareNodes < count)
+    {
+        Block* pChunk = static_cast<Block*>(PAL_MALLOC(sizeof(Block) * NodesPerChunk,
+                                                       m_pAllocator,
+                                                       AllocInternal));
+
+        result = (pChunk != nullptr) ? m_nodeChunks.PushBack(pChunk) : Result::ErrorOutOfMemory;
+
+        if (result == Result::Success)
+        {
+            for (uint32 i = 0; i < NodesPerChunk; ++i)
+            {
+                ReleaseNode(&pChunk[i]);
+            }
+        }
+        else
+        {
+            PAL_SAFE_FREE(pChunk, m_pAllocator);
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+typename TlsfAllocator<Allocator>::Block* TlsfAllocator<Allocator>::AcquireNode()
+{
+    PAL_ASSERT(m_pSpareNodes != nullptr);
+
+    Block*const pBlock = m_pSpareNodes;
+
+    m_pSpareNodes = pBlock->pNextFree;
+    m_numSpareNodes--;
+
+    return pBlock;
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+void TlsfAllocator<Allocator>::ReleaseNode(
+    Block* pBlock)
+{
+    pBlock->pNextFree = m_pSpareNodes;
+
+    m_pSpareNodes = pBlock;
+    m_numSpareNodes++;
+}
+
+// =====================================================================================================================
+// Suballocates a block from the base allocation that this allocator manages. If no free space is found then an
+// appropriate error is returned.
+template<typename Allocator>
+Result TlsfAllocator<Allocator>::Allocate(
+    Pal::gpusize  size,
+    Pal::gpusize  alignment,
+    Pal::gpusize* pOffset)
+{
+    Result result = Result::ErrorOutOfGpuMemory;
+
+    size      = Max(Pow2Align(size, m_minBlockSize), m_minBlockSize);
+    alignment = Max(Pow2Align(alignment, m_minBlockSize), m_minBlockSize);
+
+    Block* pBlock = nullptr;
+
+    if (size <= MaximumAllocationSize())
+    {
+        // Try a block which only fits the size first, in case it happens to be aligned. Otherwise, a block which can
+        // fit the size at any alignment is needed.
+        pBlock = FindFreeBlock(size);
+
+        if ((pBlock != nullptr) && (BlockFits(pBlock, size, alignment) == false))
+        {
+            pBlock = FindFreeBlock(size + alignment - m_minBlockSize);
+        }
+
+        if ((pBlock == nullptr) || (BlockFits(pBlock, size, alignment) == false))
+        {
+            pBlock = FindFittingFreeBlock(size, alignment);
+        }
+    }
+
+    Pal::gpusize alignedOffset = 0;
+    Block**      ppMapEntry    = nullptr;
+
+    if (pBlock != nullptr)
+    {
+        alignedOffset = Pow2Align(pBlock->offset, alignment);
+
+        // Reserve everything which could fail up front: up to two new blocks and the map entry.
+        result = ReserveNodes(2);
+
+        if (result == Result::Success)
+        {
+            bool existed = false;
+            result = m_busyBlocks.FindAllocate(BlockKey(alignedOffset), &existed, &ppMapEntry);
+
+            PAL_ASSERT(existed == false);
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        RemoveFreeBlock(pBlock);
+
+        // Return any padding needed for alignment to the free lists.
+        if (alignedOffset != pBlock->offset)
+        {
+            Block*const pPadding = pBlock;
+
+            pBlock = SplitBlock(pPadding, alignedOffset - pPadding->offset);
+            InsertFreeBlock(pPadding);
+        }
+
+        // ... and the same for any space left over at the end.
+        if (pBlock->size != size)
+        {
+            InsertFreeBlock(SplitBlock(pBlock, size));
+        }
+
+        *ppMapEntry = pBlock;
+        m_freeBytes -= size;
+        *pOffset     = pBlock->offset;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Frees a suballocated block making it available for future re-use.
+template<typename Allocator>
+void TlsfAllocator<Allocator>::Free(
+    Pal::gpusize offset,
+    Pal::gpusize size,
+    Pal::gpusize alignment)
+{
+    PAL_ALERT(!((offset % m_minBlockSize) == 0));
+
+    Block*const* ppBlock = m_busyBlocks.FindKey(BlockKey(offset));
+
+    // The block was never allocated?
+    PAL_ASSERT(ppBlock != nullptr);
+
+    if (ppBlock != nullptr)
+    {
+        Block* pBlock = *ppBlock;
+
+        m_busyBlocks.Erase(BlockKey(offset));
+        m_freeBytes += pBlock->size;
+
+        // Merge with the next block and then the previous block, if they're free.
+        if ((pBlock->pNextPhys != nullptr) && pBlock->pNextPhys->isFree)
+        {
+            RemoveFreeBlock(pBlock->pNextPhys);
+            MergeBlocks(pBlock, pBlock->pNextPhys);
+        }
+
+        if ((pBlock->pPrevPhys != nullptr) && pBlock->pPrevPhys->isFree)
+        {
+            Block*const pPrev = pBlock->pPrevPhys;
+
+            RemoveFreeBlock(pPrev);
+            MergeBlocks(pPrev, pBlock);
+
+            pBlock = pPrev;
+        }
+
+        InsertFreeBlock(pBlock);
+    }
+}
+
+} // Util
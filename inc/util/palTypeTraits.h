@@ -67,6 +67,12 @@ struct Conjunction : std::is_same<std::tuple<std::true_type, B1, Bn...>, std::tu
 template<typename B1, typename... Bn>
 struct Disjunction : Negation<Conjunction<B1, Bn...>>{};
 
+/// Type trait which tells the containers that an object of type T can be moved to a new address with a plain memcpy,
+/// without calling its move constructor and then its destructor at the old address.  This is true of every trivially
+/// copyable type; specialize it to std::true_type for other types which don't point into themselves.
+template<typename T>
+struct IsTriviallyRelocatable : BoolConstant<std::is_trivially_copyable<T>::value>{};
+
 /// Type trait to determine if a given type is a scoped enum.
 /// Will be deprecated by C++23's std::is_scoped_enum.
 template<typename E, bool = std::is_enum<E>::value>
@@ -603,8 +603,11 @@ constexpr Result CollapseResults(Result lhs, Result rhs)
  * - HashMap: Fast map implementation.  Note that this implementation has some non-standard restrictions on the key
  *   (can't be 0) and value size (must fit in a cache line).
  * - HashSet: Fast set implementation.  Note the similar restrictions to HashMap.
+ * - IntervalSet: Sorted array of merged ranges for fast overlap checks when interval values aren't needed.
  * - IntervalTree: [Interval tree] implementation.
+ * - MpmcQueue: Bounded lock-free queue for any number of producer and consumer threads.
  * - RingBuffer: A ringed buffer of variable length and size.
+ * - SpscQueue: Bounded lock-free queue for one producer thread and one consumer thread.
  *
  * ### Multithreading and Synchronization
  * Util includes a number of OS-abstracted multithreading and CPU synchronization constructs:
@@ -614,6 +617,7 @@ constexpr Result CollapseResults(Result lhs, Result rhs)
  * - Semaphore
  * - ConditionVariable
  * - Event
+ * - EventCount
  *
  * ### Files
  * The File class provides an OS-abstracted interface for opening files and reading/writing data in those files.
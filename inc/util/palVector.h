@@ -34,6 +34,7 @@
 #include "palUtil.h"
 #include "palAssert.h"
 #include "palSysMemory.h"
+#include "palTypeTraits.h"
 #include <type_traits>
 
 namespace Util
@@ -174,7 +175,24 @@ public:
     /// @param [in] data The element to be pushed to the vector. The element will become the last element.
     ///
     /// @returns Result ErrorOutOfMemory if the operation failed.
-    Result PushBack(const T& data);
+    Result PushBack(const T& data) { return EmplaceBack(data); }
+
+    /// Move an element to end of the vector.  See the copying overload of PushBack.
+    ///
+    /// @param [in] data The element to be pushed to the vector. The element will become the last element.
+    ///
+    /// @returns Result ErrorOutOfMemory if the operation failed.
+    Result PushBack(T&& data) { return EmplaceBack(Move(data)); }
+
+    /// Constructs a new element in place at the end of the vector. If not enough space is available, the capacity is
+    /// doubled and the old elements are relocated to the new space.
+    ///
+    /// @param [in] args Arguments which are forwarded to the constructor of the new element.  They may refer to an
+    ///                  element of this vector.
+    ///
+    /// @returns Result ErrorOutOfMemory if the operation failed.
+    template<typename... Args>
+    Result EmplaceBack(Args&&... args);
 
     /// Returns the element at the end of the vector and destroys it.
     ///
@@ -305,6 +323,14 @@ public:
     ///@}
 
 private:
+    // Capacity of the first heap allocation of a vector which has no local buffer.
+    static constexpr uint32 MinHeapCapacity = 8;
+
+    template<typename... Args>
+    Result GrowAndEmplaceBack(Args&&... args);
+
+    void AdoptBuffer(T* pNewData, uint32 newCapacity);
+
     // This is a POD-type that exactly fits one T value.
     typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type ValueStorage;
 
@@ -350,7 +376,7 @@ template<typename T, uint32 defaultCapacity, typename Allocator>
 Vector<T, defaultCapacity, Allocator>::~Vector()
 {
     // Explicitly destroy all non-trivial types.
-    if (!std::is_pod<T>::value)
+    if (std::is_trivially_destructible<T>::value == false)
     {
         for (uint32 idx = 0; idx < m_numElements; ++idx)
         {
@@ -384,10 +410,12 @@ Vector<T, defaultCapacity, Allocator>::Vector(
         // Data buffer will be using storage from local buffer.
         m_pData = reinterpret_cast<T*>(m_data);
 
-        if (std::is_pod<T>::value)
+        if (IsTriviallyRelocatable<T>::value)
         {
-            // Optimize trivial types by copying local buffer.
-            std::memcpy(m_pData, vector.m_pData, sizeof(T) * m_numElements);
+            // Optimize trivially relocatable types by copying local buffer.  The dying vector forgets its copies, so
+            // they're never destroyed.
+            std::memcpy(static_cast<void*>(m_pData), vector.m_pData, sizeof(T) * m_numElements);
+            vector.m_numElements = 0;
         }
         else
         {
@@ -403,10 +431,11 @@ Vector<T, defaultCapacity, Allocator>::Vector(
         // Steal heap allocation from dying vector.
         m_pData = vector.m_pData;
 
-        // After the allocation has been stolen, dying vector is just an empty shell.
-        vector.m_pData = nullptr;
+        // After the allocation has been stolen, dying vector is just an empty shell, which falls back to its local
+        // buffer in case it's reused.
+        vector.m_pData = reinterpret_cast<T*>(vector.m_data);
         vector.m_numElements = 0;
-        vector.m_maxCapacity = 0;
+        vector.m_maxCapacity = defaultCapacity;
     }
 }
 
@@ -33,10 +33,46 @@
 
 #include "palVector.h"
 #include "palSysMemory.h"
+#include <utility>
 
 namespace Util
 {
 
+// =====================================================================================================================
+// Relocates the elements into a new buffer of the given capacity, frees the old buffer if it came from the heap and
+// takes ownership of the new one.
+template<typename T, uint32 defaultCapacity, typename Allocator>
+void Vector<T, defaultCapacity, Allocator>::AdoptBuffer(
+    T*     pNewData,
+    uint32 newCapacity)
+{
+    if (IsTriviallyRelocatable<T>::value)
+    {
+        // Optimize trivially relocatable types by copying the whole buffer.
+        std::memcpy(static_cast<void*>(pNewData), m_pData, sizeof(T) * m_numElements);
+    }
+    else
+    {
+        // Move objects from data buffer to heap alloation.
+        // Destory corpses of objects in data buffer after moving.
+        for (uint32 idx = 0; idx < m_numElements; ++idx)
+        {
+            PAL_PLACEMENT_NEW(pNewData + idx) T(Move(m_pData[idx]));
+            m_pData[idx].~T();
+        }
+    }
+
+    // Free data buffer if it uses storage from heap allocation.
+    if (m_pData != reinterpret_cast<T*>(m_data))
+    {
+        PAL_FREE(m_pData, m_pAllocator);
+    }
+
+    // Take ownership of the heap allocation.
+    m_pData       = pNewData;
+    m_maxCapacity = newCapacity;
+}
+
 // =====================================================================================================================
 // If new capacity exceeds maximum capacity, allocates on the heap new storage for data buffer,
 // moves objects from data buffer to heap allocation and takes ownership of that allocation.
@@ -60,33 +96,7 @@ Result Vector<T, defaultCapacity, Allocator>::Reserve(
         }
         else
         {
-            T* const pNewData = static_cast<T*>(pNewMemory);
-
-            if (std::is_pod<T>::value)
-            {
-                // Optimize trivial types by copying local buffer.
-                std::memcpy(pNewData, m_pData, sizeof(T) * m_numElements);
-            }
-            else
-            {
-                // Move objects from data buffer to heap alloation.
-                // Destory corpses of objects in data buffer after moving.
-                for (uint32 idx = 0; idx < m_numElements; ++idx)
-                {
-                    PAL_PLACEMENT_NEW(pNewData + idx) T(Move(m_pData[idx]));
-                    m_pData[idx].~T();
-                }
-            }
-
-            // Free data buffer if it uses storage from heap allocation.
-            if (m_pData != reinterpret_cast<T*>(m_data))
-            {
-                PAL_FREE(m_pData, m_pAllocator);
-            }
-
-            // Take ownership of the heap allocation.
-            m_pData       = pNewData;
-            m_maxCapacity = newCapacity;
+            AdoptBuffer(static_cast<T*>(pNewMemory), newCapacity);
         }
     }
 
@@ -106,7 +116,7 @@ Result Vector<T, defaultCapacity, Allocator>::Resize(
 
     if (m_numElements > newSize)
     {
-        if (std::is_pod<T>::value)
+        if (std::is_trivially_destructible<T>::value)
         {
             // Trivial value, so we don't need to destroy any objects.  Just shrink m_numElements.
             m_numElements = newSize;
@@ -142,27 +152,55 @@ Result Vector<T, defaultCapacity, Allocator>::Resize(
 }
 
 // =====================================================================================================================
-// Pushes the new element to the end of the vector. If the vector has reached maximum capacity, new space is allocated
-// on the heap and the data in the old space is copied over to the new space. The old space is freed if it was also
-// allocated on the heap.
+// Constructs the new element at the end of the vector. If the vector has reached maximum capacity, the slow path
+// allocates new space on the heap.
 template<typename T, uint32 defaultCapacity, typename Allocator>
-Result Vector<T, defaultCapacity, Allocator>::PushBack(
-    const T& data)
+template<typename... Args>
+Result Vector<T, defaultCapacity, Allocator>::EmplaceBack(
+    Args&&... args)
 {
     Result result = Result::_Success;
 
-    // Alloc more space if push back requested when current size is at max capacity.
-    if (m_numElements == m_maxCapacity)
+    if (m_numElements < m_maxCapacity)
+    {
+        // Insert new data into the array.
+        PAL_PLACEMENT_NEW(m_pData + m_numElements) T(std::forward<Args>(args)...);
+        ++(m_numElements);
+    }
+    else
     {
-        // Allocate an additional amount of memory that is double the old size.
-        result = Reserve(m_numElements * 2);
+        result = GrowAndEmplaceBack(std::forward<Args>(args)...);
     }
 
-    if (result == Result::_Success)
+    return result;
+}
+
+// =====================================================================================================================
+// Allocates a buffer of double the capacity, constructs the new element in it and then relocates the old elements to
+// it.  The new element has to be constructed first because the arguments may refer to one of the old elements.
+template<typename T, uint32 defaultCapacity, typename Allocator>
+template<typename... Args>
+Result Vector<T, defaultCapacity, Allocator>::GrowAndEmplaceBack(
+    Args&&... args)
+{
+    Result result = Result::ErrorOutOfMemory;
+
+    const uint32 newCapacity = Max(m_maxCapacity * 2, MinHeapCapacity);
+
+    if (newCapacity > m_maxCapacity)
     {
-        // Insert new data into the array.
-        PAL_PLACEMENT_NEW(m_pData + m_numElements) T(data);
-        ++(m_numElements);
+        void* const pNewMemory = PAL_MALLOC(sizeof(T) * newCapacity, m_pAllocator, AllocInternal);
+
+        if (pNewMemory != nullptr)
+        {
+            T* const pNewData = static_cast<T*>(pNewMemory);
+
+            PAL_PLACEMENT_NEW(pNewData + m_numElements) T(std::forward<Args>(args)...);
+            AdoptBuffer(pNewData, newCapacity);
+            ++(m_numElements);
+
+            result = Result::_Success;
+        }
     }
 
     return result;
@@ -178,11 +216,11 @@ void Vector<T, defaultCapacity, Allocator>::PopBack(
 
     if (pData != nullptr)
     {
-        *pData = *(m_pData + m_numElements);
+        *pData = Move(*(m_pData + m_numElements));
     }
 
     // Explicitly destroy the removed value if it's non-trivial.
-    if (!std::is_pod<T>::value)
+    if (std::is_trivially_destructible<T>::value == false)
     {
         m_pData[m_numElements].~T();
     }
@@ -193,7 +231,7 @@ template<typename T, uint32 defaultCapacity, typename Allocator>
 void Vector<T, defaultCapacity, Allocator>::Clear()
 {
     // Explicitly destroy all non-trivial types.
-    if (!std::is_pod<T>::value)
+    if (std::is_trivially_destructible<T>::value == false)
     {
         for (uint32 idx = 0; idx < m_numElements; ++idx)
         {
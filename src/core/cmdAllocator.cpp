@@ -469,9 +469,19 @@ Result CmdAllocator::Reset()
     {
         FreeAllLinearAllocators();
     }
-    else if (m_linearAllocBusyList.IsEmpty() == false)
+    else
     {
-        m_linearAllocFreeList.PushFrontList(&m_linearAllocBusyList);
+        if (m_linearAllocBusyList.IsEmpty() == false)
+        {
+            m_linearAllocFreeList.PushFrontList(&m_linearAllocBusyList);
+        }
+
+        // Give back pages that weren't needed since the last reset, but keep each allocator's high-water mark committed
+        // so that recording the same work again doesn't have to commit the same pages again.
+        for (auto iter = m_linearAllocFreeList.Begin(); iter.IsValid(); iter.Next())
+        {
+            iter.Get()->Trim();
+        }
     }
 
     if (m_pLinearAllocLock != nullptr)
@@ -767,8 +777,9 @@ VirtualLinearAllocator* CmdAllocator::GetNewLinearAllocator()
 
     if (m_linearAllocFreeList.IsEmpty() == false)
     {
-        // Just pop the first free allocator off of the list.
-        pAllocator = m_linearAllocFreeList.Back();
+        // Just pop the first free allocator off of the list.  Allocators are returned to the front, so this is the most
+        // recently used one and the one most likely to still have its pages committed and cached.
+        pAllocator = m_linearAllocFreeList.Front();
 
         // Move the allocator from the free list to the front of the busy list.
         auto*const pNode = pAllocator->GetNode();
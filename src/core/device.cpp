@@ -32,15 +32,18 @@
 #include "core/image.h"
 #include "core/masterQueueSemaphore.h"
 #include "core/openedQueueSemaphore.h"
+#include "core/pipelineUploadBatch.h"
 #include "core/platform.h"
 #include "core/queue.h"
 #include "core/settingsLoader.h"
 #include "core/hw/gfxip/gfxDevice.h"
+#include "core/hw/gfxip/pipeline.h"
 #include "core/hw/ossip/ossDevice.h"
 #include "core/addrMgr/addrMgr.h"
 #include "core/svmMgr.h"
 #include "palDequeImpl.h"
 #include "palFormatInfo.h"
+#include "palFlatHashMapImpl.h"
 #include "palHashMapImpl.h"
 #include "palIntrusiveListImpl.h"
 #include "palPipeline.h"
@@ -201,6 +204,7 @@ Device::Device(
     :
     m_pPlatform(pPlatform),
     m_memMgr(this),
+    m_shaderCodeStore(this),
     m_connectedPrivateScreens(0),
     m_emulatedPrivateScreens(0),
     m_emulatedTargetId(UINT_MAX),
@@ -224,6 +228,8 @@ Device::Device(
 #endif
     m_dmaUploadRingLock(),
     m_pDmaUploadRing(nullptr),
+    m_uploadBatchKey(),
+    m_uploadBatchKeyValid(false),
     m_referencedGpuMem(ReferencedMemoryMapElements, pPlatform),
     m_referencedGpuMemLock(),
     m_pAddrMgr(nullptr),
@@ -287,6 +293,13 @@ Device::~Device()
         m_pOssDevice = nullptr;
     }
 
+    if (m_uploadBatchKeyValid)
+    {
+        const Result result = Util::DeleteThreadLocalKey(m_uploadBatchKey);
+        PAL_ASSERT(result == Result::Success);
+        m_uploadBatchKeyValid = false;
+    }
+
     if (m_pAddrMgr != nullptr)
     {
         m_pAddrMgr->Destroy();
@@ -406,6 +419,7 @@ Result Device::Cleanup()
 
     // NOTE: Explicitly free all internal GPU memory. Any child object which needs to free GPU memory MUST be torn
     // down before this!
+    m_shaderCodeStore.Cleanup();
     m_memMgr.FreeAllocations();
 
 #if PAL_ENABLE_PRINTS_ASSERTS
@@ -437,6 +451,22 @@ Result Device::EarlyInit(
 {
     Result result = m_referencedGpuMem.Init();
 
+    if (result == Result::Success)
+    {
+        result = m_memMgr.Init();
+    }
+
+    if (result == Result::Success)
+    {
+        result = m_shaderCodeStore.Init();
+    }
+
+    if (result == Result::Success)
+    {
+        result = Util::CreateThreadLocalKey(&m_uploadBatchKey);
+        m_uploadBatchKeyValid = (result == Result::Success);
+    }
+
     if (result == Result::Success)
     {
         result = OsEarlyInit();
@@ -498,6 +528,10 @@ Result Device::SetupPublicSettingDefaults()
 #endif
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 691
     m_publicSettings.disableExecuteIndirectAceOffload = false;
+#endif
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    m_publicSettings.enableShaderCodeDeduplication = false;
+    m_publicSettings.enableTlsfSvmAllocator = false;
 #endif
     return ret;
 }
@@ -3936,6 +3970,187 @@ Result Device::CreateGraphicsPipeline(
             Result::ErrorUnavailable;
 }
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+// =====================================================================================================================
+// Default implementation for IDevice implementations which don't batch pipeline creation, including the layers: the
+// pipelines are simply created one at a time through the (possibly overridden) per-pipeline create functions.
+Result IDevice::CreatePipelinesBatch(
+    uint32                         pipelineCount,
+    const PipelineBatchCreateInfo* pCreateInfos,
+    uint32                         maxWorkerThreads)
+{
+    Result result = Result::Success;
+
+    for (uint32 i = 0; i < pipelineCount; i++)
+    {
+        const PipelineBatchCreateInfo& info = pCreateInfos[i];
+
+        *info.ppPipeline = nullptr;
+
+        const Result pipelineResult = (info.bindPoint == PipelineBindPoint::Compute)
+            ? CreateComputePipeline(*info.pComputeInfo, info.pPlacementAddr, info.ppPipeline)
+            : CreateGraphicsPipeline(*info.pGraphicsInfo, info.pPlacementAddr, info.ppPipeline);
+
+        if ((pipelineResult != Result::Success) && (result == Result::Success))
+        {
+            result = pipelineResult;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Shared state for all of the threads creating the pipelines of one CreatePipelinesBatch() call.
+struct Device::PipelineBatchContext
+{
+    Device*                        pDevice;
+    PipelineUploadBatch*           pBatch;
+    const PipelineBatchCreateInfo* pCreateInfos;
+    uint32                         pipelineCount;
+    volatile uint32                nextPipeline;  // Index of the next pipeline to be claimed by a thread.
+    Util::Mutex                    resultLock;
+    Result                         result;        // First error encountered by any thread.
+};
+
+// =====================================================================================================================
+// Creates many pipelines at once.  Pipelines are spread across the calling thread and up to maxWorkerThreads helper
+// threads.  Their GPU memory is packed into a few arenas and all of their DMA uploads are submitted together once every
+// pipeline has been created, so all of the pipelines share one upload fence.
+// NOTE: Part of the public IDevice interface.
+Result Device::CreatePipelinesBatch(
+    uint32                         pipelineCount,
+    const PipelineBatchCreateInfo* pCreateInfos,
+    uint32                         maxWorkerThreads)
+{
+    Result result = Result::Success;
+
+    if (m_pGfxDevice == nullptr)
+    {
+        result = Result::ErrorUnavailable;
+    }
+    else if ((pipelineCount > 0) && (pCreateInfos == nullptr))
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else if (pipelineCount > 0)
+    {
+        PipelineUploadBatch batch(this);
+
+        PipelineBatchContext context = { };
+        context.pDevice       = this;
+        context.pBatch        = &batch;
+        context.pCreateInfos  = pCreateInfos;
+        context.pipelineCount = pipelineCount;
+        context.nextPipeline  = 0;
+        context.result        = Result::Success;
+
+        // The calling thread creates pipelines too, so there's no point in more helpers than remaining pipelines.
+        const uint32 numThreads = Min(maxWorkerThreads, pipelineCount - 1);
+
+        Util::Thread* pThreads = nullptr;
+        if (numThreads > 0)
+        {
+            pThreads = PAL_NEW_ARRAY(Util::Thread, numThreads, m_pPlatform, AllocInternalTemp);
+        }
+
+        uint32 numStarted = 0;
+        if (pThreads != nullptr)
+        {
+            for (; numStarted < numThreads; numStarted++)
+            {
+                if (pThreads[numStarted].Begin(&CreatePipelinesBatchThread, &context) != Result::Success)
+                {
+                    // Just make do with the threads we have.
+                    break;
+                }
+            }
+        }
+
+        CreateBatchedPipelines(&context);
+
+        for (uint32 i = 0; i < numStarted; i++)
+        {
+            pThreads[i].Join();
+        }
+
+        PAL_SAFE_DELETE_ARRAY(pThreads, m_pPlatform);
+
+        UploadFenceToken uploadFence = 0;
+        result = batch.End(&uploadFence);
+
+        for (uint32 i = 0; i < pipelineCount; i++)
+        {
+            IPipeline** ppPipeline = pCreateInfos[i].ppPipeline;
+
+            if (*ppPipeline != nullptr)
+            {
+                if (result == Result::Success)
+                {
+                    static_cast<Pipeline*>(*ppPipeline)->SetUploadFenceToken(uploadFence);
+                }
+                else
+                {
+                    // The pipeline's code never made it to the GPU, so it can't be handed back to the client.
+                    (*ppPipeline)->Destroy();
+                    *ppPipeline = nullptr;
+                }
+            }
+        }
+
+        if (result == Result::Success)
+        {
+            result = context.result;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+void Device::CreatePipelinesBatchThread(
+    void* pContext)
+{
+    auto*const pBatchContext = static_cast<PipelineBatchContext*>(pContext);
+    pBatchContext->pDevice->CreateBatchedPipelines(pBatchContext);
+}
+
+// =====================================================================================================================
+// Creates pipelines from a batch until none are left.  Runs on the thread which called CreatePipelinesBatch() and on
+// each of its helper threads.
+void Device::CreateBatchedPipelines(
+    PipelineBatchContext* pContext)
+{
+    Result result = Util::SetThreadLocalValue(m_uploadBatchKey, pContext->pBatch);
+    PAL_ASSERT(result == Result::Success);
+
+    for (uint32 i = Util::AtomicIncrement(&pContext->nextPipeline) - 1;
+         i < pContext->pipelineCount;
+         i = Util::AtomicIncrement(&pContext->nextPipeline) - 1)
+    {
+        const PipelineBatchCreateInfo& info = pContext->pCreateInfos[i];
+
+        *info.ppPipeline = nullptr;
+
+        result = (info.bindPoint == PipelineBindPoint::Compute)
+            ? CreateComputePipeline(*info.pComputeInfo, info.pPlacementAddr, info.ppPipeline)
+            : CreateGraphicsPipeline(*info.pGraphicsInfo, info.pPlacementAddr, info.ppPipeline);
+
+        if (result != Result::Success)
+        {
+            Util::MutexAuto lock(&pContext->resultLock);
+
+            if (pContext->result == Result::Success)
+            {
+                pContext->result = result;
+            }
+        }
+    }
+
+    Util::SetThreadLocalValue(m_uploadBatchKey, nullptr);
+}
+#endif
+
 // =====================================================================================================================
 // Determine if hardware accelerated stereo rendering can be enabled for given graphic pipeline.
 bool Device::DetermineHwStereoRenderingSupported(
@@ -27,6 +27,7 @@
 
 #include "core/image.h"
 #include "core/internalMemMgr.h"
+#include "core/shaderCodeStore.h"
 #include "core/privateScreen.h"
 #include "core/hw/gfxip/gfxDevice.h"
 #include "core/hw/ossip/ossDevice.h"
@@ -36,7 +37,7 @@
 #include "palDevice.h"
 #include "palDeque.h"
 #include "palEvent.h"
-#include "palHashMap.h"
+#include "palFlatHashMap.h"
 #include "palInlineFuncs.h"
 #include "palIntrusiveList.h"
 #include "palMutex.h"
@@ -45,6 +46,7 @@
 #include "palSettingsFileMgr.h"
 #endif
 #include "palSysMemory.h"
+#include "palThread.h"
 #include "palTextWriter.h"
 #include "palShaderLibrary.h"
 
@@ -63,6 +65,7 @@ class  CmdBuffer;
 class  Fence;
 class  GpuMemory;
 class  OssDevice;
+class  PipelineUploadBatch;
 class  Platform;
 class  SettingsLoader;
 class  Queue;
@@ -1406,6 +1409,14 @@ public:
         void*                             pPlacementAddr,
         IPipeline**                       ppPipeline) override;
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    // NOTE: Part of the public IDevice interface.
+    virtual Result CreatePipelinesBatch(
+        uint32                         pipelineCount,
+        const PipelineBatchCreateInfo* pCreateInfos,
+        uint32                         maxWorkerThreads) override;
+#endif
+
     // NOTE: Part of the public IDevice interface.
     virtual size_t GetMsaaStateSize(
         const MsaaStateCreateInfo& createInfo,
@@ -1702,6 +1713,11 @@ public:
     SchedulerMode GetSchedulerMode() const { return m_hwsInfo.mode; }
 
     InternalMemMgr* MemMgr() { return &m_memMgr; }
+    ShaderCodeStore* GetShaderCodeStore() { return &m_shaderCodeStore; }
+
+    // Returns the upload batch which pipelines created on the calling thread should be placed in, if any.
+    PipelineUploadBatch* GetPipelineUploadBatch() const
+        { return static_cast<PipelineUploadBatch*>(Util::GetThreadLocalValue(m_uploadBatchKey)); }
 
     // Returns the internal tracked command allocator except for engines that do not support tracking.
     CmdAllocator* InternalCmdAllocator(EngineType engineType) const
@@ -2043,8 +2059,9 @@ protected:
     uint32 GetDeviceIndex() const
         { return m_deviceIndex; }
 
-    Platform*      m_pPlatform;
-    InternalMemMgr m_memMgr;
+    Platform*       m_pPlatform;
+    InternalMemMgr  m_memMgr;
+    ShaderCodeStore m_shaderCodeStore;  // Shared, deduplicated client shader code.
 
     // An array stores enumerated private screens info and only m_connectedPrivateScreens out of them are valid.
     PrivateScreenCreateInfo m_privateScreenInfo[MaxPrivateScreens];
@@ -2136,6 +2153,17 @@ protected:
     DmaUploadRing* m_pDmaUploadRing;
 
 private:
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    struct PipelineBatchContext;
+
+    static void CreatePipelinesBatchThread(void* pContext);
+    void CreateBatchedPipelines(PipelineBatchContext* pContext);
+#endif
+
+    // Thread-local key which associates the threads running CreatePipelinesBatch() with their PipelineUploadBatch.
+    Util::ThreadLocalKey m_uploadBatchKey;
+    bool                 m_uploadBatchKeyValid;
+
     Result HwlEarlyInit();
     void   InitPageFaultDebugSrd();
     Result InitDummyChunkMem();
@@ -2149,7 +2177,7 @@ private:
 
     uint64 GetTimeoutValueInNs(uint64  appTimeoutInNs) const;
 
-    typedef Util::HashMap<IGpuMemory*, uint32, Pal::Platform>  MemoryRefMap;
+    typedef Util::FlatHashMap<IGpuMemory*, uint32, Pal::Platform>  MemoryRefMap;
 
     MemoryRefMap  m_referencedGpuMem;
     Util::Mutex   m_referencedGpuMemLock;
@@ -415,6 +415,50 @@ void EventProvider::LogResourceCorrelationEvent(
     }
 }
 
+// =====================================================================================================================
+// Appends the bytes of an RMT token to the staging buffer of the event being logged.
+void EventProvider::AppendToken(
+    const RMT_TOKEN_DATA& token,
+    RmtTokenBuffer*       pTokens)
+{
+    if (pTokens->result == Result::Success)
+    {
+        const uint32 offset = pTokens->bytes.NumElements();
+
+        pTokens->result = pTokens->bytes.Resize(offset + static_cast<uint32>(token.Size()));
+
+        if (pTokens->result == Result::Success)
+        {
+            memcpy(pTokens->bytes.Data() + offset, token.Data(), token.Size());
+        }
+    }
+}
+
+// =====================================================================================================================
+// Writes the tokens of one event as a single RmtToken event payload so that no other thread's tokens can end up
+// between them.
+void EventProvider::WriteTokenData(
+    const RMT_TOKEN_DATA* pTimestampToken,
+    RmtTokenBuffer*       pTokens)
+{
+    RMT_TOKEN_DATA tokens = {};
+    tokens.pByteData   = pTokens->bytes.Data();
+    tokens.sizeInBytes = pTokens->bytes.NumElements();
+
+    WriteEventWithHeader(
+        static_cast<uint32>(PalEvent::RmtToken),
+        (pTimestampToken != nullptr) ? pTimestampToken->Data() : nullptr,
+        (pTimestampToken != nullptr) ? pTimestampToken->Size() : 0,
+        tokens.Data(),
+        tokens.Size());
+
+    if (pTimestampToken != nullptr)
+    {
+        m_eventService.WriteTokenData(*pTimestampToken);
+    }
+    m_eventService.WriteTokenData(tokens);
+}
+
 // =====================================================================================================================
 void EventProvider::LogEvent(
     PalEvent    eventId,
@@ -425,42 +469,11 @@ void EventProvider::LogEvent(
 
     if (ShouldLog(eventId))
     {
-        // The RMT format requires that certain tokens strictly follow each other (e.g. resource create + description),
-        // so we need to lock to ensure another event isn't inserted into the stream while writing dependent tokens.
-        DevDriver::Platform::LockGuard<DevDriver::Platform::Mutex> providerLock(m_providerLock);
-
-        // The first time we have something to log, we need to log the RmtVersion first
-        if (m_logRmtVersion)
-        {
-            if (ShouldLog(PalEvent::RmtVersion))
-            {
-                // If RMT logging is enabled, the first token we emit should be the RmtVersion event
-                static const RmtDataVersion kRmtVersionEvent = {
-                    RMT_FILE_DATA_CHUNK_MAJOR_VERSION,
-                    RMT_FILE_DATA_CHUNK_MINOR_VERSION };
-
-                WriteEvent(static_cast<uint32>(PalEvent::RmtVersion), &kRmtVersionEvent, sizeof(RmtDataVersion));
-                m_logRmtVersion = false;
-            }
-        }
-
-        const EventTimestamp timestamp = m_eventTimer.CreateTimestamp();
-        uint8 delta = 0;
-
-        if (timestamp.type == EventTimestampType::Full)
-        {
-            RMT_MSG_TIMESTAMP tsToken(timestamp.full.timestamp, timestamp.full.frequency);
-            WriteTokenData(tsToken);
-        }
-        else if (timestamp.type == EventTimestampType::LargeDelta)
-        {
-            RMT_MSG_TIME_DELTA tdToken(timestamp.largeDelta.delta, timestamp.largeDelta.numBytes);
-            WriteTokenData(tdToken);
-        }
-        else
-        {
-            delta = timestamp.smallDelta.delta;
-        }
+        // The RMT format requires that certain tokens strictly follow each other (e.g. resource create + description).
+        // All tokens of this event are built into a local staging buffer first, without holding any lock. The timestamp
+        // delta of the first token is only known once the event is ordered in the stream, so it's patched in below.
+        RmtTokenBuffer tokens(m_pPlatform);
+        constexpr uint8 delta = 0;
 
         switch (eventId)
         {
@@ -472,7 +485,7 @@ void EventProvider::LogEvent(
                 const uint32 driverHandle = LowPart(pData->driverHandle);
 
                 RMT_MSG_USERDATA_RSRC_CORRELATION eventToken(delta, handle, driverHandle);
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
                 break;
             }
             case PalEvent::Count:
@@ -509,7 +522,7 @@ void EventProvider::LogEvent(
                     PalToRmtHeapType(pData->heaps[3]),
                     static_cast<DevDriver::uint8>(pData->heapCount));
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
 
                 break;
             }
@@ -521,13 +534,13 @@ void EventProvider::LogEvent(
 
                 RMT_MSG_FREE_VIRTUAL eventToken(delta, pData->gpuVirtualAddr);
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
 
                 break;
             }
             case PalEvent::GpuMemoryResourceCreate:
             {
-                LogResourceCreateEvent(delta, pEventData, eventDataSize);
+                LogResourceCreateEvent(pEventData, eventDataSize, &tokens);
                 break;
             }
             case PalEvent::GpuMemoryResourceDestroy:
@@ -538,7 +551,7 @@ void EventProvider::LogEvent(
 
                 RMT_MSG_RESOURCE_DESTROY eventToken(delta, LowPart(pData->handle));
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
 
                 break;
             }
@@ -549,7 +562,7 @@ void EventProvider::LogEvent(
 
                 RMT_MSG_MISC eventToken(delta, PalToRmtMiscEventType(pData->type));
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
                 break;
             }
             case PalEvent::GpuMemorySnapshot:
@@ -562,7 +575,7 @@ void EventProvider::LogEvent(
                     RMT_USERDATA_EVENT_TYPE_SNAPSHOT,
                     pData->pSnapshotName);
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
                 break;
             }
             case PalEvent::DebugName:
@@ -575,7 +588,7 @@ void EventProvider::LogEvent(
                     pData->pDebugName,
                     LowPart(pData->handle));
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
                 break;
             }
             case PalEvent::GpuMemoryResourceBind:
@@ -591,7 +604,7 @@ void EventProvider::LogEvent(
                     LowPart(pData->resourceHandle),
                     pData->isSystemMemory);
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
 
                 GpuMemory* pGpuMemory = reinterpret_cast<GpuMemory*>(pData->handle);
                 if (pGpuMemory != nullptr)
@@ -611,7 +624,7 @@ void EventProvider::LogEvent(
 
                 RMT_MSG_CPU_MAP eventToken(delta, pData->gpuVirtualAddr, false);
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
                 break;
             }
             case PalEvent::GpuMemoryCpuUnmap:
@@ -621,7 +634,7 @@ void EventProvider::LogEvent(
 
                 RMT_MSG_CPU_MAP eventToken(delta, pData->gpuVirtualAddr, true);
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
                 break;
             }
             case PalEvent::GpuMemoryAddReference:
@@ -635,7 +648,7 @@ void EventProvider::LogEvent(
                     pData->gpuVirtualAddr,
                     static_cast<uint8>(pData->queueHandle) & 0x7f);
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
                 break;
             }
             case PalEvent::GpuMemoryRemoveReference:
@@ -649,30 +662,75 @@ void EventProvider::LogEvent(
                     pData->gpuVirtualAddr,
                     static_cast<uint8>(pData->queueHandle) & 0x7f);
 
-                WriteTokenData(eventToken);
+                AppendToken(eventToken, &tokens);
                 break;
             }
         }
+
+        if ((tokens.result == Result::Success) && (tokens.bytes.IsEmpty() == false))
+        {
+            DevDriver::Platform::LockGuard<DevDriver::Platform::Mutex> providerLock(m_providerLock);
+
+            // The first time we have something to log, we need to log the RmtVersion first
+            if (m_logRmtVersion)
+            {
+                if (ShouldLog(PalEvent::RmtVersion))
+                {
+                    // If RMT logging is enabled, the first token we emit should be the RmtVersion event
+                    static const RmtDataVersion kRmtVersionEvent = {
+                        RMT_FILE_DATA_CHUNK_MAJOR_VERSION,
+                        RMT_FILE_DATA_CHUNK_MINOR_VERSION };
+
+                    WriteEvent(static_cast<uint32>(PalEvent::RmtVersion), &kRmtVersionEvent, sizeof(RmtDataVersion));
+                    m_logRmtVersion = false;
+                }
+            }
+
+            const EventTimestamp timestamp = m_eventTimer.CreateTimestamp();
+
+            if (timestamp.type == EventTimestampType::Full)
+            {
+                RMT_MSG_TIMESTAMP tsToken(timestamp.full.timestamp, timestamp.full.frequency);
+                WriteTokenData(&tsToken, &tokens);
+            }
+            else if (timestamp.type == EventTimestampType::LargeDelta)
+            {
+                RMT_MSG_TIME_DELTA tdToken(timestamp.largeDelta.delta, timestamp.largeDelta.numBytes);
+                WriteTokenData(&tdToken, &tokens);
+            }
+            else
+            {
+                // The first token of every event starts with an RMT_TOKEN_HEADER, whose upper nibble holds the delta.
+                PAL_ASSERT(timestamp.smallDelta.delta < 16);
+                tokens.bytes[0] = static_cast<uint8>((tokens.bytes[0] & 0x0F) | (timestamp.smallDelta.delta << 4));
+
+                WriteTokenData(nullptr, &tokens);
+            }
+        }
+        else
+        {
+            PAL_ALERT(tokens.result != Result::Success);
+        }
     }
 }
 
 // =====================================================================================================================
 void EventProvider::LogResourceCreateEvent(
-    uint8       delta,
-    const void* pEventData,
-    size_t      eventDataSize)
+    const void*     pEventData,
+    size_t          eventDataSize,
+    RmtTokenBuffer* pTokens)
 {
     PAL_ASSERT(eventDataSize == sizeof(GpuMemoryResourceCreateData));
     const auto* pRsrcCreateData = reinterpret_cast<const GpuMemoryResourceCreateData*>(pEventData);
 
     RMT_MSG_RESOURCE_CREATE rsrcCreateToken(
-        delta,
+        0, // The timestamp delta is filled in by LogEvent.
         LowPart(pRsrcCreateData->handle),
         RMT_OWNER_KMD,
         0,
         RMT_COMMIT_TYPE_COMMITTED,
         PalToRmtResourceType(pRsrcCreateData->type));
-    WriteTokenData(rsrcCreateToken);
+    AppendToken(rsrcCreateToken, pTokens);
 
     switch (pRsrcCreateData->type)
     {
@@ -709,7 +767,7 @@ void EventProvider::LogResourceCreateEvent(
 
         RMT_RESOURCE_TYPE_IMAGE_TOKEN imgDesc(imgCreateInfo);
 
-        WriteTokenData(imgDesc);
+        AppendToken(imgDesc, pTokens);
         break;
     }
 
@@ -724,7 +782,7 @@ void EventProvider::LogResourceCreateEvent(
             static_cast<uint16>(pBufferData->usageFlags),
             pBufferData->size);
 
-        WriteTokenData(bufferDesc);
+        AppendToken(bufferDesc, pTokens);
         break;
     }
 
@@ -754,7 +812,7 @@ void EventProvider::LogResourceCreateEvent(
 
         RMT_RESOURCE_TYPE_PIPELINE_TOKEN pipelineDesc(flags, hash, stages, false);
 
-        WriteTokenData(pipelineDesc);
+        AppendToken(pipelineDesc, pTokens);
         break;
     }
 
@@ -805,7 +863,7 @@ void EventProvider::LogResourceCreateEvent(
             RMT_PAGE_SIZE_4KB,  //< @TODO - we don't currently have this info, so just set to 4KB
             static_cast<uint8>(pHeapData->preferredGpuHeap));
 
-        WriteTokenData(heapDesc);
+        AppendToken(heapDesc, pTokens);
         break;
     }
 
@@ -817,7 +875,7 @@ void EventProvider::LogResourceCreateEvent(
         const bool isGpuOnly = (pGpuEventData->pCreateInfo->flags.gpuAccessOnly == 1);
         RMT_RESOURCE_TYPE_GPU_EVENT_TOKEN gpuEventDesc(isGpuOnly);
 
-        WriteTokenData(gpuEventDesc);
+        AppendToken(gpuEventDesc, pTokens);
         break;
     }
 
@@ -828,7 +886,7 @@ void EventProvider::LogResourceCreateEvent(
 
         RMT_RESOURCE_TYPE_BORDER_COLOR_PALETTE_TOKEN bcpDesc(static_cast<uint8>(pBcpData->pCreateInfo->paletteSize));
 
-        WriteTokenData(bcpDesc);
+        AppendToken(bcpDesc, pTokens);
         break;
     }
 
@@ -843,7 +901,7 @@ void EventProvider::LogResourceCreateEvent(
             static_cast<uint32>(pPerfExperimentData->sqttSize),
             static_cast<uint32>(pPerfExperimentData->perfCounterSize));
 
-        WriteTokenData(perfExperimentDesc);
+        AppendToken(perfExperimentDesc, pTokens);
         break;
     }
 
@@ -856,7 +914,7 @@ void EventProvider::LogResourceCreateEvent(
             PalToRmtQueryHeapType(pQueryPoolData->pCreateInfo->queryPoolType),
             (pQueryPoolData->pCreateInfo->flags.enableCpuAccess == 1));
 
-        WriteTokenData(queryHeapDesc);
+        AppendToken(queryHeapDesc, pTokens);
         break;
     }
 
@@ -882,7 +940,7 @@ void EventProvider::LogResourceCreateEvent(
             static_cast<uint8>(pDescriptorHeapData->nodeMask),
             static_cast<uint16>(pDescriptorHeapData->numDescriptors));
 
-        WriteTokenData(descriptorHeapDesc);
+        AppendToken(descriptorHeapDesc, pTokens);
         break;
     }
 
@@ -896,7 +954,7 @@ void EventProvider::LogResourceCreateEvent(
             static_cast<uint16>(pDescriptorPoolData->maxSets),
             static_cast<uint8>(pDescriptorPoolData->numPoolSize));
 
-        WriteTokenData(poolSizeDesc);
+        AppendToken(poolSizeDesc, pTokens);
 
         // Then loop through writing RMT_POOL_SIZE_DESCs
         for (uint32 i = 0; i < pDescriptorPoolData->numPoolSize; ++i)
@@ -905,7 +963,7 @@ void EventProvider::LogResourceCreateEvent(
                 PalToRmtDescriptorType(pDescriptorPoolData->pPoolSizes[i].type),
                 static_cast<uint16>(pDescriptorPoolData->pPoolSizes[i].numDescriptors));
 
-            WriteTokenData(poolSize);
+            AppendToken(poolSize, pTokens);
         }
         break;
     }
@@ -928,7 +986,7 @@ void EventProvider::LogResourceCreateEvent(
             pCmdAllocatorData->pCreateInfo->allocInfo[CmdAllocType::GpuScratchMemAlloc].allocSize,
             pCmdAllocatorData->pCreateInfo->allocInfo[CmdAllocType::GpuScratchMemAlloc].suballocSize);
 
-        WriteTokenData(cmdAllocatorDesc);
+        AppendToken(cmdAllocatorDesc, pTokens);
         break;
     }
 
@@ -940,7 +998,7 @@ void EventProvider::LogResourceCreateEvent(
 
         RMT_RESOURCE_TYPE_MISC_INTERNAL_TOKEN miscInternalDesc(PalToRmtMiscInternalType(pMiscInternalData->type));
 
-        WriteTokenData(miscInternalDesc);
+        AppendToken(miscInternalDesc, pTokens);
         break;
     }
 
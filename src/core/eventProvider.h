@@ -30,6 +30,7 @@
 #include "palJsonWriter.h"
 #include "palMutex.h"
 #include "palPlatform.h"
+#include "palVector.h"
 
 #include "core/devDriverEventService.h"
 #include "core/eventDefs.h"
@@ -122,22 +123,28 @@ public:
 private:
     bool ShouldLog(PalEvent eventId) const;
 
+    // Staging buffer holding every RMT token generated by a single PalEvent.  Dependent tokens (e.g. resource create +
+    // description) are built here without holding any lock and are then written to the stream as one contiguous blob.
+    struct RmtTokenBuffer
+    {
+        explicit RmtTokenBuffer(Platform* pPlatform) : bytes(pPlatform), result(Result::Success) { }
+
+        Util::Vector<uint8, 256, Platform> bytes;
+        Result                             result; // The event is dropped if any of its tokens could not be staged.
+    };
+
     // Logs a PalEvent by translating it into one or more RMT Tokens and passing it into WriteTokenData
     void LogEvent(PalEvent eventId, const void* pEventData, size_t eventDataSize);
 
     // Hepler method for LogEvent
-    void LogResourceCreateEvent(uint8 delta, const void* pEventData, size_t eventDataSize);
+    void LogResourceCreateEvent(const void* pEventData, size_t eventDataSize, RmtTokenBuffer* pTokens);
 
-    // Write an RMT token to both the service and event protocol
-    void WriteTokenData(const DevDriver::RMT_TOKEN_DATA& token)
-    {
-        WriteEvent(
-            static_cast<uint32>(PalEvent::RmtToken),
-            token.Data(),
-            token.Size()
-        );
-        m_eventService.WriteTokenData(token);
-    }
+    // Appends an RMT token to a staging buffer
+    static void AppendToken(const DevDriver::RMT_TOKEN_DATA& token, RmtTokenBuffer* pTokens);
+
+    // Write an optional timestamp token followed by the staged RMT tokens of one PalEvent to both the service and event
+    // protocol. The caller must hold m_providerLock.
+    void WriteTokenData(const DevDriver::RMT_TOKEN_DATA* pTimestampToken, RmtTokenBuffer* pTokens);
 
     Platform*                  m_pPlatform;
     EventService               m_eventService;
@@ -165,7 +165,7 @@ Result ComputePipeline::InitFromPalAbiBinary(
     MsgPackReader*                   pMetadataReader)
 {
     PalAbi::CodeObjectMetadata metadata;
-    Result result = abiReader.GetMetadata(pMetadataReader, &metadata);
+    Result result = GetMetadata(m_pPipelineBinary, m_pipelineBinaryLen, abiReader, pMetadataReader, &metadata);
 
     if (result == Result::Success)
     {
@@ -193,6 +193,8 @@ Result ComputePipeline::InitFromPalAbiBinary(
         result = HwlInit(createInfo, abiReader, metadata, pMetadataReader);
     }
 
+    ReleaseMetadata();
+
     return result;
 }
 
@@ -148,13 +148,7 @@ Result ComputePipeline::HwlInit(
     const GpuChipProperties& chipProps = m_pDevice->Parent()->ChipProperties();
 
     RegisterVector registers(m_pDevice->GetPlatform());
-
-    Result result = pMetadataReader->Seek(metadata.pipeline.registers);
-
-    if (result == Result::Success)
-    {
-        result = pMetadataReader->Unpack(&registers);
-    }
+    Result result = UnpackMetadataRegisters(m_pMetadataEntry, pMetadataReader, metadata, &registers);
 
     PipelineUploader uploader(m_pDevice->Parent(), abiReader);
     if (result == Result::Success)
@@ -1005,9 +1005,25 @@ Result Device::CreateGraphicsPipeline(
 
     auto* pPipeline = PAL_PLACEMENT_NEW(pPlacementAddr) GraphicsPipeline(this, isInternal);
 
+    // The pipeline takes over our reference to the platform's metadata cache entry and releases it once initialized.
+    PipelineMetadataCache*const  pCache   = GetPlatform()->GetPipelineMetadataCache();
+    const PipelineMetadataEntry* pEntry   = nullptr;
+    PalAbi::CodeObjectMetadata   metadata = {};
+    MsgPackReader                metadataReader;
+
+    if (result == Result::Success)
+    {
+        result = pCache->GetMetadata(createInfo.pPipelineBinary,
+                                     createInfo.pipelineBinarySize,
+                                     abiReader,
+                                     &metadataReader,
+                                     &metadata,
+                                     &pEntry);
+    }
+
     if (result == Result::Success)
     {
-        result = pPipeline->Init(createInfo, internalInfo, abiReader);
+        result = pPipeline->Init(createInfo, internalInfo, abiReader, metadata, &metadataReader, pEntry);
 
         if (result != Result::Success)
         {
@@ -283,12 +283,7 @@ Result GraphicsPipeline::HwlInit(
     MsgPackReader*                    pMetadataReader)
 {
     RegisterVector registers(m_pDevice->GetPlatform());
-    Result result = pMetadataReader->Seek(metadata.pipeline.registers);
-
-    if (result == Result::Success)
-    {
-        result = pMetadataReader->Unpack(&registers);
-    }
+    Result result = UnpackMetadataRegisters(m_pMetadataEntry, pMetadataReader, metadata, &registers);
 
     if (result == Result::Success)
     {
@@ -31,7 +31,7 @@
 #include "core/hw/gfxip/gfx6/gfx6OcclusionQueryPool.h"
 #include "core/hw/gfxip/gfx6/gfx6UniversalCmdBuffer.h"
 #include "palCmdBuffer.h"
-#include "palIntervalTreeImpl.h"
+#include "palIntervalSetImpl.h"
 #include "palSysUtil.h"
 
 using namespace Util;
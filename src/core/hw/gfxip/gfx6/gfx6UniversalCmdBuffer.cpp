@@ -43,7 +43,7 @@
 #include "core/g_palPlatformSettings.h"
 #include "marker_payload.h"
 #include "palMath.h"
-#include "palIntervalTreeImpl.h"
+#include "palIntervalSetImpl.h"
 #include "palVectorImpl.h"
 
 #include <float.h>
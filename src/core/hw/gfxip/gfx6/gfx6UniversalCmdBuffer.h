@@ -32,7 +32,7 @@
 #include "core/hw/gfxip/gfx6/gfx6CmdUtil.h"
 #include "core/hw/gfxip/gfx6/gfx6WorkaroundState.h"
 #include "palAutoBuffer.h"
-#include "palIntervalTree.h"
+#include "palIntervalSet.h"
 
 namespace Pal
 {
@@ -406,7 +406,7 @@ public:
         uint32                           numChunkOutputs,
         ChunkOutput*                     pChunkOutputs) override;
 
-    Util::IntervalTree<gpusize, bool, Platform>* ActiveOcclusionQueryWriteRanges()
+    Util::IntervalSet<gpusize, Platform>* ActiveOcclusionQueryWriteRanges()
         { return &m_activeOcclusionQueryWriteRanges; }
 
     void CmdSetTriangleRasterStateInternal(
@@ -748,7 +748,7 @@ private:
     // insert an idle before performing the Reset().  This has a high performance penalty.  This structure is used
     // to track memory ranges affected by outstanding End() calls in this command buffer so we can avoid the idle
     // during Reset() if the reset doesn't affect any pending queries.
-    Util::IntervalTree<gpusize, bool, Platform>  m_activeOcclusionQueryWriteRanges;
+    Util::IntervalSet<gpusize, Platform>  m_activeOcclusionQueryWriteRanges;
 
     PAL_DISALLOW_DEFAULT_CTOR(UniversalCmdBuffer);
     PAL_DISALLOW_COPY_AND_ASSIGN(UniversalCmdBuffer);
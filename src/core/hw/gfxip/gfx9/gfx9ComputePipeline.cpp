@@ -231,12 +231,7 @@ Result ComputePipeline::HwlInit(
     m_disablePartialPreempt = createInfo.disablePartialDispatchPreemption;
 
     RegisterVector registers(m_pDevice->GetPlatform());
-    Result result = pMetadataReader->Seek(metadata.pipeline.registers);
-
-    if (result == Result::Success)
-    {
-        result = pMetadataReader->Unpack(&registers);
-    }
+    Result result = UnpackMetadataRegisters(m_pMetadataEntry, pMetadataReader, metadata, &registers);
 
     PipelineUploader uploader(m_pDevice->Parent(), abiReader);
 
@@ -959,31 +959,38 @@ Result Device::CreateGraphicsPipeline(
     AbiReader abiReader(GetPlatform(), createInfo.pPipelineBinary);
     Result result = abiReader.Init();
 
-    PalAbi::CodeObjectMetadata metadata = {};
+    // The metadata is decoded once here and handed to the pipeline's Init(), along with our reference to the
+    // platform's metadata cache entry.  The pipeline releases the entry once it has been initialized.
+    PipelineMetadataCache*const  pCache   = GetPlatform()->GetPipelineMetadataCache();
+    const PipelineMetadataEntry* pEntry   = nullptr;
+    PalAbi::CodeObjectMetadata   metadata = {};
+    MsgPackReader                metadataReader;
 
     if (result == Result::Success)
     {
-        MsgPackReader metadataReader;
-        result = abiReader.GetMetadata(&metadataReader, &metadata);
+        result = pCache->GetMetadata(createInfo.pPipelineBinary,
+                                     createInfo.pipelineBinarySize,
+                                     abiReader,
+                                     &metadataReader,
+                                     &metadata,
+                                     &pEntry);
     }
 
     if (result == Result::Success)
     {
+        GraphicsPipeline* pPipeline = nullptr;
+
         const auto& shaderMetadata = metadata.pipeline.shader[static_cast<uint32>(Abi::ApiShaderType::Task)];
         if (ShaderHashIsNonzero({ shaderMetadata.apiShaderHash[0], shaderMetadata.apiShaderHash[1] }))
         {
-            PAL_PLACEMENT_NEW(pPlacementAddr) HybridGraphicsPipeline(this);
+            pPipeline = PAL_PLACEMENT_NEW(pPlacementAddr) HybridGraphicsPipeline(this);
         }
         else
         {
-            PAL_PLACEMENT_NEW(pPlacementAddr) GraphicsPipeline(this, isInternal);
+            pPipeline = PAL_PLACEMENT_NEW(pPlacementAddr) GraphicsPipeline(this, isInternal);
         }
-    }
 
-    if (result == Result::Success)
-    {
-        auto* pPipeline = static_cast<GraphicsPipeline*>(pPlacementAddr);
-        result = pPipeline->Init(createInfo, internalInfo, abiReader);
+        result = pPipeline->Init(createInfo, internalInfo, abiReader, metadata, &metadataReader, pEntry);
 
         if (result != Result::Success)
         {
@@ -53,12 +53,7 @@ Result HybridGraphicsPipeline::HwlInit(
     MsgPackReader*                    pMetadataReader)
 {
     RegisterVector registers(m_pDevice->GetPlatform());
-    Result result = pMetadataReader->Seek(metadata.pipeline.registers);
-
-    if (result == Result::Success)
-    {
-        result = pMetadataReader->Unpack(&registers);
-    }
+    Result result = UnpackMetadataRegisters(m_pMetadataEntry, pMetadataReader, metadata, &registers);
 
     if (result == Result::Success)
     {
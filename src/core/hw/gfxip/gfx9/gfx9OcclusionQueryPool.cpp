@@ -31,7 +31,7 @@
 #include "core/hw/gfxip/gfx9/gfx9OcclusionQueryPool.h"
 #include "core/hw/gfxip/gfx9/gfx9UniversalCmdBuffer.h"
 #include "palCmdBuffer.h"
-#include "palIntervalTreeImpl.h"
+#include "palIntervalSetImpl.h"
 #include "palSysUtil.h"
 
 using namespace Util;
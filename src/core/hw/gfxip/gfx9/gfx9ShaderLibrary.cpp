@@ -95,12 +95,7 @@ Result ShaderLibrary::HwlInit(
     const GpuChipProperties& chipProps = m_pDevice->Parent()->ChipProperties();
 
     RegisterVector registers(m_pDevice->GetPlatform());
-    Result result = pMetadataReader->Seek(metadata.pipeline.registers);
-
-    if (result == Result::Success)
-    {
-        result = pMetadataReader->Unpack(&registers);
-    }
+    Result result = UnpackMetadataRegisters(m_pMetadataEntry, pMetadataReader, metadata, &registers);
 
     PipelineUploader uploader(m_pDevice->Parent(), abiReader);
 
@@ -253,12 +248,21 @@ Result ShaderLibrary::GetShaderFunctionStats(
         }
     }
 
-    MsgPackReader              metadataReader;
     PalAbi::CodeObjectMetadata metadata;
 
     if (result == Result::Success)
     {
-        result = abiReader.GetMetadata(&metadataReader, &metadata);
+        PipelineMetadataCache*const  pCache = m_pDevice->GetPlatform()->GetPipelineMetadataCache();
+        const PipelineMetadataEntry* pEntry = nullptr;
+
+        MsgPackReader metadataReader;
+        result = pCache->GetMetadata(m_pCodeObjectBinary,
+                                     m_codeObjectBinaryLen,
+                                     abiReader,
+                                     &metadataReader,
+                                     &metadata,
+                                     &pEntry);
+        pCache->Release(pEntry);
     }
 
     if (result == Result::Success)
@@ -279,98 +283,110 @@ Result ShaderLibrary::GetShaderFunctionStats(
 
     if (result == Result::Success)
     {
-        result = UnpackShaderFunctionStats(pShaderExportName,
-                                           metadata,
-                                           &metadataReader,
-                                           pShaderStats);
+        result = UnpackShaderFunctionStats(pShaderExportName, metadata, pShaderStats);
     }
 
     return result;
 }
 
 // =====================================================================================================================
-// Obtains the shader function stack frame size
+// Obtains the shader function stack frame size and register usage.  The function's entry is looked up by name through
+// the library's random-access metadata view, so the other functions' tables are stepped over without being decoded.
 Result ShaderLibrary::UnpackShaderFunctionStats(
     const char*                       pShaderExportName,
     const PalAbi::CodeObjectMetadata& metadata,
-    Util::MsgPackReader*              pMetadataReader,
     ShaderLibStats*                   pShaderStats
     ) const
 {
-    Result result = pMetadataReader->Seek(metadata.pipeline.shaderFunctions);
+    const MsgPackView* pView  = nullptr;
+    Result             result = GetMetadataView(&pView);
+
+    uint32 funcOffset = 0;
+
+    if (result == Result::Success)
+    {
+        result = pView->FindMapValue(metadata.pipeline.shaderFunctions,
+                                     pShaderExportName,
+                                     static_cast<uint32>(strlen(pShaderExportName)),
+                                     &funcOffset);
+    }
+
+    uint32 offset      = 0;
+    uint32 numChildren = 0;
 
     if (result == Result::Success)
     {
-        result    = (pMetadataReader->Type() == CWP_ITEM_MAP) ? Result::Success : Result::ErrorInvalidValue;
-        const auto& item = pMetadataReader->Get().as;
+        result = pView->GetFirstChild(funcOffset, &offset, &numChildren);
+    }
+    else if (result == Result::NotFound)
+    {
+        // A function without an entry simply has no statistics to report.
+        result = Result::Success;
+    }
+
+    for (uint32 i = 0; (result == Result::Success) && (i < numChildren); i += 2)
+    {
+        const char* pKey        = nullptr;
+        uint32      keyLength   = 0;
+        uint32      valueOffset = 0;
+        uint64      value       = 0;
+
+        result = pView->GetString(offset, &pKey, &keyLength);
 
-        for (uint32 i = item.map.size; ((result == Result::Success) && (i > 0)); --i)
+        if (result == Result::Success)
         {
-            ShaderFuncStats stats;
+            result = pView->SkipItem(offset, &valueOffset);
+        }
 
-            result = pMetadataReader->Next(CWP_ITEM_STR);
-            if (result == Result::Success)
+        if (result == Result::Success)
+        {
+            switch (HashString(pKey, keyLength))
             {
-                stats.symbolNameLength = item.str.length;
-                stats.pSymbolName      = static_cast<const char*>(item.str.start);
-            }
-
-            if (result == Result::Success)
+            case HashLiteralString(".stack_frame_size_in_bytes"):
+                result = pView->GetUint(valueOffset, &value);
+                pShaderStats->stackFrameSizeInBytes = static_cast<uint32>(value);
+                break;
+            case HashLiteralString(".shader_subtype"):
             {
-                result = pMetadataReader->Next(CWP_ITEM_MAP);
-            }
+                // Enums are stored as strings; reuse the generated deserializer, which expects to be positioned on
+                // the key.
+                MsgPackReader reader;
+                result = reader.InitFromBuffer(pView->GetBuffer(), pView->GetSize());
 
-            for (uint32 j = item.map.size; ((result == Result::Success) && (j > 0)); --j)
-            {
-                result = pMetadataReader->Next(CWP_ITEM_STR);
+                if (result == Result::Success)
+                {
+                    result = reader.Seek(offset);
+                }
 
+                Abi::ApiShaderSubType shaderSubType = Abi::ApiShaderSubType::Unknown;
                 if (result == Result::Success)
                 {
-                    if ((strncmp(pShaderExportName, stats.pSymbolName, stats.symbolNameLength) == 0) &&
-                        (strlen(pShaderExportName) == stats.symbolNameLength))
-                    {
-                        switch (HashString(static_cast<const char*>(item.str.start), item.str.length))
-                        {
-                        case HashLiteralString(".stack_frame_size_in_bytes"):
-                        {
-                            result = pMetadataReader->UnpackNext(&stats.stackFrameSizeInBytes);
-                                pShaderStats->stackFrameSizeInBytes = stats.stackFrameSizeInBytes;
-                        }
-                        break;
-                        case HashLiteralString(".shader_subtype"):
-                        {
-                            Abi::ApiShaderSubType shaderSubType;
-                            PalAbi::Metadata::DeserializeEnum(pMetadataReader, &shaderSubType);
-                            stats.shaderSubType = Pal::ShaderSubType(shaderSubType);
-                        }
-                        break;
-                        case HashLiteralString(PalAbi::HardwareStageMetadataKey::VgprCount):
-                        {
-                            result = pMetadataReader->UnpackNext(&pShaderStats->common.numUsedVgprs);
-                        }
-                        break;
-                        case HashLiteralString(PalAbi::HardwareStageMetadataKey::SgprCount):
-                        {
-                            result = pMetadataReader->UnpackNext(&pShaderStats->common.numUsedSgprs);
-                        }
-                        break;
-                        case HashLiteralString(PalAbi::HardwareStageMetadataKey::LdsSize):
-                        {
-                            result = pMetadataReader->UnpackNext(&pShaderStats->common.ldsUsageSizeInBytes);
-                        }
-                        break;
-                        default:
-                            result = pMetadataReader->Skip(1);
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        result = pMetadataReader->Skip(1);
-                    }
+                    PalAbi::Metadata::DeserializeEnum(&reader, &shaderSubType);
                 }
+
+                pShaderStats->shaderSubType = ShaderSubType(shaderSubType);
+                break;
             }
+            case HashLiteralString(PalAbi::HardwareStageMetadataKey::VgprCount):
+                result = pView->GetUint(valueOffset, &value);
+                pShaderStats->common.numUsedVgprs = static_cast<uint32>(value);
+                break;
+            case HashLiteralString(PalAbi::HardwareStageMetadataKey::SgprCount):
+                result = pView->GetUint(valueOffset, &value);
+                pShaderStats->common.numUsedSgprs = static_cast<uint32>(value);
+                break;
+            case HashLiteralString(PalAbi::HardwareStageMetadataKey::LdsSize):
+                result = pView->GetUint(valueOffset, &value);
+                pShaderStats->common.ldsUsageSizeInBytes = static_cast<size_t>(value);
+                break;
+            default:
+                break;
+            }
+        }
 
+        if (result == Result::Success)
+        {
+            result = pView->SkipItem(valueOffset, &offset);
         }
     }
 
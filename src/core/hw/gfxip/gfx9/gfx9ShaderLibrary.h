@@ -97,7 +97,6 @@ protected:
     Result UnpackShaderFunctionStats(
         const char*                             pShaderExportName,
         const Util::PalAbi::CodeObjectMetadata& metadata,
-        Util::MsgPackReader*                    pMetadataReader,
         ShaderLibStats*                         pShaderStats) const;
 
     // Update m_hwInfo afer HwlInit
@@ -46,7 +46,7 @@
 #include "marker_payload.h"
 #include "palHsaAbiMetadata.h"
 #include "palMath.h"
-#include "palIntervalTreeImpl.h"
+#include "palIntervalSetImpl.h"
 #include "palVectorImpl.h"
 
 #include <float.h>
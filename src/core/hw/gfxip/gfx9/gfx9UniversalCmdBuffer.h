@@ -32,7 +32,7 @@
 #include "core/hw/gfxip/gfx9/gfx9WorkaroundState.h"
 #include "core/hw/gfxip/gfx9/g_gfx9PalSettings.h"
 #include "palAutoBuffer.h"
-#include "palIntervalTree.h"
+#include "palIntervalSet.h"
 #include "palPipelineAbi.h"
 #include "palVector.h"
 
@@ -574,7 +574,7 @@ public:
         uint32                           numChunkOutputs,
         ChunkOutput*                     pChunkOutputs) override;
 
-    Util::IntervalTree<gpusize, bool, Platform>* ActiveOcclusionQueryWriteRanges()
+    Util::IntervalSet<gpusize, Platform>* ActiveOcclusionQueryWriteRanges()
         { return &m_activeOcclusionQueryWriteRanges; }
 
     void CmdSetTriangleRasterStateInternal(
@@ -1173,7 +1173,7 @@ private:
     // insert an idle before performing the Reset().  This has a high performance penalty.  This structure is used
     // to track memory ranges affected by outstanding End() calls in this command buffer so we can avoid the idle
     // during Reset() if the reset doesn't affect any pending queries.
-    Util::IntervalTree<gpusize, bool, Platform>  m_activeOcclusionQueryWriteRanges;
+    Util::IntervalSet<gpusize, Platform>  m_activeOcclusionQueryWriteRanges;
 
     // Used to sync the ACE and DE in a ganged submit.
     gpusize m_gangedCmdStreamSemAddr;
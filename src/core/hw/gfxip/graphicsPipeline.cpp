@@ -55,12 +55,20 @@ GraphicsPipeline::GraphicsPipeline(
 }
 
 // =====================================================================================================================
-// Initialize this graphics pipeline based on the provided creation info.
+// Initialize this graphics pipeline based on the provided creation info.  The caller has already decoded the binary's
+// metadata through the platform's metadata cache; this pipeline takes over the caller's reference to the cache entry
+// (which may be null) and gives it back once initialization is done.
 Result GraphicsPipeline::Init(
     const GraphicsPipelineCreateInfo&         createInfo,
     const GraphicsPipelineInternalCreateInfo& internalInfo,
-    const AbiReader&                          abiReader)
+    const AbiReader&                          abiReader,
+    const PalAbi::CodeObjectMetadata&         metadata,
+    MsgPackReader*                            pMetadataReader,
+    const PipelineMetadataEntry*              pMetadataEntry)
 {
+    PAL_ASSERT(m_pMetadataEntry == nullptr);
+    m_pMetadataEntry = pMetadataEntry;
+
     Result result = Result::Success;
 
     if ((createInfo.pPipelineBinary != nullptr) && (createInfo.pipelineBinarySize != 0))
@@ -84,9 +92,11 @@ Result GraphicsPipeline::Init(
     if (result == Result::Success)
     {
         PAL_ASSERT(m_pPipelineBinary != nullptr);
-        result = InitFromPipelineBinary(createInfo, internalInfo, abiReader);
+        result = InitFromPipelineBinary(createInfo, internalInfo, abiReader, metadata, pMetadataReader);
     }
 
+    ReleaseMetadata();
+
     if (result == Result::Success)
     {
         auto*const pEventProvider = m_pDevice->GetPlatform()->GetEventProvider();
@@ -119,7 +129,9 @@ Result GraphicsPipeline::Init(
 Result GraphicsPipeline::InitFromPipelineBinary(
     const GraphicsPipelineCreateInfo&         createInfo,
     const GraphicsPipelineInternalCreateInfo& internalInfo,
-    const AbiReader&                          abiReader)
+    const AbiReader&                          abiReader,
+    const PalAbi::CodeObjectMetadata&         metadata,
+    MsgPackReader*                            pMetadataReader)
 {
     // Store the ROP code this pipeline was created with
     m_logicOp = createInfo.cbState.logicOp;
@@ -150,80 +162,71 @@ Result GraphicsPipeline::InitFromPipelineBinary(
     m_viewInstancingDesc                   = createInfo.viewInstancingDesc;
     m_viewInstancingDesc.viewInstanceCount = Max(m_viewInstancingDesc.viewInstanceCount, 1u);
 
-    MsgPackReader              metadataReader;
-    PalAbi::CodeObjectMetadata metadata;
-    Result result = abiReader.GetMetadata(&metadataReader, &metadata);
-
-    if (result == Result::Success)
-    {
-        ExtractPipelineInfo(metadata, ShaderType::Task, ShaderType::Pixel);
+    ExtractPipelineInfo(metadata, ShaderType::Task, ShaderType::Pixel);
 
-        DumpPipelineElf("PipelineGfx",
-                        ((metadata.pipeline.hasEntry.name != 0) ? &metadata.pipeline.name[0] : nullptr));
+    DumpPipelineElf("PipelineGfx",
+                    ((metadata.pipeline.hasEntry.name != 0) ? &metadata.pipeline.name[0] : nullptr));
 
-        if (ShaderHashIsNonzero(m_info.shader[static_cast<uint32>(ShaderType::Geometry)].hash))
-        {
-            m_flags.gsEnabled = 1;
-        }
-        if (ShaderHashIsNonzero(m_info.shader[static_cast<uint32>(ShaderType::Hull)].hash) &&
-            ShaderHashIsNonzero(m_info.shader[static_cast<uint32>(ShaderType::Domain)].hash))
-        {
-            m_flags.tessEnabled = 1;
-        }
-
-        if (ShaderHashIsNonzero(m_info.shader[static_cast<uint32>(ShaderType::Mesh)].hash))
-        {
-            m_flags.meshShader = 1;
-        }
+    if (ShaderHashIsNonzero(m_info.shader[static_cast<uint32>(ShaderType::Geometry)].hash))
+    {
+        m_flags.gsEnabled = 1;
+    }
+    if (ShaderHashIsNonzero(m_info.shader[static_cast<uint32>(ShaderType::Hull)].hash) &&
+        ShaderHashIsNonzero(m_info.shader[static_cast<uint32>(ShaderType::Domain)].hash))
+    {
+        m_flags.tessEnabled = 1;
+    }
 
-        if (ShaderHashIsNonzero(m_info.shader[static_cast<uint32>(ShaderType::Task)].hash))
-        {
-            SetTaskShaderEnabled();
-            m_flags.taskShader = 1;
-        }
-        // A task shader is not allowed unless a mesh shader is also present, but a mesh shader can be present
-        // without requiring a task shader.
-        PAL_ASSERT(HasMeshShader() || (HasTaskShader() == false));
+    if (ShaderHashIsNonzero(m_info.shader[static_cast<uint32>(ShaderType::Mesh)].hash))
+    {
+        m_flags.meshShader = 1;
+    }
 
-        m_flags.vportArrayIdx = (metadata.pipeline.flags.usesViewportArrayIndex != 0);
+    if (ShaderHashIsNonzero(m_info.shader[static_cast<uint32>(ShaderType::Task)].hash))
+    {
+        SetTaskShaderEnabled();
+        m_flags.taskShader = 1;
+    }
+    // A task shader is not allowed unless a mesh shader is also present, but a mesh shader can be present
+    // without requiring a task shader.
+    PAL_ASSERT(HasMeshShader() || (HasTaskShader() == false));
 
-        const auto& psStageMetadata = metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ps)];
+    m_flags.vportArrayIdx = (metadata.pipeline.flags.usesViewportArrayIndex != 0);
 
-        m_flags.psUsesUavs          = (psStageMetadata.flags.usesUavs          != 0);
-        m_flags.psUsesRovs          = (psStageMetadata.flags.usesRovs          != 0);
-        m_flags.psWritesUavs        = (psStageMetadata.flags.writesUavs        != 0);
-        m_flags.psWritesDepth       = (psStageMetadata.flags.writesDepth       != 0);
-        m_flags.psUsesAppendConsume = (psStageMetadata.flags.usesAppendConsume != 0);
+    const auto& psStageMetadata = metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ps)];
 
-        if ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ls)].flags.usesUavs) ||
-            (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Hs)].flags.usesUavs) ||
-            (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Es)].flags.usesUavs) ||
-            (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Gs)].flags.usesUavs) ||
-            (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Vs)].flags.usesUavs))
-        {
-            m_flags.nonPsShaderUsesUavs = true;
-        }
+    m_flags.psUsesUavs          = (psStageMetadata.flags.usesUavs          != 0);
+    m_flags.psUsesRovs          = (psStageMetadata.flags.usesRovs          != 0);
+    m_flags.psWritesUavs        = (psStageMetadata.flags.writesUavs        != 0);
+    m_flags.psWritesDepth       = (psStageMetadata.flags.writesDepth       != 0);
+    m_flags.psUsesAppendConsume = (psStageMetadata.flags.usesAppendConsume != 0);
 
-        if (((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ls)].hasEntry.usesPrimId) &&
-             (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ls)].flags.usesPrimId)) ||
-            ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Hs)].hasEntry.usesPrimId) &&
-             (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Hs)].flags.usesPrimId)) ||
-            ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Es)].hasEntry.usesPrimId) &&
-             (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Es)].flags.usesPrimId)) ||
-            ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Gs)].hasEntry.usesPrimId) &&
-             (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Gs)].flags.usesPrimId)) ||
-            ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Vs)].hasEntry.usesPrimId) &&
-             (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Vs)].flags.usesPrimId)) ||
-            ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ps)].hasEntry.usesPrimId) &&
-             (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ps)].flags.usesPrimId)))
-        {
-            m_flags.primIdUsed = true;
-        }
+    if ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ls)].flags.usesUavs) ||
+        (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Hs)].flags.usesUavs) ||
+        (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Es)].flags.usesUavs) ||
+        (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Gs)].flags.usesUavs) ||
+        (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Vs)].flags.usesUavs))
+    {
+        m_flags.nonPsShaderUsesUavs = true;
+    }
 
-        result = HwlInit(createInfo, abiReader, metadata, &metadataReader);
+    if (((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ls)].hasEntry.usesPrimId) &&
+         (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ls)].flags.usesPrimId)) ||
+        ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Hs)].hasEntry.usesPrimId) &&
+         (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Hs)].flags.usesPrimId)) ||
+        ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Es)].hasEntry.usesPrimId) &&
+         (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Es)].flags.usesPrimId)) ||
+        ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Gs)].hasEntry.usesPrimId) &&
+         (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Gs)].flags.usesPrimId)) ||
+        ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Vs)].hasEntry.usesPrimId) &&
+         (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Vs)].flags.usesPrimId)) ||
+        ((metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ps)].hasEntry.usesPrimId) &&
+         (metadata.pipeline.hardwareStage[static_cast<uint32>(Abi::HardwareStage::Ps)].flags.usesPrimId)))
+    {
+        m_flags.primIdUsed = true;
     }
 
-    return result;
+    return HwlInit(createInfo, abiReader, metadata, pMetadataReader);
 }
 
 } // Pal
@@ -41,7 +41,10 @@ public:
     virtual Result Init(
         const GraphicsPipelineCreateInfo&         createInfo,
         const GraphicsPipelineInternalCreateInfo& internalInfo,
-        const AbiReader&                          abiReader);
+        const AbiReader&                          abiReader,
+        const Util::PalAbi::CodeObjectMetadata&   metadata,
+        Util::MsgPackReader*                      pMetadataReader,
+        const PipelineMetadataEntry*              pMetadataEntry);
 
     bool IsGsEnabled() const { return m_flags.gsEnabled; }
     bool IsGsOnChip() const { return m_flags.isGsOnchip; }
@@ -93,7 +96,9 @@ private:
     Result InitFromPipelineBinary(
         const GraphicsPipelineCreateInfo&         createInfo,
         const GraphicsPipelineInternalCreateInfo& internalInfo,
-        const AbiReader&                          abiReader);
+        const AbiReader&                          abiReader,
+        const Util::PalAbi::CodeObjectMetadata&   metadata,
+        Util::MsgPackReader*                      pMetadataReader);
 
     union
     {
@@ -27,6 +27,7 @@
 #include "core/device.h"
 #include "core/dmaUploadRing.h"
 #include "core/g_palSettings.h"
+#include "core/pipelineUploadBatch.h"
 #include "core/platform.h"
 #include "core/hw/gfxip/gfxDevice.h"
 #include "core/hw/gfxip/pipeline.h"
@@ -56,6 +57,13 @@ constexpr Abi::ApiShaderType PalToAbiShaderType[] =
 static_assert(ArrayLen(PalToAbiShaderType) == NumShaderTypes,
               "PalToAbiShaderType[] array is incorrectly sized!");
 
+// User data passed through ShaderCodeStore::Acquire() to PipelineUploader::FillSharedCodeCb().
+struct SharedCodeFillInfo
+{
+    PipelineUploader*    pUploader;
+    ElfReader::SectionId sectionId;
+};
+
 // =====================================================================================================================
 Pipeline::Pipeline(
     Device* pDevice,
@@ -72,9 +80,12 @@ Pipeline::Pipeline(
     m_apiHwMapping{},
     m_uploadFenceToken(0),
     m_pagingFenceVal(0),
+    m_pMetadataEntry(nullptr),
     m_flags{},
     m_perfDataMem(),
-    m_perfDataGpuMemSize(0)
+    m_perfDataGpuMemSize(0),
+    m_sharedCode{},
+    m_pCodeArena(nullptr)
 {
     m_flags.isInternal = isInternal;
 }
@@ -82,12 +93,24 @@ Pipeline::Pipeline(
 // =====================================================================================================================
 Pipeline::~Pipeline()
 {
-    if (m_gpuMem.IsBound())
+    if (m_pCodeArena != nullptr)
+    {
+        m_pCodeArena->Release();
+        m_pCodeArena = nullptr;
+        m_gpuMem.Update(nullptr, 0);
+    }
+    else if (m_gpuMem.IsBound())
     {
         m_pDevice->MemMgr()->FreeGpuMem(m_gpuMem.Memory(), m_gpuMem.Offset());
         m_gpuMem.Update(nullptr, 0);
     }
 
+    if (m_sharedCode.count > 0)
+    {
+        m_pDevice->GetShaderCodeStore()->Release(m_sharedCode);
+        m_sharedCode.count = 0;
+    }
+
     if (m_perfDataMem.IsBound())
     {
         m_pDevice->MemMgr()->FreeGpuMem(m_perfDataMem.Memory(), m_perfDataMem.Offset());
@@ -177,7 +200,13 @@ Result Pipeline::PerformRelocationsAndUploadToGpuMemory(
 
     if (result == Result::Success)
     {
-        result = pUploader->Begin(clientPreferredHeap);
+        // Only client pipelines may share code or be batched; internal pipelines are created once per device anyway.
+        if (IsInternal() == false)
+        {
+            pUploader->SetUploadBatch(m_pDevice->GetPipelineUploadBatch());
+        }
+
+        result = pUploader->Begin(clientPreferredHeap, IsInternal() ? nullptr : &m_sharedCode);
     }
 
     if (result == Result::Success)
@@ -189,6 +218,7 @@ Result Pipeline::PerformRelocationsAndUploadToGpuMemory(
     {
         m_pagingFenceVal = pUploader->PagingFenceVal();
         m_gpuMemSize     = pUploader->GpuMemSize();
+        m_pCodeArena     = pUploader->TakeCodeArena();
         m_gpuMem.Update(pUploader->GpuMem(), pUploader->GpuMemOffset());
     }
 
@@ -422,8 +452,19 @@ Result Pipeline::GetShaderStatsForStage(
 
     if (result == Result::Success)
     {
+        PipelineMetadataCache*const  pCache = m_pDevice->GetPlatform()->GetPipelineMetadataCache();
+        const PipelineMetadataEntry* pEntry = nullptr;
+
         MsgPackReader metadataReader;
-        result = abiReader.GetMetadata(&metadataReader, &metadata);
+        result = pCache->GetMetadata(m_pPipelineBinary,
+                                     m_pipelineBinaryLen,
+                                     abiReader,
+                                     &metadataReader,
+                                     &metadata,
+                                     &pEntry);
+
+        // Only the decoded metadata is needed here.
+        pCache->Release(pEntry);
     }
 
     if (result == Result::Success)
@@ -499,6 +540,34 @@ size_t Pipeline::PerformanceDataSize(
     return dataSize;
 }
 
+// =====================================================================================================================
+// Decodes the pipeline's PAL ABI metadata through the platform's metadata cache.  The cache entry, if any, is kept in
+// m_pMetadataEntry so the hardware layer can reuse its pre-decoded registers; it must be given back with
+// ReleaseMetadata() once initialization is done.
+Result Pipeline::GetMetadata(
+    const void*                 pBinary,
+    size_t                      binarySize,
+    const AbiReader&            abiReader,
+    MsgPackReader*              pReader,
+    PalAbi::CodeObjectMetadata* pMetadata)
+{
+    PAL_ASSERT(m_pMetadataEntry == nullptr);
+
+    return m_pDevice->GetPlatform()->GetPipelineMetadataCache()->GetMetadata(pBinary,
+                                                                             binarySize,
+                                                                             abiReader,
+                                                                             pReader,
+                                                                             pMetadata,
+                                                                             &m_pMetadataEntry);
+}
+
+// =====================================================================================================================
+void Pipeline::ReleaseMetadata()
+{
+    m_pDevice->GetPlatform()->GetPipelineMetadataCache()->Release(m_pMetadataEntry);
+    m_pMetadataEntry = nullptr;
+}
+
 // =====================================================================================================================
 void Pipeline::DumpPipelineElf(
     const char*         pPrefix,
@@ -569,17 +638,56 @@ void Pipeline::DumpPipelineElf(
 }
 
 // =====================================================================================================================
+// Returns the CPU address an offset within this section is mapped to.  Sections uploaded through a CPU mapping have a
+// single chunk; sections uploaded through the DMA ring may be split into a few, which are binary searched by offset.
 void* SectionInfo::GetCpuMappedAddr(
     gpusize offset
     ) const
 {
-    auto chunkIter = m_chunks.Begin();
-    while (offset > chunkIter.Get().size)
+    uint32 chunk = 0;
+
+    if (m_chunks.NumElements() > 1)
     {
-        offset -= chunkIter.Get().size;
-        chunkIter.Next();
+        uint32 low  = 0;
+        uint32 high = m_chunks.NumElements() - 1;
+
+        // Find the last chunk which starts at or before offset.
+        while (low < high)
+        {
+            const uint32 mid = low + ((high - low + 1) / 2);
+
+            if (m_chunks.At(mid).sectionOffset <= offset)
+            {
+                low = mid;
+            }
+            else
+            {
+                high = mid - 1;
+            }
+        }
+
+        chunk = low;
     }
-    return Util::VoidPtrInc(chunkIter.Get().pCpuMappedAddr, static_cast<size_t>(offset));
+
+    const SectionChunk& sectionChunk = m_chunks.At(chunk);
+    return Util::VoidPtrInc(sectionChunk.pCpuMappedAddr, static_cast<size_t>(offset - sectionChunk.sectionOffset));
+}
+
+// =====================================================================================================================
+Result SectionInfo::AddCpuMappedChunk(
+    const SectionChunk& chunk)
+{
+    SectionChunk newChunk = chunk;
+
+    newChunk.sectionOffset = 0;
+
+    if (m_chunks.IsEmpty() == false)
+    {
+        const SectionChunk& lastChunk = m_chunks.Back();
+        newChunk.sectionOffset = lastChunk.sectionOffset + lastChunk.size;
+    }
+
+    return m_chunks.PushBack(newChunk);
 }
 
 // =====================================================================================================================
@@ -588,31 +696,29 @@ SectionInfo* SectionMemoryMap::AddSection(
     gpusize                    gpuVirtAddr,
     const void*                pCpuLocalAddr)
 {
-    SectionInfo info(&m_allocator, sectionId, gpuVirtAddr, pCpuLocalAddr);
-    Result result = m_sections.PushBack(info);
+    PAL_ASSERT(FindSection(sectionId) == nullptr);
+
+    Result result = Result::Success;
+
+    while ((result == Result::Success) && (m_sectionIndices.NumElements() <= sectionId))
+    {
+        result = m_sectionIndices.PushBack(InvalidIndex);
+    }
+
     SectionInfo* pSection = nullptr;
+
     if (result == Result::Success)
     {
-        pSection = &m_sections.Back();
+        SectionInfo info(&m_allocator, sectionId, gpuVirtAddr, pCpuLocalAddr);
+        result = m_sections.PushBack(info);
     }
-    return pSection;
-}
 
-// =====================================================================================================================
-const SectionInfo* SectionMemoryMap::FindSection(
-    Util::ElfReader::SectionId sectionId
-    ) const
-{
-    const SectionInfo* pSection = nullptr;
-    for (uint32 i = 0; i < m_sections.NumElements(); i++)
+    if (result == Result::Success)
     {
-        const auto& section = m_sections.At(i);
-        if (section.GetSectionId() == sectionId)
-        {
-            pSection = &section;
-            break;
-        }
+        m_sectionIndices[sectionId] = m_sections.NumElements() - 1;
+        pSection = &m_sections.Back();
     }
+
     return pSection;
 }
 
@@ -645,10 +751,14 @@ PipelineUploader::PipelineUploader(
     :
     m_pDevice(pDevice),
     m_abiReader(abiReader),
+    m_pBatch(nullptr),
+    m_pCodeArena(nullptr),
     m_pGpuMemory(nullptr),
     m_baseOffset(0),
     m_gpuMemSize(0),
     m_memoryMap(pDevice->GetPlatform()),
+    m_sharedSections{},
+    m_numSharedSections(0),
     m_pMappedPtr(nullptr),
     m_pagingFenceVal(0),
     m_pipelineHeapType(GpuHeap::GpuHeapCount),
@@ -661,6 +771,20 @@ PipelineUploader::PipelineUploader(
 PipelineUploader::~PipelineUploader()
 {
     PAL_ASSERT(m_pMappedPtr == nullptr); // If this fires, the caller forgot to call End()!
+
+    if (m_pCodeArena != nullptr)
+    {
+        m_pCodeArena->Release();
+    }
+}
+
+// =====================================================================================================================
+PipelineCodeArena* PipelineUploader::TakeCodeArena()
+{
+    PipelineCodeArena*const pArena = m_pCodeArena;
+    m_pCodeArena = nullptr;
+
+    return pArena;
 }
 
 // =====================================================================================================================
@@ -675,13 +799,30 @@ Result PipelineUploader::UploadPipelineSections(
     size_t localOffset    = 0;
     while (bytesRemaining > 0)
     {
-        void* pEmbeddedData = nullptr;
-        size_t bytesCopied = m_pDevice->UploadUsingEmbeddedData(
-                                                        m_slotId,
-                                                        m_pGpuMemory,
-                                                        m_baseOffset + m_heapInvisUploadOffset,
-                                                        bytesRemaining,
-                                                        &pEmbeddedData);
+        void*  pEmbeddedData = nullptr;
+        size_t bytesCopied   = 0;
+
+        if (m_pBatch != nullptr)
+        {
+            result = m_pBatch->UploadUsingEmbeddedData(m_pGpuMemory,
+                                                       m_baseOffset + m_heapInvisUploadOffset,
+                                                       bytesRemaining,
+                                                       m_pagingFenceVal,
+                                                       &pEmbeddedData,
+                                                       &bytesCopied);
+            if (result != Result::Success)
+            {
+                break;
+            }
+        }
+        else
+        {
+            bytesCopied = m_pDevice->UploadUsingEmbeddedData(m_slotId,
+                                                             m_pGpuMemory,
+                                                             m_baseOffset + m_heapInvisUploadOffset,
+                                                             bytesRemaining,
+                                                             &pEmbeddedData);
+        }
 
         if (pChunks != nullptr)
         {
@@ -767,19 +908,37 @@ GpuHeap PipelineUploader::SelectUploadHeap(
 // Allocates GPU memory for the current pipeline.  Also, maps the memory for CPU access and uploads the pipeline code
 // and data.  The GPU virtual addresses for the code, data, and register segments are also computed.  The caller is
 // responsible for calling End() which unmaps the GPU memory.
+//
+// If pSharedCode is non-null and shader code deduplication is enabled, position-independent code sections are placed
+// in the device's ShaderCodeStore instead of this pipeline's allocation and the references taken on them are recorded
+// in pSharedCode.  The caller must release those references even if this function fails.
 Result PipelineUploader::Begin(
-    GpuHeap heap)
+    GpuHeap         heap,
+    SharedCodeRefs* pSharedCode)
 {
     const PalSettings& settings = m_pDevice->Settings();
     Result result = Result::Success;
 
+    if ((pSharedCode != nullptr) && (m_pDevice->GetShaderCodeStore()->IsEnabled() == false))
+    {
+        pSharedCode = nullptr;
+    }
+
     SectionAddressCalculator addressCalculator(m_pDevice->GetPlatform());
 
     const ElfReader::Reader& elfReader = m_abiReader.GetElfReader();
     for (ElfReader::SectionId i = 0; i < elfReader.GetNumSections(); i++)
     {
         const auto& section = elfReader.GetSection(i);
-        if (section.sh_flags & Elf::ShfAlloc)
+        if ((pSharedCode != nullptr)                                &&
+            ((section.sh_flags & Elf::ShfAlloc) != 0)               &&
+            ((section.sh_flags & Elf::ShfExecInstr) != 0)           &&
+            (m_numSharedSections < SharedCodeRefs::MaxSections)     &&
+            IsSharableCodeSection(i))
+        {
+            m_sharedSections[m_numSharedSections++] = i;
+        }
+        else if (section.sh_flags & Elf::ShfAlloc)
         {
             result = addressCalculator.AddSection(elfReader, i);
             if (result != Result::Success)
@@ -803,6 +962,29 @@ Result PipelineUploader::Begin(
 
         m_gpuMemSize = Max(m_gpuMemSize, minSafeSize);
 
+        // Pipelines created in a batch are packed into the batch's arenas instead of being suballocated individually.
+        if (m_pBatch != nullptr)
+        {
+            result = m_pBatch->AllocateCode(SelectUploadHeap(heap),
+                                            m_gpuMemSize,
+                                            GpuMemByteAlign,
+                                            &m_pCodeArena,
+                                            &m_pGpuMemory,
+                                            &m_baseOffset,
+                                            &m_pagingFenceVal);
+
+            // A pipeline too large for an arena gets its own suballocation below, which is freed as soon as the
+            // pipeline is destroyed, even if it fails before the batch is submitted.  Upload it through its own ring
+            // slot like an unbatched pipeline, so the batch's slot never holds a copy into memory which was freed.
+            if (m_pCodeArena == nullptr)
+            {
+                m_pBatch = nullptr;
+            }
+        }
+    }
+
+    if ((result == Result::Success) && (m_pGpuMemory == nullptr))
+    {
         GpuMemoryCreateInfo createInfo = { };
         createInfo.size      = m_gpuMemSize;
         createInfo.alignment = GpuMemByteAlign;
@@ -837,6 +1019,212 @@ Result PipelineUploader::Begin(
         m_prefetchGpuVirtAddr = (m_pGpuMemory->Desc().gpuVirtAddr + m_baseOffset);
     }
 
+    for (uint32 i = 0; (result == Result::Success) && (i < m_numSharedSections); i++)
+    {
+        result = AcquireSharedCode(m_sharedSections[i], pSharedCode);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Returns true if the given code section can be shared with other pipelines.  This requires that every relocation
+// applied to the section refers to a symbol within the section itself, so that the relocated code depends only on the
+// section contents and its own GPU virtual address.
+bool PipelineUploader::IsSharableCodeSection(
+    ElfReader::SectionId sectionId
+    ) const
+{
+    const ElfReader::Reader& elfReader = m_abiReader.GetElfReader();
+
+    bool sharable = true;
+    for (ElfReader::SectionId i = 0; sharable && (i < elfReader.GetNumSections()); i++)
+    {
+        const auto type = elfReader.GetSectionType(i);
+        if ((type == Elf::SectionHeaderType::Rel) || (type == Elf::SectionHeaderType::Rela))
+        {
+            const ElfReader::Relocations relocs(elfReader, i);
+            if (relocs.GetDestSection() == sectionId)
+            {
+                const ElfReader::Symbols symbols(elfReader, relocs.GetSymbolSection());
+                for (uint64 r = 0; r < relocs.GetNumRelocations(); r++)
+                {
+                    if (symbols.GetSymbol(relocs.GetRel(r).r_info.sym).st_shndx != sectionId)
+                    {
+                        sharable = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return sharable;
+}
+
+// =====================================================================================================================
+bool PipelineUploader::IsSharedSection(
+    ElfReader::SectionId sectionId
+    ) const
+{
+    bool shared = false;
+    for (uint32 i = 0; i < m_numSharedSections; i++)
+    {
+        if (m_sharedSections[i] == sectionId)
+        {
+            shared = true;
+            break;
+        }
+    }
+
+    return shared;
+}
+
+// =====================================================================================================================
+// Computes the content hash of a sharable code section.  The hash covers everything which determines the section's
+// contents after relocation: its size and alignment, its raw bytes, and each relocation applied to it.
+void PipelineUploader::HashCodeSection(
+    ElfReader::SectionId sectionId,
+    MetroHash::Hash*     pHash
+    ) const
+{
+    const ElfReader::Reader& elfReader = m_abiReader.GetElfReader();
+    const auto&              section   = elfReader.GetSection(sectionId);
+
+    MetroHash128 hasher;
+    hasher.Update(section.sh_size);
+    hasher.Update(section.sh_addralign);
+    hasher.Update(static_cast<const uint8*>(elfReader.GetSectionData(sectionId)), section.sh_size);
+
+    for (ElfReader::SectionId i = 0; i < elfReader.GetNumSections(); i++)
+    {
+        const auto type = elfReader.GetSectionType(i);
+        if ((type == Elf::SectionHeaderType::Rel) || (type == Elf::SectionHeaderType::Rela))
+        {
+            const ElfReader::Relocations relocs(elfReader, i);
+            if (relocs.GetDestSection() == sectionId)
+            {
+                const ElfReader::Symbols symbols(elfReader, relocs.GetSymbolSection());
+                for (uint64 r = 0; r < relocs.GetNumRelocations(); r++)
+                {
+                    const Elf::RelTableEntry& relocation = relocs.GetRel(r);
+
+                    hasher.Update(relocation.r_offset);
+                    hasher.Update(relocation.r_info.type);
+                    hasher.Update(symbols.GetSymbol(relocation.r_info.sym).st_value);
+                    if (relocs.IsRela())
+                    {
+                        hasher.Update(relocs.GetRela(r).r_addend);
+                    }
+                }
+            }
+        }
+    }
+
+    hasher.Finalize(pHash->bytes);
+}
+
+// =====================================================================================================================
+// Looks up or creates the shared copy of a code section and maps the section to it.
+Result PipelineUploader::AcquireSharedCode(
+    ElfReader::SectionId sectionId,
+    SharedCodeRefs*      pSharedCode)
+{
+    PAL_ASSERT(pSharedCode->count < SharedCodeRefs::MaxSections);
+
+    const ElfReader::Reader& elfReader = m_abiReader.GetElfReader();
+    const auto&              section   = elfReader.GetSection(sectionId);
+
+    MetroHash::Hash hash = {};
+    HashCodeSection(sectionId, &hash);
+
+    // Shared code gets the same prefetch padding as a pipeline allocation, since the SQ may prefetch past its end.
+    const gpusize size      = Pow2Align(section.sh_size, ShaderICacheLineSize) +
+                              m_pDevice->ChipProperties().gfxip.shaderPrefetchBytes;
+    const gpusize alignment = Max<gpusize>(GpuMemByteAlign, section.sh_addralign);
+
+    SharedCodeFillInfo fillInfo = { this, sectionId };
+
+    gpusize gpuVirtAddr    = 0;
+    uint64  pagingFenceVal = 0;
+
+    Result result = m_pDevice->GetShaderCodeStore()->Acquire(hash,
+                                                             size,
+                                                             alignment,
+                                                             &FillSharedCodeCb,
+                                                             &fillInfo,
+                                                             &gpuVirtAddr,
+                                                             &pagingFenceVal);
+
+    if (result == Result::Success)
+    {
+        pSharedCode->hashes[pSharedCode->count++] = hash;
+        m_pagingFenceVal = Max(m_pagingFenceVal, pagingFenceVal);
+
+        // If the code was already in the store, FillSharedCode() did not run and the section still needs to be mapped.
+        if ((m_memoryMap.FindSection(sectionId) == nullptr) &&
+            (m_memoryMap.AddSection(sectionId, gpuVirtAddr, elfReader.GetSectionData(sectionId)) == nullptr))
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result PipelineUploader::FillSharedCodeCb(
+    void*   pUserData,
+    void*   pCpuAddr,
+    gpusize gpuVirtAddr)
+{
+    const SharedCodeFillInfo*const pInfo = static_cast<const SharedCodeFillInfo*>(pUserData);
+
+    return pInfo->pUploader->FillSharedCode(pInfo->sectionId, pCpuAddr, gpuVirtAddr);
+}
+
+// =====================================================================================================================
+// Copies a code section into newly created shared GPU memory and applies its (section-local) relocations.  This runs
+// while the ShaderCodeStore still holds the section as pending, before any other pipeline can reference the memory.
+Result PipelineUploader::FillSharedCode(
+    ElfReader::SectionId sectionId,
+    void*                pCpuAddr,
+    gpusize              gpuVirtAddr)
+{
+    const ElfReader::Reader& elfReader    = m_abiReader.GetElfReader();
+    const void*              pSectionData = elfReader.GetSectionData(sectionId);
+    const uint64             sectionSize  = elfReader.GetSection(sectionId).sh_size;
+
+    Result result = Result::ErrorOutOfMemory;
+
+    SectionInfo*const pInfo = m_memoryMap.AddSection(sectionId, gpuVirtAddr, pSectionData);
+    if (pInfo != nullptr)
+    {
+        result = pInfo->AddCpuMappedChunk({pCpuAddr, sectionSize});
+    }
+
+    if (result == Result::Success)
+    {
+        memcpy(pCpuAddr, pSectionData, static_cast<size_t>(sectionSize));
+
+        for (ElfReader::SectionId i = 0; i < elfReader.GetNumSections(); i++)
+        {
+            const auto type = elfReader.GetSectionType(i);
+            if ((type == Elf::SectionHeaderType::Rel) || (type == Elf::SectionHeaderType::Rela))
+            {
+                const ElfReader::Relocations relocs(elfReader, i);
+                if (relocs.GetDestSection() == sectionId)
+                {
+                    result = ApplyRelocationSection(relocs);
+                    if (result != Result::Success)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
     return result;
 }
 
@@ -845,7 +1233,8 @@ Result PipelineUploader::UploadUsingDma(
     const SectionAddressCalculator& addressCalc,
     void**                          ppMappedPtr)
 {
-    Result result = m_pDevice->AcquireRingSlot(&m_slotId);
+    // Batched pipelines record their uploads into the batch's ring slot instead.
+    Result result = (m_pBatch != nullptr) ? Result::Success : m_pDevice->AcquireRingSlot(&m_slotId);
     if (result == Result::Success)
     {
         const gpusize gpuVirtAddr = (m_pGpuMemory->Desc().gpuVirtAddr + m_baseOffset);
@@ -977,6 +1366,13 @@ Result PipelineUploader::ApplyRelocations()
         }
 
         Util::ElfReader::Relocations relocs(m_abiReader.GetElfReader(), i);
+
+        // Shared code was already relocated when it was first added to the ShaderCodeStore.
+        if (IsSharedSection(relocs.GetDestSection()))
+        {
+            continue;
+        }
+
         result = ApplyRelocationSection(relocs);
         if (result != Result::Success)
         {
@@ -1131,10 +1527,14 @@ Result PipelineUploader::End(
                 PAL_ASSERT(m_pMappedPtr != nullptr);
                 result = UploadPipelineSections(m_pMappedPtr, dataRegisterAndPadding, nullptr);
             }
-            if (result == Result::Success)
+            if ((result == Result::Success) && (m_pBatch == nullptr))
             {
                 result = m_pDevice->SubmitDmaUploadRing(m_slotId, pCompletionFence, m_pagingFenceVal);
                 PAL_ASSERT(*pCompletionFence > 0);
+            }
+            // Batched pipelines are submitted by PipelineUploadBatch::End(), which also provides their fence token.
+            if (result == Result::Success)
+            {
                 PAL_SAFE_FREE(m_pMappedPtr, m_pDevice->GetPlatform());
             }
         }
@@ -30,6 +30,7 @@
 #include "core/device.h"
 #include "core/gpuMemory.h"
 #include "core/dmaUploadRing.h"
+#include "core/pipelineMetadataCache.h"
 #include "palElfPackager.h"
 #include "palElfReader.h"
 #include "palLib.h"
@@ -44,6 +45,8 @@ namespace Pal
 
 class CmdBuffer;
 class CmdStream;
+class PipelineCodeArena;
+class PipelineUploadBatch;
 class PipelineUploader;
 
 // Represents information about shader operations stored obtained as shader metadata flags during processing of shader
@@ -158,6 +161,9 @@ public:
     virtual const Util::HsaAbi::KernelArgument* GetKernelArgument(uint32 index) const override { return nullptr; }
 
     UploadFenceToken GetUploadFenceToken() const { return m_uploadFenceToken; }
+    // Pipelines created by IDevice::CreatePipelinesBatch() only learn their upload fence once the whole batch has
+    // been submitted.
+    void SetUploadFenceToken(UploadFenceToken token) { m_uploadFenceToken = Util::Max(m_uploadFenceToken, token); }
     uint64 GetPagingFenceVal() const { return m_pagingFenceVal; }
 
     bool IsTaskShaderEnabled() const { return (m_flags.taskShaderEnabled != 0); }
@@ -200,6 +206,14 @@ protected:
     size_t PerformanceDataSize(
         const Util::PalAbi::CodeObjectMetadata& metadata) const;
 
+    Result GetMetadata(
+        const void*                       pBinary,
+        size_t                            binarySize,
+        const AbiReader&                  abiReader,
+        Util::MsgPackReader*              pReader,
+        Util::PalAbi::CodeObjectMetadata* pMetadata);
+    void ReleaseMetadata();
+
     void SetTaskShaderEnabled() { m_flags.taskShaderEnabled = 1; }
     void SetDynamicDispatchSupported() { m_flags.supportDynamicDispatch = 1; }
 
@@ -220,6 +234,9 @@ protected:
     UploadFenceToken  m_uploadFenceToken;
     uint64            m_pagingFenceVal;
 
+    // Platform metadata cache entry for this pipeline's binary.  Only held while the pipeline is being initialized.
+    const PipelineMetadataEntry* m_pMetadataEntry;
+
 private:
     union
     {
@@ -236,6 +253,9 @@ private:
     BoundGpuMemory m_perfDataMem;
     gpusize        m_perfDataGpuMemSize;
 
+    SharedCodeRefs     m_sharedCode;  // Code sections shared with other pipelines through the device's ShaderCodeStore.
+    PipelineCodeArena* m_pCodeArena;  // Arena which m_gpuMem was allocated from, if created in a batch.
+
     PAL_DISALLOW_DEFAULT_CTOR(Pipeline);
     PAL_DISALLOW_COPY_AND_ASSIGN(Pipeline);
 };
@@ -247,6 +267,8 @@ struct SectionChunk
     // For host invisible memory, this is the address of the temporary CPU copy in the dma queue.
     void* pCpuMappedAddr;
     gpusize size;
+    // Offset of this chunk from the start of the section.  Filled in by SectionInfo::AddCpuMappedChunk.
+    gpusize sectionOffset;
 };
 
 // =====================================================================================================================
@@ -285,7 +307,7 @@ public:
     gpusize GetGpuVirtAddr() const { return m_gpuVirtAddr; }
     const void* GetCpuLocalAddr() const { return m_pCpuLocalAddr; }
 
-    Result AddCpuMappedChunk(const SectionChunk &chunk) { return m_chunks.PushBack(chunk); }
+    Result AddCpuMappedChunk(const SectionChunk &chunk);
 
 private:
     Util::ElfReader::SectionId m_sectionId;
@@ -309,7 +331,8 @@ public:
     template <typename Allocator>
     SectionMemoryMap(Allocator*const pAllocator) :
         m_allocator(pAllocator),
-        m_sections(&m_allocator)
+        m_sections(&m_allocator),
+        m_sectionIndices(&m_allocator)
     {}
 
     // The cpu mapped chunks have to be filled afterwards.
@@ -321,12 +344,22 @@ public:
 
     // Get the GPU virtual address of a section.
     // Returns null if the given section id was not found.
-    const SectionInfo* FindSection(Util::ElfReader::SectionId sectionId) const;
+    const SectionInfo* FindSection(Util::ElfReader::SectionId sectionId) const
+    {
+        return ((sectionId < m_sectionIndices.NumElements()) && (m_sectionIndices.At(sectionId) != InvalidIndex))
+               ? &m_sections.At(m_sectionIndices.At(sectionId))
+               : nullptr;
+    }
 
 private:
+    static constexpr uint32 InvalidIndex = UINT32_MAX;
+
     Util::IndirectAllocator m_allocator;
     // A pipeline usually has one or two sections that get uploaded to the GPU.
     Util::Vector<SectionInfo, 2, Util::IndirectAllocator> m_sections;
+    // Maps an ELF section index directly to its entry in m_sections, so that relocation processing does not have to
+    // search m_sections for every relocation.  Sections which are not mapped hold InvalidIndex.
+    Util::Vector<uint32, 16, Util::IndirectAllocator> m_sectionIndices;
 
     PAL_DISALLOW_COPY_AND_ASSIGN(SectionMemoryMap);
 };
@@ -381,12 +414,20 @@ public:
         const AbiReader& abiReader);
     virtual ~PipelineUploader();
 
-    Result Begin(GpuHeap heap);
+    Result Begin(
+        GpuHeap         heap,
+        SharedCodeRefs* pSharedCode = nullptr);
 
     Result ApplyRelocations();
 
     Result End(UploadFenceToken* pCompletionFence);
 
+    // Places this pipeline's GPU memory and DMA uploads in the given batch.  Must be called before Begin().
+    void SetUploadBatch(PipelineUploadBatch* pBatch) { m_pBatch = pBatch; }
+
+    // Transfers ownership of the uploader's reference on the code arena (if any) to the caller.
+    PipelineCodeArena* TakeCodeArena();
+
     GpuMemory* GpuMem() const { return m_pGpuMemory; }
     gpusize GpuMemSize() const { return m_gpuMemSize; }
     gpusize GpuMemOffset() const { return m_baseOffset; }
@@ -427,9 +468,30 @@ private:
     Result UploadUsingCpu(const SectionAddressCalculator& addressCalc, void** ppMappedPtr);
     Result UploadUsingDma(const SectionAddressCalculator& addressCalc, void** ppMappedPtr);
 
+    bool IsSharableCodeSection(Util::ElfReader::SectionId sectionId) const;
+    bool IsSharedSection(Util::ElfReader::SectionId sectionId) const;
+
+    void HashCodeSection(
+        Util::ElfReader::SectionId sectionId,
+        Util::MetroHash::Hash*     pHash) const;
+
+    Result AcquireSharedCode(
+        Util::ElfReader::SectionId sectionId,
+        SharedCodeRefs*            pSharedCode);
+
+    static Result FillSharedCodeCb(void* pUserData, void* pCpuAddr, gpusize gpuVirtAddr);
+
+    Result FillSharedCode(
+        Util::ElfReader::SectionId sectionId,
+        void*                      pCpuAddr,
+        gpusize                    gpuVirtAddr);
+
     Device*const m_pDevice;
     const AbiReader& m_abiReader;
 
+    PipelineUploadBatch* m_pBatch;
+    PipelineCodeArena*   m_pCodeArena;
+
     GpuMemory*  m_pGpuMemory;
     gpusize     m_baseOffset;
     gpusize     m_gpuMemSize;
@@ -439,6 +501,10 @@ private:
 
     SectionMemoryMap m_memoryMap;
 
+    // Code sections which are stored in the device's ShaderCodeStore instead of this pipeline's own allocation.
+    Util::ElfReader::SectionId m_sharedSections[SharedCodeRefs::MaxSections];
+    uint32                     m_numSharedSections;
+
     void*    m_pMappedPtr;
     uint64   m_pagingFenceVal;
 
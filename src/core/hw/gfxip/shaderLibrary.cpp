@@ -49,8 +49,12 @@ ShaderLibrary::ShaderLibrary(
     m_maxStackSizeInBytes(0),
     m_uploadFenceToken(0),
     m_pagingFenceVal(0),
+    m_pMetadataEntry(nullptr),
     m_perfDataMem(),
-    m_perfDataGpuMemSize(0)
+    m_perfDataGpuMemSize(0),
+    m_metadataOffset(0),
+    m_metadataSize(0),
+    m_metadataView(pDevice->GetPlatform())
 {
 }
 
@@ -102,13 +106,23 @@ Result ShaderLibrary::InitFromCodeObjectBinary(
     MsgPackReader              metadataReader;
     PalAbi::CodeObjectMetadata metadata;
 
+    PipelineMetadataCache*const pCache = m_pDevice->GetPlatform()->GetPipelineMetadataCache();
+
     if (result == Result::Success)
     {
-        result = abiReader.GetMetadata(&metadataReader, &metadata);
+        result = pCache->GetMetadata(m_pCodeObjectBinary,
+                                     m_codeObjectBinaryLen,
+                                     abiReader,
+                                     &metadataReader,
+                                     &metadata,
+                                     &m_pMetadataEntry);
     }
 
     if (result == Result::Success)
     {
+        m_metadataOffset = static_cast<uint32>(VoidPtrDiff(metadataReader.GetBuffer(), m_pCodeObjectBinary));
+        m_metadataSize   = metadataReader.GetSize();
+
         ExtractLibraryInfo(metadata);
 
         result = metadataReader.Seek(metadata.pipeline.shaderFunctions);
@@ -124,6 +138,33 @@ Result ShaderLibrary::InitFromCodeObjectBinary(
                 &metadataReader);
     }
 
+    pCache->Release(m_pMetadataEntry);
+    m_pMetadataEntry = nullptr;
+
+    return result;
+}
+
+// =====================================================================================================================
+// Returns a random-access view of this library's metadata blob, building its structural index on first use.  Only the
+// per-function statistics queries need it, so libraries which are never queried don't pay for the index.
+Result ShaderLibrary::GetMetadataView(
+    const MsgPackView** ppView
+    ) const
+{
+    MutexAuto lock(&m_metadataViewLock);
+
+    Result result = Result::Success;
+
+    if (m_metadataView.IsValid() == false)
+    {
+        result = m_metadataView.Init(VoidPtrInc(m_pCodeObjectBinary, m_metadataOffset), m_metadataSize);
+    }
+
+    if (result == Result::Success)
+    {
+        *ppView = &m_metadataView;
+    }
+
     return result;
 }
 
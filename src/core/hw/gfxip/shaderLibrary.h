@@ -26,6 +26,8 @@
 #pragma once
 
 #include "core/device.h"
+#include "palMsgPackView.h"
+#include "palMutex.h"
 #include "palShaderLibrary.h"
 #include "core/hw/gfxip/pipeline.h"
 
@@ -116,6 +118,8 @@ protected:
     Result ExtractShaderFunctions(
         Util::MsgPackReader* pReader);
 
+    Result GetMetadataView(const Util::MsgPackView** ppView) const;
+
     Device*const    m_pDevice;
 
     LibraryInfo     m_info;                  // Public info structure available to the client.
@@ -129,6 +133,9 @@ protected:
     UploadFenceToken  m_uploadFenceToken;
     uint64            m_pagingFenceVal;
 
+    // Platform metadata cache entry for this library's binary.  Only held while the library is being initialized.
+    const PipelineMetadataEntry* m_pMetadataEntry;
+
 private:
     Result InitFromCodeObjectBinary(
         const ShaderLibraryCreateInfo& createInfo);
@@ -138,6 +145,11 @@ private:
     BoundGpuMemory  m_perfDataMem;
     gpusize         m_perfDataGpuMemSize;
 
+    uint32                    m_metadataOffset;    // Location of the PAL metadata blob within m_pCodeObjectBinary.
+    uint32                    m_metadataSize;
+    mutable Util::MsgPackView m_metadataView;      // Random-access view of the metadata, built on first use.
+    mutable Util::Mutex       m_metadataViewLock;
+
     PAL_DISALLOW_DEFAULT_CTOR(ShaderLibrary);
     PAL_DISALLOW_COPY_AND_ASSIGN(ShaderLibrary);
 };
@@ -29,6 +29,8 @@
 #include "core/platform.h"
 #include "palBuddyAllocatorImpl.h"
 #include "palGpuMemoryBindable.h"
+#include "palHashMapImpl.h"
+#include "palIntrusiveListImpl.h"
 #include "palListImpl.h"
 #include "palSysMemory.h"
 #include <stdio.h>
@@ -41,40 +43,26 @@ namespace Pal
 static constexpr gpusize PoolAllocationSize       = 1ull << 22; // 4 megabytes
 static constexpr gpusize PoolMinSuballocationSize = 1ull << 4;  // 16 bytes
 
+// Number of buckets in the pool class and pool maps. Each device typically only has a handful of pool classes.
+static constexpr uint32  PoolClassMapBuckets      = 16;
+static constexpr uint32  PoolMapBuckets           = 64;
+
 // =====================================================================================================================
-// Determines whether a base allocation matches the requested parameters
-static bool IsMatchingPool(
-    const GpuMemoryPool&    pool,
-    bool                    readOnly,
-    GpuMemoryFlags          memFlags,
-    size_t                  heapCount,
-    const GpuHeap           (&heaps)[GpuHeapCount],
-    VaRange                 vaRange,
-    MType                   mtype)
+// Returns the free-space bucket which holds pools whose largest free block is the given size.
+static uint32 FreeBucketForBlockSize(
+    gpusize blockSize)
 {
-    bool matches = true;
-
-    if ((pool.memFlags.u64All == memFlags.u64All) &&
-        (pool.heapCount       == heapCount)       &&
-        (pool.readOnly        == readOnly)        &&
-        (pool.vaRange         == vaRange)         &&
-        (pool.mtype           == mtype))
-    {
-        for (uint32 h = 0; h < heapCount; ++h)
-        {
-            if (pool.heaps[h] != heaps[h])
-            {
-                matches = false;
-                break;
-            }
-        }
-    }
-    else
-    {
-        matches = false;
-    }
+    return (blockSize < PoolMinSuballocationSize) ? 0 : (Log2(blockSize) - Log2(PoolMinSuballocationSize) + 1);
+}
 
-    return matches;
+// =====================================================================================================================
+// Returns the first free-space bucket whose pools are all able to satisfy a suballocation of the given size and
+// alignment. This mirrors how the BuddyAllocator pads requests to a power-of-two block size.
+static uint32 FirstFreeBucketForRequest(
+    gpusize size,
+    gpusize alignment)
+{
+    return FreeBucketForBlockSize(Max(Pow2Pad(Max(size, alignment)), PoolMinSuballocationSize));
 }
 
 // =====================================================================================================================
@@ -127,10 +115,26 @@ InternalMemMgr::InternalMemMgr(
     Device* pDevice)
     :
     m_pDevice(pDevice),
-    m_poolList(pDevice->GetPlatform()),
+    m_poolClasses(PoolClassMapBuckets, pDevice->GetPlatform()),
+    m_pools(PoolMapBuckets, pDevice->GetPlatform()),
     m_references(pDevice->GetPlatform()),
     m_referenceWatermark(0)
 {
+    // The largest block a pool can hand out must land in the last free-space bucket.
+    PAL_ASSERT(FreeBucketForBlockSize(PoolAllocationSize / 2) == (GpuMemoryPoolFreeBuckets - 1));
+}
+
+// =====================================================================================================================
+Result InternalMemMgr::Init()
+{
+    Result result = m_poolClasses.Init();
+
+    if (result == Result::Success)
+    {
+        result = m_pools.Init();
+    }
+
+    return result;
 }
 
 // =====================================================================================================================
@@ -152,22 +156,35 @@ void InternalMemMgr::FreeAllocations()
         m_references.Erase(&it);
     }
 
-    while (m_poolList.NumElements() != 0)
+    for (auto it = m_poolClasses.Begin(); it.Get() != nullptr; it.Next())
     {
-        auto it = m_poolList.Begin();
+        GpuMemoryPoolClass* pPoolClass = it.Get()->value;
 
-        PAL_ASSERT((it.Get() != nullptr) && (it.Get()->pBuddyAllocator != nullptr));
+        for (uint32 bucket = 0; bucket < GpuMemoryPoolFreeBuckets; ++bucket)
+        {
+            while (pPoolClass->buckets[bucket].IsEmpty() == false)
+            {
+                GpuMemoryPool* pPool = pPoolClass->buckets[bucket].Front();
 
-        // Destroy the sub-allocator
-        PAL_DELETE(it.Get()->pBuddyAllocator, m_pDevice->GetPlatform());
+                PAL_ASSERT(pPool->pBuddyAllocator != nullptr);
 
-        // Remove the list entry
-        m_poolList.Erase(&it);
+                // Destroy the sub-allocator and remove the pool from its bucket
+                PAL_DELETE(pPool->pBuddyAllocator, m_pDevice->GetPlatform());
+                pPoolClass->buckets[bucket].Erase(&pPool->node);
+                PAL_DELETE(pPool, m_pDevice->GetPlatform());
+            }
+        }
+
+        PAL_DELETE(pPoolClass, m_pDevice->GetPlatform());
     }
+
+    m_poolClasses.Reset();
+    m_pools.Reset();
 }
 
 // =====================================================================================================================
-// Allocates GPU memory for internal use, ensures thread safety by acquiring the allocator lock.
+// Allocates GPU memory for internal use. The pools are protected by their own locks, so this doesn't need to acquire
+// the allocator lock.
 Result InternalMemMgr::AllocateGpuMem(
     const GpuMemoryCreateInfo&          createInfo,
     const GpuMemoryInternalCreateInfo&  internalInfo,
@@ -175,13 +192,11 @@ Result InternalMemMgr::AllocateGpuMem(
     GpuMemory**                         ppGpuMemory,
     gpusize*                            pOffset)
 {
-    Util::MutexAuto allocatorLock(&m_allocatorLock); // Ensure thread-safety using the lock
-
     return AllocateGpuMemNoAllocLock(createInfo, internalInfo, readOnly, ppGpuMemory, pOffset);
 }
 
 // =====================================================================================================================
-// Assuming the caller is already holding the allocator lock, this function will not use the lock.
+// Can be called with or without the allocator lock held; the pools are protected by their own locks.
 //
 // Allocates GPU memory for internal use. Depending on the type of memory object requested, the memory may be
 // sub-allocated from an existing allocation, or it might not.
@@ -235,131 +250,63 @@ Result InternalMemMgr::AllocateGpuMemNoAllocLock(
         (localCreateInfo.size      <= PoolAllocationSize / 2) &&
         (localCreateInfo.alignment <= PoolAllocationSize / 2))
     {
-        // Calculate GPU memory flags based on the creation information
-        const GpuMemoryFlags requestedMemFlags = ConvertGpuMemoryFlags(localCreateInfo, internalInfo);
-
-        result = Result::ErrorOutOfMemory;
-        // Try to find a base allocation of the appropriate type that has sufficient enough space
-        for (auto it = m_poolList.Begin(); it.Get() != nullptr; it.Next())
-        {
-            GpuMemoryPool* pPool = it.Get();
-
-            if (IsMatchingPool(*pPool,
-                               readOnly,
-                               requestedMemFlags,
-                               localCreateInfo.heapCount,
-                               localCreateInfo.heaps,
-                               localCreateInfo.vaRange,
-                               internalInfo.mtype))
-            {
-                // If the base allocation matches the search criteria then try to allocate from it
-                result = pPool->pBuddyAllocator->Allocate(localCreateInfo.size, localCreateInfo.alignment, pOffset);
+        // Look up the class of pools created with the same properties as this request
+        GpuMemoryPoolKey key;
+        memset(&key, 0, sizeof(key));
 
-                if (result == Result::Success)
-                {
-                    // If we found a free block, fill in the memory object pointer from the base allocation and
-                    // stop searching
-                    *ppGpuMemory = pPool->pGpuMemory;
-                    if (internalInfo.pPagingFence != nullptr)
-                    {
-                        *internalInfo.pPagingFence = pPool->pagingFenceVal;
-                    }
-                    break;
-                }
-            }
-        }
+        key.memFlags  = ConvertGpuMemoryFlags(localCreateInfo, internalInfo);
+        key.heapCount = localCreateInfo.heapCount;
+        key.vaRange   = localCreateInfo.vaRange;
+        key.mtype     = internalInfo.mtype;
+        key.readOnly  = readOnly;
 
-        if (result != Result::Success)
+        for (uint32 h = 0; h < localCreateInfo.heapCount; ++h)
         {
-            // None of the existing base allocations had a free block large enough for us so we need to create
-            // a new base allocation
-
-            // Fix-up the GPU memory create info structures to suit the base allocation's needs
-            GpuMemoryInternalCreateInfo localInternalInfo  = internalInfo;
-
-            const gpusize localCreateInfoAlignment = localCreateInfo.alignment;
-            const gpusize localCreateInfoSize = localCreateInfo.size;
-
-            localCreateInfo.size = PoolAllocationSize;
-            localCreateInfo.alignment = PoolAllocationSize / 2;
-            localInternalInfo.flags.buddyAllocated = 1;
+            key.heaps[h] = localCreateInfo.heaps[h];
+        }
 
-            GpuMemory* pGpuMemory = nullptr;
+        GpuMemoryPoolClass* pPoolClass = nullptr;
+        result = FindOrCreatePoolClass(key, &pPoolClass);
 
-            // Issue the base memory allocation
-            result = AllocateBaseGpuMem(localCreateInfo, localInternalInfo, readOnly, &pGpuMemory);
-            localCreateInfo.size = localCreateInfoSize;
-            localCreateInfo.alignment = localCreateInfoAlignment;
+        if (result == Result::Success)
+        {
+            MutexAuto poolClassLock(&pPoolClass->lock);
 
-            if (result == Result::Success)
+            // Any pool in a bucket at or above this one has a free block big enough for the request
+            GpuMemoryPool* pPool = nullptr;
+            for (uint32 bucket = FirstFreeBucketForRequest(localCreateInfo.size, localCreateInfo.alignment);
+                 bucket < GpuMemoryPoolFreeBuckets;
+                 ++bucket)
             {
-                // We need to add the newly allocated base allocation to the list
-                GpuMemoryPool newPool = {};
-
-                newPool.pGpuMemory = pGpuMemory;
-                newPool.readOnly   = readOnly;
-                newPool.memFlags   = requestedMemFlags;
-                newPool.heapCount  = localCreateInfo.heapCount;
-                newPool.vaRange    = localCreateInfo.vaRange;
-                newPool.mtype      = internalInfo.mtype;
-                if (internalInfo.pPagingFence != nullptr)
+                if (pPoolClass->buckets[bucket].IsEmpty() == false)
                 {
-                    newPool.pagingFenceVal = *internalInfo.pPagingFence;
+                    pPool = pPoolClass->buckets[bucket].Front();
+                    break;
                 }
+            }
 
-                for (uint32 h = 0; h < localCreateInfo.heapCount; ++h)
-                {
-                    newPool.heaps[h] = localCreateInfo.heaps[h];
-                }
+            if (pPool == nullptr)
+            {
+                // None of the existing base allocations had a free block large enough for us so we need to create
+                // a new base allocation
+                result = CreatePool(pPoolClass, localCreateInfo, internalInfo, readOnly, &pPool);
+            }
 
-                // Create and initialize the buddy allocator
-                newPool.pBuddyAllocator = PAL_NEW(BuddyAllocator<Platform>, m_pDevice->GetPlatform(), AllocInternal)
-                                          (m_pDevice->GetPlatform(), PoolAllocationSize, PoolMinSuballocationSize);
+            if (result == Result::Success)
+            {
+                // NOTE: The sub-allocation can only fail here in a low system memory situation because the pool is
+                // known to have a free block large enough.
+                result = pPool->pBuddyAllocator->Allocate(localCreateInfo.size, localCreateInfo.alignment, pOffset);
+            }
 
-                if (newPool.pBuddyAllocator != nullptr)
-                {
-                    // Try to initialize the buddy allocator
-                    result = newPool.pBuddyAllocator->Init();
-
-                    gpusize localOffset = 0;
-
-                    if (result == Result::Success)
-                    {
-                        // ... and then sub-allocate from it
-                        // NOTE: The sub-allocation should never fail here since we just optained a fresh base
-                        // allocation, the only possible case for failure is a low system memory situation
-                        result = newPool.pBuddyAllocator->Allocate(localCreateInfo.size,
-                                                                   localCreateInfo.alignment,
-                                                                   &localOffset);
-                    }
-
-                    // If we successfully sub-allocated from the new buddy allocator, then attempt to add the new pool
-                    // to the list
-                    if (result == Result::Success)
-                    {
-                        result = m_poolList.PushFront(newPool);
-                    }
-
-                    // Finally, if absolutely everything succeeded, return values to caller
-                    if (result == Result::Success)
-                    {
-                        *ppGpuMemory = pGpuMemory;
-                        *pOffset     = localOffset;
-                    }
-                }
-                else
-                {
-                    result = Result::ErrorOutOfMemory;
-                }
+            if (result == Result::Success)
+            {
+                UpdatePoolBucket(pPool);
 
-                // Undo any allocations if something went wrong
-                if (result != Result::Success)
+                *ppGpuMemory = pPool->pGpuMemory;
+                if (internalInfo.pPagingFence != nullptr)
                 {
-                    // Delete the buddy allocator if it exists.
-                    PAL_DELETE(newPool.pBuddyAllocator, m_pDevice->GetPlatform());
-
-                    // If there was a failure then release the base allocation
-                    FreeBaseGpuMem(pGpuMemory);
+                    *internalInfo.pPagingFence = pPool->pagingFenceVal;
                 }
             }
         }
@@ -383,6 +330,139 @@ Result InternalMemMgr::AllocateGpuMemNoAllocLock(
     return result;
 }
 
+// =====================================================================================================================
+// Finds the class of pools with the given properties, creating it if this is the first request for them.
+Result InternalMemMgr::FindOrCreatePoolClass(
+    const GpuMemoryPoolKey& key,
+    GpuMemoryPoolClass**    ppPoolClass)
+{
+    Result result = Result::Success;
+
+    {
+        RWLockAuto<RWLock::ReadOnly> poolMapLock(&m_poolMapLock);
+
+        GpuMemoryPoolClass*const* ppExisting = m_poolClasses.FindKey(key);
+        *ppPoolClass = (ppExisting != nullptr) ? *ppExisting : nullptr;
+    }
+
+    if (*ppPoolClass == nullptr)
+    {
+        RWLockAuto<RWLock::ReadWrite> poolMapLock(&m_poolMapLock);
+
+        // Another thread may have created the class since we released the read lock.
+        bool                  existed     = false;
+        GpuMemoryPoolClass**  ppMapEntry  = nullptr;
+        result = m_poolClasses.FindAllocate(key, &existed, &ppMapEntry);
+
+        if ((result == Result::Success) && (existed == false))
+        {
+            *ppMapEntry = PAL_NEW(GpuMemoryPoolClass, m_pDevice->GetPlatform(), AllocInternal);
+
+            if (*ppMapEntry == nullptr)
+            {
+                m_poolClasses.Erase(key);
+                result = Result::ErrorOutOfMemory;
+            }
+        }
+
+        if (result == Result::Success)
+        {
+            *ppPoolClass = *ppMapEntry;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Creates a new pool in the given class and puts it in the bucket for empty pools. The caller must hold the pool
+// class's lock.
+Result InternalMemMgr::CreatePool(
+    GpuMemoryPoolClass*                 pPoolClass,
+    const GpuMemoryCreateInfo&          createInfo,
+    const GpuMemoryInternalCreateInfo&  internalInfo,
+    bool                                readOnly,
+    GpuMemoryPool**                     ppPool)
+{
+    Result result = Result::ErrorOutOfMemory;
+
+    GpuMemoryPool* pPool = PAL_NEW(GpuMemoryPool, m_pDevice->GetPlatform(), AllocInternal)(pPoolClass);
+
+    if (pPool != nullptr)
+    {
+        // Fix-up the GPU memory create info structures to suit the base allocation's needs
+        GpuMemoryCreateInfo         localCreateInfo   = createInfo;
+        GpuMemoryInternalCreateInfo localInternalInfo = internalInfo;
+
+        localCreateInfo.size      = PoolAllocationSize;
+        localCreateInfo.alignment = PoolAllocationSize / 2;
+        localInternalInfo.flags.buddyAllocated = 1;
+
+        // Issue the base memory allocation
+        result = AllocateBaseGpuMem(localCreateInfo, localInternalInfo, readOnly, &pPool->pGpuMemory);
+    }
+
+    if (result == Result::Success)
+    {
+        if (internalInfo.pPagingFence != nullptr)
+        {
+            pPool->pagingFenceVal = *internalInfo.pPagingFence;
+        }
+
+        // Create and initialize the buddy allocator
+        pPool->pBuddyAllocator = PAL_NEW(BuddyAllocator<Platform>, m_pDevice->GetPlatform(), AllocInternal)
+                                 (m_pDevice->GetPlatform(), PoolAllocationSize, PoolMinSuballocationSize);
+
+        result = (pPool->pBuddyAllocator != nullptr) ? pPool->pBuddyAllocator->Init() : Result::ErrorOutOfMemory;
+    }
+
+    if (result == Result::Success)
+    {
+        // Record the pool against its base allocation so frees can find it directly
+        RWLockAuto<RWLock::ReadWrite> poolMapLock(&m_poolMapLock);
+
+        result = m_pools.Insert(pPool->pGpuMemory, pPool);
+    }
+
+    if (result == Result::Success)
+    {
+        pPool->freeBucket = FreeBucketForBlockSize(pPool->pBuddyAllocator->LargestFreeBlockSize());
+        pPoolClass->buckets[pPool->freeBucket].PushFront(&pPool->node);
+
+        *ppPool = pPool;
+    }
+    else if (pPool != nullptr)
+    {
+        // Undo any allocations if something went wrong
+        PAL_DELETE(pPool->pBuddyAllocator, m_pDevice->GetPlatform());
+
+        if (pPool->pGpuMemory != nullptr)
+        {
+            FreeBaseGpuMem(pPool->pGpuMemory);
+        }
+
+        PAL_DELETE(pPool, m_pDevice->GetPlatform());
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Moves a pool to the free-space bucket matching its largest free block after a suballocation or free. The caller must
+// hold the pool's class lock.
+void InternalMemMgr::UpdatePoolBucket(
+    GpuMemoryPool* pPool)
+{
+    const uint32 bucket = FreeBucketForBlockSize(pPool->pBuddyAllocator->LargestFreeBlockSize());
+
+    if (bucket != pPool->freeBucket)
+    {
+        pPool->pClass->buckets[pPool->freeBucket].Erase(&pPool->node);
+        pPool->pClass->buckets[bucket].PushFront(&pPool->node);
+        pPool->freeBucket = bucket;
+    }
+}
+
 // =====================================================================================================================
 // Allocates a base GPU memory object allocation.
 Result InternalMemMgr::AllocateBaseGpuMem(
@@ -480,23 +560,27 @@ Result InternalMemMgr::FreeGpuMem(
 
     if (pGpuMemory->WasBuddyAllocated())
     {
-        MutexAuto allocatorLock(&m_allocatorLock); // Ensure thread-safety using the lock
+        GpuMemoryPool* pPool = nullptr;
 
-        // Try to find the allocation in the pool list
-        for (auto it = m_poolList.Begin(); it.Get() != nullptr; it.Next())
         {
-            GpuMemoryPool* pPool = it.Get();
+            RWLockAuto<RWLock::ReadOnly> poolMapLock(&m_poolMapLock);
 
-            PAL_ASSERT((pPool->pGpuMemory != nullptr) && (pPool->pBuddyAllocator != nullptr));
+            GpuMemoryPool*const* ppPool = m_pools.FindKey(pGpuMemory);
+            pPool = (ppPool != nullptr) ? *ppPool : nullptr;
+        }
 
-            if (pPool->pGpuMemory == pGpuMemory)
-            {
-                // If found then use the buddy allocator to release the block
-                pPool->pBuddyAllocator->Free(offset);
+        // Pools live until FreeAllocations(), so the pool can be used after releasing the map lock.
+        if (pPool != nullptr)
+        {
+            MutexAuto poolClassLock(&pPool->pClass->lock);
 
-                result = Result::Success;
-                break;
-            }
+            PAL_ASSERT(pPool->pBuddyAllocator != nullptr);
+
+            // Use the buddy allocator to release the block
+            pPool->pBuddyAllocator->Free(offset);
+            UpdatePoolBucket(pPool);
+
+            result = Result::Success;
         }
 
         // If we didn't find the allocation in the pool list then something went wrong with the allocation scheme
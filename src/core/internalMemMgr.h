@@ -27,6 +27,10 @@
 
 #include "core/gpuMemory.h"
 #include "palBuddyAllocator.h"
+#include "palHashMap.h"
+#include "palHwHash.h"
+#include "palIntrusiveList.h"
+#include "palList.h"
 #include "palMutex.h"
 
 namespace Pal
@@ -42,20 +46,55 @@ struct GpuMemoryInfo
     bool            readOnly;
 };
 
-// Contains the information describing a GPU memory chunk pool
-struct GpuMemoryPool
+// Identifies a class of interchangeable GPU memory chunk pools. Every pool in a class was created with the same
+// properties, so any of them can satisfy a suballocation request with those properties. Unused bytes must be zero so
+// the key can be hashed and compared bytewise.
+struct GpuMemoryPoolKey
 {
-    GpuMemory*                      pGpuMemory;             // GPU memory object that the allocator suballocates from
-
-    bool                            readOnly;               // Tells whether the allocation is read-only
     GpuMemoryFlags                  memFlags;               // Properties of the GPU memory object
-    size_t                          heapCount;              // Number of heaps in the heap preference array
     GpuHeap                         heaps[GpuHeapCount];    // Heap preference array
+    uint32                          heapCount;              // Number of heaps in the heap preference array
     VaRange                         vaRange;                // Virtual address range
     MType                           mtype;                  // The mtype of the GPU memory object.
+    uint32                          readOnly;               // Tells whether the allocation is read-only
+};
+
+struct GpuMemoryPoolClass;
+
+// Contains the information describing a GPU memory chunk pool
+struct GpuMemoryPool
+{
+    explicit GpuMemoryPool(GpuMemoryPoolClass* pPoolClass)
+        :
+        pGpuMemory(nullptr),
+        pagingFenceVal(0),
+        pBuddyAllocator(nullptr),
+        pClass(pPoolClass),
+        freeBucket(0),
+        node(this)
+    { }
+
+    GpuMemory*                      pGpuMemory;             // GPU memory object that the allocator suballocates from
     uint64                          pagingFenceVal;         // Paging fence value
 
     Util::BuddyAllocator<Platform>* pBuddyAllocator;        // Buddy allocator used for the suballocation
+
+    GpuMemoryPoolClass*             pClass;                 // Class this pool belongs to
+    uint32                          freeBucket;             // Index of the free-space bucket holding this pool
+    Util::IntrusiveListNode<GpuMemoryPool> node;            // Node in the class's free-space bucket
+};
+
+// Number of free-space buckets in each pool class. Bucket zero holds full pools and bucket N holds pools whose
+// largest free block is (PoolMinSuballocationSize << (N - 1)) bytes, up to half of the pool size.
+constexpr uint32 GpuMemoryPoolFreeBuckets = 19;
+
+// A set of GPU memory chunk pools sharing the same GpuMemoryPoolKey. The pools are bucketed by the size of their
+// largest free block, so a suballocation takes the first pool in the first non-empty bucket big enough for it rather
+// than trying each pool in turn.
+struct GpuMemoryPoolClass
+{
+    Util::Mutex                         lock;                               // Serializes access to the pools
+    Util::IntrusiveList<GpuMemoryPool>  buckets[GpuMemoryPoolFreeBuckets];  // Pools bucketed by largest free block
 };
 
 // =====================================================================================================================
@@ -76,11 +115,11 @@ public:
     typedef Util::List<GpuMemoryInfo, Platform>         GpuMemoryList;
     typedef Util::ListIterator<GpuMemoryInfo, Platform> GpuMemoryListIterator;
 
-    typedef Util::List<GpuMemoryPool, Platform>         GpuMemoryPoolList;
-
     explicit InternalMemMgr(Device* pDevice);
     ~InternalMemMgr() { FreeAllocations(); }
 
+    Result Init();
+
     void FreeAllocations();
 
     Result AllocateGpuMem(
@@ -125,13 +164,41 @@ private:
     Result FreeBaseGpuMem(
         GpuMemory*  pGpuMemory);
 
+    Result FindOrCreatePoolClass(
+        const GpuMemoryPoolKey& key,
+        GpuMemoryPoolClass**    ppPoolClass);
+
+    Result CreatePool(
+        GpuMemoryPoolClass*                 pPoolClass,
+        const GpuMemoryCreateInfo&          createInfo,
+        const GpuMemoryInternalCreateInfo&  internalInfo,
+        bool                                readOnly,
+        GpuMemoryPool**                     ppPool);
+
+    static void UpdatePoolBucket(
+        GpuMemoryPool* pPool);
+
+    typedef Util::HashMap<GpuMemoryPoolKey,
+                          GpuMemoryPoolClass*,
+                          Platform,
+                          Util::Crc32cHashFunc> PoolClassMap;
+    typedef Util::HashMap<GpuMemory*, GpuMemoryPool*, Platform> PoolMap;
+
     Device*const        m_pDevice;
 
-    // Serialize access to the memory manager to ensure thread-safety
+    // Lets callers serialize a sequence of allocations, see CmdAllocator. The pools themselves are protected by
+    // m_poolMapLock and each pool class's own lock, so allocations from different pool classes don't contend.
     Util::Mutex         m_allocatorLock;
 
-    // Maintain a list of GPU memory objects that are sub-allocated
-    GpuMemoryPoolList   m_poolList;
+    // Serializes access to m_poolClasses and m_pools. A pool class's lock may be held while taking this lock, but a
+    // pool class's lock must never be taken while holding this one.
+    Util::RWLock        m_poolMapLock;
+
+    // Maps each set of suballocation properties to the pools created with them
+    PoolClassMap        m_poolClasses;
+
+    // Maps each pool's base GPU memory object to the pool, so frees don't have to search for it
+    PoolMap             m_pools;
 
     // Maintain a list of internal GPU memory references
     GpuMemoryList       m_references;
@@ -282,6 +282,12 @@ public:
         PlatformProperties* pProperties) override
         { return m_pNextLayer->GetProperties(pProperties); }
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    virtual Result GetPipelineMetadataCacheStats(
+        PipelineMetadataCacheStats* pStats) override
+        { return m_pNextLayer->GetPipelineMetadataCacheStats(pStats); }
+#endif
+
     // Part of the IDestroyable public interface.
     virtual void Destroy() override
     {
@@ -38,6 +38,7 @@
 #include "core/queueSemaphore.h"
 #include "core/device.h"
 #include "palAutoBuffer.h"
+#include "palFlatHashMapImpl.h"
 #include "palHashMapImpl.h"
 #include "palInlineFuncs.h"
 #include "palSettingsFileMgrImpl.h"
@@ -33,6 +33,7 @@
 #include "core/os/amdgpu/amdgpuScreen.h"
 #include "core/os/amdgpu/g_drmLoader.h"
 #include "core/svmMgr.h"
+#include "palFlatHashMap.h"
 #include "palHashMap.h"
 #include "palIntrusiveList.h"
 
@@ -1014,7 +1015,7 @@ private:
     static Result ParseClkInfo(const char* pFilePath, ClkInfo* pClkInfo, uint32* pCurIndex);
     Result        InitClkInfo();
 
-    typedef Util::HashMap<IGpuMemory*, uint32, Pal::Platform> MemoryRefMap;
+    typedef Util::FlatHashMap<IGpuMemory*, uint32, Pal::Platform> MemoryRefMap;
     MemoryRefMap m_globalRefMap;
     Util::Mutex  m_globalRefLock;
     static constexpr uint32 MemoryRefMapElements = 2048;
@@ -27,7 +27,7 @@
 
 #include "core/queue.h"
 #include "core/os/amdgpu/amdgpuHeaders.h"
-#include "palHashMap.h"
+#include "palFlatHashMap.h"
 #include "palVector.h"
 
 // It is a temporary solution while we are waiting for open source promotion.
@@ -66,9 +66,9 @@ enum class CommandListType : uint32
 // Maximum number of IB's we will specify in a single submission to the GPU.
 constexpr uint32 MaxIbsPerSubmit = 16;
 
-// Initial size of m_globalRefMap, the size of hashmap affects the performance of traversing the hashmap badly. When
-// perVmBo enabled, there is usually less than 3 presentable image in the m_globalRefMap. So set it 16 is enough for
-// most of the games when perVmBo enabled. When perVmBo disabled, set it 1024.
+// Initial capacity of m_globalRefMap. The map grows as needed, but traversing it costs time in proportion to its
+// capacity. When perVmBo enabled, there is usually less than 3 presentable image in the m_globalRefMap. So set it 16 is
+// enough for most of the games when perVmBo enabled. When perVmBo disabled, set it 1024.
 constexpr uint32 MemoryRefMapElementsPerVmBo = 16;
 constexpr uint32 MemoryRefMapElements        = 1024;
 
@@ -230,7 +230,7 @@ private:
         const InternalSubmitInfo& internalSubmitInfo);
 
     // Tracks global memory references for this queue. Each key is a GPU memory object and each value is a refcount.
-    typedef Util::HashMap<IGpuMemory*, uint32, Pal::Platform> MemoryRefMap;
+    typedef Util::FlatHashMap<IGpuMemory*, uint32, Pal::Platform> MemoryRefMap;
 
     // Kernel object representing a list of GPU memory allocations referenced by a submit.
     // Stored as a member variable to prevent re-creating the kernel object on every submit
@@ -49,6 +49,11 @@ VamMgr::VamMgr()
         m_vaRangeInfo[partIndex].allocatedVa     = nullptr;
         m_vaRangeInfo[partIndex].baseVirtualAddr = 0;
         m_vaRangeInfo[partIndex].size            = 0;
+
+        for (uint32 sizeClass = 0; sizeClass < VaCacheNumSizeClasses; sizeClass++)
+        {
+            m_vaCache[partIndex][sizeClass].count = 0;
+        }
     }
 }
 
@@ -148,6 +153,41 @@ Result VamMgr::AssignVirtualAddress(
     Pal::Device*               pDevice,
     const VirtAddrAssignInfo&  vaInfo,
     gpusize*                   pGpuVirtAddr)  // [in/out] In: Zero, or the desired VA. Out: The assigned VA.
+{
+    Result result = Result::ErrorOutOfGpuMemory;
+
+    // VAM takes a 32-bit alignment so the high part needs to be zero.
+    PAL_ASSERT(HighPart(vaInfo.alignment) == 0);
+
+    const uint32 sizeClass = VaCacheSizeClass(vaInfo.size);
+
+    // Ranges in the cache are size-aligned, so they can only be handed out if the caller has no particular VA in mind
+    // and doesn't need a stricter alignment.
+    if ((*pGpuVirtAddr == 0) && (sizeClass != InvalidVaCacheClass) && (vaInfo.alignment <= vaInfo.size))
+    {
+        result = AssignCachedVirtualAddress(vaInfo, sizeClass, pGpuVirtAddr);
+    }
+
+    if (result != Result::Success)
+    {
+        result = AllocVirtualAddress(vaInfo, pGpuVirtAddr);
+
+        if (result != Result::Success)
+        {
+            // The requested range may be held by the cache, or the cache may hold enough space to fit the request.
+            FlushVaCache(vaInfo.partition);
+            result = AllocVirtualAddress(vaInfo, pGpuVirtAddr);
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Allocates a GPU virtual address directly from VAM.
+Result VamMgr::AllocVirtualAddress(
+    const VirtAddrAssignInfo&  vaInfo,
+    gpusize*                   pGpuVirtAddr)  // [in/out] In: Zero, or the desired VA. Out: The assigned VA.
 {
     Result result = Result::Success;
 
@@ -158,9 +198,6 @@ Result VamMgr::AssignVirtualAddress(
     vamAllocIn.sizeInBytes    = vaInfo.size;
     vamAllocIn.alignment      = Max(LowPart(vaInfo.alignment), MinVamAllocAlignment);
 
-    // VAM takes a 32-bit alignment so the high part needs to be zero.
-    PAL_ASSERT(HighPart(vaInfo.alignment) == 0);
-
     vamAllocIn.hSection = m_hSection[static_cast<uint32>(vaInfo.partition)];
     PAL_ASSERT(vamAllocIn.hSection != nullptr);
 
@@ -185,6 +222,55 @@ Result VamMgr::AssignVirtualAddress(
     return result;
 }
 
+// =====================================================================================================================
+// Assigns a GPU virtual address from the VA cache, refilling the cache bin from VAM if it is empty.
+Result VamMgr::AssignCachedVirtualAddress(
+    const VirtAddrAssignInfo&  vaInfo,
+    uint32                     sizeClass,
+    gpusize*                   pGpuVirtAddr)
+{
+    Result      result = Result::Success;
+    VaCacheBin* pBin   = &m_vaCache[static_cast<uint32>(vaInfo.partition)][sizeClass];
+
+    MutexAuto binLock(&pBin->lock);
+
+    if (pBin->count == 0)
+    {
+        VAM_ALLOC_INPUT vamAllocIn = { };
+        vamAllocIn.sizeInBytes     = vaInfo.size;
+        vamAllocIn.alignment       = LowPart(vaInfo.size);
+        vamAllocIn.hSection        = m_hSection[static_cast<uint32>(vaInfo.partition)];
+        PAL_ASSERT(vamAllocIn.hSection != nullptr);
+
+        MutexAuto lock(&m_mutex);
+
+        for (uint32 i = 0; i < VaCacheBatchSize; i++)
+        {
+            VAM_ALLOC_OUTPUT vamAllocOut = { };
+
+            if (VAMAlloc(m_hVamInstance, &vamAllocIn, &vamAllocOut) != VAM_OK)
+            {
+                break;
+            }
+
+            PAL_ASSERT(vamAllocOut.actualSize == vamAllocIn.sizeInBytes);
+            pBin->gpuVirtAddr[pBin->count++] = vamAllocOut.virtualAddress;
+        }
+    }
+
+    if (pBin->count > 0)
+    {
+        *pGpuVirtAddr = pBin->gpuVirtAddr[--pBin->count];
+        PAL_ASSERT((vaInfo.alignment == 0) || IsPow2Aligned(*pGpuVirtAddr, vaInfo.alignment));
+    }
+    else
+    {
+        result = Result::ErrorOutOfGpuMemory;
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Unmaps a previously-allocated GPU virtual address described by the associated GPU memory object. This is called when
 // allocations are destroyed.
@@ -199,22 +285,128 @@ Result VamMgr::FreeVirtualAddress(
     PAL_ASSERT((pGpuMemory != nullptr) &&
                IsVamPartition(pGpuMemory->VirtAddrPartition()));
 
-    VAM_FREE_INPUT vamFreeIn = { };
-    vamFreeIn.virtualAddress = pGpuMemory->Desc().gpuVirtAddr;
-    vamFreeIn.actualSize     = pGpuMemory->Desc().size;
-    vamFreeIn.hSection       = m_hSection[static_cast<uint32>(pGpuMemory->VirtAddrPartition())];
-
-    MutexAuto lock(&m_mutex);
+    const VaPartition vaPartition = pGpuMemory->VirtAddrPartition();
+    const gpusize     gpuVirtAddr = pGpuMemory->Desc().gpuVirtAddr;
+    const gpusize     size        = pGpuMemory->Desc().size;
+    const uint32      sizeClass   = VaCacheSizeClass(size);
 
-    if (VAMFree(m_hVamInstance, &vamFreeIn) != VAM_OK)
+    // Only size-aligned ranges may be cached.  The ShadowDescriptorTable partition is never cached because all of its
+    // allocations request a specific VA.
+    if ((sizeClass != InvalidVaCacheClass)                  &&
+        (vaPartition != VaPartition::ShadowDescriptorTable) &&
+        IsPow2Aligned(gpuVirtAddr, size))
     {
-        PAL_ASSERT_ALWAYS();
-        result = Result::ErrorOutOfGpuMemory;
+        FreeCachedVirtualAddress(vaPartition, sizeClass, gpuVirtAddr);
+    }
+    else
+    {
+        VAM_FREE_INPUT vamFreeIn = { };
+        vamFreeIn.virtualAddress = gpuVirtAddr;
+        vamFreeIn.actualSize     = size;
+        vamFreeIn.hSection       = m_hSection[static_cast<uint32>(vaPartition)];
+
+        MutexAuto lock(&m_mutex);
+
+        if (VAMFree(m_hVamInstance, &vamFreeIn) != VAM_OK)
+        {
+            PAL_ASSERT_ALWAYS();
+            result = Result::ErrorOutOfGpuMemory;
+        }
     }
 
     return result;
 }
 
+// =====================================================================================================================
+// Returns a GPU virtual address to the VA cache. If the cache bin is full, a batch of its ranges is returned to VAM
+// first.
+void VamMgr::FreeCachedVirtualAddress(
+    VaPartition vaPartition,
+    uint32      sizeClass,
+    gpusize     gpuVirtAddr)
+{
+    VaCacheBin* pBin = &m_vaCache[static_cast<uint32>(vaPartition)][sizeClass];
+
+    MutexAuto binLock(&pBin->lock);
+
+    if (pBin->count == VaCacheDepth)
+    {
+        // Return the oldest ranges to VAM and keep the most recently freed ones.
+        FreeVaBatch(vaPartition, 1ull << (VaCacheMinSizeLog2 + sizeClass), &pBin->gpuVirtAddr[0], VaCacheBatchSize);
+
+        pBin->count -= VaCacheBatchSize;
+        memmove(&pBin->gpuVirtAddr[0],
+                &pBin->gpuVirtAddr[VaCacheBatchSize],
+                pBin->count * sizeof(pBin->gpuVirtAddr[0]));
+    }
+
+    pBin->gpuVirtAddr[pBin->count++] = gpuVirtAddr;
+}
+
+// =====================================================================================================================
+// Returns all ranges held by the VA cache of the given partition to VAM.
+void VamMgr::FlushVaCache(
+    VaPartition vaPartition)
+{
+    for (uint32 sizeClass = 0; sizeClass < VaCacheNumSizeClasses; sizeClass++)
+    {
+        VaCacheBin* pBin = &m_vaCache[static_cast<uint32>(vaPartition)][sizeClass];
+
+        MutexAuto binLock(&pBin->lock);
+
+        FreeVaBatch(vaPartition, 1ull << (VaCacheMinSizeLog2 + sizeClass), &pBin->gpuVirtAddr[0], pBin->count);
+        pBin->count = 0;
+    }
+}
+
+// =====================================================================================================================
+// Frees a batch of equally-sized GPU virtual address ranges in VAM with a single acquisition of m_mutex.
+void VamMgr::FreeVaBatch(
+    VaPartition    vaPartition,
+    gpusize        size,
+    const gpusize* pGpuVirtAddrs,
+    uint32         count)
+{
+    if (count > 0)
+    {
+        VAM_FREE_INPUT vamFreeIn = { };
+        vamFreeIn.actualSize     = size;
+        vamFreeIn.hSection       = m_hSection[static_cast<uint32>(vaPartition)];
+
+        MutexAuto lock(&m_mutex);
+
+        for (uint32 i = 0; i < count; i++)
+        {
+            vamFreeIn.virtualAddress = pGpuVirtAddrs[i];
+
+            if (VAMFree(m_hVamInstance, &vamFreeIn) != VAM_OK)
+            {
+                PAL_ASSERT_ALWAYS();
+            }
+        }
+    }
+}
+
+// =====================================================================================================================
+// Returns the VA cache size class of an allocation size, or InvalidVaCacheClass if ranges of this size aren't cached.
+uint32 VamMgr::VaCacheSizeClass(
+    gpusize size)
+{
+    uint32 sizeClass = InvalidVaCacheClass;
+
+    if (IsPowerOfTwo(size))
+    {
+        const uint32 sizeLog2 = Log2(size);
+
+        if ((sizeLog2 >= VaCacheMinSizeLog2) && (sizeLog2 < (VaCacheMinSizeLog2 + VaCacheNumSizeClasses)))
+        {
+            sizeClass = sizeLog2 - VaCacheMinSizeLog2;
+        }
+    }
+
+    return sizeClass;
+}
+
 // =====================================================================================================================
 // Creates a GPU memory object for a page table block.  This method is protected by VAM's use of m_vamSyncObj.
 Result VamMgr::AllocPageTableBlock(
@@ -253,6 +445,17 @@ bool VamMgr::IsVamPartition(
 Result VamMgr::Cleanup(
     Pal::Device* pDevice)
 {
+    if (m_hVamInstance != nullptr)
+    {
+        for (uint32 partIndex = 0; partIndex < static_cast<uint32>(VaPartition::Count); partIndex++)
+        {
+            if (m_hSection[partIndex] != nullptr)
+            {
+                FlushVaCache(static_cast<VaPartition>(partIndex));
+            }
+        }
+    }
+
     FreeReservedVaRanges(static_cast<Device*>(pDevice));
 
     return Pal::VamMgr::Cleanup(pDevice);
@@ -124,6 +124,32 @@ protected:
     void FreeReservedVaRanges(
         Device* pDevice);
 
+    Result AllocVirtualAddress(
+        const VirtAddrAssignInfo& vaInfo,
+        gpusize*                  pGpuVirtAddr);
+
+    Result AssignCachedVirtualAddress(
+        const VirtAddrAssignInfo& vaInfo,
+        uint32                    sizeClass,
+        gpusize*                  pGpuVirtAddr);
+
+    void FreeCachedVirtualAddress(
+        VaPartition vaPartition,
+        uint32      sizeClass,
+        gpusize     gpuVirtAddr);
+
+    void FlushVaCache(
+        VaPartition vaPartition);
+
+    void FreeVaBatch(
+        VaPartition    vaPartition,
+        gpusize        size,
+        const gpusize* pGpuVirtAddrs,
+        uint32         count);
+
+    static uint32 VaCacheSizeClass(
+        gpusize size);
+
     // VAM callbacks.
     static void*             VAM_STDCALL AllocSysMemCb(VAM_CLIENT_HANDLE hPal, uint32 sizeInBytes);
     static VAM_RETURNCODE    VAM_STDCALL FreeSysMemCb(VAM_CLIENT_HANDLE hPal, void* pAddress);
@@ -151,6 +177,24 @@ protected:
     SharedBoMap                   m_sharedBoMap;
 
     static constexpr uint32 InitialBoCount = 8;
+
+    // Small VA ranges are cached per partition and power-of-two size class so that frequently created and destroyed
+    // allocations neither serialize on m_mutex nor walk VAM's section allocator.  Cached ranges stay allocated in VAM;
+    // each bin is refilled from and returned to VAM in batches, under a single acquisition of m_mutex.
+    static constexpr uint32 VaCacheMinSizeLog2    = 12; // 4KB
+    static constexpr uint32 VaCacheNumSizeClasses = 10; // 4KB - 2MB
+    static constexpr uint32 VaCacheDepth          = 16; // Maximum number of cached ranges per bin.
+    static constexpr uint32 VaCacheBatchSize      = 8;  // Number of ranges allocated or freed at once.
+    static constexpr uint32 InvalidVaCacheClass   = UINT32_MAX;
+
+    struct VaCacheBin
+    {
+        Util::Mutex lock;                        // Must be acquired before m_mutex if both are needed.
+        uint32      count;                       // Number of valid entries in gpuVirtAddr.
+        gpusize     gpuVirtAddr[VaCacheDepth];
+    };
+
+    VaCacheBin m_vaCache[static_cast<uint32>(VaPartition::Count)][VaCacheNumSizeClasses];
 };
 
 // =====================================================================================================================
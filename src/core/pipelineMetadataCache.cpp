@@ -0,0 +1,337 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "core/pipelineMetadataCache.h"
+#include "core/platform.h"
+#include "palHashMapImpl.h"
+#include "palMsgPackImpl.h"
+#include "palSysUtil.h"
+
+using namespace Util;
+
+namespace Pal
+{
+
+// =====================================================================================================================
+PipelineMetadataCache::PipelineMetadataCache(
+    Platform* pPlatform)
+    :
+    m_pPlatform(pPlatform),
+    m_entries(NumBuckets, pPlatform),
+    m_useCounter(0)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+// =====================================================================================================================
+// Drops the cache's reference to every entry.  Pipelines only hold entries while they are being initialized, so every
+// entry should be freed here.
+PipelineMetadataCache::~PipelineMetadataCache()
+{
+    MutexAuto lock(&m_lock);
+
+    for (auto iter = m_entries.Begin(); iter.Get() != nullptr; iter.Next())
+    {
+        PipelineMetadataEntry* pEntry = iter.Get()->value;
+
+        PAL_ALERT(pEntry->m_refCount != 1);
+        ReleaseLocked(pEntry);
+    }
+
+    m_entries.Reset();
+}
+
+// =====================================================================================================================
+Result PipelineMetadataCache::Init()
+{
+    return m_entries.Init();
+}
+
+// =====================================================================================================================
+// Decodes the PAL ABI metadata of a pipeline binary, reusing the result of an earlier decode of the same binary when
+// possible.  On return, pReader is initialized over the binary's metadata blob so callers can still seek to offsets
+// recorded in pMetadata (e.g., the shader function map of a shader library).
+//
+// If ppEntry is non-null on return, the caller holds a reference to the cache entry and must return it via Release().
+// A null entry is not an error: it just means the metadata could not be cached and the caller must unpack any data
+// it needs from pReader itself.
+Result PipelineMetadataCache::GetMetadata(
+    const void*                   pBinary,
+    size_t                        binarySize,
+    const Abi::PipelineAbiReader& abiReader,
+    MsgPackReader*                pReader,
+    PalAbi::CodeObjectMetadata*   pMetadata,
+    const PipelineMetadataEntry** ppEntry)
+{
+    PAL_ASSERT((pBinary != nullptr) && (pReader != nullptr) && (pMetadata != nullptr) && (ppEntry != nullptr));
+
+    const int64 startTime = GetPerfCpuTime();
+
+    MetroHash::Hash key = {};
+    MetroHash128::Hash(static_cast<const uint8*>(pBinary), binarySize, &key.bytes[0]);
+
+    PipelineMetadataEntry* pEntry = nullptr;
+
+    {
+        MutexAuto lock(&m_lock);
+
+        PipelineMetadataEntry*const* ppFound = m_entries.FindKey(key);
+
+        if (ppFound != nullptr)
+        {
+            pEntry = *ppFound;
+            pEntry->m_refCount++;
+            pEntry->m_lastUse = ++m_useCounter;
+        }
+    }
+
+    const bool hit = (pEntry != nullptr);
+    Result     result = Result::Success;
+
+    if (hit)
+    {
+        memcpy(pMetadata, &pEntry->m_metadata, sizeof(PalAbi::CodeObjectMetadata));
+
+        if (pMetadata->pipeline.hasEntry.apiCreateInfo != 0)
+        {
+            pMetadata->pipeline.apiCreateInfo.pBuffer = VoidPtrInc(pBinary, pEntry->m_apiCreateInfoOffset);
+        }
+
+        result = pReader->InitFromBuffer(VoidPtrInc(pBinary, pEntry->m_msgPackOffset), pEntry->m_msgPackSize);
+    }
+    else
+    {
+        result = abiReader.GetMetadata(pReader, pMetadata);
+
+        // Failing to cache the metadata is not fatal; the caller simply has to unpack the registers itself.
+        if ((result == Result::Success) &&
+            (CreateEntry(key, pBinary, pReader, *pMetadata, &pEntry) == Result::Success))
+        {
+            Publish(&pEntry);
+        }
+    }
+
+    if ((result != Result::Success) && (pEntry != nullptr))
+    {
+        Release(pEntry);
+        pEntry = nullptr;
+    }
+
+    *ppEntry = pEntry;
+
+    const uint64 elapsed = static_cast<uint64>(GetPerfCpuTime() - startTime);
+
+    MutexAuto lock(&m_lock);
+
+    if (hit)
+    {
+        m_stats.hitCount++;
+        m_stats.hitTime += elapsed;
+    }
+    else
+    {
+        m_stats.missCount++;
+        m_stats.missTime += elapsed;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Builds a new, unpublished cache entry from freshly decoded metadata.  The caller holds the only reference to it.
+Result PipelineMetadataCache::CreateEntry(
+    const MetroHash::Hash&            key,
+    const void*                       pBinary,
+    MsgPackReader*                    pReader,
+    const PalAbi::CodeObjectMetadata& metadata,
+    PipelineMetadataEntry**           ppEntry)
+{
+    // Binaries without a register map are left to the uncached path so that they fail (or not) exactly as before.
+    Result result = (metadata.pipeline.hasEntry.registers != 0) ? Result::Success : Result::ErrorInvalidValue;
+
+    if (result == Result::Success)
+    {
+        result = pReader->Seek(metadata.pipeline.registers);
+    }
+
+    if (result == Result::Success)
+    {
+        result = (pReader->Type() == CWP_ITEM_MAP) ? Result::Success : Result::ErrorInvalidValue;
+    }
+
+    const uint32 numRegisters = (result == Result::Success) ? pReader->Get().as.map.size : 0;
+
+    PipelineMetadataEntry* pEntry = nullptr;
+
+    if (result == Result::Success)
+    {
+        const size_t entrySize = sizeof(PipelineMetadataEntry) + (numRegisters * sizeof(MetadataRegister));
+
+        pEntry = static_cast<PipelineMetadataEntry*>(PAL_MALLOC(entrySize, m_pPlatform, AllocInternal));
+        result = (pEntry != nullptr) ? Result::Success : Result::ErrorOutOfMemory;
+    }
+
+    if (result == Result::Success)
+    {
+        memset(pEntry, 0, sizeof(PipelineMetadataEntry));
+
+        pEntry->m_key           = key;
+        pEntry->m_metadata      = metadata;
+        pEntry->m_msgPackOffset = VoidPtrDiff(pReader->GetBuffer(), pBinary);
+        pEntry->m_msgPackSize   = pReader->GetSize();
+        pEntry->m_numRegisters  = numRegisters;
+        pEntry->m_pRegisters    = static_cast<MetadataRegister*>(VoidPtrInc(pEntry, sizeof(PipelineMetadataEntry)));
+        pEntry->m_refCount      = 1;
+
+        // The API create info lives inside the binary, so store its location relative to the binary instead of the
+        // pointer into this particular copy of it.
+        if (metadata.pipeline.hasEntry.apiCreateInfo != 0)
+        {
+            pEntry->m_apiCreateInfoOffset = VoidPtrDiff(metadata.pipeline.apiCreateInfo.pBuffer, pBinary);
+            pEntry->m_metadata.pipeline.apiCreateInfo.pBuffer = nullptr;
+        }
+
+        for (uint32 i = 0; (result == Result::Success) && (i < numRegisters); ++i)
+        {
+            result = pReader->UnpackNextPair(&pEntry->m_pRegisters[i].offset, &pEntry->m_pRegisters[i].value);
+        }
+
+        if (result != Result::Success)
+        {
+            PAL_SAFE_FREE(pEntry, m_pPlatform);
+        }
+    }
+
+    *ppEntry = pEntry;
+
+    return result;
+}
+
+// =====================================================================================================================
+// Inserts a new entry into the cache.  If another thread published the same binary in the meantime, the new entry is
+// discarded and *ppEntry is replaced with a reference to the existing one.  If the entry cannot be inserted, it is
+// left unpublished and is freed once the caller releases it.
+void PipelineMetadataCache::Publish(
+    PipelineMetadataEntry** ppEntry)
+{
+    PipelineMetadataEntry* pEntry = *ppEntry;
+
+    MutexAuto lock(&m_lock);
+
+    PipelineMetadataEntry** ppFound = m_entries.FindKey(pEntry->m_key);
+
+    if (ppFound != nullptr)
+    {
+        ReleaseLocked(pEntry);
+
+        pEntry = *ppFound;
+        pEntry->m_refCount++;
+    }
+    else
+    {
+        if (m_entries.GetNumEntries() >= MaxEntries)
+        {
+            EvictOne();
+        }
+
+        bool                    existed = false;
+        PipelineMetadataEntry** ppSlot  = nullptr;
+
+        if (m_entries.FindAllocate(pEntry->m_key, &existed, &ppSlot) == Result::Success)
+        {
+            PAL_ASSERT(existed == false);
+
+            *ppSlot = pEntry;
+            pEntry->m_refCount++;
+        }
+    }
+
+    pEntry->m_lastUse = ++m_useCounter;
+
+    *ppEntry = pEntry;
+}
+
+// =====================================================================================================================
+// Removes the least recently used entry from the cache.  Entries which are still in use by a pipeline stay alive until
+// that pipeline releases them.  The cache lock must be held by the caller.
+void PipelineMetadataCache::EvictOne()
+{
+    PipelineMetadataEntry* pVictim = nullptr;
+
+    for (auto iter = m_entries.Begin(); iter.Get() != nullptr; iter.Next())
+    {
+        PipelineMetadataEntry* pEntry = iter.Get()->value;
+
+        if ((pVictim == nullptr) || (pEntry->m_lastUse < pVictim->m_lastUse))
+        {
+            pVictim = pEntry;
+        }
+    }
+
+    if (pVictim != nullptr)
+    {
+        m_entries.Erase(pVictim->m_key);
+        ReleaseLocked(pVictim);
+
+        m_stats.evictionCount++;
+    }
+}
+
+// =====================================================================================================================
+// Returns a reference obtained from GetMetadata().
+void PipelineMetadataCache::Release(
+    const PipelineMetadataEntry* pEntry)
+{
+    if (pEntry != nullptr)
+    {
+        MutexAuto lock(&m_lock);
+        ReleaseLocked(const_cast<PipelineMetadataEntry*>(pEntry));
+    }
+}
+
+// =====================================================================================================================
+// Drops one reference to an entry, freeing it when no references remain.  The cache lock must be held by the caller.
+void PipelineMetadataCache::ReleaseLocked(
+    PipelineMetadataEntry* pEntry)
+{
+    PAL_ASSERT(pEntry->m_refCount > 0);
+
+    if (--pEntry->m_refCount == 0)
+    {
+        PAL_FREE(pEntry, m_pPlatform);
+    }
+}
+
+// =====================================================================================================================
+void PipelineMetadataCache::GetStats(
+    PipelineMetadataCacheStats* pStats)
+{
+    MutexAuto lock(&m_lock);
+
+    *pStats            = m_stats;
+    pStats->entryCount = m_entries.GetNumEntries();
+}
+
+} // Pal
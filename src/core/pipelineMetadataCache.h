@@ -0,0 +1,163 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "palHashMap.h"
+#include "palHwHash.h"
+#include "palMetroHash.h"
+#include "palMsgPack.h"
+#include "palMutex.h"
+#include "palPipelineAbiReader.h"
+#include "palPlatform.h"
+
+namespace Pal
+{
+
+class Platform;
+
+// A single register address/value pair from a pipeline's metadata register map.
+struct MetadataRegister
+{
+    uint32 offset;
+    uint32 value;
+};
+
+// =====================================================================================================================
+// One decoded PAL ABI metadata blob.  An entry is immutable once it has been published to the cache, so any number of
+// pipelines may read it concurrently while they hold a reference.
+class PipelineMetadataEntry
+{
+public:
+    uint32                  NumRegisters() const { return m_numRegisters; }
+    const MetadataRegister* Registers()    const { return m_pRegisters; }
+
+private:
+    friend class PipelineMetadataCache;
+
+    Util::MetroHash::Hash            m_key;
+    Util::PalAbi::CodeObjectMetadata m_metadata;         // pipeline.apiCreateInfo.pBuffer is not valid here.
+    size_t                           m_apiCreateInfoOffset;
+    size_t                           m_msgPackOffset;    // Location of the metadata blob within the binary.
+    uint32                           m_msgPackSize;
+    uint32                           m_numRegisters;
+    MetadataRegister*                m_pRegisters;       // Points into the same allocation as this entry.
+    uint32                           m_refCount;         // The cache itself holds one reference while published.
+    uint64                           m_lastUse;
+};
+
+// =====================================================================================================================
+// Platform-wide cache of decoded pipeline metadata, keyed by a hash of the entire pipeline ELF.  Decoding the MsgPack
+// metadata note and its register map is a large part of the CPU cost of pipeline creation, and applications commonly
+// create the same binary many times (on several devices, or after a client-side pipeline cache hit).  A repeat
+// creation copies the decoded metadata out of the cache instead of decoding it again.
+//
+// Only data derived purely from the binary is cached.  Anything that also depends on the create info (such as the
+// PM4 images built by the hardware layers) is still computed per pipeline.
+class PipelineMetadataCache
+{
+public:
+    explicit PipelineMetadataCache(Platform* pPlatform);
+    ~PipelineMetadataCache();
+
+    Result Init();
+
+    Result GetMetadata(
+        const void*                         pBinary,
+        size_t                              binarySize,
+        const Util::Abi::PipelineAbiReader& abiReader,
+        Util::MsgPackReader*                pReader,
+        Util::PalAbi::CodeObjectMetadata*   pMetadata,
+        const PipelineMetadataEntry**       ppEntry);
+
+    void Release(const PipelineMetadataEntry* pEntry);
+
+    void GetStats(PipelineMetadataCacheStats* pStats);
+
+private:
+    // Upper bound on the number of cached binaries.  Entries are small (a few KB), so this mostly bounds how much
+    // memory is spent on binaries which are only ever created once.
+    static constexpr uint32 MaxEntries = 512;
+    static constexpr uint32 NumBuckets = 128;
+
+    typedef Util::HashMap<Util::MetroHash::Hash, PipelineMetadataEntry*, Platform, Util::Crc32cHashFunc> EntryMap;
+
+    Result CreateEntry(
+        const Util::MetroHash::Hash&            key,
+        const void*                             pBinary,
+        Util::MsgPackReader*                    pReader,
+        const Util::PalAbi::CodeObjectMetadata& metadata,
+        PipelineMetadataEntry**                 ppEntry);
+
+    void Publish(PipelineMetadataEntry** ppEntry);
+    void EvictOne();
+    void ReleaseLocked(PipelineMetadataEntry* pEntry);
+
+    Platform*const             m_pPlatform;
+    EntryMap                   m_entries;
+    Util::Mutex                m_lock;
+    uint64                     m_useCounter;
+    PipelineMetadataCacheStats m_stats;
+
+    PAL_DISALLOW_DEFAULT_CTOR(PipelineMetadataCache);
+    PAL_DISALLOW_COPY_AND_ASSIGN(PipelineMetadataCache);
+};
+
+// =====================================================================================================================
+// Fills a hardware layer's register vector from a pipeline's metadata.  When the metadata came from the cache, the
+// pre-decoded register list is used; otherwise the register map is unpacked from the MsgPack blob as before.
+template <typename RegisterVector>
+Result UnpackMetadataRegisters(
+    const PipelineMetadataEntry*            pEntry,
+    Util::MsgPackReader*                    pReader,
+    const Util::PalAbi::CodeObjectMetadata& metadata,
+    RegisterVector*                         pRegisters)
+{
+    Result result = Result::Success;
+
+    if (pEntry != nullptr)
+    {
+        result = pRegisters->Reserve(pRegisters->NumElements() + pEntry->NumRegisters());
+
+        const MetadataRegister* pRegs = pEntry->Registers();
+        for (uint32 i = 0; (result == Result::Success) && (i < pEntry->NumRegisters()); ++i)
+        {
+            result = pRegisters->Insert(pRegs[i].offset, pRegs[i].value);
+        }
+    }
+    else
+    {
+        result = pReader->Seek(metadata.pipeline.registers);
+
+        if (result == Result::Success)
+        {
+            result = pReader->Unpack(pRegisters);
+        }
+    }
+
+    return result;
+}
+
+} // Pal
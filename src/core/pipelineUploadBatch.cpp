@@ -0,0 +1,305 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "core/device.h"
+#include "core/gpuMemory.h"
+#include "core/platform.h"
+#include "core/pipelineUploadBatch.h"
+
+using namespace Util;
+
+namespace Pal
+{
+
+// GPU memory alignment for pipeline code arenas.  Matches the alignment of individually allocated pipelines.
+constexpr gpusize ArenaByteAlign = 256;
+
+// =====================================================================================================================
+PipelineCodeArena::PipelineCodeArena(
+    Device* pDevice,
+    GpuHeap heap)
+    :
+    m_pDevice(pDevice),
+    m_heap(heap),
+    m_pGpuMemory(nullptr),
+    m_baseOffset(0),
+    m_size(0),
+    m_usedSize(0),
+    m_pagingFenceVal(0),
+    m_refCount(1),
+    m_pNextFull(nullptr)
+{
+}
+
+// =====================================================================================================================
+PipelineCodeArena::~PipelineCodeArena()
+{
+    if (m_pGpuMemory != nullptr)
+    {
+        m_pDevice->MemMgr()->FreeGpuMem(m_pGpuMemory, m_baseOffset);
+        m_pGpuMemory = nullptr;
+    }
+}
+
+// =====================================================================================================================
+// Creates a new arena of the given size.  The caller owns the initial reference to the arena.
+Result PipelineCodeArena::Create(
+    Device*             pDevice,
+    GpuHeap             heap,
+    gpusize             size,
+    PipelineCodeArena** ppArena)
+{
+    Result result = Result::ErrorOutOfMemory;
+
+    PipelineCodeArena* pArena = PAL_NEW(PipelineCodeArena, pDevice->GetPlatform(), AllocInternal)(pDevice, heap);
+    if (pArena != nullptr)
+    {
+        result = pArena->Init(size);
+
+        if (result == Result::Success)
+        {
+            *ppArena = pArena;
+        }
+        else
+        {
+            pArena->Release();
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result PipelineCodeArena::Init(
+    gpusize size)
+{
+    GpuMemoryCreateInfo createInfo = { };
+    createInfo.size      = size;
+    createInfo.alignment = ArenaByteAlign;
+    createInfo.vaRange   = VaRange::DescriptorTable;
+    createInfo.heaps[0]  = m_heap;
+    createInfo.heaps[1]  = GpuHeapGartUswc;
+    createInfo.heapCount = 2;
+    createInfo.priority  = GpuMemPriority::High;
+
+    GpuMemoryInternalCreateInfo internalInfo = { };
+    internalInfo.flags.alwaysResident = 1;
+    internalInfo.pPagingFence         = &m_pagingFenceVal;
+
+    const Result result =
+        m_pDevice->MemMgr()->AllocateGpuMem(createInfo, internalInfo, false, &m_pGpuMemory, &m_baseOffset);
+
+    if (result == Result::Success)
+    {
+        m_size = size;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Carves a block out of the unused end of the arena.  On success, the returned offset is relative to Memory() and the
+// caller owns a new reference to the arena.
+bool PipelineCodeArena::Allocate(
+    gpusize  size,
+    gpusize  alignment,
+    gpusize* pOffset)
+{
+    const gpusize offset  = Pow2Align(m_baseOffset + m_usedSize, alignment) - m_baseOffset;
+    const bool    success = ((offset + size) <= m_size);
+
+    if (success)
+    {
+        m_usedSize = offset + size;
+        *pOffset   = m_baseOffset + offset;
+        AddRef();
+    }
+
+    return success;
+}
+
+// =====================================================================================================================
+void PipelineCodeArena::Release()
+{
+    if (AtomicDecrement(&m_refCount) == 0)
+    {
+        Platform*const pPlatform = m_pDevice->GetPlatform();
+        this->~PipelineCodeArena();
+        PAL_FREE(this, pPlatform);
+    }
+}
+
+// =====================================================================================================================
+PipelineUploadBatch::PipelineUploadBatch(
+    Device* pDevice)
+    :
+    m_pDevice(pDevice),
+    m_pFullArenas(nullptr),
+    m_hasRingSlot(false),
+    m_ringSlot(0),
+    m_pagingFenceVal(0)
+{
+    memset(&m_pArena[0], 0, sizeof(m_pArena));
+}
+
+// =====================================================================================================================
+PipelineUploadBatch::~PipelineUploadBatch()
+{
+    PAL_ASSERT(m_hasRingSlot == false); // If this fires, the caller forgot to call End()!
+
+    ReleaseArenas();
+}
+
+// =====================================================================================================================
+// Drops the batch's references to its arenas.  Each arena stays alive until its last pipeline is destroyed.
+void PipelineUploadBatch::ReleaseArenas()
+{
+    for (uint32 heap = 0; heap < GpuHeapCount; heap++)
+    {
+        if (m_pArena[heap] != nullptr)
+        {
+            m_pArena[heap]->Release();
+            m_pArena[heap] = nullptr;
+        }
+    }
+
+    while (m_pFullArenas != nullptr)
+    {
+        PipelineCodeArena*const pArena = m_pFullArenas;
+
+        m_pFullArenas = pArena->NextFull();
+        pArena->Release();
+    }
+}
+
+// =====================================================================================================================
+// Allocates GPU memory for a pipeline from the batch's current arena in the given heap, starting a new arena if needed.
+// Each heap has its own arena, so batches which mix heaps don't abandon partially filled arenas.  If the pipeline
+// is too large to ever fit in an arena, this succeeds without returning an arena and the caller should allocate and
+// upload the pipeline's memory itself, outside of the batch.
+Result PipelineUploadBatch::AllocateCode(
+    GpuHeap             heap,
+    gpusize             size,
+    gpusize             alignment,
+    PipelineCodeArena** ppArena,
+    GpuMemory**         ppGpuMemory,
+    gpusize*            pOffset,
+    uint64*             pPagingFenceVal)
+{
+    Result result = Result::Success;
+    *ppArena = nullptr;
+
+    if ((size <= ArenaSize) && (alignment <= ArenaByteAlign))
+    {
+        MutexAuto lock(&m_lock);
+
+        PipelineCodeArena** ppHeapArena = &m_pArena[heap];
+
+        bool allocated = (*ppHeapArena != nullptr) && (*ppHeapArena)->Allocate(size, alignment, pOffset);
+
+        if (allocated == false)
+        {
+            PipelineCodeArena* pNewArena = nullptr;
+            result = PipelineCodeArena::Create(m_pDevice, heap, ArenaSize, &pNewArena);
+
+            if (result == Result::Success)
+            {
+                // Every pipeline placed in the old arena may still fail and be destroyed before End(), which would
+                // free the arena while the ring slot still holds copies into it.
+                if (*ppHeapArena != nullptr)
+                {
+                    (*ppHeapArena)->SetNextFull(m_pFullArenas);
+                    m_pFullArenas = *ppHeapArena;
+                }
+
+                *ppHeapArena = pNewArena;
+                allocated    = pNewArena->Allocate(size, alignment, pOffset);
+                PAL_ASSERT(allocated);
+            }
+        }
+
+        if (result == Result::Success)
+        {
+            *ppArena         = *ppHeapArena;
+            *ppGpuMemory     = (*ppHeapArena)->Memory();
+            *pPagingFenceVal = (*ppHeapArena)->PagingFenceVal();
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Records DMA upload commands into the batch's ring slot, acquiring the slot on first use.  See
+// DmaUploadRing::UploadUsingEmbeddedData() for details.
+Result PipelineUploadBatch::UploadUsingEmbeddedData(
+    GpuMemory* pDst,
+    gpusize    dstOffset,
+    size_t     bytes,
+    uint64     pagingFenceVal,
+    void**     ppEmbeddedData,
+    size_t*    pBytesCopied)
+{
+    MutexAuto lock(&m_lock);
+
+    Result result = Result::Success;
+
+    if (m_hasRingSlot == false)
+    {
+        result        = m_pDevice->AcquireRingSlot(&m_ringSlot);
+        m_hasRingSlot = (result == Result::Success);
+    }
+
+    if (result == Result::Success)
+    {
+        *pBytesCopied    = m_pDevice->UploadUsingEmbeddedData(m_ringSlot, pDst, dstOffset, bytes, ppEmbeddedData);
+        m_pagingFenceVal = Max(m_pagingFenceVal, pagingFenceVal);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Submits all of the DMA uploads recorded by the batch's pipelines.  pCompletionFence is left untouched if none of the
+// pipelines needed a DMA upload.
+Result PipelineUploadBatch::End(
+    UploadFenceToken* pCompletionFence)
+{
+    MutexAuto lock(&m_lock);
+
+    Result result = Result::Success;
+
+    if (m_hasRingSlot)
+    {
+        result = m_pDevice->SubmitDmaUploadRing(m_ringSlot, pCompletionFence, m_pagingFenceVal);
+        m_hasRingSlot = false;
+    }
+
+    ReleaseArenas();
+
+    return result;
+}
+
+} // Pal
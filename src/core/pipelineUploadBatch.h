@@ -0,0 +1,134 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "core/dmaUploadRing.h"
+#include "palMutex.h"
+
+namespace Pal
+{
+
+class Device;
+class GpuMemory;
+
+// =====================================================================================================================
+// A large block of GPU memory which the pipelines created by one IDevice::CreatePipelinesBatch() call are packed into,
+// instead of each pipeline getting its own InternalMemMgr suballocation.  Space is handed out linearly and never reused;
+// the arena is reference counted and freed once every pipeline placed in it has been destroyed and the batch which
+// filled it has submitted its uploads.
+class PipelineCodeArena
+{
+public:
+    static Result Create(
+        Device*             pDevice,
+        GpuHeap             heap,
+        gpusize             size,
+        PipelineCodeArena** ppArena);
+
+    // Not thread-safe; the owning PipelineUploadBatch serializes calls.
+    bool Allocate(gpusize size, gpusize alignment, gpusize* pOffset);
+
+    void AddRef() { Util::AtomicIncrement(&m_refCount); }
+    void Release();
+
+    GpuMemory* Memory() const { return m_pGpuMemory; }
+    GpuHeap    Heap() const { return m_heap; }
+    uint64     PagingFenceVal() const { return m_pagingFenceVal; }
+
+    // Links full arenas which the owning PipelineUploadBatch keeps alive until its uploads have been submitted.
+    PipelineCodeArena* NextFull() const { return m_pNextFull; }
+    void SetNextFull(PipelineCodeArena* pNext) { m_pNextFull = pNext; }
+
+private:
+    PipelineCodeArena(Device* pDevice, GpuHeap heap);
+    ~PipelineCodeArena();
+
+    Result Init(gpusize size);
+
+    Device*const       m_pDevice;
+    const GpuHeap      m_heap;
+    GpuMemory*         m_pGpuMemory;
+    gpusize            m_baseOffset;      // Offset of the arena within m_pGpuMemory.
+    gpusize            m_size;
+    gpusize            m_usedSize;
+    uint64             m_pagingFenceVal;
+    volatile uint32    m_refCount;
+    PipelineCodeArena* m_pNextFull;       // Next arena in the owning batch's list of full arenas.
+
+    PAL_DISALLOW_DEFAULT_CTOR(PipelineCodeArena);
+    PAL_DISALLOW_COPY_AND_ASSIGN(PipelineCodeArena);
+};
+
+// =====================================================================================================================
+// Collects the GPU memory allocations and DMA uploads of all pipelines created by one IDevice::CreatePipelinesBatch()
+// call.  Pipelines are packed into shared PipelineCodeArenas and all DMA uploads are recorded into a single ring slot
+// which is submitted once by End().  The batch is used concurrently by all of the threads creating its pipelines.
+class PipelineUploadBatch
+{
+public:
+    explicit PipelineUploadBatch(Device* pDevice);
+    ~PipelineUploadBatch();
+
+    Result AllocateCode(
+        GpuHeap             heap,
+        gpusize             size,
+        gpusize             alignment,
+        PipelineCodeArena** ppArena,
+        GpuMemory**         ppGpuMemory,
+        gpusize*            pOffset,
+        uint64*             pPagingFenceVal);
+
+    Result UploadUsingEmbeddedData(
+        GpuMemory* pDst,
+        gpusize    dstOffset,
+        size_t     bytes,
+        uint64     pagingFenceVal,
+        void**     ppEmbeddedData,
+        size_t*    pBytesCopied);
+
+    Result End(UploadFenceToken* pCompletionFence);
+
+private:
+    // Size of each arena.  Pipelines which don't fit in an empty arena get their own allocation as usual.
+    static constexpr gpusize ArenaSize = 4 * 1024 * 1024;
+
+    void ReleaseArenas();
+
+    Device*const       m_pDevice;
+    Util::Mutex        m_lock;
+    PipelineCodeArena* m_pArena[GpuHeapCount]; // Arena currently being filled in each heap; the batch holds a
+                                                //  reference to each of them.
+    PipelineCodeArena* m_pFullArenas;          // Arenas which have been replaced, whose references the batch keeps
+                                                //  until End(), so uploads into them never outlive their memory.
+    bool               m_hasRingSlot;
+    UploadRingSlot     m_ringSlot;
+    uint64             m_pagingFenceVal;  // Largest paging fence of any memory uploaded to via the DMA ring.
+
+    PAL_DISALLOW_DEFAULT_CTOR(PipelineUploadBatch);
+    PAL_DISALLOW_COPY_AND_ASSIGN(PipelineUploadBatch);
+};
+
+} // Pal
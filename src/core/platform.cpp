@@ -104,7 +104,8 @@ Platform::Platform(
     m_svmRangeStart(0),
     m_maxSvmSize(createInfo.maxSvmSize),
     m_logCb(),
-    m_eventProvider(this)
+    m_eventProvider(this),
+    m_pipelineMetadataCache(this)
 {
     memset(&m_pDevice[0], 0, sizeof(m_pDevice));
     memset(&m_properties, 0, sizeof(m_properties));
@@ -300,6 +301,24 @@ Result Platform::GetProperties(
     return result;
 }
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+// =====================================================================================================================
+Result Platform::GetPipelineMetadataCacheStats(
+    PipelineMetadataCacheStats* pStats)
+{
+    Result result = Result::ErrorInvalidPointer;
+
+    if (pStats != nullptr)
+    {
+        m_pipelineMetadataCache.GetStats(pStats);
+
+        result = Result::Success;
+    }
+
+    return result;
+}
+#endif
+
 // =====================================================================================================================
 // Helper method which destroys all previously enumerated devices.
 void Platform::TearDownDevices()
@@ -323,6 +342,11 @@ Result Platform::Init()
 {
     Result result = IPlatform::Init();
 
+    if (result == Result::Success)
+    {
+        result = m_pipelineMetadataCache.Init();
+    }
+
     // Perform early initialization of the developer driver after the platform is available.
     if (result == Result::Success)
     {
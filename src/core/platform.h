@@ -29,6 +29,7 @@
 #include "palPlatform.h"
 #include "platformSettingsLoader.h"
 #include "core/eventProvider.h"
+#include "core/pipelineMetadataCache.h"
 #include "core/g_palSettings.h"
 #include "core/g_palPlatformSettings.h"
 #include "ver.h"
@@ -116,6 +117,11 @@ public:
     virtual Result GetProperties(
         PlatformProperties* pProperties) override;
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    virtual Result GetPipelineMetadataCacheStats(
+        PipelineMetadataCacheStats* pStats) override;
+#endif
+
     Result ReEnumerateDevices();
 
     Device* GetDevice(uint32 index) const
@@ -168,6 +174,8 @@ public:
 
     EventProvider* GetEventProvider() { return &m_eventProvider; }
 
+    PipelineMetadataCache* GetPipelineMetadataCache() { return &m_pipelineMetadataCache; }
+
     virtual void LogEvent(
         PalEvent    eventId,
         const void* pEventData,
@@ -281,6 +289,7 @@ private:
     gpusize                m_maxSvmSize;
     Util::LogCallbackInfo  m_logCb;
     EventProvider          m_eventProvider;
+    PipelineMetadataCache  m_pipelineMetadataCache;
 
     PAL_DISALLOW_COPY_AND_ASSIGN(Platform);
 };
@@ -0,0 +1,273 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "core/device.h"
+#include "core/gpuMemory.h"
+#include "core/pipelineUploadBatch.h"
+#include "core/platform.h"
+#include "core/shaderCodeStore.h"
+#include "palHashMapImpl.h"
+
+using namespace Util;
+
+namespace Pal
+{
+
+// =====================================================================================================================
+ShaderCodeStore::ShaderCodeStore(
+    Device* pDevice)
+    :
+    m_pDevice(pDevice),
+    m_entries(NumBuckets, pDevice->GetPlatform())
+{
+}
+
+// =====================================================================================================================
+Result ShaderCodeStore::Init()
+{
+    return m_entries.Init();
+}
+
+// =====================================================================================================================
+// Frees any shared code which is still referenced.  Pipelines should all be destroyed before the device, so this only
+// reclaims memory leaked by the client.
+void ShaderCodeStore::Cleanup()
+{
+    MutexAuto lock(&m_lock);
+
+    for (auto iter = m_entries.Begin(); iter.Get() != nullptr; iter.Next())
+    {
+        FreeEntry(iter.Get()->value);
+    }
+
+    m_entries.Reset();
+}
+
+// =====================================================================================================================
+bool ShaderCodeStore::IsEnabled() const
+{
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+    return (m_pDevice->GetPublicSettings()->enableShaderCodeDeduplication &&
+            (m_pDevice->GetPlatform()->IsDeveloperModeEnabled() == false));
+#else
+    return false;
+#endif
+}
+
+// =====================================================================================================================
+// Looks up a shared code section by hash, creating it if it does not exist yet.  A new section is filled by pfnFill
+// without the store lock; other pipelines which want the same section wait until it's ready, so none of them can
+// observe partially written code.  On success, the caller holds one reference to the section and must eventually give
+// it back via Release().
+Result ShaderCodeStore::Acquire(
+    const MetroHash::Hash& hash,
+    gpusize                size,      // Size of the section in bytes, including any prefetch padding.
+    gpusize                alignment,
+    ShaderCodeFillFunc     pfnFill,
+    void*                  pUserData,
+    gpusize*               pGpuVirtAddr,
+    uint64*                pPagingFenceVal)
+{
+    PAL_ASSERT((pfnFill != nullptr) && (pGpuVirtAddr != nullptr) && (pPagingFenceVal != nullptr));
+
+    Result result = Result::Success;
+    Entry* pEntry = nullptr;
+
+    m_lock.Lock();
+
+    while ((result == Result::Success) && (pEntry == nullptr))
+    {
+        bool existed = false;
+        result = m_entries.FindAllocate(hash, &existed, &pEntry);
+
+        if ((result == Result::Success) && (existed == false))
+        {
+            // Publish the section as pending, so that other pipelines wait for it instead of creating it again, and
+            // create it without holding the lock.  Nothing else removes a pending entry, but the map may move it.
+            memset(pEntry, 0, sizeof(*pEntry));
+            pEntry->isPending = true;
+
+            m_lock.Unlock();
+
+            Entry newEntry = { };
+            result = CreateEntry(size, alignment, pfnFill, pUserData, &newEntry);
+
+            m_lock.Lock();
+
+            pEntry = m_entries.FindKey(hash);
+            PAL_ASSERT((pEntry != nullptr) && pEntry->isPending);
+
+            if (result == Result::Success)
+            {
+                *pEntry = newEntry;
+            }
+            else
+            {
+                m_entries.Erase(hash);
+                pEntry = nullptr;
+            }
+
+            m_entryReady.WakeAll();
+        }
+        else if ((result == Result::Success) && pEntry->isPending)
+        {
+            // Another pipeline is creating this section.  Once it's done, look it up again: if its creation failed,
+            // this pipeline will try to create it instead.
+            m_entryReady.Wait(&m_lock, UINT32_MAX);
+            pEntry = nullptr;
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        pEntry->refCount++;
+
+        *pGpuVirtAddr    = pEntry->gpuVirtAddr;
+        *pPagingFenceVal = pEntry->pagingFenceVal;
+    }
+
+    m_lock.Unlock();
+
+    return result;
+}
+
+// =====================================================================================================================
+// Allocates and fills the GPU memory backing a new shared code section.  This is called without the store lock.
+Result ShaderCodeStore::CreateEntry(
+    gpusize            size,
+    gpusize            alignment,
+    ShaderCodeFillFunc pfnFill,
+    void*              pUserData,
+    Entry*             pEntry)
+{
+    memset(pEntry, 0, sizeof(*pEntry));
+
+    // Shared code is always uploaded by the CPU, so it must live in a CPU visible heap.  Using the DMA upload ring
+    // would force every pipeline which hits in the store to wait on another pipeline's upload fence.
+    Result result = Result::Success;
+
+    // Pack code created for a pipeline batch into the batch's arena, like the batch's pipelines.  The entry keeps its
+    // own reference to the arena.
+    PipelineUploadBatch*const pBatch = m_pDevice->GetPipelineUploadBatch();
+    if (pBatch != nullptr)
+    {
+        result = pBatch->AllocateCode(GpuHeapLocal,
+                                      size,
+                                      alignment,
+                                      &pEntry->pArena,
+                                      &pEntry->pGpuMemory,
+                                      &pEntry->offset,
+                                      &pEntry->pagingFenceVal);
+    }
+
+    if ((result == Result::Success) && (pEntry->pGpuMemory == nullptr))
+    {
+        GpuMemoryCreateInfo createInfo = { };
+        createInfo.size      = size;
+        createInfo.alignment = alignment;
+        createInfo.vaRange   = VaRange::DescriptorTable;
+        createInfo.heaps[0]  = GpuHeapLocal;
+        createInfo.heaps[1]  = GpuHeapGartUswc;
+        createInfo.heapCount = 2;
+        createInfo.priority  = GpuMemPriority::High;
+
+        GpuMemoryInternalCreateInfo internalInfo = { };
+        internalInfo.flags.alwaysResident = 1;
+        internalInfo.pPagingFence         = &pEntry->pagingFenceVal;
+
+        result = m_pDevice->MemMgr()->AllocateGpuMem(createInfo,
+                                                     internalInfo,
+                                                     false,
+                                                     &pEntry->pGpuMemory,
+                                                     &pEntry->offset);
+    }
+
+    if (result == Result::Success)
+    {
+        pEntry->gpuVirtAddr = (pEntry->pGpuMemory->Desc().gpuVirtAddr + pEntry->offset);
+
+        void* pMappedPtr = nullptr;
+        result = pEntry->pGpuMemory->Map(&pMappedPtr);
+
+        if (result == Result::Success)
+        {
+            result = pfnFill(pUserData,
+                             VoidPtrInc(pMappedPtr, static_cast<size_t>(pEntry->offset)),
+                             pEntry->gpuVirtAddr);
+
+            const Result unmapResult = pEntry->pGpuMemory->Unmap();
+            if (result == Result::Success)
+            {
+                result = unmapResult;
+            }
+        }
+
+        if (result != Result::Success)
+        {
+            FreeEntry(*pEntry);
+            pEntry->pGpuMemory = nullptr;
+            pEntry->pArena     = nullptr;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Gives back the GPU memory of a shared code section.
+void ShaderCodeStore::FreeEntry(
+    const Entry& entry)
+{
+    if (entry.pArena != nullptr)
+    {
+        entry.pArena->Release();
+    }
+    else if (entry.pGpuMemory != nullptr)
+    {
+        m_pDevice->MemMgr()->FreeGpuMem(entry.pGpuMemory, entry.offset);
+    }
+}
+
+// =====================================================================================================================
+// Drops one reference to each of a pipeline's shared code sections, freeing any section which is no longer used.
+void ShaderCodeStore::Release(
+    const SharedCodeRefs& refs)
+{
+    MutexAuto lock(&m_lock);
+
+    for (uint32 i = 0; i < refs.count; i++)
+    {
+        Entry*const pEntry = m_entries.FindKey(refs.hashes[i]);
+        PAL_ASSERT((pEntry != nullptr) && (pEntry->refCount > 0));
+
+        if ((pEntry != nullptr) && (--pEntry->refCount == 0))
+        {
+            FreeEntry(*pEntry);
+            m_entries.Erase(refs.hashes[i]);
+        }
+    }
+}
+
+} // Pal
@@ -0,0 +1,126 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "pal.h"
+#include "palHashMap.h"
+#include "palConditionVariable.h"
+#include "palHwHash.h"
+#include "palMetroHash.h"
+#include "palMutex.h"
+
+namespace Pal
+{
+
+class Device;
+class GpuMemory;
+class PipelineCodeArena;
+class Platform;
+
+// Identifies the shared code sections referenced by a single pipeline.  A pipeline usually has at most one executable
+// section, but some ELF producers emit a second one for subroutines.
+struct SharedCodeRefs
+{
+    static constexpr uint32 MaxSections = 2;
+
+    Util::MetroHash::Hash hashes[MaxSections];
+    uint32                count;
+};
+
+// Callback used to fill a newly created shared code section.  pCpuAddr is a CPU mapping of the section's GPU memory
+// and gpuVirtAddr is its final GPU virtual address, so the callback can apply section-local relocations in place.
+typedef Result (*ShaderCodeFillFunc)(void* pUserData, void* pCpuAddr, gpusize gpuVirtAddr);
+
+// =====================================================================================================================
+// Device-level store of uploaded shader code, keyed by a hash of the relocated code section contents.  Pipelines with
+// identical code sections share a single copy of that code in GPU memory.  Each copy is reference counted and freed
+// when the last pipeline referencing it is destroyed.
+//
+// The store's lock only guards its map.  A new section is published as pending and allocated and filled without the
+// lock, so pipelines creating different sections don't serialize on each other; only pipelines which want the same
+// section wait for it.  Sections created during IDevice::CreatePipelinesBatch() are packed into the batch's arenas.
+//
+// Only code sections whose relocations are entirely self-referential are eligible for sharing, because their contents
+// after relocation depend only on the section bytes and on the section's own GPU virtual address.
+class ShaderCodeStore
+{
+public:
+    explicit ShaderCodeStore(Device* pDevice);
+    ~ShaderCodeStore() { Cleanup(); }
+
+    Result Init();
+    void Cleanup();
+
+    // Sharing is disabled when developer mode is enabled because the profiling tools expect each pipeline's code to
+    // live inside that pipeline's own allocation.
+    bool IsEnabled() const;
+
+    Result Acquire(
+        const Util::MetroHash::Hash& hash,
+        gpusize                      size,
+        gpusize                      alignment,
+        ShaderCodeFillFunc           pfnFill,
+        void*                        pUserData,
+        gpusize*                     pGpuVirtAddr,
+        uint64*                      pPagingFenceVal);
+
+    void Release(const SharedCodeRefs& refs);
+
+private:
+    struct Entry
+    {
+        GpuMemory*         pGpuMemory;
+        PipelineCodeArena* pArena;          // Arena holding the code, or null if it has its own suballocation.
+        gpusize            offset;
+        gpusize            gpuVirtAddr;
+        uint64             pagingFenceVal;
+        uint32             refCount;
+        bool               isPending;       // The code is still being written by the thread which created the entry.
+    };
+
+    static constexpr uint32 NumBuckets = 64;
+
+    typedef Util::HashMap<Util::MetroHash::Hash, Entry, Platform, Util::Crc32cHashFunc> EntryMap;
+
+    Result CreateEntry(
+        gpusize            size,
+        gpusize            alignment,
+        ShaderCodeFillFunc pfnFill,
+        void*              pUserData,
+        Entry*             pEntry);
+
+    void FreeEntry(const Entry& entry);
+
+    Device*const            m_pDevice;
+    EntryMap                m_entries;
+    Util::Mutex             m_lock;
+    Util::ConditionVariable m_entryReady;  // Signaled whenever a pending entry is finished or abandoned.
+
+    PAL_DISALLOW_DEFAULT_CTOR(ShaderCodeStore);
+    PAL_DISALLOW_COPY_AND_ASSIGN(ShaderCodeStore);
+};
+
+} // Pal
@@ -26,6 +26,7 @@
 #include "core/device.h"
 #include "core/svmMgr.h"
 #include "palBestFitAllocatorImpl.h"
+#include "palTlsfAllocatorImpl.h"
 
 using namespace Util;
 
@@ -39,6 +40,7 @@ SvmMgr::SvmMgr(
     m_pDevice(pDevice),
     m_vaStart(0),
     m_vaSize(0),
+    m_pTlsfAllocator(nullptr),
     m_pSubAllocator(nullptr)
 {
 }
@@ -46,6 +48,7 @@ SvmMgr::SvmMgr(
 // =====================================================================================================================
 SvmMgr::~SvmMgr()
 {
+    PAL_DELETE(m_pTlsfAllocator, m_pDevice->GetPlatform());
     PAL_DELETE(m_pSubAllocator, m_pDevice->GetPlatform());
 }
 
@@ -147,16 +150,23 @@ Result SvmMgr::Init(
 
     if (result == Result::Success)
     {
+        bool useTlsfAllocator = false;
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+        useTlsfAllocator = m_pDevice->GetPublicSettings()->enableTlsfSvmAllocator;
+#endif
+
         // Create and initialize the suballocator
-        m_pSubAllocator = PAL_NEW(BestFitAllocator<Platform>, pPlatform, AllocInternal)
-                                (pPlatform, m_vaSize, memProps.fragmentSize);
-        if (m_pSubAllocator != nullptr)
+        if (useTlsfAllocator)
         {
-            result = m_pSubAllocator->Init();
+            m_pTlsfAllocator = PAL_NEW(TlsfAllocator<Platform>, pPlatform, AllocInternal)
+                                     (pPlatform, m_vaSize, memProps.fragmentSize);
+            result = (m_pTlsfAllocator != nullptr) ? m_pTlsfAllocator->Init() : Result::ErrorOutOfMemory;
         }
         else
         {
-            result = Result::ErrorOutOfMemory;
+            m_pSubAllocator = PAL_NEW(BestFitAllocator<Platform>, pPlatform, AllocInternal)
+                                    (pPlatform, m_vaSize, memProps.fragmentSize);
+            result = (m_pSubAllocator != nullptr) ? m_pSubAllocator->Init() : Result::ErrorOutOfMemory;
         }
     }
 
@@ -187,7 +197,8 @@ Result SvmMgr::AllocVa(
     gpusize assignedVa = 0;
     MutexAuto lock(&m_allocFreeVaLock);
 
-    Result result = m_pSubAllocator->Allocate(size, align, &assignedVa);
+    Result result = (m_pTlsfAllocator != nullptr) ? m_pTlsfAllocator->Allocate(size, align, &assignedVa)
+                                                  : m_pSubAllocator->Allocate(size, align, &assignedVa);
     *pVirtualAddress = assignedVa + m_vaStart;
 
     return result;
@@ -199,7 +210,14 @@ void SvmMgr::FreeVa(
 {
     MutexAuto lock(&m_allocFreeVaLock);
 
-    m_pSubAllocator->Free((virtualAddress - m_vaStart));
+    if (m_pTlsfAllocator != nullptr)
+    {
+        m_pTlsfAllocator->Free((virtualAddress - m_vaStart));
+    }
+    else
+    {
+        m_pSubAllocator->Free((virtualAddress - m_vaStart));
+    }
     return;
 }
 } // Pal
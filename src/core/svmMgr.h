@@ -27,6 +27,7 @@
 
 #include "palMutex.h"
 #include "palBestFitAllocator.h"
+#include "palTlsfAllocator.h"
 #include "core/platform.h"
 
 namespace Pal
@@ -34,8 +35,8 @@ namespace Pal
 class Platform;
 
 // =====================================================================================================================
-// SvmMgr provides a clean interface between PAL and the BestFitAllocator, which is used to allocate and free GPU
-// virtual address space for SVM allocations on Windows and Linux platforms.
+// SvmMgr provides a clean interface between PAL and the TlsfAllocator or BestFitAllocator, which are used to allocate
+// and free GPU virtual address space for SVM allocations on Windows and Linux platforms.
 // This GPU virtual address is shared with CPU.
 //
 // Some commonly used abbreviations throughout the implementation of this class:
@@ -60,7 +61,9 @@ private:
     gpusize      m_vaStart;
     gpusize      m_vaSize;
 
-    Util::BestFitAllocator<Pal::Platform>* m_pSubAllocator;  // Suballocator used for the suballocation
+    // Suballocator used for the suballocation. Only one of these is created, see enableTlsfSvmAllocator.
+    Util::TlsfAllocator<Pal::Platform>*    m_pTlsfAllocator;
+    Util::BestFitAllocator<Pal::Platform>* m_pSubAllocator;
 
     Util::Mutex  m_allocFreeVaLock;                          // Mutex protecting allocation and free of SVM va
 
@@ -0,0 +1,350 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palCodeObjectStore.h"
+#include "palHashMapImpl.h"
+#include "palInlineFuncs.h"
+#include "palPipeline.h"
+#include "palShaderLibrary.h"
+#include "palSysMemory.h"
+#include "sqtt_file_format.h"
+
+using namespace Pal;
+
+namespace GpuUtil
+{
+
+// Header of each stored code object.  The RGP code object record and the binary immediately follow it in memory.
+struct CodeObjectStore::Entry
+{
+    uint64 hash;     // Hash of the code object this entry holds.
+    uint32 refCount; // Number of outstanding references, protected by m_lock.
+    uint32 reserved;
+};
+
+// =====================================================================================================================
+// Returns the RGP record stored behind an entry.
+SqttCodeObjectDatabaseRecord* CodeObjectStore::GetRecord(
+    Entry* pEntry)
+{
+    return static_cast<SqttCodeObjectDatabaseRecord*>(Util::VoidPtrInc(pEntry, sizeof(Entry)));
+}
+
+// =====================================================================================================================
+CodeObjectStore::CodeObjectStore(
+    IPlatform* pPlatform)
+    :
+    m_pPlatform(pPlatform),
+    m_entries(512, pPlatform)
+{
+}
+
+// =====================================================================================================================
+CodeObjectStore::~CodeObjectStore()
+{
+    // Every session is expected to release its records before the store is destroyed, but don't leak if one didn't.
+    PAL_ALERT(m_entries.GetNumEntries() != 0);
+
+    for (auto iter = m_entries.Begin(); iter.Get() != nullptr; iter.Next())
+    {
+        PAL_FREE(iter.Get()->value, m_pPlatform);
+    }
+}
+
+// =====================================================================================================================
+Result CodeObjectStore::Init()
+{
+    return m_entries.Init();
+}
+
+// =====================================================================================================================
+SqttCodeObjectDatabaseRecord* CodeObjectStore::FindAndAddRef(
+    uint64 hash)
+{
+    SqttCodeObjectDatabaseRecord* pRecord = nullptr;
+
+    Util::MutexAuto lock(&m_lock);
+
+    Entry** ppEntry = m_entries.FindKey(hash);
+
+    if (ppEntry != nullptr)
+    {
+        (*ppEntry)->refCount++;
+        pRecord = GetRecord(*ppEntry);
+    }
+
+    return pRecord;
+}
+
+// =====================================================================================================================
+// Allocates a new entry with a single reference.  The binary must be copied into it before it's published.
+CodeObjectStore::Entry* CodeObjectStore::CreateEntry(
+    uint64 hash,
+    size_t binarySize)
+{
+    PAL_ASSERT(binarySize != 0);
+
+    // Pad the record size to the nearest multiple of 4 bytes per the RGP file format spec.
+    const uint32 recordSize = Util::RoundUpToMultiple(static_cast<uint32>(binarySize), 4U);
+
+    Entry* pEntry = static_cast<Entry*>(PAL_MALLOC(sizeof(Entry) + sizeof(SqttCodeObjectDatabaseRecord) + recordSize,
+                                                   m_pPlatform,
+                                                   Util::SystemAllocType::AllocInternal));
+
+    if (pEntry != nullptr)
+    {
+        pEntry->hash     = hash;
+        pEntry->refCount = 1;
+        pEntry->reserved = 0;
+
+        SqttCodeObjectDatabaseRecord* pRecord = GetRecord(pEntry);
+        pRecord->recordSize = recordSize;
+
+        // Clear the padding so the RGP file doesn't contain uninitialized memory.
+        memset(Util::VoidPtrInc(pRecord, sizeof(SqttCodeObjectDatabaseRecord) + binarySize),
+               0,
+               recordSize - binarySize);
+    }
+
+    return pEntry;
+}
+
+// =====================================================================================================================
+// Makes a fully initialized entry visible to other threads.  The binary copy is done outside of the lock, so another
+// thread may have published the same code object in the meantime; in that case the new copy is simply dropped.
+SqttCodeObjectDatabaseRecord* CodeObjectStore::Publish(
+    Entry* pEntry)
+{
+    Entry* pDiscard = nullptr;
+    SqttCodeObjectDatabaseRecord* pRecord = nullptr;
+
+    m_lock.Lock();
+
+    bool    existed = false;
+    Entry** ppEntry = nullptr;
+    Result  result  = m_entries.FindAllocate(pEntry->hash, &existed, &ppEntry);
+
+    if (result != Result::Success)
+    {
+        pDiscard = pEntry;
+    }
+    else if (existed)
+    {
+        (*ppEntry)->refCount++;
+        pRecord  = GetRecord(*ppEntry);
+        pDiscard = pEntry;
+    }
+    else
+    {
+        *ppEntry = pEntry;
+        pRecord  = GetRecord(pEntry);
+    }
+
+    m_lock.Unlock();
+
+    PAL_FREE(pDiscard, m_pPlatform);
+
+    return pRecord;
+}
+
+// =====================================================================================================================
+Result CodeObjectStore::Acquire(
+    uint64                         hash,
+    const IPipeline*               pPipeline,
+    SqttCodeObjectDatabaseRecord** ppRecord)
+{
+    PAL_ASSERT((pPipeline != nullptr) && (ppRecord != nullptr));
+
+    Result result = Result::Success;
+    SqttCodeObjectDatabaseRecord* pRecord = FindAndAddRef(hash);
+
+    if (pRecord == nullptr)
+    {
+        uint32 binarySize = 0;
+        result = pPipeline->GetCodeObject(&binarySize, nullptr);
+
+        Entry* pEntry = nullptr;
+        if (result == Result::Success)
+        {
+            pEntry = CreateEntry(hash, binarySize);
+            result = (pEntry != nullptr) ? Result::Success : Result::ErrorOutOfMemory;
+        }
+
+        if (result == Result::Success)
+        {
+            result = pPipeline->GetCodeObject(&binarySize,
+                                              Util::VoidPtrInc(GetRecord(pEntry),
+                                                               sizeof(SqttCodeObjectDatabaseRecord)));
+        }
+
+        if (result == Result::Success)
+        {
+            pRecord = Publish(pEntry);
+            result  = (pRecord != nullptr) ? Result::Success : Result::ErrorOutOfMemory;
+        }
+        else
+        {
+            PAL_FREE(pEntry, m_pPlatform);
+        }
+    }
+
+    *ppRecord = pRecord;
+
+    return result;
+}
+
+// =====================================================================================================================
+Result CodeObjectStore::Acquire(
+    uint64                         hash,
+    const IShaderLibrary*          pLibrary,
+    SqttCodeObjectDatabaseRecord** ppRecord)
+{
+    PAL_ASSERT((pLibrary != nullptr) && (ppRecord != nullptr));
+
+    Result result = Result::Success;
+    SqttCodeObjectDatabaseRecord* pRecord = FindAndAddRef(hash);
+
+    if (pRecord == nullptr)
+    {
+        uint32 binarySize = 0;
+        result = pLibrary->GetCodeObject(&binarySize, nullptr);
+
+        Entry* pEntry = nullptr;
+        if (result == Result::Success)
+        {
+            pEntry = CreateEntry(hash, binarySize);
+            result = (pEntry != nullptr) ? Result::Success : Result::ErrorOutOfMemory;
+        }
+
+        if (result == Result::Success)
+        {
+            result = pLibrary->GetCodeObject(&binarySize,
+                                             Util::VoidPtrInc(GetRecord(pEntry),
+                                                              sizeof(SqttCodeObjectDatabaseRecord)));
+        }
+
+        if (result == Result::Success)
+        {
+            pRecord = Publish(pEntry);
+            result  = (pRecord != nullptr) ? Result::Success : Result::ErrorOutOfMemory;
+        }
+        else
+        {
+            PAL_FREE(pEntry, m_pPlatform);
+        }
+    }
+
+    *ppRecord = pRecord;
+
+    return result;
+}
+
+// =====================================================================================================================
+Result CodeObjectStore::Acquire(
+    uint64                         hash,
+    const void*                    pBinary,
+    size_t                         binarySize,
+    SqttCodeObjectDatabaseRecord** ppRecord)
+{
+    PAL_ASSERT((pBinary != nullptr) && (ppRecord != nullptr));
+
+    Result result = Result::Success;
+    SqttCodeObjectDatabaseRecord* pRecord = FindAndAddRef(hash);
+
+    if (pRecord == nullptr)
+    {
+        Entry* pEntry = CreateEntry(hash, binarySize);
+
+        if (pEntry != nullptr)
+        {
+            memcpy(Util::VoidPtrInc(GetRecord(pEntry), sizeof(SqttCodeObjectDatabaseRecord)),
+                   pBinary,
+                   binarySize);
+
+            pRecord = Publish(pEntry);
+        }
+
+        result = (pRecord != nullptr) ? Result::Success : Result::ErrorOutOfMemory;
+    }
+
+    *ppRecord = pRecord;
+
+    return result;
+}
+
+// =====================================================================================================================
+Result CodeObjectStore::Acquire(
+    const SqttCodeObjectDatabaseRecord* pSrcRecord,
+    SqttCodeObjectDatabaseRecord**      ppRecord)
+{
+    PAL_ASSERT((pSrcRecord != nullptr) && (ppRecord != nullptr));
+
+    // Records of all stores share the same layout, so the hash can be read back from the source entry.  The padded
+    // record size is copied as is.
+    const Entry* pSrcEntry = static_cast<const Entry*>(Util::VoidPtrDec(pSrcRecord, sizeof(Entry)));
+
+    return Acquire(pSrcEntry->hash,
+                   Util::VoidPtrInc(pSrcRecord, sizeof(SqttCodeObjectDatabaseRecord)),
+                   pSrcRecord->recordSize,
+                   ppRecord);
+}
+
+// =====================================================================================================================
+void CodeObjectStore::AddRef(
+    SqttCodeObjectDatabaseRecord* pRecord)
+{
+    Entry* pEntry = static_cast<Entry*>(Util::VoidPtrDec(pRecord, sizeof(Entry)));
+
+    Util::MutexAuto lock(&m_lock);
+
+    PAL_ASSERT(pEntry->refCount > 0);
+    pEntry->refCount++;
+}
+
+// =====================================================================================================================
+void CodeObjectStore::Release(
+    SqttCodeObjectDatabaseRecord* pRecord)
+{
+    Entry* pEntry = static_cast<Entry*>(Util::VoidPtrDec(pRecord, sizeof(Entry)));
+    bool   free   = false;
+
+    m_lock.Lock();
+
+    PAL_ASSERT(pEntry->refCount > 0);
+    if (--pEntry->refCount == 0)
+    {
+        m_entries.Erase(pEntry->hash);
+        free = true;
+    }
+
+    m_lock.Unlock();
+
+    if (free)
+    {
+        PAL_FREE(pEntry, m_pPlatform);
+    }
+}
+
+} // GpuUtil
@@ -24,11 +24,13 @@
  **********************************************************************************************************************/
 
 #include "gpaSessionPerfSample.h"
+#include "palCodeObjectStore.h"
 #include "palCmdAllocator.h"
 #include "palCmdBuffer.h"
 #include "palDequeImpl.h"
 #include "palFence.h"
 #include "palGpuEvent.h"
+#include "palHashMapImpl.h"
 #include "palHashSetImpl.h"
 #include "palInlineFuncs.h"
 #include "palMemTrackerImpl.h"
@@ -388,7 +390,8 @@ GpaSession::GpaSession(
     ApiType              apiType,
     uint16               rgpInstrumentationSpecVer,
     uint16               rgpInstrumentationApiVer,
-    PerfExpMemDeque*     pAvailablePerfExpMem)
+    PerfExpMemDeque*     pAvailablePerfExpMem,
+    CodeObjectStore*     pCodeObjectStore)
     :
     m_pDevice(pDevice),
     m_timestampAlignment(0),
@@ -412,6 +415,8 @@ GpaSession::GpaSession(
     m_pAvailablePerfExpMem(pAvailablePerfExpMem),
     m_registeredPipelines(512, m_pPlatform),
     m_registeredApiHashes(512, m_pPlatform),
+    m_pCodeObjectStore(pCodeObjectStore),
+    m_ownsCodeObjectStore(false),
     m_codeObjectRecordsCache(m_pPlatform),
     m_curCodeObjectRecords(m_pPlatform),
     m_codeObjectLoadEventRecordsCache(m_pPlatform),
@@ -528,14 +533,19 @@ GpaSession::~GpaSession()
         PAL_SAFE_FREE(m_pCmdAllocator, m_pPlatform);
     }
 
-    // Clear the code object records cache.
+    // Release the code object records cache.
     while (m_codeObjectRecordsCache.NumElements() > 0)
     {
         SqttCodeObjectDatabaseRecord* pRecord = nullptr;
         m_codeObjectRecordsCache.PopFront(&pRecord);
         PAL_ASSERT(pRecord != nullptr);
 
-        PAL_SAFE_FREE(pRecord, m_pPlatform);
+        m_pCodeObjectStore->Release(pRecord);
+    }
+
+    if (m_ownsCodeObjectStore)
+    {
+        PAL_SAFE_DELETE(m_pCodeObjectStore, m_pPlatform);
     }
 }
 
@@ -566,6 +576,9 @@ GpaSession::GpaSession(
     m_pAvailablePerfExpMem(src.m_pAvailablePerfExpMem),
     m_registeredPipelines(512, m_pPlatform),
     m_registeredApiHashes(512, m_pPlatform),
+    // A private store of the source session may not outlive this copy, so only a client owned store can be shared.
+    m_pCodeObjectStore(src.m_ownsCodeObjectStore ? nullptr : src.m_pCodeObjectStore),
+    m_ownsCodeObjectStore(false),
     m_codeObjectRecordsCache(m_pPlatform),
     m_curCodeObjectRecords(m_pPlatform),
     m_codeObjectLoadEventRecordsCache(m_pPlatform),
@@ -678,6 +691,20 @@ Result GpaSession::Init()
     {
         result = m_registeredApiHashes.Init();
     }
+    if ((result == Result::Success) && (m_pCodeObjectStore == nullptr))
+    {
+        m_pCodeObjectStore = PAL_NEW(CodeObjectStore, m_pPlatform, Util::SystemAllocType::AllocObject)(m_pPlatform);
+
+        if (m_pCodeObjectStore == nullptr)
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+        else
+        {
+            m_ownsCodeObjectStore = true;
+            result = m_pCodeObjectStore->Init();
+        }
+    }
 
     // CopySession specific work
     if ((result == Result::Success) && (m_pSrcSession != nullptr))
@@ -700,10 +727,24 @@ Result GpaSession::Init()
         // Import SampleItem array and shader ISA database.
         if ((result == Result::Success) && (m_pSrcSession != nullptr))
         {
-            // Copy code object database from srcSession
-            for (auto iter = m_pSrcSession->m_codeObjectRecordsCache.Begin(); iter.Get() != nullptr; iter.Next())
+            // Copy code object database from srcSession.  If both sessions share a store this only takes another
+            // reference to each record.
+            for (auto iter = m_pSrcSession->m_codeObjectRecordsCache.Begin();
+                 (iter.Get() != nullptr) && (result == Result::Success);
+                 iter.Next())
             {
-                m_codeObjectRecordsCache.PushBack(*iter.Get());
+                SqttCodeObjectDatabaseRecord* pRecord = nullptr;
+                result = m_pCodeObjectStore->Acquire(*iter.Get(), &pRecord);
+
+                if (result == Result::Success)
+                {
+                    result = m_codeObjectRecordsCache.PushBack(pRecord);
+
+                    if (result != Result::Success)
+                    {
+                        m_pCodeObjectStore->Release(pRecord);
+                    }
+                }
             }
 
             // Copy code object load event database from srcSession
@@ -2002,7 +2043,10 @@ Result GpaSession::GetResults(
                 PAL_ASSERT(pSizeInBytes != nullptr);
 
                 // Dump both thread trace and spm trace results in the RGP file.
-                result = DumpRgpData(pTraceSample, pData, pSizeInBytes);
+                RgpWriter writer(pData, *pSizeInBytes);
+                result = DumpRgpData(pTraceSample, &writer);
+
+                *pSizeInBytes = static_cast<size_t>(writer.Offset());
             }
         }
     }
@@ -2026,6 +2070,43 @@ Result GpaSession::GetResults(
     return result;
 }
 
+// =====================================================================================================================
+// Streams the RGP file of a trace sample through a client callback.  Only valid for sessions in the _ready_ state.
+Result GpaSession::GetResults(
+    uint32       sampleId,
+    RgpWriteFunc pfnWrite,
+    void*        pUserData
+    ) const
+{
+    PAL_ASSERT(m_sessionState == GpaSessionState::Complete);
+
+    Result result = Result::Success;
+
+    SampleItem* pSampleItem = m_sampleItemArray.At(sampleId);
+
+    if (pfnWrite == nullptr)
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else if (pSampleItem->sampleConfig.type != GpaSampleType::Trace)
+    {
+        result = Result::ErrorInvalidObjectType;
+    }
+    else
+    {
+        TraceSample* pTraceSample = static_cast<TraceSample*>(pSampleItem->pPerfSample);
+
+        if ((pTraceSample->GetTraceBufferSize() > 0) &&
+            (pTraceSample->IsThreadTraceEnabled() || pTraceSample->IsSpmTraceEnabled()))
+        {
+            RgpWriter writer(pfnWrite, pUserData);
+            result = DumpRgpData(pTraceSample, &writer);
+        }
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Moves the session to the _reset_ state, marking all sessions resources as unused and available for reuse when
 // the session is re-built.
@@ -2521,12 +2602,125 @@ Result GpaSession::RegisterPipeline(
     const RegisterPipelineInfo&  clientInfo)
 {
     PAL_ASSERT(pPipeline != nullptr);
-    const PipelineInfo& pipeInfo = pPipeline->GetInfo();
 
     // Even if the pipeline was already previously encountered, we still want to record every time it gets loaded.
-    Result result = AddCodeObjectLoadEvent(pPipeline, CodeObjectLoadEventType::LoadToGpuMemory);
+    CodeObjectLoadEventRecord loadEvent = {};
+    Result result = BuildCodeObjectLoadEvent(pPipeline, CodeObjectLoadEventType::LoadToGpuMemory, &loadEvent);
 
-    m_registerPipelineLock.LockForWrite();
+    // The client may destroy the pipeline at any time after this, so take our own copy of its binary now.  Copying it
+    // before taking the lock keeps large binaries from blocking other registrations.
+    SqttCodeObjectDatabaseRecord* pRecord = nullptr;
+    if (result == Result::Success)
+    {
+        result = m_pCodeObjectStore->Acquire(pPipeline->GetInfo().internalPipelineHash.unique, pPipeline, &pRecord);
+    }
+
+    if (result == Result::Success)
+    {
+        m_registerPipelineLock.LockForWrite();
+        result = RegisterPipelineLocked(pPipeline, clientInfo, loadEvent, pRecord);
+        m_registerPipelineLock.UnlockForWrite();
+    }
+
+    // The session only keeps the record if the pipeline was registered.
+    if ((result != Result::Success) && (pRecord != nullptr))
+    {
+        m_pCodeObjectStore->Release(pRecord);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Registers a batch of pipelines with the GpaSession. Duplicate pipelines are skipped.
+Result GpaSession::RegisterPipelines(
+    uint32                       pipelineCount,
+    const IPipeline* const*      ppPipelines,
+    const RegisterPipelineInfo*  pClientInfo)
+{
+    PAL_ASSERT((pipelineCount == 0) || ((ppPipelines != nullptr) && (pClientInfo != nullptr)));
+
+    Result result = Result::Success;
+
+    // Query the load addresses and copy the binaries in chunks outside of the lock, so the lock is only taken once per
+    // chunk and is never held while a binary is copied.
+    constexpr uint32 BatchSize = 64;
+    CodeObjectLoadEventRecord     loadEvents[BatchSize];
+    SqttCodeObjectDatabaseRecord* records[BatchSize];
+
+    for (uint32 first = 0; (first < pipelineCount) && (result == Result::Success); first += BatchSize)
+    {
+        const uint32 count       = Util::Min(BatchSize, pipelineCount - first);
+        uint32       numAcquired = 0;
+
+        for (; (numAcquired < count) && (result == Result::Success); numAcquired++)
+        {
+            const IPipeline*const pPipeline = ppPipelines[first + numAcquired];
+            PAL_ASSERT(pPipeline != nullptr);
+
+            records[numAcquired] = nullptr;
+            result = BuildCodeObjectLoadEvent(pPipeline,
+                                              CodeObjectLoadEventType::LoadToGpuMemory,
+                                              &loadEvents[numAcquired]);
+
+            if (result == Result::Success)
+            {
+                result = m_pCodeObjectStore->Acquire(pPipeline->GetInfo().internalPipelineHash.unique,
+                                                     pPipeline,
+                                                     &records[numAcquired]);
+            }
+        }
+
+        if (result == Result::Success)
+        {
+            m_registerPipelineLock.LockForWrite();
+
+            for (uint32 i = 0; (i < count) && (result == Result::Success); i++)
+            {
+                result = RegisterPipelineLocked(ppPipelines[first + i],
+                                                pClientInfo[first + i],
+                                                loadEvents[i],
+                                                records[i]);
+
+                if (result == Result::Success)
+                {
+                    records[i] = nullptr;
+                }
+                else if (result == Result::AlreadyExists)
+                {
+                    result = Result::Success;
+                }
+            }
+
+            m_registerPipelineLock.UnlockForWrite();
+        }
+
+        // Give back the records of pipelines which were already registered or weren't reached because of an error.
+        for (uint32 i = 0; i < numAcquired; i++)
+        {
+            if (records[i] != nullptr)
+            {
+                m_pCodeObjectStore->Release(records[i]);
+            }
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Records the load event, the PSO correlation and the code object of a pipeline. The caller must hold
+// m_registerPipelineLock for write and have acquired the pipeline's code object record, which the session takes over
+// on success. Returns AlreadyExists on duplicate PAL pipeline.
+Result GpaSession::RegisterPipelineLocked(
+    const IPipeline*                 pPipeline,
+    const RegisterPipelineInfo&      clientInfo,
+    const CodeObjectLoadEventRecord& loadEvent,
+    SqttCodeObjectDatabaseRecord*    pRecord)
+{
+    const PipelineInfo& pipeInfo = pPipeline->GetInfo();
+
+    Result result = m_codeObjectLoadEventRecordsCache.PushBack(loadEvent);
 
     if ((result == Result::Success) && (clientInfo.apiPsoHash != 0))
     {
@@ -2560,58 +2754,9 @@ Result GpaSession::RegisterPipeline(
                  m_registeredPipelines.Insert(pipeInfo.internalPipelineHash.unique);
     }
 
-    m_registerPipelineLock.UnlockForWrite();
-
     if (result == Result::Success)
     {
-        // Cache the pipeline binary in GpaSession-owned memory.
-        SqttCodeObjectDatabaseRecord record = {};
-
-        void* pCodeObjectRecord = nullptr;
-
-        result = pPipeline->GetCodeObject(&record.recordSize, nullptr);
-
-        if (result == Result::Success)
-        {
-            PAL_ASSERT(record.recordSize != 0);
-
-            // Pad the record size to the nearest multiple of 4 bytes per the RGP file format spec.
-            record.recordSize = Util::RoundUpToMultiple(record.recordSize, 4U);
-
-            // Allocate space to store all the information for one record.
-            pCodeObjectRecord = PAL_MALLOC((sizeof(SqttCodeObjectDatabaseRecord) + record.recordSize),
-                                           m_pPlatform,
-                                           Util::SystemAllocType::AllocInternal);
-
-            if (pCodeObjectRecord != nullptr)
-            {
-                // Write the record header.
-                memcpy(pCodeObjectRecord, &record, sizeof(record));
-
-                // Write the pipeline binary.
-                result = pPipeline->GetCodeObject(&record.recordSize,
-                                                   Util::VoidPtrInc(pCodeObjectRecord, sizeof(record)));
-
-                if (result != Result::Success)
-                {
-                    // Deallocate if some error occurred.
-                    PAL_SAFE_FREE(pCodeObjectRecord, m_pPlatform)
-                }
-            }
-            else
-            {
-                result = Result::ErrorOutOfMemory;
-            }
-        }
-
-        if (result == Result::Success)
-        {
-            m_registerPipelineLock.LockForWrite();
-
-            m_codeObjectRecordsCache.PushBack(static_cast<SqttCodeObjectDatabaseRecord*>(pCodeObjectRecord));
-
-            m_registerPipelineLock.UnlockForWrite();
-        }
+        result = m_codeObjectRecordsCache.PushBack(pRecord);
     }
 
     return result;
@@ -2637,6 +2782,14 @@ Result GpaSession::RegisterLibrary(
     // Even if the library was already previously encountered, we still want to record every time it gets loaded.
     Result result = AddCodeObjectLoadEvent(pLibrary, CodeObjectLoadEventType::LoadToGpuMemory);
 
+    // The client may destroy the library at any time after this, so take our own copy of its binary now, before taking
+    // the lock.
+    SqttCodeObjectDatabaseRecord* pRecord = nullptr;
+    if (result == Result::Success)
+    {
+        result = m_pCodeObjectStore->Acquire(libraryInfo.internalLibraryHash.unique, pLibrary, &pRecord);
+    }
+
     m_registerPipelineLock.LockForWrite();
 
     if ((result == Result::Success) && (clientInfo.apiHash != 0))
@@ -2671,58 +2824,17 @@ Result GpaSession::RegisterLibrary(
                  m_registeredPipelines.Insert(libraryInfo.internalLibraryHash.unique);
     }
 
-    m_registerPipelineLock.UnlockForWrite();
-
     if (result == Result::Success)
     {
-        // Cache the code object binary in GpaSession-owned memory.
-        SqttCodeObjectDatabaseRecord record = {};
-
-        void* pCodeObjectRecord = nullptr;
-
-        result = pLibrary->GetCodeObject(&record.recordSize, nullptr);
-
-        if (result == Result::Success)
-        {
-            PAL_ASSERT(record.recordSize != 0);
-
-            // Pad the record size to the nearest multiple of 4 bytes per the RGP file format spec.
-            record.recordSize = Util::RoundUpToMultiple(record.recordSize, 4U);
-
-            // Allocate space to store all the information for one record.
-            pCodeObjectRecord = PAL_MALLOC((sizeof(SqttCodeObjectDatabaseRecord) + record.recordSize),
-                                           m_pPlatform,
-                                           Util::SystemAllocType::AllocInternal);
-
-            if (pCodeObjectRecord != nullptr)
-            {
-                // Write the record header.
-                memcpy(pCodeObjectRecord, &record, sizeof(record));
-
-                // Write the code object binary.
-                result = pLibrary->GetCodeObject(&record.recordSize,
-                                                 Util::VoidPtrInc(pCodeObjectRecord, sizeof(record)));
-
-                if (result != Result::Success)
-                {
-                    // Deallocate if some error occurred.
-                    PAL_SAFE_FREE(pCodeObjectRecord, m_pPlatform)
-                }
-            }
-            else
-            {
-                result = Result::ErrorOutOfMemory;
-            }
-        }
-
-        if (result == Result::Success)
-        {
-            m_registerPipelineLock.LockForWrite();
+        result = m_codeObjectRecordsCache.PushBack(pRecord);
+    }
 
-            m_codeObjectRecordsCache.PushBack(static_cast<SqttCodeObjectDatabaseRecord*>(pCodeObjectRecord));
+    m_registerPipelineLock.UnlockForWrite();
 
-            m_registerPipelineLock.UnlockForWrite();
-        }
+    // The session only keeps the record if the library was registered.
+    if ((result != Result::Success) && (pRecord != nullptr))
+    {
+        m_pCodeObjectStore->Release(pRecord);
     }
 
     return result;
@@ -2786,51 +2898,24 @@ Result GpaSession::RegisterElfBinary(
 
     if (result == Result::Success)
     {
-        // Cache the code object binary in GpaSession-owned memory.
-        SqttCodeObjectDatabaseRecord record = {};
-
-        void* pCodeObjectRecord = nullptr;
-
-        record.recordSize = elfBinaryInfo.binarySize;
+        // The client may free the binary as soon as this returns, so it has to be copied now.
+        SqttCodeObjectDatabaseRecord* pRecord = nullptr;
+        result = m_pCodeObjectStore->Acquire(elfBinaryInfo.compiledHash,
+                                             elfBinaryInfo.pBinary,
+                                             elfBinaryInfo.binarySize,
+                                             &pRecord);
 
         if (result == Result::Success)
         {
-            PAL_ASSERT(record.recordSize != 0);
-
-            // Pad the record size to the nearest multiple of 4 bytes per the RGP file format spec.
-            record.recordSize = Util::RoundUpToMultiple(record.recordSize, 4U);
-
-            // Allocate space to store all the information for one record.
-            pCodeObjectRecord = PAL_MALLOC((sizeof(SqttCodeObjectDatabaseRecord) + record.recordSize),
-                                           m_pPlatform,
-                                           Util::SystemAllocType::AllocInternal);
-
-            if (pCodeObjectRecord != nullptr)
-            {
-                // Write the record header.
-                memcpy(pCodeObjectRecord, &record, sizeof(record));
-
-                // Write the code object binary.
-                memcpy(Util::VoidPtrInc(pCodeObjectRecord,
-                                        sizeof(record)),
-                                        elfBinaryInfo.pBinary,
-                                        record.recordSize);
+            m_registerPipelineLock.LockForWrite();
+            result = m_codeObjectRecordsCache.PushBack(pRecord);
+            m_registerPipelineLock.UnlockForWrite();
 
-            }
-            else
+            if (result != Result::Success)
             {
-                result = Result::ErrorOutOfMemory;
+                m_pCodeObjectStore->Release(pRecord);
             }
         }
-
-        if (result == Result::Success)
-        {
-            m_registerPipelineLock.LockForWrite();
-
-            m_codeObjectRecordsCache.PushBack(static_cast<SqttCodeObjectDatabaseRecord*>(pCodeObjectRecord));
-
-            m_registerPipelineLock.UnlockForWrite();
-        }
     }
 
     return result;
@@ -2902,12 +2987,14 @@ Result GpaSession::ValidatePerfCounters(
 }
 
 // =====================================================================================================================
-// Helper function to add a new code object load event record.
-Result GpaSession::AddCodeObjectLoadEvent(
-    const IPipeline*         pPipeline,
-    CodeObjectLoadEventType  eventType)
+// Helper function to fill out a code object load event record for a pipeline.
+Result GpaSession::BuildCodeObjectLoadEvent(
+    const IPipeline*           pPipeline,
+    CodeObjectLoadEventType    eventType,
+    CodeObjectLoadEventRecord* pRecord
+    ) const
 {
-    PAL_ASSERT(pPipeline != nullptr);
+    PAL_ASSERT((pPipeline != nullptr) && (pRecord != nullptr));
 
     const auto& info = pPipeline->GetInfo();
 
@@ -2925,12 +3012,27 @@ Result GpaSession::AddCodeObjectLoadEvent(
     if (result == Result::Success)
     {
         PAL_ASSERT(gpuSubAlloc.pGpuMemory != nullptr);
-        CodeObjectLoadEventRecord record = { };
-        record.eventType      = eventType;
-        record.baseAddress    = (gpuSubAlloc.pGpuMemory->Desc().gpuVirtAddr + gpuSubAlloc.offset);
-        record.codeObjectHash = { info.internalPipelineHash.stable, info.internalPipelineHash.unique };
-        record.timestamp      = static_cast<uint64>(Util::GetPerfCpuTime());
+        *pRecord = { };
+        pRecord->eventType      = eventType;
+        pRecord->baseAddress    = (gpuSubAlloc.pGpuMemory->Desc().gpuVirtAddr + gpuSubAlloc.offset);
+        pRecord->codeObjectHash = { info.internalPipelineHash.stable, info.internalPipelineHash.unique };
+        pRecord->timestamp      = static_cast<uint64>(Util::GetPerfCpuTime());
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Helper function to add a new code object load event record.
+Result GpaSession::AddCodeObjectLoadEvent(
+    const IPipeline*         pPipeline,
+    CodeObjectLoadEventType  eventType)
+{
+    CodeObjectLoadEventRecord record = { };
+    Result result = BuildCodeObjectLoadEvent(pPipeline, eventType, &record);
 
+    if (result == Result::Success)
+    {
         m_registerPipelineLock.LockForWrite();
         result = m_codeObjectLoadEventRecordsCache.PushBack(record);
         m_registerPipelineLock.UnlockForWrite();
@@ -3745,12 +3847,103 @@ Result GpaSession::AcquirePipeStatsQuery(
     return result;
 }
 
+// =====================================================================================================================
+GpaSession::RgpWriter::RgpWriter(
+    void*  pBuffer,
+    size_t bufferSize)
+    :
+    m_pBuffer(pBuffer),
+    m_bufferSize(bufferSize),
+    m_pfnWrite(nullptr),
+    m_pUserData(nullptr),
+    m_offset(0),
+    m_result(Result::Success),
+    m_stagingSize(0)
+{
+}
+
+// =====================================================================================================================
+GpaSession::RgpWriter::RgpWriter(
+    RgpWriteFunc pfnWrite,
+    void*        pUserData)
+    :
+    m_pBuffer(nullptr),
+    m_bufferSize(0),
+    m_pfnWrite(pfnWrite),
+    m_pUserData(pUserData),
+    m_offset(0),
+    m_result(Result::Success),
+    m_stagingSize(0)
+{
+}
+
+// =====================================================================================================================
+// Appends data to the RGP output.  The file offset is always advanced, even after an error, so that the total size of
+// the RGP file can be reported back to the client.
+void GpaSession::RgpWriter::Write(
+    const void* pData,
+    size_t      dataSize)
+{
+    if (m_result != Result::Success)
+    {
+        // Keep counting, but don't touch the output anymore.
+    }
+    else if (m_pfnWrite != nullptr)
+    {
+        if ((m_stagingSize + dataSize) > sizeof(m_staging))
+        {
+            Flush();
+        }
+
+        if (m_result != Result::Success)
+        {
+            // The client failed to consume the staged data.
+        }
+        else if (dataSize >= sizeof(m_staging))
+        {
+            // Large blocks such as the SQTT data are handed to the client straight from the mapped trace memory.
+            m_result = m_pfnWrite(m_pUserData, pData, dataSize);
+        }
+        else
+        {
+            memcpy(&m_staging[m_stagingSize], pData, dataSize);
+            m_stagingSize += dataSize;
+        }
+    }
+    else if (m_pBuffer != nullptr)
+    {
+        if (static_cast<size_t>(m_offset + dataSize) > m_bufferSize)
+        {
+            m_result = Result::ErrorInvalidMemorySize;
+        }
+        else
+        {
+            memcpy(Util::VoidPtrInc(m_pBuffer, static_cast<size_t>(m_offset)), pData, dataSize);
+        }
+    }
+
+    m_offset += dataSize;
+}
+
+// =====================================================================================================================
+// Hands any staged data over to the client's write callback.
+Result GpaSession::RgpWriter::Flush()
+{
+    if ((m_result == Result::Success) && (m_stagingSize > 0))
+    {
+        m_result = m_pfnWrite(m_pUserData, &m_staging[0], m_stagingSize);
+    }
+
+    m_stagingSize = 0;
+
+    return m_result;
+}
+
 // =====================================================================================================================
 // Dump SQ thread trace data and spm trace data, if available, in rgp format.
 Result GpaSession::DumpRgpData(
     TraceSample* pTraceSample,
-    void*        pRgpOutput,
-    size_t*      pTraceSize   // [in|out] Size of the thread trace data and/or spm trace data.
+    RgpWriter*   pWriter
     ) const
 {
     ThreadTraceLayout* pThreadTraceLayout = nullptr;
@@ -3765,10 +3958,7 @@ Result GpaSession::DumpRgpData(
 
     Result result = Result::Success;
 
-    gpusize curFileOffset = 0;
-
     SqttFileHeader fileHeader   = {};
-    SqttFileHeader* pFileHeader = &fileHeader;
     fileHeader.magicNumber      = SQTT_FILE_MAGIC_NUMBER;
     fileHeader.versionMajor     = RGP_FILE_FORMAT_SPEC_MAJOR_VER;
     fileHeader.versionMinor     = RGP_FILE_FORMAT_SPEC_MINOR_VER;
@@ -3796,35 +3986,13 @@ Result GpaSession::DumpRgpData(
     fileHeader.dayInYear         = time.tm_yday;
     fileHeader.isDaylightSavings = time.tm_isdst;
 
-    if (pRgpOutput != nullptr)
-    {
-        if (static_cast<size_t>(curFileOffset + sizeof(fileHeader)) > *pTraceSize)
-        {
-            result = Result::ErrorInvalidMemorySize;
-        }
-        else
-        {
-            memcpy(pRgpOutput, pFileHeader, sizeof(fileHeader));
-        }
-    }
-    curFileOffset += sizeof(fileHeader);
+    pWriter->Write(fileHeader);
 
     // Get cpu info for rgp dump
     SqttFileChunkCpuInfo cpuInfo = {};
     FillSqttCpuInfo(&cpuInfo);
 
-    if ((result == Result::Success) && (pRgpOutput != nullptr))
-    {
-        if (static_cast<size_t>(curFileOffset + sizeof(cpuInfo)) > *pTraceSize)
-        {
-            result = Result::ErrorInvalidMemorySize;
-        }
-        else
-        {
-            memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)), &cpuInfo, sizeof(cpuInfo));
-        }
-    }
-    curFileOffset += sizeof(cpuInfo);
+    pWriter->Write(cpuInfo);
 
     // Get gpu info for rgp dump
 
@@ -3840,18 +4008,7 @@ Result GpaSession::DumpRgpData(
     SqttFileChunkAsicInfo gpuInfo = {};
     FillSqttAsicInfo(m_deviceProps, m_perfExperimentProps, gpuClocksSample, &gpuInfo);
 
-    if ((result == Result::Success) && (pRgpOutput != nullptr))
-    {
-        if (static_cast<size_t>(curFileOffset + sizeof(gpuInfo)) > *pTraceSize)
-        {
-            result = Result::ErrorInvalidMemorySize;
-        }
-        else
-        {
-            memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)), &gpuInfo, sizeof(gpuInfo));
-        }
-    }
-    curFileOffset += sizeof(gpuInfo);
+    pWriter->Write(gpuInfo);
 
     // Get api info for rgp dump
     SqttFileChunkApiInfo apiInfo              = {};
@@ -3932,18 +4089,7 @@ Result GpaSession::DumpRgpData(
         break;
     }
 
-    if ((result == Result::Success) && (pRgpOutput != nullptr))
-    {
-        if (static_cast<size_t>(curFileOffset + sizeof(apiInfo)) > *pTraceSize)
-        {
-            result = Result::ErrorInvalidMemorySize;
-        }
-        else
-        {
-            memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)), &apiInfo, sizeof(apiInfo));
-        }
-    }
-    curFileOffset += sizeof(apiInfo);
+    pWriter->Write(apiInfo);
 
     if (pTraceSample->IsThreadTraceEnabled())
     {
@@ -3969,18 +4115,7 @@ Result GpaSession::DumpRgpData(
 
             desc.sqttVersion = GfxipToSqttVersion(m_deviceProps.gfxLevel);
 
-            if ((result == Result::Success) && (pRgpOutput != nullptr))
-            {
-                if (static_cast<size_t>(curFileOffset + sizeof(desc)) > *pTraceSize)
-                {
-                    result = Result::ErrorInvalidMemorySize;
-                }
-                else
-                {
-                    memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)), &desc, sizeof(desc));
-                }
-            }
-            curFileOffset += sizeof(desc);
+            pWriter->Write(desc);
 
             // Get data info and data for rgp dump
             const auto& info  = *static_cast<const ThreadTraceInfoData*>(
@@ -3996,239 +4131,132 @@ Result GpaSession::DumpRgpData(
             data.header.chunkIdentifier.chunkType  = SQTT_FILE_CHUNK_TYPE_SQTT_DATA;
             data.header.chunkIdentifier.chunkIndex = i;
             data.header.sizeInBytes                = sizeof(data) + sqttBytesWritten;
-            data.offset                            = static_cast<int32>(curFileOffset + sizeof(data));
+            data.offset                            = static_cast<int32>(pWriter->Offset() + sizeof(data));
             data.size                              = sqttBytesWritten;
 
             data.header.majorVersion = RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_SQTT_DATA].majorVersion;
             data.header.minorVersion = RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_SQTT_DATA].minorVersion;
 
-            if ((result == Result::Success) && (pRgpOutput != nullptr))
-            {
-                if (static_cast<size_t>(curFileOffset + sizeof(data)) > *pTraceSize)
-                {
-                    result = Result::ErrorInvalidMemorySize;
-                }
-                else
-                {
-                    memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)), &data, sizeof(data));
-                }
-            }
-            curFileOffset += sizeof(data);
+            pWriter->Write(data);
 
-            if ((result == Result::Success) && (pRgpOutput != nullptr))
-            {
-                if (static_cast<size_t>(curFileOffset + sqttBytesWritten) > *pTraceSize)
-                {
-                    result = Result::ErrorInvalidMemorySize;
-                }
-                else
-                {
-                    memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)),
-                           pData,
-                           sqttBytesWritten);
-                }
-            }
-            curFileOffset += sqttBytesWritten;
+            // The SQTT data is written straight from the mapped trace buffer.
+            pWriter->Write(pData, sqttBytesWritten);
         }
 
         // Write code object database to the RGP file.
-        if (result == Result::Success)
+        SqttFileChunkCodeObjectDatabase codeObjectDb   = {};
+        codeObjectDb.header.chunkIdentifier.chunkType  = SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_DATABASE;
+        codeObjectDb.header.chunkIdentifier.chunkIndex = 0;
+        codeObjectDb.header.majorVersion =
+            RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_DATABASE].majorVersion;
+        codeObjectDb.header.minorVersion =
+            RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_DATABASE].minorVersion;
+        codeObjectDb.recordCount = static_cast<uint32>(m_curCodeObjectRecords.NumElements());
+
+        uint32 codeObjectDatabaseSize = sizeof(SqttFileChunkCodeObjectDatabase);
+        for (auto iter = m_curCodeObjectRecords.Begin(); iter.Get() != nullptr; iter.Next())
         {
-            if (pRgpOutput != nullptr)
-            {
-                if (static_cast<size_t>(curFileOffset + sizeof(SqttFileChunkCodeObjectDatabase)) > *pTraceSize)
-                {
-                    result = Result::ErrorInvalidMemorySize;
-                }
-                else
-                {
-                    SqttFileChunkCodeObjectDatabase codeObjectDb   = {};
-                    codeObjectDb.header.chunkIdentifier.chunkType  = SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_DATABASE;
-                    codeObjectDb.header.chunkIdentifier.chunkIndex = 0;
-                    codeObjectDb.header.majorVersion =
-                        RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_DATABASE].majorVersion;
-                    codeObjectDb.header.minorVersion =
-                        RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_DATABASE].minorVersion;
-                    codeObjectDb.recordCount = static_cast<uint32>(m_curCodeObjectRecords.NumElements());
-
-                    uint32 codeObjectDatabaseSize = sizeof(SqttFileChunkCodeObjectDatabase);
-                    for (auto iter = m_curCodeObjectRecords.Begin(); iter.Get() != nullptr; iter.Next())
-                    {
-                        codeObjectDatabaseSize += (sizeof(SqttCodeObjectDatabaseRecord) + (*iter.Get())->recordSize);
-                    }
-
-                    // The sizes must be updated by adding the size of the rest of the chunk later.
-                    codeObjectDb.header.sizeInBytes                = codeObjectDatabaseSize;
-                    // TODO: Duplicate - will have to remove later once RGP spec is updated.
-                    codeObjectDb.size                              = codeObjectDatabaseSize;
-
-                    // The code object database starts from the beginning of the chunk.
-                    codeObjectDb.offset                            = static_cast<uint32>(curFileOffset);
+            codeObjectDatabaseSize += (sizeof(SqttCodeObjectDatabaseRecord) + (*iter.Get())->recordSize);
+        }
 
-                    // There are no flags for this chunk in the specification as of yet.
-                    codeObjectDb.flags                             = 0;
+        // The sizes must be updated by adding the size of the rest of the chunk later.
+        codeObjectDb.header.sizeInBytes                = codeObjectDatabaseSize;
+        // TODO: Duplicate - will have to remove later once RGP spec is updated.
+        codeObjectDb.size                              = codeObjectDatabaseSize;
 
-                    memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)),
-                           &codeObjectDb,
-                           sizeof(SqttFileChunkCodeObjectDatabase));
-                }
-            }
+        // The code object database starts from the beginning of the chunk.
+        codeObjectDb.offset                            = static_cast<uint32>(pWriter->Offset());
 
-            curFileOffset += sizeof(SqttFileChunkCodeObjectDatabase);
+        // There are no flags for this chunk in the specification as of yet.
+        codeObjectDb.flags                             = 0;
 
-            for (auto iter = m_curCodeObjectRecords.Begin(); iter.Get() != nullptr; iter.Next())
-            {
-                SqttCodeObjectDatabaseRecord* pCodeObjectRecord = *iter.Get();
-                const size_t recordTotalSize = (sizeof(SqttCodeObjectDatabaseRecord) + pCodeObjectRecord->recordSize);
+        pWriter->Write(codeObjectDb);
 
-                if ((result == Result::Success) && (pRgpOutput != nullptr))
-                {
-                    if (static_cast<size_t>(curFileOffset + recordTotalSize) > *pTraceSize)
-                    {
-                        result = Result::ErrorInvalidMemorySize;
-                    }
-                    else
-                    {
-                        // Copy one record to the buffer provided.
-                        memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)),
-                               pCodeObjectRecord,
-                               recordTotalSize);
-                    }
-                }
+        for (auto iter = m_curCodeObjectRecords.Begin(); iter.Get() != nullptr; iter.Next())
+        {
+            const SqttCodeObjectDatabaseRecord* pCodeObjectRecord = *iter.Get();
 
-                curFileOffset += recordTotalSize;
-            }
+            // Copy one record to the output.
+            pWriter->Write(pCodeObjectRecord, (sizeof(SqttCodeObjectDatabaseRecord) + pCodeObjectRecord->recordSize));
         }
 
         // Write API code object loader events to the RGP file.
-        if (result == Result::Success)
-        {
-            const size_t chunkTotalSize = (sizeof(SqttFileChunkCodeObjectLoaderEvents) +
-                (sizeof(SqttCodeObjectLoaderEventRecord) * m_curCodeObjectLoadEventRecords.NumElements()));
+        const size_t loaderEventsChunkSize = (sizeof(SqttFileChunkCodeObjectLoaderEvents) +
+            (sizeof(SqttCodeObjectLoaderEventRecord) * m_curCodeObjectLoadEventRecords.NumElements()));
 
-            if (pRgpOutput != nullptr)
-            {
-                if (static_cast<size_t>(curFileOffset + chunkTotalSize) > *pTraceSize)
-                {
-                    result = Result::ErrorInvalidMemorySize;
-                }
-                else
-                {
-                    SqttFileChunkCodeObjectLoaderEvents loaderEvents = {};
-                    loaderEvents.header.chunkIdentifier.chunkType    = SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_LOADER_EVENTS;
-                    loaderEvents.header.chunkIdentifier.chunkIndex   = 0;
-                    loaderEvents.header.majorVersion =
-                        RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_LOADER_EVENTS].majorVersion;
-                    loaderEvents.header.minorVersion =
-                        RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_LOADER_EVENTS].minorVersion;
-                    loaderEvents.recordCount         =
-                        static_cast<uint32>(m_curCodeObjectLoadEventRecords.NumElements());
-                    loaderEvents.recordSize          = sizeof(SqttCodeObjectLoaderEventRecord);
-
-                    loaderEvents.header.sizeInBytes  = static_cast<int32>(chunkTotalSize);
-
-                    // The loader events start from the beginning of the chunk.
-                    loaderEvents.offset              = static_cast<uint32>(curFileOffset);
-
-                    // There are no flags for this chunk in the specification as of yet.
-                    loaderEvents.flags               = 0;
-
-                    memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)),
-                           &loaderEvents,
-                           sizeof(SqttFileChunkCodeObjectLoaderEvents));
-                }
-            }
+        SqttFileChunkCodeObjectLoaderEvents loaderEvents = {};
+        loaderEvents.header.chunkIdentifier.chunkType    = SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_LOADER_EVENTS;
+        loaderEvents.header.chunkIdentifier.chunkIndex   = 0;
+        loaderEvents.header.majorVersion =
+            RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_LOADER_EVENTS].majorVersion;
+        loaderEvents.header.minorVersion =
+            RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_CODE_OBJECT_LOADER_EVENTS].minorVersion;
+        loaderEvents.recordCount         = static_cast<uint32>(m_curCodeObjectLoadEventRecords.NumElements());
+        loaderEvents.recordSize          = sizeof(SqttCodeObjectLoaderEventRecord);
 
-            curFileOffset += sizeof(SqttFileChunkCodeObjectLoaderEvents);
+        loaderEvents.header.sizeInBytes  = static_cast<int32>(loaderEventsChunkSize);
 
-            constexpr SqttCodeObjectLoaderEventType PalToSqttLoadEvent[] =
-            {
-                SQTT_CODE_OBJECT_LOAD_TO_GPU_MEMORY,     // CodeObjectLoadEventType::LoadToGpuMemory
-                SQTT_CODE_OBJECT_UNLOAD_FROM_GPU_MEMORY, // CodeObjectLoadEventType::UnloadFromGpuMemory
-            };
+        // The loader events start from the beginning of the chunk.
+        loaderEvents.offset              = static_cast<uint32>(pWriter->Offset());
 
-            for (auto iter = m_curCodeObjectLoadEventRecords.Begin(); iter.Get() != nullptr; iter.Next())
-            {
-                const CodeObjectLoadEventRecord& srcRecord = *iter.Get();
+        // There are no flags for this chunk in the specification as of yet.
+        loaderEvents.flags               = 0;
 
-                if ((result == Result::Success) && (pRgpOutput != nullptr))
-                {
-                    SqttCodeObjectLoaderEventRecord sqttRecord = {};
-                    sqttRecord.eventType      =
-                        PalToSqttLoadEvent[static_cast<uint32>(srcRecord.eventType)];
-                    sqttRecord.baseAddress    = srcRecord.baseAddress;
-                    sqttRecord.codeObjectHash = { srcRecord.codeObjectHash.lower, srcRecord.codeObjectHash.upper };
-                    sqttRecord.timestamp      = srcRecord.timestamp;
-
-                    // Copy one record to the buffer provided.
-                    memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)),
-                           &sqttRecord,
-                           sizeof(SqttCodeObjectLoaderEventRecord));
-                }
+        pWriter->Write(loaderEvents);
 
-                curFileOffset += sizeof(SqttCodeObjectLoaderEventRecord);
-            }
+        constexpr SqttCodeObjectLoaderEventType PalToSqttLoadEvent[] =
+        {
+            SQTT_CODE_OBJECT_LOAD_TO_GPU_MEMORY,     // CodeObjectLoadEventType::LoadToGpuMemory
+            SQTT_CODE_OBJECT_UNLOAD_FROM_GPU_MEMORY, // CodeObjectLoadEventType::UnloadFromGpuMemory
+        };
+
+        for (auto iter = m_curCodeObjectLoadEventRecords.Begin(); iter.Get() != nullptr; iter.Next())
+        {
+            const CodeObjectLoadEventRecord& srcRecord = *iter.Get();
+
+            SqttCodeObjectLoaderEventRecord sqttRecord = {};
+            sqttRecord.eventType      = PalToSqttLoadEvent[static_cast<uint32>(srcRecord.eventType)];
+            sqttRecord.baseAddress    = srcRecord.baseAddress;
+            sqttRecord.codeObjectHash = { srcRecord.codeObjectHash.lower, srcRecord.codeObjectHash.upper };
+            sqttRecord.timestamp      = srcRecord.timestamp;
+
+            pWriter->Write(sqttRecord);
         }
 
         // Write API PSO -> internal pipeline correlation chunk.
-        if (result == Result::Success)
-        {
-            const size_t chunkTotalSize = (sizeof(SqttFileChunkPsoCorrelation) +
-                (sizeof(SqttPsoCorrelationRecord) * m_curPsoCorrelationRecords.NumElements()));
+        const size_t psoCorrelationChunkSize = (sizeof(SqttFileChunkPsoCorrelation) +
+            (sizeof(SqttPsoCorrelationRecord) * m_curPsoCorrelationRecords.NumElements()));
 
-            if (pRgpOutput != nullptr)
-            {
-                if (static_cast<size_t>(curFileOffset + chunkTotalSize) > *pTraceSize)
-                {
-                    result = Result::ErrorInvalidMemorySize;
-                }
-                else
-                {
-                    SqttFileChunkPsoCorrelation psoCorrelations       = {};
-                    psoCorrelations.header.chunkIdentifier.chunkType  = SQTT_FILE_CHUNK_TYPE_PSO_CORRELATION;
-                    psoCorrelations.header.chunkIdentifier.chunkIndex = 0;
-                    psoCorrelations.header.majorVersion =
-                        RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_PSO_CORRELATION].majorVersion;
-                    psoCorrelations.header.minorVersion =
-                        RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_PSO_CORRELATION].minorVersion;
-                    psoCorrelations.recordCount         = static_cast<uint32>(m_curPsoCorrelationRecords.NumElements());
-                    psoCorrelations.recordSize          = sizeof(SqttPsoCorrelationRecord);
-
-                    psoCorrelations.header.sizeInBytes  = static_cast<int32>(chunkTotalSize);
-
-                    // The PSO correlations start from the beginning of the chunk.
-                    psoCorrelations.offset              = static_cast<uint32>(curFileOffset);
-
-                    // There are no flags for this chunk in the specification as of yet.
-                    psoCorrelations.flags               = 0;
-
-                    memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)),
-                           &psoCorrelations,
-                           sizeof(SqttFileChunkPsoCorrelation));
-                }
-            }
+        SqttFileChunkPsoCorrelation psoCorrelations       = {};
+        psoCorrelations.header.chunkIdentifier.chunkType  = SQTT_FILE_CHUNK_TYPE_PSO_CORRELATION;
+        psoCorrelations.header.chunkIdentifier.chunkIndex = 0;
+        psoCorrelations.header.majorVersion =
+            RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_PSO_CORRELATION].majorVersion;
+        psoCorrelations.header.minorVersion =
+            RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_PSO_CORRELATION].minorVersion;
+        psoCorrelations.recordCount         = static_cast<uint32>(m_curPsoCorrelationRecords.NumElements());
+        psoCorrelations.recordSize          = sizeof(SqttPsoCorrelationRecord);
 
-            curFileOffset += sizeof(SqttFileChunkPsoCorrelation);
+        psoCorrelations.header.sizeInBytes  = static_cast<int32>(psoCorrelationChunkSize);
 
-            for (auto iter = m_curPsoCorrelationRecords.Begin(); iter.Get() != nullptr; iter.Next())
-            {
-                const PsoCorrelationRecord& srcRecord = *iter.Get();
+        // The PSO correlations start from the beginning of the chunk.
+        psoCorrelations.offset              = static_cast<uint32>(pWriter->Offset());
 
-                if ((result == Result::Success) && (pRgpOutput != nullptr))
-                {
-                    SqttPsoCorrelationRecord sqttRecord = { };
-                    sqttRecord.apiPsoHash           = srcRecord.apiPsoHash;
-                    sqttRecord.internalPipelineHash =
-                        { srcRecord.internalPipelineHash.stable, srcRecord.internalPipelineHash.unique };
-
-                    // Copy one record to the buffer provided.
-                    memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)),
-                           &sqttRecord,
-                           sizeof(SqttPsoCorrelationRecord));
-                }
+        // There are no flags for this chunk in the specification as of yet.
+        psoCorrelations.flags               = 0;
 
-                curFileOffset += sizeof(SqttPsoCorrelationRecord);
-            }
+        pWriter->Write(psoCorrelations);
+
+        for (auto iter = m_curPsoCorrelationRecords.Begin(); iter.Get() != nullptr; iter.Next())
+        {
+            const PsoCorrelationRecord& srcRecord = *iter.Get();
+
+            SqttPsoCorrelationRecord sqttRecord = { };
+            sqttRecord.apiPsoHash           = srcRecord.apiPsoHash;
+            sqttRecord.internalPipelineHash =
+                { srcRecord.internalPipelineHash.stable, srcRecord.internalPipelineHash.unique };
+
+            pWriter->Write(sqttRecord);
         }
     }
 
@@ -4258,155 +4286,116 @@ Result GpaSession::DumpRgpData(
         eventTimings.queueEventTableRecordCount = numQueueEventRecords;
         eventTimings.queueEventTableSize = queueEventTableSize;
 
-        // Write the chunk header into the buffer
-        if ((result == Result::Success) && (pRgpOutput != nullptr))
-        {
-            if (static_cast<size_t>(curFileOffset + sizeof(eventTimings)) > *pTraceSize)
-            {
-                result = Result::ErrorInvalidMemorySize;
-            }
-            else
-            {
-                memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)),
-                    &eventTimings,
-                    sizeof(eventTimings));
-            }
-        }
-        curFileOffset += sizeof(eventTimings);
+        // Write the chunk header
+        pWriter->Write(eventTimings);
 
         // Write the queue info table
-        if ((result == Result::Success) && (pRgpOutput != nullptr))
+        for (uint32 queueIndex = 0; queueIndex < numQueueInfoRecords; ++queueIndex)
         {
-            if (static_cast<size_t>(curFileOffset + queueInfoTableSize) > *pTraceSize)
-            {
-                result = Result::ErrorInvalidMemorySize;
-            }
-            else
-            {
-                void* pQueueInfoTableFileOffset = Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset));
-
-                for (uint32 queueIndex = 0; queueIndex < numQueueInfoRecords; ++queueIndex)
-                {
-                    TimedQueueState* pQueueState = m_timedQueuesArray.At(queueIndex);
-
-                    SqttQueueInfoRecord queueInfoRecord     = {};
-                    queueInfoRecord.queueID                 = pQueueState->queueId;
-                    queueInfoRecord.queueContext            = pQueueState->queueContext;
-                    queueInfoRecord.hardwareInfo.queueType  = PalQueueTypeToSqttQueueType[pQueueState->queueType];
-                    queueInfoRecord.hardwareInfo.engineType = PalEngineTypeToSqttEngineType[pQueueState->engineType];
+            TimedQueueState* pQueueState = m_timedQueuesArray.At(queueIndex);
 
-                    memcpy(pQueueInfoTableFileOffset, &queueInfoRecord, sizeof(queueInfoRecord));
+            SqttQueueInfoRecord queueInfoRecord     = {};
+            queueInfoRecord.queueID                 = pQueueState->queueId;
+            queueInfoRecord.queueContext            = pQueueState->queueContext;
+            queueInfoRecord.hardwareInfo.queueType  = PalQueueTypeToSqttQueueType[pQueueState->queueType];
+            queueInfoRecord.hardwareInfo.engineType = PalEngineTypeToSqttEngineType[pQueueState->engineType];
 
-                    pQueueInfoTableFileOffset = Util::VoidPtrInc(pQueueInfoTableFileOffset, sizeof(queueInfoRecord));
-                }
-            }
+            pWriter->Write(queueInfoRecord);
         }
-        curFileOffset += queueInfoTableSize;
 
-        // Write the queue event table
-        if ((result == Result::Success) && (pRgpOutput != nullptr))
+        // Write the queue event table.  The GPU timestamps are only read when the output is actually consumed.
+        for (uint32 eventIndex = 0; eventIndex < numQueueEventRecords; ++eventIndex)
         {
-            if (static_cast<size_t>(curFileOffset + queueEventTableSize) > *pTraceSize)
-            {
-                result = Result::ErrorInvalidMemorySize;
-            }
-            else
+            SqttQueueEventRecord queueEventRecord = {};
+
+            if (pWriter->IsCounting() == false)
             {
-                void* pQueueEventTableFileOffset = Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset));
+                const TimedQueueEventItem* pQueueEvent = &m_queueEvents.At(eventIndex);
 
-                for (uint32 eventIndex = 0; eventIndex < numQueueEventRecords; ++eventIndex)
-                {
-                    const TimedQueueEventItem* pQueueEvent = &m_queueEvents.At(eventIndex);
+                queueEventRecord.frameIndex           = pQueueEvent->frameIndex;
+                queueEventRecord.queueInfoIndex       = pQueueEvent->queueIndex;
+                queueEventRecord.cpuTimestamp         = pQueueEvent->cpuTimestamp;
 
-                    SqttQueueEventRecord queueEventRecord = {};
-                    queueEventRecord.frameIndex           = pQueueEvent->frameIndex;
-                    queueEventRecord.queueInfoIndex       = pQueueEvent->queueIndex;
-                    queueEventRecord.cpuTimestamp         = pQueueEvent->cpuTimestamp;
+                switch (pQueueEvent->eventType)
+                {
+                case TimedQueueEventType::Submit:
+                {
+                    const uint64* pPreTimestamp = reinterpret_cast<const uint64*>(Util::VoidPtrInc(
+                        pQueueEvent->gpuTimestamps.memInfo[0].pCpuAddr,
+                        static_cast<size_t>(pQueueEvent->gpuTimestamps.offsets[0])));
 
-                    switch (pQueueEvent->eventType)
-                    {
-                    case TimedQueueEventType::Submit:
-                    {
-                        const uint64* pPreTimestamp = reinterpret_cast<const uint64*>(Util::VoidPtrInc(
-                            pQueueEvent->gpuTimestamps.memInfo[0].pCpuAddr,
-                            static_cast<size_t>(pQueueEvent->gpuTimestamps.offsets[0])));
-
-                        const uint64* pPostTimestamp = reinterpret_cast<const uint64*>(Util::VoidPtrInc(
-                            pQueueEvent->gpuTimestamps.memInfo[1].pCpuAddr,
-                            static_cast<size_t>(pQueueEvent->gpuTimestamps.offsets[1])));
-
-                        queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_CMDBUF_SUBMIT;
-                        queueEventRecord.gpuTimestamps[0] = *pPreTimestamp;
-                        queueEventRecord.gpuTimestamps[1] = *pPostTimestamp;
-                        queueEventRecord.apiId            = pQueueEvent->apiId;
-                        queueEventRecord.sqttCbId         = pQueueEvent->sqttCmdBufId;
-                        queueEventRecord.submitSubIndex   = pQueueEvent->submitSubIndex;
-
-                        break;
-                    }
+                    const uint64* pPostTimestamp = reinterpret_cast<const uint64*>(Util::VoidPtrInc(
+                        pQueueEvent->gpuTimestamps.memInfo[1].pCpuAddr,
+                        static_cast<size_t>(pQueueEvent->gpuTimestamps.offsets[1])));
 
-                    case TimedQueueEventType::Signal:
-                    {
-                        queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_SIGNAL_SEMAPHORE;
-                        queueEventRecord.apiId            = pQueueEvent->apiId;
+                    queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_CMDBUF_SUBMIT;
+                    queueEventRecord.gpuTimestamps[0] = *pPreTimestamp;
+                    queueEventRecord.gpuTimestamps[1] = *pPostTimestamp;
+                    queueEventRecord.apiId            = pQueueEvent->apiId;
+                    queueEventRecord.sqttCbId         = pQueueEvent->sqttCmdBufId;
+                    queueEventRecord.submitSubIndex   = pQueueEvent->submitSubIndex;
 
-                        break;
-                    }
+                    break;
+                }
 
-                    case TimedQueueEventType::Wait:
-                    {
-                        queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_WAIT_SEMAPHORE;
-                        queueEventRecord.apiId            = pQueueEvent->apiId;
+                case TimedQueueEventType::Signal:
+                {
+                    queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_SIGNAL_SEMAPHORE;
+                    queueEventRecord.apiId            = pQueueEvent->apiId;
 
-                        break;
-                    }
+                    break;
+                }
 
-                    case TimedQueueEventType::Present:
-                    {
-                        const uint64* pTimestamp = reinterpret_cast<const uint64*>(Util::VoidPtrInc(
-                            pQueueEvent->gpuTimestamps.memInfo[0].pCpuAddr,
-                            static_cast<size_t>(pQueueEvent->gpuTimestamps.offsets[0])));
+                case TimedQueueEventType::Wait:
+                {
+                    queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_WAIT_SEMAPHORE;
+                    queueEventRecord.apiId            = pQueueEvent->apiId;
 
-                        queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_PRESENT;
-                        queueEventRecord.gpuTimestamps[0] = *pTimestamp;
-                        queueEventRecord.apiId            = pQueueEvent->apiId;
+                    break;
+                }
 
-                        break;
-                    }
+                case TimedQueueEventType::Present:
+                {
+                    const uint64* pTimestamp = reinterpret_cast<const uint64*>(Util::VoidPtrInc(
+                        pQueueEvent->gpuTimestamps.memInfo[0].pCpuAddr,
+                        static_cast<size_t>(pQueueEvent->gpuTimestamps.offsets[0])));
 
-                    case TimedQueueEventType::ExternalSignal:
-                    {
-                        queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_SIGNAL_SEMAPHORE;
-                        queueEventRecord.gpuTimestamps[0] = ExtractGpuTimestampFromQueueEvent(*pQueueEvent);
-                        queueEventRecord.apiId            = pQueueEvent->apiId;
+                    queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_PRESENT;
+                    queueEventRecord.gpuTimestamps[0] = *pTimestamp;
+                    queueEventRecord.apiId            = pQueueEvent->apiId;
 
-                        break;
-                    }
+                    break;
+                }
 
-                    case TimedQueueEventType::ExternalWait:
-                    {
-                        queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_WAIT_SEMAPHORE;
-                        queueEventRecord.gpuTimestamps[0] = ExtractGpuTimestampFromQueueEvent(*pQueueEvent);
-                        queueEventRecord.apiId            = pQueueEvent->apiId;
+                case TimedQueueEventType::ExternalSignal:
+                {
+                    queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_SIGNAL_SEMAPHORE;
+                    queueEventRecord.gpuTimestamps[0] = ExtractGpuTimestampFromQueueEvent(*pQueueEvent);
+                    queueEventRecord.apiId            = pQueueEvent->apiId;
 
-                        break;
-                    }
+                    break;
+                }
 
-                    default:
-                    {
-                        // Invalid event type
-                        PAL_ASSERT_ALWAYS();
-                        break;
-                    }
-                    }
+                case TimedQueueEventType::ExternalWait:
+                {
+                    queueEventRecord.eventType        = SQTT_QUEUE_TIMING_EVENT_WAIT_SEMAPHORE;
+                    queueEventRecord.gpuTimestamps[0] = ExtractGpuTimestampFromQueueEvent(*pQueueEvent);
+                    queueEventRecord.apiId            = pQueueEvent->apiId;
 
-                    memcpy(pQueueEventTableFileOffset, &queueEventRecord, sizeof(queueEventRecord));
+                    break;
+                }
 
-                    pQueueEventTableFileOffset = Util::VoidPtrInc(pQueueEventTableFileOffset, sizeof(queueEventRecord));
+                default:
+                {
+                    // Invalid event type
+                    PAL_ASSERT_ALWAYS();
+                    break;
+                }
                 }
             }
+
+            pWriter->Write(queueEventRecord);
         }
-        curFileOffset += queueEventTableSize;
 
         // SqttClockCalibration chunk
         SqttFileChunkClockCalibration clockCalibration = {};
@@ -4435,86 +4424,60 @@ Result GpaSession::DumpRgpData(
                 clockCalibration.gpuTimestamp = timestampCalibration.gpuTimestamp;
             }
 
-            // Write the chunk header into the buffer
-            if ((result == Result::Success) && (pRgpOutput != nullptr))
-            {
-                if (static_cast<size_t>(curFileOffset + sizeof(clockCalibration)) > *pTraceSize)
-                {
-                    result = Result::ErrorInvalidMemorySize;
-                }
-                else
-                {
-                    memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(curFileOffset)),
-                        &clockCalibration,
-                        sizeof(clockCalibration));
-                }
-            }
-            curFileOffset += sizeof(clockCalibration);
+            pWriter->Write(clockCalibration);
         }
     }
 
-    if ((result == Result::Success) && (pTraceSample->IsSpmTraceEnabled()))
+    if (pTraceSample->IsSpmTraceEnabled())
     {
         // Add Spm chunk to RGP file.
-        result = AppendSpmTraceData(pTraceSample, (*pTraceSize), pRgpOutput, &curFileOffset);
+        AppendSpmTraceData(pTraceSample, pWriter);
     }
 
-    *pTraceSize = static_cast<size_t>(curFileOffset);
+    if (result == Result::Success)
+    {
+        result = pWriter->Flush();
+    }
 
     return result;
 }
 
 // =====================================================================================================================
-// Appends the spm trace data in the buffer provided. If nullptr buffer is provided, it returns the size required for
-// the spm data.
-Result GpaSession::AppendSpmTraceData(
+// Appends the spm trace data to the RGP output. If the writer is only counting, this just accounts for the size
+// required for the spm data.
+void GpaSession::AppendSpmTraceData(
     TraceSample* pTraceSample,  // [in] The PerfSample from which to get the spm trace data.
-    size_t       bufferSize,    // [in] Size of the buffer.
-    void*        pRgpOutput,    // [out] The buffer into which spm trace data is written. May contain thread trace data.
-    gpusize*     pCurFileOffset // [in|out] Current wptr position in buffer.
+    RgpWriter*   pWriter        // [in] Destination of the spm trace data. May already contain thread trace data.
     ) const
 {
-    Result result = Result::Success;
-
     // Initialize the Sqtt chunk, get the spm trace results and add to the file.
     gpusize spmDataSize   = 0;
     gpusize numSpmSamples = 0;
     pTraceSample->GetSpmResultsSize(&spmDataSize, &numSpmSamples);
 
-    if (pRgpOutput != nullptr)
-    {
-        // Header for spm chunk.
-        if (static_cast<gpusize>(*pCurFileOffset + sizeof(SqttFileChunkSpmDb) + spmDataSize) > bufferSize)
-        {
-            result = Result::ErrorOutOfMemory;
-        }
-        else
-        {
-            // Write the chunk header first.
-            SqttFileChunkSpmDb spmDbChunk               = { };
-            spmDbChunk.header.chunkIdentifier.chunkType = SQTT_FILE_CHUNK_TYPE_SPM_DB;
-            spmDbChunk.header.sizeInBytes               = static_cast<int32>(sizeof(SqttFileChunkSpmDb) + spmDataSize);
-            spmDbChunk.numTimestamps                    = static_cast<uint32>(numSpmSamples);
-            spmDbChunk.numSpmCounterInfo                = pTraceSample->GetNumSpmCounters();
-            spmDbChunk.samplingInterval                 = pTraceSample->GetSpmSampleInterval();
-            spmDbChunk.preambleSize                     = sizeof(SqttFileChunkSpmDb);
-            spmDbChunk.spmCounterInfoSize               = sizeof(SpmCounterInfo);
-
-            spmDbChunk.header.majorVersion = RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_SPM_DB].majorVersion;
-            spmDbChunk.header.minorVersion = RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_SPM_DB].minorVersion;
+    // Write the chunk header first.
+    SqttFileChunkSpmDb spmDbChunk               = { };
+    spmDbChunk.header.chunkIdentifier.chunkType = SQTT_FILE_CHUNK_TYPE_SPM_DB;
+    spmDbChunk.header.sizeInBytes               = static_cast<int32>(sizeof(SqttFileChunkSpmDb) + spmDataSize);
+    spmDbChunk.numTimestamps                    = static_cast<uint32>(numSpmSamples);
+    spmDbChunk.numSpmCounterInfo                = pTraceSample->GetNumSpmCounters();
+    spmDbChunk.samplingInterval                 = pTraceSample->GetSpmSampleInterval();
+    spmDbChunk.preambleSize                     = sizeof(SqttFileChunkSpmDb);
+    spmDbChunk.spmCounterInfoSize               = sizeof(SpmCounterInfo);
 
-            memcpy(Util::VoidPtrInc(pRgpOutput, static_cast<size_t>(*pCurFileOffset)), &spmDbChunk, sizeof(spmDbChunk));
+    spmDbChunk.header.majorVersion = RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_SPM_DB].majorVersion;
+    spmDbChunk.header.minorVersion = RgpChunkVersionNumberLookup[SQTT_FILE_CHUNK_TYPE_SPM_DB].minorVersion;
 
-            size_t curWriteOffset = static_cast<size_t>(*pCurFileOffset + sizeof(SqttFileChunkSpmDb));
+    pWriter->Write(spmDbChunk);
 
-            result = pTraceSample->GetSpmTraceResults(Util::VoidPtrInc(pRgpOutput, curWriteOffset),
-                                                      (bufferSize - curWriteOffset));
-        }
+    if (pWriter->IsCounting())
+    {
+        pWriter->Skip(static_cast<size_t>(spmDataSize));
+    }
+    else
+    {
+        pTraceSample->WriteSpmTraceResults(pWriter);
     }
-
-    (*pCurFileOffset) += (sizeof(SqttFileChunkSpmDb) + spmDataSize);
-
-    return result;
 }
 
 // =====================================================================================================================
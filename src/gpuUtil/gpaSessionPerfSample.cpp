@@ -339,11 +339,10 @@ void GpaSession::TraceSample::GetSpmResultsSize(
 }
 
 // =====================================================================================================================
-// Returns the size of the SPM counter delta output if nullptr buffer is provided, or outputs the counter sample values
-// into the buffer provided.
-Result GpaSession::TraceSample::GetSpmTraceResults(
-    void*  pDstBuffer,
-    size_t bufferSize)
+// Converts the SPM ring buffer contents into the RGP SPM layout and streams the result into the RGP output.  The
+// conversion is done in small batches so no intermediate copy of the whole SPM chunk is needed.
+void GpaSession::TraceSample::WriteSpmTraceResults(
+    RgpWriter* pWriter)
 {
     /* RGP Layout for SPM trace data:
      *   1. Header
@@ -354,7 +353,7 @@ Result GpaSession::TraceSample::GetSpmTraceResults(
      *   6. Counter values[]
     */
 
-    Result result = Result::Success;
+    constexpr uint32 BatchSize = 256;
 
     const size_t NumMetadataBytes         = 32;
     const gpusize SampleSizeInQWords      = m_pSpmTraceLayout->sampleSizeInBytes / sizeof(uint64);
@@ -362,35 +361,32 @@ Result GpaSession::TraceSample::GetSpmTraceResults(
     const size_t TimestampDataSizeInBytes = m_numSpmSamples * sizeof(gpusize);
     const gpusize CounterDataSizeInBytes  = m_numSpmSamples * sizeof(uint16); // Size of data written for one counter.
     const size_t CounterInfoSizeInBytes   = m_numSpmCounters * sizeof(SpmCounterInfo);
-    const uint32  SegmentSizeInWords      = m_pSpmTraceLayout->sampleSizeInBytes / sizeof(uint16);
     const size_t CounterDataOffset        = TimestampDataSizeInBytes + CounterInfoSizeInBytes;
 
-    // A valid destination buffer size is expected.
-    PAL_ASSERT((bufferSize > 0) && (pDstBuffer != nullptr));
-
     // Start of the spm results section.
     void* pSrcBufferStart = Util::VoidPtrInc(m_pPerfExpResults,
                                              static_cast<size_t>(m_pSpmTraceLayout->offset));
 
-    // Extract timestamps from m_perfExpResults
-    uint32 numSpmDwords = static_cast<uint32*>(pSrcBufferStart)[0];
-
     // Move to the actual start of the Spm data. The first dword is the wptr. There are 32 bytes of
     // reserved fields after which the data begins.
     void* pSrcDataStart = Util::VoidPtrInc(pSrcBufferStart, NumMetadataBytes);
-    uint64* pTimestamp = static_cast<uint64*>(pSrcDataStart);
+    const uint64* pTimestamp = static_cast<const uint64*>(pSrcDataStart);
 
-    for (int32 sample = 0; sample < m_numSpmSamples; ++sample)
+    // RGP Spm output: Write the timestamps.
+    uint64 timestamps[BatchSize];
+    for (int32 sample = 0; sample < m_numSpmSamples; )
     {
-        // RGP Spm output: Write the timestamps.
-        static_cast<uint64*>(pDstBuffer)[sample] = *pTimestamp;
+        const uint32 batchCount = Util::Min(BatchSize, static_cast<uint32>(m_numSpmSamples - sample));
 
-        pTimestamp += SampleSizeInQWords;
-    }
+        for (uint32 i = 0; i < batchCount; ++i)
+        {
+            timestamps[i] = *pTimestamp;
+            pTimestamp   += SampleSizeInQWords;
+        }
 
-    // Beginning of the SpmCounterInfo section.
-    SpmCounterInfo* pCounterInfo =
-        static_cast<SpmCounterInfo*>(Util::VoidPtrInc(pDstBuffer, TimestampDataSizeInBytes));
+        pWriter->Write(&timestamps[0], batchCount * sizeof(uint64));
+        sample += batchCount;
+    }
 
     // Offset from the beginning of the RGP spm chunk to where the counter values begin.
     gpusize curCounterDataOffset = CounterDataOffset;
@@ -398,41 +394,41 @@ Result GpaSession::TraceSample::GetSpmTraceResults(
     // RGP SPM output: write the SpmCounterInfo for each counter.
     for (uint32 counter = 0; counter < m_numSpmCounters; counter++)
     {
-        pCounterInfo[counter].block      = static_cast<SpmGpuBlock>(m_pSpmTraceLayout->counterData[counter].gpuBlock);
-        pCounterInfo[counter].instance   = m_pSpmTraceLayout->counterData[counter].instance;
-        pCounterInfo[counter].dataOffset = static_cast<uint32>(curCounterDataOffset);
-        pCounterInfo[counter].eventIndex = m_pSpmTraceLayout->counterData[counter].eventId;
-        pCounterInfo[counter].dataSize   = sizeof(uint16);
+        SpmCounterInfo counterInfo = {};
+        counterInfo.block      = static_cast<SpmGpuBlock>(m_pSpmTraceLayout->counterData[counter].gpuBlock);
+        counterInfo.instance   = m_pSpmTraceLayout->counterData[counter].instance;
+        counterInfo.dataOffset = static_cast<uint32>(curCounterDataOffset);
+        counterInfo.eventIndex = m_pSpmTraceLayout->counterData[counter].eventId;
+        counterInfo.dataSize   = sizeof(uint16);
+
+        pWriter->Write(counterInfo);
 
         curCounterDataOffset += CounterDataSizeInBytes;
     }
 
     // Read pointer points to the first segment of the first sample.
-    uint16* pSample = static_cast<uint16*>(pSrcDataStart);
-
-    // Index within the SPM ring buffer, which is considered an array of uint16.
-    gpusize index = 0;
-    gpusize offset = 0;
-
-    // Write pointer points to the beginning ofthe first counter data.
-    uint16* pDstCounterData = static_cast<uint16*>(Util::VoidPtrInc(pDstBuffer, CounterDataOffset));
+    const uint16* pSample = static_cast<const uint16*>(pSrcDataStart);
 
+    // RGP SPM OUTPUT: write the delta values of each counter for all samples.
+    uint16 counterValues[BatchSize];
     for (uint32 counter = 0; counter < m_numSpmCounters; counter++)
     {
-        offset = m_pSpmTraceLayout->counterData[counter].offset;
+        const gpusize offset = m_pSpmTraceLayout->counterData[counter].offset;
 
-        for (int32 sample = 0; sample < m_numSpmSamples; sample++)
+        for (int32 sample = 0; sample < m_numSpmSamples; )
         {
-            index = offset + (sample * SampleSizeInWords);
+            const uint32 batchCount = Util::Min(BatchSize, static_cast<uint32>(m_numSpmSamples - sample));
 
-            // RGP SPM OUTPUT: write the delta values of the current counter for all samples.
-            (*pDstCounterData) = pSample[index];
-            pDstCounterData++;
+            for (uint32 i = 0; i < batchCount; ++i)
+            {
+                // Index within the SPM ring buffer, which is considered an array of uint16.
+                counterValues[i] = pSample[offset + ((sample + i) * SampleSizeInWords)];
+            }
 
+            pWriter->Write(&counterValues[0], batchCount * sizeof(uint16));
+            sample += batchCount;
         } // Iterate over samples.
     } // Iterate over counters.
-
-    return result;
 }
 
 // =====================================================================================================================
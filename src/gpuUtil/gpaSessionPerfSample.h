@@ -65,6 +65,47 @@ struct GpaSession::SampleItem
     PerfSample*           pPerfSample;
 };
 
+// =====================================================================================================================
+// Destination of the RGP file produced by GpaSession::DumpRgpData.  The RGP data is either copied into a client buffer,
+// only counted to report the required buffer size, or streamed out through a client callback.  When streaming, small
+// writes are batched in a fixed staging buffer and large blocks are passed through without an intermediate copy.
+class GpaSession::RgpWriter
+{
+public:
+    // Writes into pBuffer, or only counts the written bytes if pBuffer is null.
+    RgpWriter(void* pBuffer, size_t bufferSize);
+    // Streams all written data through pfnWrite.
+    RgpWriter(RgpWriteFunc pfnWrite, void* pUserData);
+
+    void Write(const void* pData, size_t dataSize);
+    template <typename T>
+    void Write(const T& value) { Write(&value, sizeof(T)); }
+
+    // Advances the offset without producing any data.  Only valid when counting.
+    void Skip(size_t dataSize) { PAL_ASSERT(IsCounting()); m_offset += dataSize; }
+
+    Pal::Result Flush();
+
+    bool         IsCounting() const { return (m_pBuffer == nullptr) && (m_pfnWrite == nullptr); }
+    Pal::gpusize Offset() const { return m_offset; }
+
+private:
+    static constexpr size_t StagingBufferSize = 4096;
+
+    void* const        m_pBuffer;
+    const size_t       m_bufferSize;
+    const RgpWriteFunc m_pfnWrite;
+    void* const        m_pUserData;
+
+    Pal::gpusize m_offset;      // Current offset into the RGP file.
+    Pal::Result  m_result;      // First error encountered while writing.
+    size_t       m_stagingSize; // Number of bytes currently held in m_staging.
+    Pal::uint8   m_staging[StagingBufferSize];
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(RgpWriter);
+    PAL_DISALLOW_DEFAULT_CTOR(RgpWriter);
+};
+
 // =====================================================================================================================
 // Helper classes to store pointers related to various types of perfExperiment operations.
 // PerfSamples are used internally by the PerfItem in GpaSession to manage programming of the PerfExeriments.
@@ -181,7 +222,7 @@ public:
     Pal::gpusize            GetTraceBufferSize() const { return m_traceMemorySize; }
     Pal::SpmTraceLayout*    GetSpmTraceLayout() const { return m_pSpmTraceLayout; }
     Pal::uint32             GetNumSpmCounters() const { return m_numSpmCounters; }
-    Pal::Result             GetSpmTraceResults(void* pDstBuffer, size_t bufferSize);
+    void                    WriteSpmTraceResults(RgpWriter* pWriter);
     void                    GetSpmResultsSize(Pal::gpusize* pSizeInBytes, Pal::gpusize* pNumSamples);
     Pal::uint32             GetSpmSampleInterval() const { return m_spmSampleInterval; }
 
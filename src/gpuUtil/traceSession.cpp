@@ -62,8 +62,12 @@ TraceSession::TraceSession(IPlatform* pPlatform)
     m_pPlatform(pPlatform),
     m_registeredTraceSources(512, pPlatform),
     m_registeredTraceControllers(512, pPlatform),
-    m_sessionState(TraceSessionState::Ready)
+    m_sessionState(TraceSessionState::Ready),
+    m_pChunkFileWriter(nullptr),
+    m_pCurrentStream(nullptr),
+    m_currentChunkIndex(0)
 {
+    m_traceFilePath[0] = '\0';
 }
 
 // =====================================================================================================================
@@ -172,72 +176,125 @@ Result TraceSession::UnregisterSource(
     return result;
 }
 
+// =====================================================================================================================
+Result TraceSession::SetTraceFile(
+    const char* pFilePath)
+{
+    Result result = Result::Success;
+
+    if (m_sessionState != TraceSessionState::Ready)
+    {
+        result = Result::ErrorUnavailable;
+    }
+    else if (pFilePath == nullptr)
+    {
+        m_traceFilePath[0] = '\0';
+    }
+    else if (strlen(pFilePath) >= sizeof(m_traceFilePath))
+    {
+        result = Result::ErrorInvalidValue;
+    }
+    else
+    {
+        Util::Strncpy(m_traceFilePath, pFilePath, sizeof(m_traceFilePath));
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 Result TraceSession::CollectTrace(
     void*   pData,
     size_t* pDataSize)
 {
-    // Destroying(ie.closing) the ChunkWriter ensures that all data, both compressed and uncompressed, is written to
-    // the data stream. This step also completes the RDF file by adding the final parts(index entries) of the file.
-    // Trace data and data-sizes will be correctly outputted only after this step.
-    Result result = RdfResultToPalResult(rdfChunkFileWriterDestroy(&m_pChunkFileWriter));
+    Result result = Result::Success;
 
-    // We need to move the RDF offset manually to the beginning of the data stream
-    if (result == Result::Success)
+    if (pDataSize == nullptr)
     {
-        result = RdfResultToPalResult(rdfStreamSeek(m_pCurrentStream, 0));
+        result = Result::ErrorInvalidPointer;
+    }
+    else if (m_sessionState != TraceSessionState::Progress)
+    {
+        result = Result::ErrorUnavailable;
     }
 
-    size_t streamSize;
-    if (result == Result::Success)
+    // Destroying(ie.closing) the ChunkWriter ensures that all data, both compressed and uncompressed, is written to
+    // the data stream. This step also completes the RDF file by adding the final parts(index entries) of the file.
+    // Trace data and data-sizes will be correctly outputted only after this step. The writer is only destroyed once
+    // since a size query is typically followed by a second call to retrieve the data.
+    if ((result == Result::Success) && (m_pChunkFileWriter != nullptr))
     {
-        result = RdfResultToPalResult(rdfStreamGetSize(m_pCurrentStream, &streamSize));
+        result = RdfResultToPalResult(rdfChunkFileWriterDestroy(&m_pChunkFileWriter));
     }
 
-    if (result == Result::Success)
+    if ((result == Result::Success) && (m_traceFilePath[0] != '\0'))
     {
-        if (pDataSize == nullptr)
+        // The trace data was streamed to disk as it was written, so closing the stream flushes the remaining data
+        // and all the client needs from us is the location of the file.
+        if (m_pCurrentStream != nullptr)
         {
-            result = Result::ErrorInvalidPointer;
+            result = RdfResultToPalResult(rdfStreamClose(&m_pCurrentStream));
         }
-        else if (*pDataSize < streamSize)
+
+        const size_t pathSize = strlen(m_traceFilePath) + 1;
+
+        if (result != Result::Success)
         {
-            result  = Result::ErrorInvalidMemorySize;
+            // Nothing to do, the file could not be completed.
         }
-        else if (m_sessionState == TraceSessionState::Ready)
+        else if (pData == nullptr)
         {
-            result = Result::ErrorUnavailable;
+            *pDataSize = pathSize;
         }
-        else if (m_sessionState == TraceSessionState::Progress)
+        else if (*pDataSize < pathSize)
+        {
+            result = Result::ErrorInvalidMemorySize;
+        }
+        else
+        {
+            memcpy(pData, m_traceFilePath, pathSize);
+            m_sessionState = TraceSessionState::Ready;
+        }
+    }
+    else if (result == Result::Success)
+    {
+        // We need to move the RDF offset manually to the beginning of the data stream
+        result = RdfResultToPalResult(rdfStreamSeek(m_pCurrentStream, 0));
+
+        size_t streamSize = 0;
+        if (result == Result::Success)
+        {
+            result = RdfResultToPalResult(rdfStreamGetSize(m_pCurrentStream, &streamSize));
+        }
+
+        if (result != Result::Success)
+        {
+            // Nothing to do, the stream is unusable.
+        }
+        else if (pData == nullptr)
         {
-            if (pData != nullptr)
+            *pDataSize = streamSize;
+        }
+        else if (*pDataSize < streamSize)
+        {
+            result = Result::ErrorInvalidMemorySize;
+        }
+        else
+        {
+            // Read all trace data in the current stream in RDF format
+            size_t bytesRead = 0;
+            result = RdfResultToPalResult(rdfStreamRead(m_pCurrentStream, streamSize, pData, &bytesRead));
+
+            if (result == Result::Success)
             {
-                // Read all trace data in the current stream in RDF format
-                size_t bytesRead = 0;
-                if (result == Result::Success)
-                {
-                    result = RdfResultToPalResult(rdfStreamRead(m_pCurrentStream, streamSize, pData, &bytesRead));
-                }
-
-                if (result == Result::Success)
-                {
-                    result = RdfResultToPalResult(rdfStreamClose(&m_pCurrentStream));
-                }
-
-                if (result == Result::Success)
-                {
-                    m_sessionState = TraceSessionState::Ready;
-                }
+                result = RdfResultToPalResult(rdfStreamClose(&m_pCurrentStream));
             }
-            else
+
+            if (result == Result::Success)
             {
-                *pDataSize = streamSize;
+                m_sessionState = TraceSessionState::Ready;
             }
         }
-        else
-        {
-            result = Result::ErrorUnknown;
-        }
     }
 
     return result;
@@ -251,35 +308,54 @@ Result TraceSession::WriteDataChunk(
 {
     Result result = Result::Success;
 
-    // Setup the chunk data stream and chunk writer at the beginning
+    // Populate rdfChunkCreateInfo parameters from TraceChunkInfo struct
+    rdfChunkCreateInfo currentChunkInfo;
+    currentChunkInfo.headerSize  = info.headerSize;
+    currentChunkInfo.compression = info.enableCompression ?
+                                   rdfCompression::rdfCompressionZstd : rdfCompression::rdfCompressionNone;
+    currentChunkInfo.version     = info.version;
+    currentChunkInfo.pHeader     = info.pHeader;
+    memcpy(currentChunkInfo.identifier, info.id, TextIdentifierSize);
+
+    m_chunkAppendLock.LockForWrite();
+
+    // Setup the chunk data stream and chunk writer at the beginning. This must happen under the append lock since
+    // multiple trace sources may write their first chunks concurrently.
     if (m_sessionState == TraceSessionState::Ready)
     {
         // Create the stream to be used in the chunkFileWriter. This will also be used to retrieve
-        // the final list of appended chunks for a trace in CollectTrace()
-        result = RdfResultToPalResult(rdfStreamCreateMemoryStream(&m_pCurrentStream));
+        // the final list of appended chunks for a trace in CollectTrace(). When streaming to disk, the chunks are
+        // written straight into the trace file instead so the trace is never held in memory in its entirety.
+        if (m_traceFilePath[0] != '\0')
+        {
+            result = RdfResultToPalResult(rdfStreamCreateFile(m_traceFilePath, &m_pCurrentStream));
+        }
+        else
+        {
+            result = RdfResultToPalResult(rdfStreamCreateMemoryStream(&m_pCurrentStream));
+        }
 
         // Create the chunkFileWriter to setup the chunk data structures and buffers to collect the incoming chunks
         if (result == Result::Success)
         {
             result = RdfResultToPalResult(rdfChunkFileWriterCreate(m_pCurrentStream, &m_pChunkFileWriter));
+
+            if (result != Result::Success)
+            {
+                // Don't leak the stream (or leave a half-written trace file open) if the writer couldn't be created.
+                rdfStreamClose(&m_pCurrentStream);
+            }
         }
 
-        m_sessionState = TraceSessionState::Progress;
+        // Stay in the Ready state on failure so that the next chunk retries the setup.
+        if (result == Result::Success)
+        {
+            m_sessionState = TraceSessionState::Progress;
+        }
     }
 
-    // Populate rdfChunkCreateInfo parameters from TraceChunkInfo struct
-    rdfChunkCreateInfo currentChunkInfo;
-    currentChunkInfo.headerSize  = info.headerSize;
-    currentChunkInfo.compression = info.enableCompression ?
-                                   rdfCompression::rdfCompressionZstd : rdfCompression::rdfCompressionNone;
-    currentChunkInfo.version     = info.version;
-    currentChunkInfo.pHeader     = info.pHeader;
-    memcpy(currentChunkInfo.identifier, info.id, TextIdentifierSize);
-
-    m_chunkAppendLock.LockForWrite();
-
     // Append the incoming chunk to the data stream
-    if (result == Result::Success)
+    if ((result == Result::Success) && (m_pChunkFileWriter != nullptr))
     {
         result = RdfResultToPalResult(rdfChunkFileWriterWriteChunk(m_pChunkFileWriter,
                                                                    &currentChunkInfo,
@@ -287,6 +363,10 @@ Result TraceSession::WriteDataChunk(
                                                                    info.pData,
                                                                    &m_currentChunkIndex));
     }
+    else if (result == Result::Success)
+    {
+        result = Result::ErrorUnknown;
+    }
 
     m_chunkAppendLock.UnlockForWrite();
 
@@ -0,0 +1,84 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palEventCount.h"
+#include "palInlineFuncs.h"
+#include "palSysUtil.h"
+
+namespace Util
+{
+
+// =====================================================================================================================
+// Sleeps on the key until a Notify() changes it or the deadline passes.
+Result EventCount::Wait(
+    uint32 key,
+    int64  deadline)
+{
+    Result result = Result::Success;
+    uint32 milliseconds = Infinite;
+
+    if (deadline >= 0)
+    {
+        const int64 now = GetPerfCpuTime();
+
+        if (now >= deadline)
+        {
+            result = Result::Timeout;
+        }
+        else
+        {
+            // Round up so that we never wake before the deadline and spin on a zero-length wait.
+            const int64 frequency = GetPerfFrequency();
+            const int64 remaining = ((deadline - now) * 1000 + frequency - 1) / frequency;
+
+            milliseconds = static_cast<uint32>(Min<int64>(remaining, Infinite - 1));
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        // A timeout here doesn't mean that the deadline passed, so let the next call decide.
+        WaitOnAddress(&m_key, key, milliseconds);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Converts a relative wait time into an absolute deadline in performance counter ticks.
+int64 EventCount::ComputeDeadline(
+    uint32 milliseconds)
+{
+    int64 deadline = -1;
+
+    if (milliseconds != Infinite)
+    {
+        deadline = GetPerfCpuTime() + ((GetPerfFrequency() * milliseconds) / 1000);
+    }
+
+    return deadline;
+}
+
+} // Util
@@ -27,7 +27,7 @@
 #include "palMutex.h"
 #include "palAssert.h"
 #include "palPlatformKey.h"
-#include "palHashMapImpl.h"
+#include "palConcurrentHashMapImpl.h"
 #include "palAutoBuffer.h"
 #include "palVectorImpl.h"
 #include "core/platform.h"
@@ -40,16 +40,14 @@ namespace Util
 FileArchiveCacheLayer::FileArchiveCacheLayer(
     const AllocCallbacks& callbacks,
     IArchiveFile*         pArchiveFile,
-    IHashContext*         pBaseContext,
-    void*                 pTempContextMem)
+    bool                  threadSafeFile,
+    IHashContext*         pBaseContext)
     :
     CacheLayerBase     { callbacks },
     m_pArchivefile     { pArchiveFile },
+    m_threadSafeFile   { threadSafeFile },
     m_pBaseContext     { pBaseContext },
-    m_pTempContextMem  { pTempContextMem },
     m_archiveFileMutex {},
-    m_hashContextMutex {},
-    m_entryMapLock     {},
     m_entries          { HashTableBucketCount, Allocator() }
 {
     PAL_ASSERT(m_pArchivefile != nullptr);
@@ -102,23 +100,19 @@ Result FileArchiveCacheLayer::QueryInternal(
     }
     else
     {
-        EntryKey     key;
-        const Entry* pEntry;
+        EntryKey key;
+        Entry    entry;
 
         ConvertToEntryKey(pHashId, &key);
 
-        {
-            RWLockAuto<RWLock::ReadOnly> entryMapLock { &m_entryMapLock };
-
-            pEntry = m_entries.FindKey(key);
-        }
+        bool found = m_entries.Find(key, &entry);
 
-        if (pEntry == nullptr)
+        if (found == false)
         {
-            MutexAuto                     archiveFileLock { &m_archiveFileMutex };
-            RWLockAuto<RWLock::ReadWrite> entryMapLock { &m_entryMapLock };
+            // Every insert into m_entries happens under this lock, so the entry count is stable while we hold it.
+            MutexAuto archiveFileLock { &m_archiveFileMutex };
 
-            const size_t oldEntryCount = m_entries.GetNumEntries();
+            const uint32 oldEntryCount = m_entries.GetNumEntries();
             Result       refreshResult = RefreshHeaders();
 
             PAL_ALERT(IsErrorResult(refreshResult));
@@ -126,20 +120,20 @@ Result FileArchiveCacheLayer::QueryInternal(
             // If the refresh picked up any new header, search again
             if (oldEntryCount != m_entries.GetNumEntries())
             {
-                pEntry = m_entries.FindKey(key);
+                found = m_entries.Find(key, &entry);
             }
         }
 
-        if (pEntry != nullptr)
+        if (found)
         {
-            const size_t storeSize = pEntry->storeSize;
+            const size_t storeSize = entry.storeSize;
 
             pQuery->pLayer          = this;
             pQuery->hashId          = *pHashId;
-            pQuery->dataSize        = pEntry->dataSize;
+            pQuery->dataSize        = entry.dataSize;
             pQuery->storeSize       = storeSize;
             pQuery->promotionSize   = storeSize;
-            pQuery->context.entryId = pEntry->ordinalId;
+            pQuery->context.entryId = entry.ordinalId;
 
             result = Result::Success;
         }
@@ -177,13 +171,9 @@ Result FileArchiveCacheLayer::StoreInternal(
     {
         ConvertToEntryKey(pHashId, &key);
 
+        if (m_entries.Contains(key))
         {
-            RWLockAuto<RWLock::ReadOnly> entryMapLock { &m_entryMapLock };
-
-            if (m_entries.FindKey(key) != nullptr)
-            {
-                result = Result::AlreadyExists;
-            }
+            result = Result::AlreadyExists;
         }
     }
 
@@ -217,14 +207,13 @@ Result FileArchiveCacheLayer::StoreInternal(
             memcpy(header.entryKey, key.value, sizeof(EntryKey));
 
             result = m_pArchivefile->Write(&header, pMem);
-        }
 
-        // Only insert this entry into our lookup table if everything succeeded
-        if (result == Result::Success)
-        {
-            RWLockAuto<RWLock::ReadWrite> entryMapLock { &m_entryMapLock };
-
-            result = AddHeaderToTable(header);
+            // Only insert this entry into our lookup table if everything succeeded.  This stays under the archive lock
+            // so a concurrent refresh always finds m_entries in step with the entries of the file.
+            if (result == Result::Success)
+            {
+                result = AddHeaderToTable(header);
+            }
         }
 
         if (pMem != nullptr)
@@ -265,28 +254,36 @@ Result FileArchiveCacheLayer::LoadInternal(
 #if DEBUG
     if (result == Result::Success)
     {
-        RWLockAuto<RWLock::ReadOnly> entryMapLock { &m_entryMapLock };
-
         EntryKey key;
+        Entry    entry = {};
         ConvertToEntryKey(&pQuery->hashId, &key);
 
-        const Entry* pEntry = m_entries.FindKey(key);
+        const bool found = m_entries.Find(key, &entry);
 
-        // Should be safe to have these in order, if alerts are enabled then the first will be hit,
-        // if they are disabled then neither will be.
-        PAL_ALERT(pEntry == nullptr);
-        PAL_ALERT(pEntry->ordinalId != pQuery->context.entryId);
+        PAL_ALERT(found == false);
+        PAL_ALERT(found && (entry.ordinalId != pQuery->context.entryId));
     }
 #endif
 
     ArchiveEntryHeader header;
 
+    // Unless the client told us the archive file is thread-safe, all reads from it must hold m_archiveFileMutex.
+    Mutex* const pReadMutex = m_threadSafeFile ? nullptr : &m_archiveFileMutex;
+
     if (result == Result::Success)
     {
-        MutexAuto archiveFileLock { &m_archiveFileMutex };
+        if (pReadMutex != nullptr)
+        {
+            pReadMutex->Lock();
+        }
 
         size_t entryId = static_cast<size_t>(pQuery->context.entryId);
         result         = m_pArchivefile->GetEntryByIndex(entryId, &header);
+
+        if (pReadMutex != nullptr)
+        {
+            pReadMutex->Unlock();
+        }
     }
 
     if (result == Result::Success)
@@ -310,10 +307,18 @@ Result FileArchiveCacheLayer::LoadInternal(
 
         if (result == Result::Success)
         {
-            MutexAuto archiveFileLock { &m_archiveFileMutex };
+            if (pReadMutex != nullptr)
+            {
+                pReadMutex->Lock();
+            }
 
             result = m_pArchivefile->Read(&header, pReadMem);
 
+            if (pReadMutex != nullptr)
+            {
+                pReadMutex->Unlock();
+            }
+
             // In the case that AsyncIO is not ready, signal Result::NotFound
             if (result == Result::NotReady)
             {
@@ -368,7 +373,7 @@ static size_t GetBaseContextSizeFromCreateInfo(
 size_t GetArchiveFileCacheLayerSize(
     const ArchiveFileCacheCreateInfo* pCreateInfo)
 {
-    return sizeof(FileArchiveCacheLayer) + (GetBaseContextSizeFromCreateInfo(pCreateInfo) * 2);
+    return sizeof(FileArchiveCacheLayer) + GetBaseContextSizeFromCreateInfo(pCreateInfo);
 }
 
 // =====================================================================================================================
@@ -385,8 +390,6 @@ Result CreateArchiveFileCacheLayer(
     Result                 result          = Result::Success;
     FileArchiveCacheLayer* pLayer          = nullptr;
     IHashContext*          pBaseContext    = nullptr;
-    void*                  pTempContextMem = nullptr;
-    const size_t           hashContextSize = GetBaseContextSizeFromCreateInfo(pCreateInfo);
 
     if ((pCreateInfo == nullptr) ||
         (pPlacementAddr == nullptr) ||
@@ -398,7 +401,6 @@ Result CreateArchiveFileCacheLayer(
     if (result == Result::Success)
     {
         void* pBaseContextMem = VoidPtrInc(pPlacementAddr, sizeof(FileArchiveCacheLayer));
-        pTempContextMem       = VoidPtrInc(pBaseContextMem, hashContextSize);
 
         if (pCreateInfo->pPlatformKey != nullptr)
         {
@@ -422,8 +424,12 @@ Result CreateArchiveFileCacheLayer(
         pLayer = PAL_PLACEMENT_NEW(pPlacementAddr) FileArchiveCacheLayer(
             (pCreateInfo->baseInfo.pCallbacks == nullptr) ? callbacks : *pCreateInfo->baseInfo.pCallbacks,
             pCreateInfo->pFile,
-            pBaseContext,
-            pTempContextMem);
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+            pCreateInfo->threadSafeFile,
+#else
+            false,
+#endif
+            pBaseContext);
 
         result = pLayer->Init();
 
@@ -465,7 +471,7 @@ Result FileArchiveCacheLayer::AddHeaderToTable(
 }
 
 // =====================================================================================================================
-// Reload entry headers from the archive file
+// Reload entry headers from the archive file.  The caller must hold m_archiveFileMutex.
 Result FileArchiveCacheLayer::RefreshHeaders()
 {
     Result       result        = Result::Success;
@@ -500,7 +506,8 @@ Result FileArchiveCacheLayer::RefreshHeaders()
 }
 
 // =====================================================================================================================
-// Convert a 128-bit hash to a SHA1 entry id
+// Convert a 128-bit hash to a SHA1 entry id. Each call hashes with its own copy of the base context, which lives on the
+// stack, so any number of threads can convert keys at once.
 void FileArchiveCacheLayer::ConvertToEntryKey(
     const Hash128* pHashId,
     EntryKey*      pKey)
@@ -508,19 +515,36 @@ void FileArchiveCacheLayer::ConvertToEntryKey(
     PAL_ASSERT(pHashId != nullptr);
     PAL_ASSERT(pKey != nullptr);
 
-    MutexAuto hashContextLock { &m_hashContextMutex };
+    const size_t contextSize = m_pBaseContext->GetDuplicateObjectSize();
+
+    // Use uint64s to keep the context suitably aligned.
+    AutoBuffer<uint64, HashContextStackSize, ForwardAllocator> contextMem(
+        Pow2Align(contextSize, sizeof(uint64)) / sizeof(uint64),
+        Allocator());
 
     IHashContext* pContext = nullptr;
-    Result result          = m_pBaseContext->Duplicate(m_pTempContextMem, &pContext);
-    PAL_ALERT(IsErrorResult(result));
+    Result        result   = Result::ErrorOutOfMemory;
 
-    result = pContext->AddData(pHashId, sizeof(Hash128));
+    if ((contextMem.Capacity() * sizeof(uint64)) >= contextSize)
+    {
+        result = m_pBaseContext->Duplicate(&contextMem[0], &pContext);
+    }
     PAL_ALERT(IsErrorResult(result));
 
-    result = pContext->Finish(pKey->value);
-    PAL_ALERT(IsErrorResult(result));
+    if (result == Result::Success)
+    {
+        result = pContext->AddData(pHashId, sizeof(Hash128));
+        PAL_ALERT(IsErrorResult(result));
+
+        result = pContext->Finish(pKey->value);
+        PAL_ALERT(IsErrorResult(result));
 
-    pContext->Destroy();
+        pContext->Destroy();
+    }
+    else
+    {
+        memset(pKey->value, 0, sizeof(pKey->value));
+    }
 }
 
 } //namespace Util
@@ -28,9 +28,10 @@
 
 #include "palArchiveFileFmt.h"
 #include "palArchiveFile.h"
+#include "palConcurrentHashMap.h"
 #include "palLinearAllocator.h"
 #include "palHashProvider.h"
-#include "palHashMap.h"
+#include "palHwHash.h"
 #include "palVector.h"
 
 namespace Util
@@ -44,8 +45,8 @@ public:
     FileArchiveCacheLayer(
         const AllocCallbacks& callbacks,
         IArchiveFile*         pArchiveFile,
-        IHashContext*         pBaseContext,
-        void*                 pTemContextMem);
+        bool                  threadSafeFile,
+        IHashContext*         pBaseContext);
     virtual ~FileArchiveCacheLayer();
 
     virtual Result Init() override;
@@ -73,6 +74,7 @@ private:
     // Constants
     static constexpr size_t        MinExpectedHeaders   = 256;
     static constexpr size_t        HashTableBucketCount = 0x4000;
+    static constexpr size_t        HashContextStackSize = 64; // In uint64s; enough for an OpenSSL SHA1 context
 
     // Helper type for ArchiveEntryHeader::entryKey
     struct EntryKey
@@ -87,13 +89,12 @@ private:
         size_t dataSize;
         size_t storeSize;
     };
-    using EntryMap = HashMap<EntryKey,
-                             Entry,
-                             ForwardAllocator,
-                             JenkinsHashFunc,
-                             DefaultEqualFunc,
-                             HashAllocator<ForwardAllocator>,
-                             2048>;
+    // Queries search the map without locking; inserts only lock one shard of it.
+    using EntryMap = ConcurrentHashMap<EntryKey,
+                                       Entry,
+                                       ForwardAllocator,
+                                       Crc32cHashFunc,
+                                       DefaultEqualFunc>;
 
     // Hashing Utility functions
     void ConvertToEntryKey(const Hash128* pHashId, EntryKey* pKey);
@@ -104,12 +105,11 @@ private:
 
     // Invariants that must be passed in by ctor
     IArchiveFile* const  m_pArchivefile;
+    const bool           m_threadSafeFile;   // Loads may read from m_pArchivefile without holding m_archiveFileMutex
     IHashContext* const  m_pBaseContext;
-    void* const          m_pTempContextMem;
 
-    Mutex                m_archiveFileMutex;
-    Mutex                m_hashContextMutex;
-    RWLock               m_entryMapLock;
+    Mutex                m_archiveFileMutex; // Serializes writes to the archive and adding their headers to m_entries,
+                                             // and all reads from the archive unless m_threadSafeFile is set
 
     // Data Members
     EntryMap m_entries;
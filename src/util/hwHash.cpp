@@ -0,0 +1,565 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palHwHash.h"
+#include "palInlineFuncs.h"
+#include "palSysUtil.h"
+#include <string.h>
+
+#if PAL_HAS_CPUID
+#include <immintrin.h>
+#endif
+
+namespace Util
+{
+namespace HwHash
+{
+
+// Reflected CRC32C (Castagnoli) polynomial.
+static constexpr uint32 Crc32cPoly = 0x82F63B78;
+
+// Fractional digits of pi, used to initialize and finalize the AES hash state.
+static constexpr uint64 AesHashKeys[3][2] =
+{
+    { 0x243F6A8885A308D3ull, 0x13198A2E03707344ull },
+    { 0xA4093822299F31D0ull, 0x082EFA98EC4E6C89ull },
+    { 0x452821E638D01377ull, 0xBE5466CF34E90C6Cull },
+};
+
+// The AES hash consumes two independent 16-byte lanes per step.
+static constexpr size_t AesHashStepSize = 32;
+
+// The AES S-box, for the portable AES round.
+static const uint8 AesSBox[256] =
+{
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+// =====================================================================================================================
+// Which hashing instructions the CPU supports.
+struct CpuFeatures
+{
+    bool crc32;  // SSE4.2 CRC32 instruction
+    bool aes;    // AES-NI AESENC instruction
+};
+
+// =====================================================================================================================
+static CpuFeatures DetectCpuFeatures()
+{
+    CpuFeatures features = {};
+
+#if PAL_HAS_CPUID
+    uint32 reg[4] = {};
+    CpuId(reg, 1);
+
+    features.crc32 = TestAnyFlagSet(reg[2], 1u << 20);
+    features.aes   = TestAnyFlagSet(reg[2], 1u << 25) && TestAnyFlagSet(reg[2], 1u << 19); // AES-NI and SSE4.1
+#endif
+
+    return features;
+}
+
+// =====================================================================================================================
+static const CpuFeatures& GetCpuFeatures()
+{
+    static const CpuFeatures Features = DetectCpuFeatures();
+
+    return Features;
+}
+
+// =====================================================================================================================
+bool HasHardwareCrc32c()
+{
+    return GetCpuFeatures().crc32;
+}
+
+// =====================================================================================================================
+bool HasHardwareAes()
+{
+    return GetCpuFeatures().aes;
+}
+
+// =====================================================================================================================
+static uint32 LoadU32(
+    const uint8* pData)
+{
+    uint32 value;
+    memcpy(&value, pData, sizeof(value));
+    return value;
+}
+
+// =====================================================================================================================
+// Loads an AES hash input of less than 16 bytes as two 64-bit values, using overlapping loads instead of copying it
+// into a zero padded buffer.  The data size is part of the hash state, so inputs of different sizes which load the
+// same values still hash differently.
+static PAL_FORCE_INLINE void LoadAesHashShortInput(
+    const uint8* pData,
+    size_t       dataSize,
+    uint64*      pLo,
+    uint64*      pHi)
+{
+    *pLo = 0;
+    *pHi = 0;
+
+    if (dataSize >= 8)
+    {
+        memcpy(pLo, pData, sizeof(uint64));
+        memcpy(pHi, pData + dataSize - 8, sizeof(uint64));
+    }
+    else if (dataSize >= 4)
+    {
+        *pLo = LoadU32(pData);
+        *pHi = LoadU32(pData + dataSize - 4);
+    }
+    else if (dataSize > 0)
+    {
+        *pLo = (static_cast<uint64>(pData[0]) << 16) | (static_cast<uint64>(pData[dataSize / 2]) << 8) |
+               pData[dataSize - 1];
+    }
+}
+
+// =====================================================================================================================
+// Lookup tables for the portable CRC32C, which consumes 8 bytes per step ("slicing-by-8").  Table k holds the CRC of
+// each byte value followed by k zero bytes.
+struct Crc32cTables
+{
+    Crc32cTables()
+    {
+        for (uint32 i = 0; i < 256; i++)
+        {
+            uint32 crc = i;
+
+            for (uint32 bit = 0; bit < 8; bit++)
+            {
+                crc = (crc >> 1) ^ (Crc32cPoly & (0u - (crc & 1)));
+            }
+
+            table[0][i] = crc;
+        }
+
+        for (uint32 k = 1; k < 8; k++)
+        {
+            for (uint32 i = 0; i < 256; i++)
+            {
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+            }
+        }
+    }
+
+    uint32 table[8][256];
+};
+
+// =====================================================================================================================
+// Updates a raw (not inverted) CRC32C state without using the CRC32 instruction.
+static uint32 UpdateCrc32cPortable(
+    const uint8* pData,
+    size_t       dataSize,
+    uint32       crc)
+{
+    static const Crc32cTables Tables;
+    const uint32 (&t)[8][256] = Tables.table;
+
+    for (; dataSize >= 8; dataSize -= 8, pData += 8)
+    {
+        const uint32 lo = LoadU32(pData) ^ crc;
+        const uint32 hi = LoadU32(pData + 4);
+
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+
+    for (; dataSize > 0; dataSize--, pData++)
+    {
+        crc = t[0][(crc ^ *pData) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+// =====================================================================================================================
+// A single AES encryption round (ShiftRows, SubBytes, MixColumns, AddRoundKey), computing exactly what AESENC does.
+static void AesEncRoundPortable(
+    uint8       state[16],
+    const uint8 roundKey[16])
+{
+    uint8 shifted[16];
+
+    for (uint32 col = 0; col < 4; col++)
+    {
+        for (uint32 row = 0; row < 4; row++)
+        {
+            shifted[(col * 4) + row] = AesSBox[state[(((col + row) & 3) * 4) + row]];
+        }
+    }
+
+    for (uint32 col = 0; col < 4; col++)
+    {
+        const uint8* pIn = &shifted[col * 4];
+        uint8        doubled[4];
+
+        for (uint32 row = 0; row < 4; row++)
+        {
+            doubled[row] = static_cast<uint8>((pIn[row] << 1) ^ ((pIn[row] >> 7) * 0x1B));
+        }
+
+        state[(col * 4) + 0] = doubled[0] ^ doubled[1] ^ pIn[1] ^ pIn[2] ^ pIn[3] ^ roundKey[(col * 4) + 0];
+        state[(col * 4) + 1] = pIn[0] ^ doubled[1] ^ doubled[2] ^ pIn[2] ^ pIn[3] ^ roundKey[(col * 4) + 1];
+        state[(col * 4) + 2] = pIn[0] ^ pIn[1] ^ doubled[2] ^ doubled[3] ^ pIn[3] ^ roundKey[(col * 4) + 2];
+        state[(col * 4) + 3] = doubled[0] ^ pIn[0] ^ pIn[1] ^ pIn[2] ^ doubled[3] ^ roundKey[(col * 4) + 3];
+    }
+}
+
+// =====================================================================================================================
+// XORs 16 bytes of data into a lane of the AES hash and mixes it with one round.
+static void AesHashAbsorbPortable(
+    uint8       lane[16],
+    const uint8 data[16],
+    const uint8 key[16])
+{
+    for (uint32 i = 0; i < 16; i++)
+    {
+        lane[i] ^= data[i];
+    }
+
+    AesEncRoundPortable(lane, key);
+}
+
+// =====================================================================================================================
+// Portable implementation of Hash128().  See Hash128Hw() for a description of the algorithm.
+static void Hash128Portable(
+    const uint8* pData,
+    size_t       dataSize,
+    uint64       seed,
+    Hash*        pHash)
+{
+    uint8 keys[3][16];
+    memcpy(keys, AesHashKeys, sizeof(keys));
+
+    const uint64 params[2] = { seed, static_cast<uint64>(dataSize) };
+
+    uint8 lanes[2][16];
+    memcpy(lanes, AesHashKeys, sizeof(lanes));
+
+    for (uint32 i = 0; i < 16; i++)
+    {
+        lanes[0][i] ^= reinterpret_cast<const uint8*>(params)[i];
+        lanes[1][i] ^= reinterpret_cast<const uint8*>(params)[i];
+    }
+
+    size_t remaining = dataSize;
+
+    for (; remaining > AesHashStepSize; remaining -= AesHashStepSize, pData += AesHashStepSize)
+    {
+        AesHashAbsorbPortable(lanes[0], pData,      keys[2]);
+        AesHashAbsorbPortable(lanes[1], pData + 16, keys[2]);
+    }
+
+    // The last 1 to 32 bytes overlap the previous step.  See Hash128Hw() for shorter inputs.
+    uint64 tail[4] = {};
+
+    if (dataSize >= AesHashStepSize)
+    {
+        memcpy(tail, pData + remaining - AesHashStepSize, AesHashStepSize);
+    }
+    else if (dataSize >= 16)
+    {
+        memcpy(&tail[0], pData, 16);
+        memcpy(&tail[2], pData + dataSize - 16, 16);
+    }
+    else
+    {
+        LoadAesHashShortInput(pData, dataSize, &tail[0], &tail[1]);
+    }
+
+    AesHashAbsorbPortable(lanes[0], reinterpret_cast<const uint8*>(&tail[0]), keys[2]);
+    AesHashAbsorbPortable(lanes[1], reinterpret_cast<const uint8*>(&tail[2]), keys[2]);
+
+    AesEncRoundPortable(lanes[0], lanes[1]);
+    AesEncRoundPortable(lanes[0], keys[0]);
+    AesEncRoundPortable(lanes[0], keys[1]);
+    AesEncRoundPortable(lanes[0], keys[2]);
+
+    memcpy(pHash->bytes, lanes[0], sizeof(pHash->bytes));
+}
+
+#if PAL_HAS_CPUID
+// =====================================================================================================================
+// Updates a raw (not inverted) CRC32C state using the SSE4.2 CRC32 instruction.
+__attribute__((target("sse4.2")))
+static uint32 UpdateCrc32cHw(
+    const uint8* pData,
+    size_t       dataSize,
+    uint32       crc)
+{
+#if defined(__x86_64__)
+    uint64 crc64 = crc;
+
+    for (; dataSize >= 8; dataSize -= 8, pData += 8)
+    {
+        uint64 value;
+        memcpy(&value, pData, sizeof(value));
+        crc64 = _mm_crc32_u64(crc64, value);
+    }
+
+    crc = static_cast<uint32>(crc64);
+#endif
+
+    for (; dataSize >= 4; dataSize -= 4, pData += 4)
+    {
+        crc = _mm_crc32_u32(crc, LoadU32(pData));
+    }
+
+    for (; dataSize > 0; dataSize--, pData++)
+    {
+        crc = _mm_crc32_u8(crc, *pData);
+    }
+
+    return crc;
+}
+
+// =====================================================================================================================
+// Updates three raw CRC32C states at once.  A CRC32 instruction has a latency of three cycles but the CPU can start one
+// per cycle, so interleaving three independent streams runs up to three times as fast as checksumming them in turn.
+__attribute__((target("sse4.2")))
+static void UpdateCrc32cHw3(
+    const uint8*const* ppData,
+    const size_t*      pDataSizes,
+    uint32*            pCrcs)
+{
+    const size_t common = Min(Min(pDataSizes[0], pDataSizes[1]), pDataSizes[2]) & ~size_t(7);
+
+#if defined(__x86_64__)
+    uint64 crc0 = pCrcs[0];
+    uint64 crc1 = pCrcs[1];
+    uint64 crc2 = pCrcs[2];
+
+    for (size_t offset = 0; offset < common; offset += 8)
+    {
+        uint64 values[3];
+        memcpy(&values[0], ppData[0] + offset, sizeof(uint64));
+        memcpy(&values[1], ppData[1] + offset, sizeof(uint64));
+        memcpy(&values[2], ppData[2] + offset, sizeof(uint64));
+
+        crc0 = _mm_crc32_u64(crc0, values[0]);
+        crc1 = _mm_crc32_u64(crc1, values[1]);
+        crc2 = _mm_crc32_u64(crc2, values[2]);
+    }
+
+    pCrcs[0] = static_cast<uint32>(crc0);
+    pCrcs[1] = static_cast<uint32>(crc1);
+    pCrcs[2] = static_cast<uint32>(crc2);
+#else
+    for (size_t offset = 0; offset < common; offset += 4)
+    {
+        pCrcs[0] = _mm_crc32_u32(pCrcs[0], LoadU32(ppData[0] + offset));
+        pCrcs[1] = _mm_crc32_u32(pCrcs[1], LoadU32(ppData[1] + offset));
+        pCrcs[2] = _mm_crc32_u32(pCrcs[2], LoadU32(ppData[2] + offset));
+    }
+#endif
+
+    for (uint32 i = 0; i < 3; i++)
+    {
+        pCrcs[i] = UpdateCrc32cHw(ppData[i] + common, pDataSizes[i] - common, pCrcs[i]);
+    }
+}
+
+// =====================================================================================================================
+// Computes a 128-bit hash with AES-NI.
+//
+// Two 16-byte lanes are seeded from constants, the seed and the data size.  Each 32-byte step of the data is XOR'd
+// into the lanes, which are then mixed by one AES round each; the two lanes don't depend on each other, so their rounds
+// overlap.  The last 1 to 32 bytes are absorbed the same way; they overlap the previous step, or the two halves
+// overlap each other if the whole input is shorter.  Four more rounds fold the lanes together so every input bit
+// affects every output bit.
+__attribute__((target("aes,sse4.1")))
+static void Hash128Hw(
+    const uint8* pData,
+    size_t       dataSize,
+    uint64       seed,
+    Hash*        pHash)
+{
+    const __m128i key0   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(AesHashKeys[0]));
+    const __m128i key1   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(AesHashKeys[1]));
+    const __m128i key2   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(AesHashKeys[2]));
+    const __m128i params = _mm_set_epi64x(static_cast<int64>(dataSize), static_cast<int64>(seed));
+
+    __m128i lane0 = _mm_xor_si128(key0, params);
+    __m128i lane1 = _mm_xor_si128(key1, params);
+
+    size_t remaining = dataSize;
+
+    for (; remaining > AesHashStepSize; remaining -= AesHashStepSize, pData += AesHashStepSize)
+    {
+        lane0 = _mm_aesenc_si128(_mm_xor_si128(lane0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData))),
+                                 key2);
+        lane1 = _mm_aesenc_si128(_mm_xor_si128(lane1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + 16))),
+                                 key2);
+    }
+
+    __m128i tail0;
+    __m128i tail1;
+
+    if (dataSize >= AesHashStepSize)
+    {
+        tail0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + remaining - AesHashStepSize));
+        tail1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + remaining - 16));
+    }
+    else if (dataSize >= 16)
+    {
+        tail0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData));
+        tail1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + dataSize - 16));
+    }
+    else
+    {
+        uint64 lo;
+        uint64 hi;
+        LoadAesHashShortInput(pData, dataSize, &lo, &hi);
+
+        tail0 = _mm_set_epi64x(static_cast<int64>(hi), static_cast<int64>(lo));
+        tail1 = _mm_setzero_si128();
+    }
+
+    lane0 = _mm_aesenc_si128(_mm_xor_si128(lane0, tail0), key2);
+    lane1 = _mm_aesenc_si128(_mm_xor_si128(lane1, tail1), key2);
+
+    __m128i hash = _mm_aesenc_si128(lane0, lane1);
+    hash = _mm_aesenc_si128(hash, key0);
+    hash = _mm_aesenc_si128(hash, key1);
+    hash = _mm_aesenc_si128(hash, key2);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pHash->bytes), hash);
+}
+#endif
+
+// =====================================================================================================================
+uint32 Crc32c(
+    const void* pData,
+    size_t      dataSize,
+    uint32      crc)
+{
+    const uint8* pBytes = static_cast<const uint8*>(pData);
+
+#if PAL_HAS_CPUID
+    if (GetCpuFeatures().crc32)
+    {
+        crc = UpdateCrc32cHw(pBytes, dataSize, ~crc);
+    }
+    else
+#endif
+    {
+        crc = UpdateCrc32cPortable(pBytes, dataSize, ~crc);
+    }
+
+    return ~crc;
+}
+
+// =====================================================================================================================
+void Crc32cMulti(
+    uint32            count,
+    const void*const* ppData,
+    const size_t*     pDataSizes,
+    uint32*           pCrcs)
+{
+    PAL_ASSERT((count == 0) || ((ppData != nullptr) && (pDataSizes != nullptr) && (pCrcs != nullptr)));
+
+    uint32 first = 0;
+
+#if PAL_HAS_CPUID
+    if (GetCpuFeatures().crc32)
+    {
+        for (; (first + 3) <= count; first += 3)
+        {
+            const uint8* data[3] = { static_cast<const uint8*>(ppData[first]),
+                                     static_cast<const uint8*>(ppData[first + 1]),
+                                     static_cast<const uint8*>(ppData[first + 2]) };
+            uint32 crcs[3] = { ~0u, ~0u, ~0u };
+
+            UpdateCrc32cHw3(data, &pDataSizes[first], crcs);
+
+            pCrcs[first]     = ~crcs[0];
+            pCrcs[first + 1] = ~crcs[1];
+            pCrcs[first + 2] = ~crcs[2];
+        }
+    }
+#endif
+
+    for (; first < count; first++)
+    {
+        pCrcs[first] = Crc32c(ppData[first], pDataSizes[first]);
+    }
+}
+
+// =====================================================================================================================
+void Hash128(
+    const void* pData,
+    size_t      dataSize,
+    uint64      seed,
+    Hash*       pHash)
+{
+    PAL_ASSERT(pHash != nullptr);
+
+    const uint8* pBytes = static_cast<const uint8*>(pData);
+
+#if PAL_HAS_CPUID
+    if (GetCpuFeatures().aes)
+    {
+        Hash128Hw(pBytes, dataSize, seed, pHash);
+    }
+    else
+#endif
+    {
+        Hash128Portable(pBytes, dataSize, seed, pHash);
+    }
+}
+
+// =====================================================================================================================
+uint64 Hash64(
+    const void* pData,
+    size_t      dataSize,
+    uint64      seed)
+{
+    Hash hash;
+    Hash128(pData, dataSize, seed, &hash);
+
+    return hash.qwords[0] ^ hash.qwords[1];
+}
+
+} // HwHash
+} // Util
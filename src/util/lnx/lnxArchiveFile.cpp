@@ -120,7 +120,8 @@ static uint64 Crc64(
 }
 
 // =====================================================================================================================
-// Helper function to read directly from a file using Linux API
+// Helper function to read directly from a file using Linux API. Uses positional reads so that threads can read the
+// same file concurrently without sharing a file offset.
 static Result ReadDirect(
     int32   fd,
     size_t  fileOffset,
@@ -130,39 +131,36 @@ static Result ReadDirect(
     PAL_ASSERT(fd   > 0);
     PAL_ASSERT(pBuffer != nullptr);
 
-    struct stat statBuf;
-    Result result    = Result::ErrorUnknown;
+    Result result          = Result::Success;
+    size_t alreadyReadSize = 0;
 
-    if (fstat(fd, &statBuf) == 0)
+    while ((result == Result::Success) && (alreadyReadSize < readSize))
     {
-        result = Result::Success;
-    }
+        const ssize_t bytesRead = pread(fd,
+                                        VoidPtrInc(pBuffer, alreadyReadSize),
+                                        readSize - alreadyReadSize,
+                                        static_cast<off_t>(fileOffset + alreadyReadSize));
 
-    if (result == Result::Success)
-    {
-        if (lseek(fd, fileOffset, SEEK_SET) == InvalidSysCall)
+        if (bytesRead > 0)
+        {
+            alreadyReadSize += static_cast<size_t>(bytesRead);
+        }
+        else if (bytesRead == 0)
+        {
+            // A buffer at the start of the file may be larger than the whole file, but any other read which reaches
+            // the end of the file early means the file is shorter than expected.
+            if (fileOffset != 0)
+            {
+                result = Result::ErrorUnknown;
+                PAL_ALERT_ALWAYS();
+            }
+            break;
+        }
+        else if (errno != EINTR)
         {
             result = ConvertErrno(errno);
+            PAL_ALERT_ALWAYS();
         }
-
-    }
-
-    size_t alreadyReadSize = 0;
-    size_t exactSize = Min(readSize, static_cast<size_t>(statBuf.st_size));
-
-    if (result == Result::Success)
-    {
-        alreadyReadSize = read(fd, pBuffer, exactSize);
-    }
-
-    if (alreadyReadSize == exactSize)
-    {
-        result = Result::Success;
-    }
-    else
-    {
-        result = ConvertErrno(errno);
-        PAL_ALERT_ALWAYS();
     }
 
     return result;
@@ -181,14 +179,7 @@ static Result WriteDirect(
 
     Result result       = Result::ErrorUnknown;
 
-    if (lseek(fd, fileOffset, SEEK_SET) == InvalidSysCall)
-    {
-        result = ConvertErrno(errno);
-        PAL_ALERT_ALWAYS();
-        return result;
-    }
-
-    size_t alreadyWriteSize = write(fd, pData, writeSize);
+    size_t alreadyWriteSize = pwrite(fd, pData, writeSize, static_cast<off_t>(fileOffset));
 
     if (alreadyWriteSize == writeSize)
     {
@@ -449,6 +440,7 @@ ArchiveFile::ArchiveFile(
     :
     // File Information
     m_allocator         (callbacks),
+    m_mutex             (),
     m_hFile             (hFile),
     m_archiveHeader     (*pArchiveHeader),
     m_fileSize          (0),
@@ -464,13 +456,38 @@ ArchiveFile::ArchiveFile(
     m_recentList        (),
     m_pages             (),
     m_pageCount         (0),
-    m_pageSize          (MinPageSize)
+    m_pageSize          (MinPageSize),
+    // Asynchronous page loads
+    m_useAsyncIo        (false),
+    m_ioShutdown        (false),
+    m_ioQueue           (),
+    m_ioRequestCv       (),
+    m_ioCompleteCv      (),
+    m_ioThreads         ()
 {
 }
 
 // =====================================================================================================================
 ArchiveFile::~ArchiveFile()
 {
+    if (m_useAsyncIo)
+    {
+        {
+            MutexAuto lock(&m_mutex);
+
+            m_ioShutdown = true;
+            m_ioRequestCv.WakeAll();
+        }
+
+        for (uint32 i = 0; i < NumIoThreads; ++i)
+        {
+            if (m_ioThreads[i].IsCreated())
+            {
+                m_ioThreads[i].Join();
+            }
+        }
+    }
+
     close(m_hFile);
 }
 
@@ -487,11 +504,20 @@ Result ArchiveFile::Init(
     {
         m_useBufferedMemory = true;
         result              = InitPages();
+
+        // Asynchronous page loads are optional, so failing to start the I/O threads isn't an error
+        if ((result == Result::Success) &&
+            (pInfo->allowAsyncFileIo))
+        {
+            InitIoThreads();
+        }
     }
 
-    // Read the footer of the file directly
+    // Read the footer of the file directly. The I/O threads may already be running, so this needs the lock.
     if (result == Result::Success)
     {
+        MutexAuto lock(&m_mutex);
+
         result = RefreshFile(true);
         if ((result != Result::ErrorIncompatibleLibrary) &&
             (IsErrorResult(result)))
@@ -507,6 +533,8 @@ Result ArchiveFile::Init(
 // Returns the number of "good" entries found within the archive
 size_t ArchiveFile::GetEntryCount() const
 {
+    MutexAuto lock(&m_mutex);
+
     return m_cachedFooter.entryCount;
 }
 
@@ -518,6 +546,8 @@ Result ArchiveFile::Preload(
 {
     Result result = Result::ErrorUnknown;
 
+    MutexAuto lock(&m_mutex);
+
     if (m_useBufferedMemory)
     {
         if (startLocation < m_fileSize)
@@ -569,12 +599,14 @@ Result ArchiveFile::FillEntryHeaderTable(
     }
     else
     {
+        MutexAuto lock(&m_mutex);
+
         const size_t endEntry = Min<size_t>(startEntry + maxEntries, m_entries.NumElements());
 
         for (size_t i = startEntry; i < endEntry; ++i)
         {
             ArchiveEntryHeader* pCurEntry = &pHeaders[i];
-            result = GetEntryByIndex(i, pCurEntry);
+            result = GetEntryByIndexInternal(i, pCurEntry);
 
             if (result != Result::Success)
             {
@@ -606,24 +638,50 @@ Result ArchiveFile::Read(
     }
     else
     {
-        Result refreshResult = RefreshFile(false);
-
-        // We can still attempt to read from the file using our cached header
-        PAL_ALERT(IsErrorResult(refreshResult));
+        bool readDirect = false;
 
-        // Sanity check our arguments before attempting the read
-        if ((pHeader->ordinalId <= GetEntryCount()) &&
-            ((pHeader->dataPosition + pHeader->dataSize) <= m_curFooterOffset))
         {
-            result = ReadInternal(pHeader->dataPosition,
-                                  pDataBuffer,
-                                  pHeader->dataSize,
-                                  false,
-                                  true);
+            MutexAuto lock(&m_mutex);
+
+            Result refreshResult = RefreshFile(false);
+
+            // We can still attempt to read from the file using our cached header
+            PAL_ALERT(IsErrorResult(refreshResult));
+
+            // Sanity check our arguments before attempting the read
+            if ((pHeader->ordinalId <= m_cachedFooter.entryCount) &&
+                ((pHeader->dataPosition + pHeader->dataSize) <= m_curFooterOffset))
+            {
+                if (m_useBufferedMemory)
+                {
+                    result = ReadCached(pHeader->dataPosition, pDataBuffer, pHeader->dataSize, false, true);
+                }
+
+                readDirect = (result != Result::Success);
+
+                // Entries tend to be read in the order they were written, so start loading the page after this one
+                const size_t nextOffset = pHeader->dataPosition + pHeader->dataSize;
+
+                if (m_useAsyncIo && (nextOffset < m_curFooterOffset))
+                {
+                    Result prefetchResult = ReadCached(nextOffset,
+                                                       nullptr,
+                                                       Min(m_pageSize, m_curFooterOffset - nextOffset),
+                                                       false,
+                                                       false);
+                    PAL_ALERT(IsErrorResult(prefetchResult));
+                }
+            }
+            else
+            {
+                result = Result::ErrorInvalidValue;
+            }
         }
-        else
+
+        // Entry data below the footer never changes, so it can be read from the file without holding the lock.
+        if (readDirect)
         {
-            result = Result::ErrorInvalidValue;
+            result = ReadDirect(m_hFile, pHeader->dataPosition, pDataBuffer, pHeader->dataSize);
         }
     }
 
@@ -662,6 +720,8 @@ Result ArchiveFile::Write(
     }
     else if (m_haveWriteAccess)
     {
+        MutexAuto lock(&m_mutex);
+
         // cache off the write location
         uint32 curOffset = m_curFooterOffset;
 
@@ -824,6 +884,17 @@ Result ArchiveFile::RefreshFile(
 Result ArchiveFile::GetEntryByIndex(
     size_t              index,
     ArchiveEntryHeader* pHeader)
+{
+    MutexAuto lock(&m_mutex);
+
+    return GetEntryByIndexInternal(index, pHeader);
+}
+
+// =====================================================================================================================
+// Lookup Archive entry header by index. The caller must hold m_mutex.
+Result ArchiveFile::GetEntryByIndexInternal(
+    size_t              index,
+    ArchiveEntryHeader* pHeader)
 {
     PAL_ASSERT(pHeader != nullptr);
 
@@ -972,7 +1043,8 @@ Result ArchiveFile::WriteInternal(
 }
 
 // =====================================================================================================================
-// Copy data from cached memory pages
+// Copy data from cached memory pages. With asynchronous I/O, pages which aren't in memory yet are queued for the I/O
+// threads; if wait is false this returns without waiting for them, otherwise m_mutex is released while waiting.
 Result ArchiveFile::ReadCached(
     size_t fileOffset,
     void*  pBuffer,
@@ -996,15 +1068,20 @@ Result ArchiveFile::ReadCached(
             curEnd = CalcNextPageBoundary(curOffset);
         }
 
-        PageInfo* const pPage = FindPage(curOffset, true, forceReload);
+        PageInfo* pPage = FindPage(curOffset, true, forceReload, m_useAsyncIo);
 
-        if (pPage != nullptr)
+        while (wait && (pPage != nullptr) && pPage->IsPending())
         {
-            if (wait == true)
-            {
-                pPage->Wait();
-            }
+            WakeIoThreads();
+            m_ioCompleteCv.Wait(&m_mutex, UINT32_MAX);
 
+            // The page may have been recycled or failed to load while we weren't holding the lock, so look it up
+            // again. Don't load it again, the caller can read the file directly instead.
+            pPage = FindPage(curOffset, false, false, m_useAsyncIo);
+        }
+
+        if (pPage != nullptr)
+        {
             // Allow pBuffer to be nullptr. This allows us to reuse this function to preload cache pages
             if (pBuffer != nullptr)
             {
@@ -1030,6 +1107,9 @@ Result ArchiveFile::ReadCached(
         curOffset = curEnd;
     }
 
+    // Submit every page this read queued at once
+    WakeIoThreads();
+
     return result;
 }
 
@@ -1052,7 +1132,7 @@ Result ArchiveFile::WriteCached(
     while (curOffset < endOffset)
     {
         // If we're using async IO, just force the page to reload if found
-        PageInfo* const pPage = FindPage(curOffset, false, false);
+        PageInfo* const pPage = FindPage(curOffset, false, false, false);
 
         size_t curEnd = endOffset;
         if (CalcPageIndex(curOffset) != CalcPageIndex(curEnd))
@@ -1060,12 +1140,20 @@ Result ArchiveFile::WriteCached(
             curEnd = CalcNextPageBoundary(curOffset);
         }
 
-        // If we don't find our page in memory, that's okay our changes will be pulled in next time
+        // If we don't find our page in memory, that's okay our changes will be pulled in next time. The same goes for
+        // a page which is still queued, but a page which is being read may already have read the old data.
         if (pPage != nullptr)
         {
-            void* const       pDst = pPage->Contains(curOffset);
-            const void* const pSrc = VoidPtrInc(pData, curOffset - fileOffset);
-            memcpy(pDst, pSrc, curEnd - curOffset);
+            if (pPage->IsLoaded())
+            {
+                void* const       pDst = pPage->Contains(curOffset);
+                const void* const pSrc = VoidPtrInc(pData, curOffset - fileOffset);
+                memcpy(pDst, pSrc, curEnd - curOffset);
+            }
+            else if (pPage->GetState() == PageInfo::State::Reading)
+            {
+                pPage->MarkStale();
+            }
         }
 
         curOffset = curEnd;
@@ -1095,11 +1183,13 @@ Result ArchiveFile::InitPages()
 }
 
 // =====================================================================================================================
-// Locate the cache page corresponding to the file offset
+// Locate the cache page corresponding to the file offset. Pages loaded on a miss are queued for the I/O threads if async
+// is set and asynchronous I/O is enabled, so the returned page may not be loaded yet.
 ArchiveFile::PageInfo* ArchiveFile::FindPage(
     size_t fileOffset,
     bool   loadOnMiss,
-    bool   forceReload)
+    bool   forceReload,
+    bool   async)
 {
     PageInfo* pFoundPage = nullptr;
 
@@ -1110,11 +1200,20 @@ ArchiveFile::PageInfo* ArchiveFile::FindPage(
         if (pCurPage->Contains(fileOffset) != nullptr)
         {
             pFoundPage = pCurPage;
-            if (forceReload &&
-                (pFoundPage->IsLoaded()))
+            if (forceReload)
             {
-                Result reloadResult = pFoundPage->Reload(m_hFile, false);
-                PAL_ALERT(IsErrorResult(reloadResult));
+                if (pFoundPage->GetState() == PageInfo::State::Reading)
+                {
+                    // We can't touch the page until its read finishes, so throw the result away instead
+                    pFoundPage->MarkStale();
+                }
+                else
+                {
+                    CancelPageLoad(pFoundPage);
+
+                    Result reloadResult = LoadPage(pFoundPage, pFoundPage->BeginOffset(), async);
+                    PAL_ALERT(IsErrorResult(reloadResult));
+                }
             }
             break;
         }
@@ -1135,7 +1234,7 @@ ArchiveFile::PageInfo* ArchiveFile::FindPage(
             {
                 m_pages[m_pageCount].Init(pMem, m_pageSize);
 
-                if (m_pages[m_pageCount].Load(m_hFile, pageBaseAddress, false) == Result::Success)
+                if (LoadPage(&m_pages[m_pageCount], pageBaseAddress, async) == Result::Success)
                 {
                     pFoundPage   = &m_pages[m_pageCount];
                     m_pageCount += 1;
@@ -1148,18 +1247,32 @@ ArchiveFile::PageInfo* ArchiveFile::FindPage(
             }
         }
 
-        // Pull the least recently used page
-        if ((pFoundPage == nullptr) && (m_recentList.IsEmpty() != true))
+        // Pull the least recently used page which isn't being read
+        if (pFoundPage == nullptr)
         {
-            PageInfo* pRecyclePage = m_recentList.Back();
-            pRecyclePage->Cancel();
-            if (pRecyclePage->Load(m_hFile, pageBaseAddress, false) == Result::Success)
+            PageInfo* pRecyclePage = nullptr;
+
+            for (PageInfo::Iter i = m_recentList.End(); i.IsValid(); i.Prev())
             {
-                pFoundPage = pRecyclePage;
+                if (i.Get()->GetState() != PageInfo::State::Reading)
+                {
+                    pRecyclePage = i.Get();
+                    break;
+                }
             }
-            else
+
+            if (pRecyclePage != nullptr)
             {
-                PAL_ALERT_ALWAYS();
+                CancelPageLoad(pRecyclePage);
+
+                if (LoadPage(pRecyclePage, pageBaseAddress, async) == Result::Success)
+                {
+                    pFoundPage = pRecyclePage;
+                }
+                else
+                {
+                    PAL_ALERT_ALWAYS();
+                }
             }
         }
     }
@@ -1179,6 +1292,115 @@ ArchiveFile::PageInfo* ArchiveFile::FindPage(
     return pFoundPage;
 }
 
+// =====================================================================================================================
+// Load a page with the data at the given file offset, either right away or by queueing it for the I/O threads. The
+// page must not be pending.
+Result ArchiveFile::LoadPage(
+    PageInfo* pPage,
+    size_t    fileOffset,
+    bool      async)
+{
+    PAL_ASSERT(pPage->IsPending() == false);
+
+    Result result = Result::Success;
+
+    if (async && m_useAsyncIo)
+    {
+        pPage->SetQueued(fileOffset);
+        m_ioQueue.PushBack(pPage->IoListNode());
+    }
+    else
+    {
+        result = pPage->Load(m_hFile, fileOffset);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Take a page off the I/O queue if it is queued. The page must not be being read.
+void ArchiveFile::CancelPageLoad(
+    PageInfo* pPage)
+{
+    PAL_ASSERT(pPage->GetState() != PageInfo::State::Reading);
+
+    if (pPage->GetState() == PageInfo::State::Queued)
+    {
+        m_ioQueue.Erase(pPage->IoListNode());
+        pPage->SetState(PageInfo::State::Empty);
+    }
+}
+
+// =====================================================================================================================
+// Start the I/O threads. Asynchronous I/O stays disabled if none of them can be started.
+void ArchiveFile::InitIoThreads()
+{
+    for (uint32 i = 0; i < NumIoThreads; ++i)
+    {
+        if (m_ioThreads[i].Begin(&IoThreadFunc, this) == Result::Success)
+        {
+            m_useAsyncIo = true;
+        }
+        else
+        {
+            PAL_ALERT_ALWAYS();
+            break;
+        }
+    }
+}
+
+// =====================================================================================================================
+// Let the I/O threads know that pages were queued. The caller must hold m_mutex.
+void ArchiveFile::WakeIoThreads()
+{
+    if (m_ioQueue.IsEmpty() == false)
+    {
+        m_ioRequestCv.WakeAll();
+    }
+}
+
+// =====================================================================================================================
+void ArchiveFile::IoThreadFunc(
+    void* pParameter)
+{
+    static_cast<ArchiveFile*>(pParameter)->ProcessIoRequests();
+}
+
+// =====================================================================================================================
+// Main loop of the I/O threads. Reads queued pages in the order they were queued until the file is destroyed.
+void ArchiveFile::ProcessIoRequests()
+{
+    m_mutex.Lock();
+
+    while (m_ioShutdown == false)
+    {
+        if (m_ioQueue.IsEmpty())
+        {
+            m_ioRequestCv.Wait(&m_mutex, UINT32_MAX);
+        }
+        else
+        {
+            PageInfo* const pPage = m_ioQueue.Front();
+
+            m_ioQueue.Erase(pPage->IoListNode());
+            pPage->SetState(PageInfo::State::Reading);
+
+            // Nothing else touches the page's memory or moves it while it is being read, so drop the lock
+            const size_t fileOffset = pPage->BeginOffset();
+
+            m_mutex.Unlock();
+            const Result result = ReadDirect(m_hFile, fileOffset, pPage->Memory(), pPage->MemorySize());
+            m_mutex.Lock();
+
+            pPage->SetState(((result == Result::Success) && (pPage->IsStale() == false)) ? PageInfo::State::Loaded
+                                                                                           : PageInfo::State::Empty);
+            m_ioCompleteCv.WakeAll();
+        }
+    }
+
+    m_mutex.Unlock();
+}
+
 // =====================================================================================================================
 // Determin an a given offset is inside out page and return a pointer to the backing memory
 void* ArchiveFile::PageInfo::Contains(
@@ -1189,7 +1411,8 @@ void* ArchiveFile::PageInfo::Contains(
     const size_t endOffset = m_beginOffset + m_memSize;
     void*        pMem      = nullptr;
 
-    if ((offset >= m_beginOffset) &&
+    if ((m_state != State::Empty) &&
+        (offset >= m_beginOffset) &&
         (offset < endOffset))
     {
         pMem = VoidPtrInc(m_pMem, offset - m_beginOffset);
@@ -1199,15 +1422,18 @@ void* ArchiveFile::PageInfo::Contains(
 }
 
 // =====================================================================================================================
-// Pull a page in from the disk using the appropriate method
+// Pull a page in from the disk right away
 Result ArchiveFile::PageInfo::Load(
     int32  hFile,
-    size_t fileOffset,
-    bool   useAsyncIo)
+    size_t fileOffset)
 {
     m_beginOffset = fileOffset;
 
-    return ReadDirect(hFile, fileOffset, m_pMem, m_memSize);
+    const Result result = ReadDirect(hFile, fileOffset, m_pMem, m_memSize);
+
+    m_state = (result == Result::Success) ? State::Loaded : State::Empty;
+
+    return result;
 }
 
 // =====================================================================================================================
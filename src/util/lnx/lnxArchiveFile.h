@@ -24,8 +24,11 @@
  **********************************************************************************************************************/
 #include "palArchiveFile.h"
 #include "palArchiveFileFmt.h"
+#include "palConditionVariable.h"
 #include "palIntrusiveList.h"
 #include "palLinearAllocator.h"
+#include "palMutex.h"
+#include "palThread.h"
 #include "palVector.h"
 
 namespace Util
@@ -34,6 +37,13 @@ constexpr int32 InvalidSysCall = -1; // value representing system call happens e
 
 // =====================================================================================================================
 // Wrapper around a transaction file written int the format specified in palArchiveFileFmt.h
+//
+// All methods are thread-safe. Reads of entry data which don't go through the cache pages are done outside of the lock
+// with positional reads, so concurrent reads don't wait for each other.
+//
+// When the file is opened with allowAsyncFileIo, cache pages are loaded by a small pool of I/O threads. Preload()
+// queues all of its pages at once and returns without waiting, and every cached read queues the page after it as a
+// read-ahead.
 class ArchiveFile : public IArchiveFile
 {
 public:
@@ -86,11 +96,23 @@ private:
         using Node = IntrusiveListNode<PageInfo>;
         using Iter = IntrusiveListIterator<PageInfo>;
 
+        // Load states of a page. Only the I/O thread reading a page may touch its memory in the Reading state.
+        enum class State : uint32
+        {
+            Empty,   // Holds no data
+            Queued,  // Waiting for an I/O thread to read it
+            Reading, // Being read by an I/O thread
+            Loaded,  // Holds the data at m_beginOffset
+        };
+
         PageInfo() :
             m_beginOffset   { 0 },
             m_pMem          { nullptr },
             m_memSize       { 0 },
-            m_node          { this }
+            m_state         { State::Empty },
+            m_stale         { false },
+            m_node          { this },
+            m_ioNode        { this }
             {}
         void Init(void* pMem, size_t memSize) { m_pMem = pMem; m_memSize = memSize; }
 
@@ -98,28 +120,44 @@ private:
         void* Contains(size_t offset);
 
         // I/O Control
-        Result Load(int32 fd, size_t fileOffset, bool useAsyncIo);
-        Result Reload(int32 fd, bool useAsyncIo) { return Load(fd, m_beginOffset, useAsyncIo); }
-        bool   IsLoaded() { return true; }
-        void   Wait() {}
-        void   Cancel() {}
+        Result Load(int32 fd, size_t fileOffset);
+        void   SetQueued(size_t fileOffset) { m_beginOffset = fileOffset; m_state = State::Queued; m_stale = false; }
+        void   SetState(State state) { m_state = state; }
+        State  GetState() const { return m_state; }
+        bool   IsLoaded() const { return (m_state == State::Loaded); }
+        bool   IsPending() const { return (m_state == State::Queued) || (m_state == State::Reading); }
+        size_t BeginOffset() const { return m_beginOffset; }
+        void*  Memory() const { return m_pMem; }
+        size_t MemorySize() const { return m_memSize; }
+
+        // Set when the file is written under a page which is being read, so that the read's result is thrown away
+        void   MarkStale() { m_stale = true; }
+        bool   IsStale() const { return m_stale; }
 
         // LRU list node
         Node* ListNode() { return &m_node; }
 
+        // I/O queue node
+        Node* IoListNode() { return &m_ioNode; }
+
     private:
         PAL_DISALLOW_COPY_AND_ASSIGN(PageInfo);
 
         size_t       m_beginOffset; // Location in file where page begins
         void*        m_pMem;        // Memory backing this page
         size_t       m_memSize;     // Size of memory page
+        State        m_state;       // Load state of the page
+        bool         m_stale;       // The data being read is out of date
         Node         m_node;        // Page's position in an LRU chain
+        Node         m_ioNode;      // Page's position in the I/O queue
     };
 
     Result RefreshFile(bool forceRefresh);
 
     Result ReadNextEntry(ArchiveEntryHeader* pCurheader, ArchiveEntryHeader* pNextHeader);
 
+    Result GetEntryByIndexInternal(size_t index, ArchiveEntryHeader* pHeader);
+
     Result ReadInternal(size_t fileOffset, void* pBuffer, size_t readSize, bool forceCacheReload, bool wait);
     Result WriteInternal(size_t fileOffset, const void* pData, size_t writeSize);
 
@@ -129,21 +167,35 @@ private:
 
     // Page management
     Result    InitPages();
-    PageInfo* FindPage(size_t fileOffset, bool loadOnMiss, bool forceReload);
+    PageInfo* FindPage(size_t fileOffset, bool loadOnMiss, bool forceReload, bool async);
+    Result    LoadPage(PageInfo* pPage, size_t fileOffset, bool async);
+    void      CancelPageLoad(PageInfo* pPage);
     int32     CalcPageIndex(size_t fileOffset) const        { return static_cast<int32>(fileOffset / m_pageSize); }
     size_t    CalcNextPageBoundary(size_t fileOffset) const { return (CalcPageIndex(fileOffset) + 1) * m_pageSize; }
 
+    // Asynchronous page loads
+    void        InitIoThreads();
+    void        WakeIoThreads();
+    static void IoThreadFunc(void* pParameter);
+    void        ProcessIoRequests();
+
     // Paged memory should total 512 MB max
     static constexpr size_t MaxPageCount = 64;
     static constexpr size_t MaxPageSize  = 8 * 1024 * 1024;
     static constexpr size_t MinPageSize  = 256 * 1024;
 
+    // Number of threads which load cache pages asynchronously
+    static constexpr uint32 NumIoThreads = 4;
+
     using EntryVector = Vector<ArchiveEntryHeader, 16, ForwardAllocator>;
 
     // Allocator
     ForwardAllocator*       Allocator() { return &m_allocator; }
     ForwardAllocator        m_allocator;
 
+    // Guards all of the mutable state below
+    mutable Mutex           m_mutex;
+
     // File information
     const int32             m_hFile;
     const ArchiveFileHeader m_archiveHeader;
@@ -163,6 +215,14 @@ private:
     PageInfo                m_pages[MaxPageCount];
     size_t                  m_pageCount;
     size_t                  m_pageSize;
+
+    // Asynchronous page loads
+    bool                    m_useAsyncIo;     // The I/O threads are running
+    bool                    m_ioShutdown;     // Tells the I/O threads to exit
+    PageInfo::List          m_ioQueue;        // Pages in the Queued state, in the order they were requested
+    ConditionVariable       m_ioRequestCv;    // Signaled when pages are queued or on shutdown
+    ConditionVariable       m_ioCompleteCv;   // Signaled when an I/O thread finishes reading a page
+    Thread                  m_ioThreads[NumIoThreads];
 };
 
 } //namespace Util
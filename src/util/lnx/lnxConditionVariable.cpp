@@ -26,12 +26,74 @@
 #include "palConditionVariable.h"
 #include "palMutex.h"
 #include "palSysMemory.h"
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION < 692
 #include "util/lnx/lnxTimeout.h"
 #include <errno.h>
+#endif
 
 namespace Util
 {
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+// =====================================================================================================================
+// Atomically releases the given mutex object and goes to sleep on the condition variable.  Once we awake from this
+// sleep, reacquire the critical section.  Returns false if the specified number of milliseconds elapse before it is
+// awoken.
+bool ConditionVariable::Wait(
+    Mutex* pMutex,
+    uint32 milliseconds)  // Can be set to 0xFFFFFFFF to wait forever.
+{
+    bool result = false;
+
+    if (pMutex != nullptr)
+    {
+        // Register as a waiter while still holding the mutex.  A waker which changes the condition under the mutex
+        // then either runs before our caller checked it, or sees this waiter and bumps the sequence number, which
+        // makes the futex return immediately if that happens before we go to sleep.
+        AtomicIncrement(&m_numWaiters);
+
+        const uint32 sequence = AtomicReadAcquire(&m_sequence);
+
+        pMutex->Unlock();
+        result = (WaitOnAddress(&m_sequence, sequence, milliseconds) == Result::Success);
+        pMutex->Lock();
+
+        AtomicDecrement(&m_numWaiters);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Wakes one or all of the waiting threads.  Without waiters, this is just a memory barrier and a load.
+void ConditionVariable::Wake(
+    bool wakeAll)
+{
+    // Order the write which changed the condition before the read of the waiter count.
+    AtomicThreadFence();
+
+    if (AtomicReadAcquire(&m_numWaiters) != 0)
+    {
+        AtomicIncrement(&m_sequence);
+        WakeOnAddress(&m_sequence, wakeAll);
+    }
+}
+
+// =====================================================================================================================
+// Wakes up one thread that is waiting on this condition variable.
+void ConditionVariable::WakeOne()
+{
+    Wake(false);
+}
+
+// =====================================================================================================================
+// Wakes up all threads that are waiting on this condition variable.
+void ConditionVariable::WakeAll()
+{
+    Wake(true);
+}
+
+#else
 // =====================================================================================================================
 // Atomically releases the given mutex object and goes to sleep on the condition variable.  Once we awake from this
 // sleep, reacquire the critical section.  Returns false if the specified number of milliseconds elapse before it is
@@ -88,4 +150,6 @@ void ConditionVariable::WakeAll()
     PAL_ASSERT(ret == 0);
 }
 
+#endif
+
 } // Util
@@ -25,12 +25,383 @@
 
 #include "palMutex.h"
 #include "palSysMemory.h"
+#include "palSysUtil.h"
 #include <errno.h>
+#include <linux/futex.h>
 #include <sched.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
 
 namespace Util
 {
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692
+// Mutex states.  LockedWithSleepers means some thread may be asleep on m_state, so Unlock() must wake one.
+constexpr uint32 Unlocked           = 0;
+constexpr uint32 Locked             = 1;
+constexpr uint32 LockedWithSleepers = 2;
+
+// RWLock state bits: a reader count, a count of waiting writers, a writer-owned bit and a bit which tells the thread
+// releasing the lock that some thread may be asleep on it.
+constexpr uint32 ReaderMask        = 0x000FFFFF;
+constexpr uint32 WaitingWriterOne  = 0x00100000;
+constexpr uint32 WaitingWriterMask = 0x3FF00000;
+constexpr uint32 WriterLocked      = 0x40000000;
+constexpr uint32 HasSleepers       = 0x80000000;
+
+// Contended acquisitions spin at most this many times before sleeping.  Each spin is a pause plus one relaxed load, so
+// this covers a critical section of a few microseconds; anything longer is cheaper to sleep through.
+constexpr uint32 MaxSpinCount = 200;
+
+constexpr uint32 Infinite = 0xFFFFFFFF;
+
+// =====================================================================================================================
+// Tells the CPU that this thread is spinning, which saves power and frees up the core for a hyper-threaded sibling.
+static void SpinPause()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// =====================================================================================================================
+static bool CompareAndSwapAcquire(
+    volatile uint32* pTarget,
+    uint32           oldValue,
+    uint32           newValue)
+{
+    return __atomic_compare_exchange_n(pTarget, &oldValue, newValue, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+// =====================================================================================================================
+// Acquires the mutex if it is not contended.  If it is contended, waits for the mutex to become available, then
+// acquires it.
+void Mutex::Lock()
+{
+    if (CompareAndSwapAcquire(&m_state, Unlocked, Locked) == false)
+    {
+        LockContended();
+    }
+
+#if PAL_DEVELOPER_BUILD
+    m_stats.acquireCount++;
+#endif
+}
+
+// =====================================================================================================================
+// Spins for a while, then sleeps until the mutex can be acquired.
+void Mutex::LockContended()
+{
+#if PAL_DEVELOPER_BUILD
+    const int64 startTime = GetPerfCpuTime();
+    bool        slept     = false;
+#endif
+
+    // Spin for up to twice as long as contended acquisitions have recently needed, so that the budget grows when the
+    // owner tends to release the lock soon and shrinks towards nothing when it doesn't.  m_spinCount is only written
+    // while holding the lock; reading a stale value here just changes how long we spin.
+    const uint32 spinCount = __atomic_load_n(&m_spinCount, __ATOMIC_RELAXED);
+    const uint32 maxSpins  = Min(2 * spinCount + 10, MaxSpinCount);
+    uint32       spins    = 0;
+    bool         acquired = false;
+
+    for (; (acquired == false) && (spins < maxSpins); ++spins)
+    {
+        SpinPause();
+
+        acquired = (__atomic_load_n(&m_state, __ATOMIC_RELAXED) == Unlocked) &&
+                   CompareAndSwapAcquire(&m_state, Unlocked, Locked);
+    }
+
+    if (acquired == false)
+    {
+        // Marking the mutex as having sleepers before sleeping makes the owner's Unlock() wake us.  Once we've slept,
+        // we can't tell whether other threads are still asleep, so we keep the mark when we do take the lock.
+        while (__atomic_exchange_n(&m_state, LockedWithSleepers, __ATOMIC_ACQUIRE) != Unlocked)
+        {
+            WaitOnAddress(&m_state, LockedWithSleepers, Infinite);
+#if PAL_DEVELOPER_BUILD
+            slept = true;
+#endif
+        }
+    }
+
+    const int32 delta = (static_cast<int32>(spins) - static_cast<int32>(m_spinCount)) / 8;
+    __atomic_store_n(&m_spinCount, m_spinCount + delta, __ATOMIC_RELAXED);
+
+#if PAL_DEVELOPER_BUILD
+    m_stats.contendedCount++;
+    m_stats.sleepCount += slept ? 1 : 0;
+    m_stats.waitTicks  += GetPerfCpuTime() - startTime;
+#endif
+}
+
+// =====================================================================================================================
+// Acquires the mutex if it is not contended.  Does not wait for the mutex to become available if it is contended.
+// Returns true if the mutex was successfully acquired.
+bool Mutex::TryLock()
+{
+    const bool acquired = CompareAndSwapAcquire(&m_state, Unlocked, Locked);
+
+#if PAL_DEVELOPER_BUILD
+    // The stats may only be written while holding the lock.
+    if (acquired)
+    {
+        m_stats.acquireCount++;
+    }
+#endif
+
+    return acquired;
+}
+
+// =====================================================================================================================
+// Releases the mutex, waking one sleeping thread if there are any.
+void Mutex::Unlock()
+{
+    const uint32 oldState = __atomic_exchange_n(&m_state, Unlocked, __ATOMIC_RELEASE);
+    PAL_ASSERT(oldState != Unlocked);
+
+    if (oldState == LockedWithSleepers)
+    {
+        WakeOnAddress(&m_state, false);
+    }
+}
+
+// =====================================================================================================================
+// Acquires a rw lock in readonly mode if it is not contended in readwrite mode.
+// If it is contended, wait for rw lock to become available, then enter it.
+void RWLock::LockForRead()
+{
+    // Readers only need to wait if a writer holds or is waiting for the lock, so retry the fast path as long as it's
+    // just other readers changing the count.
+    uint32 state    = __atomic_load_n(&m_state, __ATOMIC_RELAXED);
+    bool   acquired = false;
+
+    while ((acquired == false) && ((state & (WriterLocked | WaitingWriterMask)) == 0))
+    {
+        acquired = __atomic_compare_exchange_n(&m_state, &state, state + 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+    }
+
+    if (acquired == false)
+    {
+        LockForReadContended();
+    }
+
+#if PAL_DEVELOPER_BUILD
+    AtomicIncrement64(&m_stats.acquireCount);
+#endif
+}
+
+// =====================================================================================================================
+// Spins for a while, then sleeps until no writer holds or waits for the lock, then takes it for read.
+void RWLock::LockForReadContended()
+{
+#if PAL_DEVELOPER_BUILD
+    const int64 startTime = GetPerfCpuTime();
+    bool        slept     = false;
+#endif
+
+    uint32 spins    = 0;
+    bool   acquired = false;
+
+    while (acquired == false)
+    {
+        uint32 state = __atomic_load_n(&m_state, __ATOMIC_RELAXED);
+
+        if ((state & (WriterLocked | WaitingWriterMask)) == 0)
+        {
+            PAL_ASSERT((state & ReaderMask) != ReaderMask);
+            acquired = __atomic_compare_exchange_n(&m_state, &state, state + 1, false, __ATOMIC_ACQUIRE,
+                                                   __ATOMIC_RELAXED);
+        }
+        else if (spins < MaxSpinCount)
+        {
+            SpinPause();
+            ++spins;
+        }
+        else if (((state & HasSleepers) != 0) ||
+                 __atomic_compare_exchange_n(&m_state, &state, state | HasSleepers, false, __ATOMIC_RELAXED,
+                                             __ATOMIC_RELAXED))
+        {
+            WaitOnAddress(&m_state, state | HasSleepers, Infinite);
+#if PAL_DEVELOPER_BUILD
+            slept = true;
+#endif
+        }
+    }
+
+#if PAL_DEVELOPER_BUILD
+    AtomicIncrement64(&m_stats.contendedCount);
+    AtomicAdd64(&m_stats.sleepCount, slept ? 1 : 0);
+    AtomicAdd64(&m_stats.waitTicks, GetPerfCpuTime() - startTime);
+#endif
+}
+
+// =====================================================================================================================
+// Acquires a rw lock in readwrite mode if it is not contended.
+// If it is contended, wait for rw lock to become available, then enter it.
+void RWLock::LockForWrite()
+{
+    if (CompareAndSwapAcquire(&m_state, 0, WriterLocked) == false)
+    {
+        LockForWriteContended();
+    }
+
+#if PAL_DEVELOPER_BUILD
+    m_stats.acquireCount++;
+#endif
+}
+
+// Spins for a while, then registers as a waiting writer, which holds off new readers, and sleeps until the lock is
+// free.
+void RWLock::LockForWriteContended()
+{
+#if PAL_DEVELOPER_BUILD
+    const int64 startTime = GetPerfCpuTime();
+    bool        slept     = false;
+#endif
+
+    uint32 spins    = 0;
+    bool   waiting  = false;
+    bool   acquired = false;
+
+    while (acquired == false)
+    {
+        uint32 state = __atomic_load_n(&m_state, __ATOMIC_RELAXED);
+
+        if ((state & (ReaderMask | WriterLocked)) == 0)
+        {
+            const uint32 newState = (state | WriterLocked) - (waiting ? WaitingWriterOne : 0);
+
+            acquired = __atomic_compare_exchange_n(&m_state, &state, newState, false, __ATOMIC_ACQUIRE,
+                                                   __ATOMIC_RELAXED);
+        }
+        else if (spins < MaxSpinCount)
+        {
+            SpinPause();
+            ++spins;
+        }
+        else if (waiting == false)
+        {
+            PAL_ASSERT((state & WaitingWriterMask) != WaitingWriterMask);
+            __atomic_fetch_add(&m_state, WaitingWriterOne, __ATOMIC_RELAXED);
+            waiting = true;
+        }
+        else if (((state & HasSleepers) != 0) ||
+                 __atomic_compare_exchange_n(&m_state, &state, state | HasSleepers, false, __ATOMIC_RELAXED,
+                                             __ATOMIC_RELAXED))
+        {
+            WaitOnAddress(&m_state, state | HasSleepers, Infinite);
+#if PAL_DEVELOPER_BUILD
+            slept = true;
+#endif
+        }
+    }
+
+#if PAL_DEVELOPER_BUILD
+    m_stats.contendedCount++;
+    m_stats.sleepCount += slept ? 1 : 0;
+    m_stats.waitTicks  += GetPerfCpuTime() - startTime;
+#endif
+}
+
+// =====================================================================================================================
+// Tries to acquire a rw lock in readonly mode if it is not contended in readwrite mode.
+// Does not wait for the rw lock to become available.
+bool RWLock::TryLockForRead()
+{
+    uint32 state    = __atomic_load_n(&m_state, __ATOMIC_RELAXED);
+    bool   acquired = false;
+
+    while ((acquired == false) && ((state & (WriterLocked | WaitingWriterMask)) == 0))
+    {
+        acquired = __atomic_compare_exchange_n(&m_state, &state, state + 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+    }
+
+#if PAL_DEVELOPER_BUILD
+    if (acquired)
+    {
+        AtomicIncrement64(&m_stats.acquireCount);
+    }
+#endif
+
+    return acquired;
+}
+
+// =====================================================================================================================
+// Tries to acquire a rw lock in readonly mode if it is not contended.
+// Does not wait for the rw lock to become available.
+bool RWLock::TryLockForWrite()
+{
+    uint32 state    = __atomic_load_n(&m_state, __ATOMIC_RELAXED);
+    bool   acquired = false;
+
+    while ((acquired == false) && ((state & (ReaderMask | WriterLocked)) == 0))
+    {
+        acquired = __atomic_compare_exchange_n(&m_state, &state, state | WriterLocked, true, __ATOMIC_ACQUIRE,
+                                               __ATOMIC_RELAXED);
+    }
+
+#if PAL_DEVELOPER_BUILD
+    // The stats may only be written while holding the lock.
+    if (acquired)
+    {
+        m_stats.acquireCount++;
+    }
+#endif
+
+    return acquired;
+}
+
+// =====================================================================================================================
+// Release the rw lock which is previously contended.
+void RWLock::UnlockForRead()
+{
+    const uint32 state = __atomic_sub_fetch(&m_state, 1, __ATOMIC_RELEASE);
+    PAL_ASSERT((state & ReaderMask) != ReaderMask);
+
+    // Only the last reader out can let a writer in.
+    if ((state & ReaderMask) == 0)
+    {
+        WakeSleepers(state);
+    }
+}
+
+// =====================================================================================================================
+// Release the rw lock which is previously contended.
+void RWLock::UnlockForWrite()
+{
+    const uint32 state = __atomic_and_fetch(&m_state, ~WriterLocked, __ATOMIC_RELEASE);
+
+    WakeSleepers(state);
+}
+
+// =====================================================================================================================
+// Wakes every thread sleeping on the lock, given the state its last holder left it in.  They all recheck the state, so
+// a waiting writer or the readers (if no writer is waiting) get the lock and the rest go back to sleep.
+void RWLock::WakeSleepers(
+    uint32 state)
+{
+    // Clear the flag before waking so that threads which go back to sleep set it again.  Even if another thread took
+    // the lock in the meantime, waking the sleepers is harmless: they'll just find it taken and sleep again.
+    bool cleared = false;
+
+    while ((cleared == false) && ((state & HasSleepers) != 0))
+    {
+        cleared = __atomic_compare_exchange_n(&m_state, &state, state & ~HasSleepers, true, __ATOMIC_RELAXED,
+                                              __ATOMIC_RELAXED);
+    }
+
+    if (cleared)
+    {
+        WakeOnAddress(&m_state, true);
+    }
+}
+
+#else
 // =====================================================================================================================
 // Acquires the mutex if it is not contended.  If it is contended, waits for the mutex to become available, then
 // acquires it.
@@ -115,6 +486,8 @@ void RWLock::UnlockForWrite()
     PAL_ASSERT(ret == 0);
 }
 
+#endif
+
 // =====================================================================================================================
 // Yields the current thread to another thread in the ready state (if available).
 void YieldThread()
@@ -122,6 +495,51 @@ void YieldThread()
     sched_yield();
 }
 
+// =====================================================================================================================
+// Sleeps on a futex as long as *pAddress holds the expected value.
+Result WaitOnAddress(
+    volatile uint32* pAddress,
+    uint32           expected,
+    uint32           milliseconds)  // Milliseconds to sleep before timing-out.
+{
+    constexpr uint32 Infinite = 0xFFFFFFFF;
+
+    timespec  timeout  = { };
+    timespec* pTimeout = nullptr;
+
+    if (milliseconds != Infinite)
+    {
+        timeout.tv_sec  = milliseconds / 1000;
+        timeout.tv_nsec = (milliseconds % 1000) * 1000 * 1000;
+        pTimeout        = &timeout;
+    }
+
+    // The kernel rechecks *pAddress under its own lock, so a change made before the matching wake is never missed.
+    // EAGAIN means the value already changed and EINTR is a spurious wakeup; the caller rechecks its condition anyway.
+    const long ret = syscall(SYS_futex, pAddress, FUTEX_WAIT_PRIVATE, expected, pTimeout, nullptr, 0);
+    PAL_ASSERT((ret == 0) || (errno == EAGAIN) || (errno == EINTR) || (errno == ETIMEDOUT));
+
+    return ((ret == -1) && (errno == ETIMEDOUT)) ? Result::Timeout : Result::Success;
+}
+
+// =====================================================================================================================
+// Wakes one or all of the threads sleeping on a futex.
+void WakeOnAddress(
+    volatile uint32* pAddress,
+    bool             wakeAll)
+{
+    const int numToWake = wakeAll ? INT32_MAX : 1;
+
+    syscall(SYS_futex, pAddress, FUTEX_WAKE_PRIVATE, numToWake, nullptr, nullptr, 0);
+}
+
+// =====================================================================================================================
+// Issues a full (sequentially consistent) memory barrier.
+void AtomicThreadFence()
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
 // =====================================================================================================================
 // Thread-safe method to write a 64-bit value, using relaxed memory ordering.
 void AtomicWriteRelaxed64(
@@ -157,6 +575,40 @@ uint64 AtomicReadRelaxed64(
 #endif
 }
 
+// =====================================================================================================================
+// Thread-safe method to read a 32-bit value, using acquire memory ordering.
+uint32 AtomicReadAcquire(
+    const volatile uint32* pTarget)
+{
+    return __atomic_load_n(pTarget, __ATOMIC_ACQUIRE);
+}
+
+// =====================================================================================================================
+// Thread-safe method to write a 32-bit value, using release memory ordering.
+void AtomicWriteRelease(
+    volatile uint32* pTarget,
+    uint32           newValue)
+{
+    __atomic_store_n(pTarget, newValue, __ATOMIC_RELEASE);
+}
+
+// =====================================================================================================================
+// Thread-safe method to read a pointer, using acquire memory ordering.
+void* AtomicReadAcquirePointer(
+    void*const volatile* ppTarget)
+{
+    return __atomic_load_n(ppTarget, __ATOMIC_ACQUIRE);
+}
+
+// =====================================================================================================================
+// Thread-safe method to write a pointer, using release memory ordering.
+void AtomicWriteReleasePointer(
+    void*volatile* ppTarget,
+    void*          pValue)
+{
+    __atomic_store_n(ppTarget, pValue, __ATOMIC_RELEASE);
+}
+
 // =====================================================================================================================
 // Atomically increments a 32-bit unsigned integer, returning the new value.
 uint32 AtomicIncrement(
@@ -24,7 +24,7 @@
  **********************************************************************************************************************/
 
 #include "memoryCacheLayer.h"
-#include "palHashMapImpl.h"
+#include "palFlatHashMapImpl.h"
 #include "palIntrusiveListImpl.h"
 #include "palAssert.h"
 #include "core/platform.h"
@@ -26,7 +26,8 @@
 
 #include "cacheLayerBase.h"
 #include "palConditionVariable.h"
-#include "palHashMap.h"
+#include "palFlatHashMap.h"
+#include "palHwHash.h"
 #include "palIntrusiveList.h"
 #include "palVector.h"
 
@@ -107,7 +108,7 @@ private:
         using List = IntrusiveList<Entry>;
         using Node = IntrusiveListNode<Entry>;
         using Iter = IntrusiveListIterator<Entry>;
-        using Map  = HashMap<Hash128, Entry*, ForwardAllocator, JenkinsHashFunc>;
+        using Map  = FlatHashMap<Hash128, Entry*, ForwardAllocator, Crc32cHashFunc>;
 
         static Entry* Create(
             ForwardAllocator* pAllocator,
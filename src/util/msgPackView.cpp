@@ -0,0 +1,390 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palAssert.h"
+#include "palMsgPackImpl.h"
+#include "palMsgPackView.h"
+#include "palVectorImpl.h"
+
+#include <cstring>
+
+namespace Util
+{
+
+// =====================================================================================================================
+// Walks the whole blob once, recording the byte extent of every map and array.  A stack of the containers which are
+// still open tracks how many children each one is waiting for; when an item completes, it closes every enclosing
+// container for which it was the last child.
+Result MsgPackView::Init(
+    const void* pBuffer,
+    uint32      sizeInBytes)
+{
+    PAL_ASSERT(pBuffer != nullptr);
+
+    struct OpenContainer
+    {
+        uint32 index;      // Index of the container in m_containers.
+        uint64 remaining;  // Number of direct children which have not been completed yet.
+    };
+
+    Vector<OpenContainer, 16, IndirectAllocator> openContainers(&m_allocator);
+
+    m_pBuffer     = nullptr;
+    m_sizeInBytes = 0;
+    m_containers.Clear();
+
+    cw_unpack_context context;
+    cw_unpack_context_init(&context, pBuffer, sizeInBytes, nullptr, nullptr);
+
+    Result result = Result::Success;
+
+    while ((result == Result::Success) && (context.current < context.end))
+    {
+        const uint32 begin = static_cast<uint32>(VoidPtrDiff(context.current, pBuffer));
+
+        cw_unpack_next(&context);
+        result = TranslateCwpReturnCode(context.return_code);
+
+        if (result == Result::Success)
+        {
+            const uint32 headerEnd   = static_cast<uint32>(VoidPtrDiff(context.current, pBuffer));
+            uint64       numChildren = 0;
+            bool         isContainer = false;
+
+            if (context.item.type == CWP_ITEM_MAP)
+            {
+                numChildren = uint64(context.item.as.map.size) * 2;
+                isContainer = true;
+            }
+            else if (context.item.type == CWP_ITEM_ARRAY)
+            {
+                numChildren = context.item.as.array.size;
+                isContainer = true;
+            }
+
+            if (isContainer)
+            {
+                result = m_containers.PushBack({ begin, headerEnd });
+            }
+
+            if ((result == Result::Success) && (numChildren > 0))
+            {
+                result = openContainers.PushBack({ (m_containers.NumElements() - 1), numChildren });
+            }
+            else
+            {
+                // This item is complete, which may complete its parent, and so on.
+                while (openContainers.IsEmpty() == false)
+                {
+                    OpenContainer& parent = openContainers.Back();
+
+                    if (--parent.remaining > 0)
+                    {
+                        break;
+                    }
+
+                    m_containers[parent.index].end = headerEnd;
+
+                    OpenContainer closed;
+                    openContainers.PopBack(&closed);
+                }
+            }
+        }
+    }
+
+    // A container which is still open means the blob was truncated.
+    if ((result == Result::Success) && (openContainers.IsEmpty() == false))
+    {
+        result = Result::ErrorInvalidValue;
+    }
+
+    if (result == Result::Success)
+    {
+        m_pBuffer     = static_cast<const uint8*>(pBuffer);
+        m_sizeInBytes = sizeInBytes;
+    }
+    else
+    {
+        m_containers.Clear();
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Decodes the item header at the given offset.  pHeaderEnd receives the offset just past the header, which for
+// scalars, strings and binary items is also the end of the whole item.
+Result MsgPackView::DecodeItem(
+    uint32       offset,
+    cwpack_item* pItem,
+    uint32*      pHeaderEnd
+    ) const
+{
+    PAL_ASSERT(IsValid());
+
+    Result result = Result::Eof;
+
+    if (offset < m_sizeInBytes)
+    {
+        cw_unpack_context context;
+        cw_unpack_context_init(&context, (m_pBuffer + offset), (m_sizeInBytes - offset), nullptr, nullptr);
+        cw_unpack_next(&context);
+
+        result = TranslateCwpReturnCode(context.return_code);
+
+        // Running out of input in the middle of an item means the offset did not point at the start of one.
+        if (result == Result::Eof)
+        {
+            result = Result::ErrorInvalidValue;
+        }
+
+        if (result == Result::Success)
+        {
+            *pItem      = context.item;
+            *pHeaderEnd = static_cast<uint32>(VoidPtrDiff(context.current, m_pBuffer));
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Finds the indexed container which begins at the given offset.  The index is sorted by begin offset, so this is a
+// binary search.
+const MsgPackView::Container* MsgPackView::FindContainer(
+    uint32 offset
+    ) const
+{
+    uint32 low  = 0;
+    uint32 high = m_containers.NumElements();
+
+    while (low < high)
+    {
+        const uint32 mid = low + ((high - low) / 2);
+
+        if (m_containers[mid].begin < offset)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return ((low < m_containers.NumElements()) && (m_containers[low].begin == offset)) ? &m_containers[low] : nullptr;
+}
+
+// =====================================================================================================================
+Result MsgPackView::GetItem(
+    uint32       offset,
+    cwpack_item* pItem
+    ) const
+{
+    uint32 headerEnd = 0;
+    return DecodeItem(offset, pItem, &headerEnd);
+}
+
+// =====================================================================================================================
+Result MsgPackView::SkipItem(
+    uint32  offset,
+    uint32* pNextOffset
+    ) const
+{
+    cwpack_item item;
+    uint32      headerEnd = 0;
+    Result      result    = DecodeItem(offset, &item, &headerEnd);
+
+    if (result == Result::Success)
+    {
+        if ((item.type == CWP_ITEM_MAP) || (item.type == CWP_ITEM_ARRAY))
+        {
+            const Container* pContainer = FindContainer(offset);
+
+            // Every container in the blob was indexed by Init(), so a miss means offset was not at an item boundary.
+            if (pContainer != nullptr)
+            {
+                *pNextOffset = pContainer->end;
+            }
+            else
+            {
+                result = Result::ErrorInvalidValue;
+            }
+        }
+        else
+        {
+            *pNextOffset = headerEnd;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result MsgPackView::GetFirstChild(
+    uint32  offset,
+    uint32* pChildOffset,
+    uint32* pNumChildren
+    ) const
+{
+    cwpack_item item;
+    uint32      headerEnd = 0;
+    Result      result    = DecodeItem(offset, &item, &headerEnd);
+
+    if (result == Result::Success)
+    {
+        if (item.type == CWP_ITEM_MAP)
+        {
+            *pNumChildren = item.as.map.size * 2;
+        }
+        else if (item.type == CWP_ITEM_ARRAY)
+        {
+            *pNumChildren = item.as.array.size;
+        }
+        else
+        {
+            result = Result::ErrorInvalidValue;
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        *pChildOffset = headerEnd;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Compares each key of the map against pKey, stepping over non-matching values without decoding them.
+Result MsgPackView::FindMapValue(
+    uint32      mapOffset,
+    const char* pKey,
+    uint32      keyLength,
+    uint32*     pValueOffset
+    ) const
+{
+    cwpack_item map;
+    uint32      offset = 0;
+    Result      result = DecodeItem(mapOffset, &map, &offset);
+
+    if ((result == Result::Success) && (map.type != CWP_ITEM_MAP))
+    {
+        result = Result::ErrorInvalidValue;
+    }
+
+    bool found = false;
+
+    // Only a successfully decoded map has a valid pair count.
+    const uint32 numPairs = (result == Result::Success) ? map.as.map.size : 0;
+
+    for (uint32 i = numPairs; (result == Result::Success) && (found == false) && (i > 0); --i)
+    {
+        cwpack_item key;
+        uint32      keyEnd = 0;
+
+        result = DecodeItem(offset, &key, &keyEnd);
+
+        if ((result == Result::Success) && ((key.type == CWP_ITEM_MAP) || (key.type == CWP_ITEM_ARRAY)))
+        {
+            result = SkipItem(offset, &keyEnd);
+        }
+
+        if (result == Result::Success)
+        {
+            if ((key.type == CWP_ITEM_STR) && (key.as.str.length == keyLength) &&
+                (memcmp(key.as.str.start, pKey, keyLength) == 0))
+            {
+                *pValueOffset = keyEnd;
+                found         = true;
+            }
+            else
+            {
+                result = SkipItem(keyEnd, &offset);
+            }
+        }
+    }
+
+    if ((result == Result::Success) && (found == false))
+    {
+        result = Result::NotFound;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result MsgPackView::GetString(
+    uint32       offset,
+    const char** ppString,
+    uint32*      pLength
+    ) const
+{
+    cwpack_item item;
+    Result      result = GetItem(offset, &item);
+
+    if ((result == Result::Success) && (item.type != CWP_ITEM_STR))
+    {
+        result = Result::ErrorInvalidValue;
+    }
+
+    if (result == Result::Success)
+    {
+        *ppString = static_cast<const char*>(item.as.str.start);
+        *pLength  = item.as.str.length;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result MsgPackView::GetUint(
+    uint32  offset,
+    uint64* pValue
+    ) const
+{
+    cwpack_item item;
+    Result      result = GetItem(offset, &item);
+
+    if (result == Result::Success)
+    {
+        if (item.type == CWP_ITEM_POSITIVE_INTEGER)
+        {
+            *pValue = item.as.u64;
+        }
+        else if (item.type == CWP_ITEM_BOOLEAN)
+        {
+            *pValue = item.as.boolean ? 1 : 0;
+        }
+        else
+        {
+            result = Result::ErrorInvalidValue;
+        }
+    }
+
+    return result;
+}
+
+} // Util
@@ -0,0 +1,370 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palBuddyAllocatorImpl.h"
+#include "palInlineFuncs.h"
+#include "palTestAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace Util;
+using namespace PalTests;
+
+namespace
+{
+
+constexpr Pal::gpusize MinBlockSize = 4 * 1024;
+
+// Simple linear congruential generator, so every run sees the same sequence of requests.
+uint64 NextRandom(uint64* pState)
+{
+    *pState = (*pState * 6364136223846793005ull) + 1442695040888963407ull;
+    return (*pState >> 33);
+}
+
+// =====================================================================================================================
+// The block-list buddy allocator BuddyAllocator used to be, with each size's free blocks kept in offset order.  The
+// old allocator took the first free block in its list; taking the lowest offset instead makes it pick the same blocks
+// as the bitmap allocator, so the two can be compared offset for offset.
+class ReferenceBuddyAllocator
+{
+public:
+    ReferenceBuddyAllocator(uint32 baseAllocKval, uint32 minKval)
+        :
+        m_baseAllocKval(baseAllocKval),
+        m_minKval(minKval),
+        m_freeBlocks(baseAllocKval - minKval)
+    {
+        m_freeBlocks.back().insert(0);
+        m_freeBlocks.back().insert(1ull << (baseAllocKval - 1));
+    }
+
+    bool Allocate(Pal::gpusize size, Pal::gpusize alignment, Pal::gpusize* pOffset)
+    {
+        const uint32 kval = Max(Log2(Pow2Pad(Max(size, alignment))), m_minKval);
+
+        uint32 blockKval = kval;
+        while ((blockKval < m_baseAllocKval) && FreeList(blockKval).empty())
+        {
+            blockKval++;
+        }
+
+        const bool found = (blockKval < m_baseAllocKval);
+
+        if (found)
+        {
+            const Pal::gpusize offset = *FreeList(blockKval).begin();
+            FreeList(blockKval).erase(FreeList(blockKval).begin());
+
+            // Split the block down to the requested size, keeping the lower half each time.
+            while (blockKval > kval)
+            {
+                blockKval--;
+                FreeList(blockKval).insert(offset + (1ull << blockKval));
+            }
+
+            m_liveKvals[offset] = kval;
+            *pOffset            = offset;
+        }
+
+        return found;
+    }
+
+    void Free(Pal::gpusize offset)
+    {
+        uint32 kval = m_liveKvals.at(offset);
+        m_liveKvals.erase(offset);
+
+        while (kval < (m_baseAllocKval - 1))
+        {
+            const Pal::gpusize buddy = (offset ^ (1ull << kval));
+
+            if (FreeList(kval).erase(buddy) == 0)
+            {
+                break;
+            }
+
+            offset = Min(offset, buddy);
+            kval++;
+        }
+
+        FreeList(kval).insert(offset);
+    }
+
+    Pal::gpusize LargestFreeBlockSize() const
+    {
+        Pal::gpusize size = 0;
+
+        for (uint32 kval = m_minKval; kval < m_baseAllocKval; ++kval)
+        {
+            if (m_freeBlocks[kval - m_minKval].empty() == false)
+            {
+                size = (1ull << kval);
+            }
+        }
+
+        return size;
+    }
+
+    bool IsEmpty() const { return m_liveKvals.empty(); }
+
+private:
+    std::set<Pal::gpusize>& FreeList(uint32 kval) { return m_freeBlocks[kval - m_minKval]; }
+
+    const uint32                        m_baseAllocKval;
+    const uint32                        m_minKval;
+    std::vector<std::set<Pal::gpusize>> m_freeBlocks; // Free block offsets of each size, indexed by kval - m_minKval.
+    std::map<Pal::gpusize, uint32>      m_liveKvals;  // Block size of every live allocation, by offset.
+};
+
+// =====================================================================================================================
+// Sends the same random requests and frees to a BuddyAllocator and the reference allocator, and checks that they hand
+// out the same offsets, fail the same requests and agree on the largest free block.  Frees alternate between passing
+// the original size and alignment and passing neither, which makes BuddyAllocator find the block from its split bits.
+void RunRandomOperations(
+    uint32 baseAllocKval,
+    uint32 numOperations,
+    uint64 seed)
+{
+    TestAllocator allocator;
+
+    {
+        const uint32 minKval = Log2(MinBlockSize);
+
+        BuddyAllocator<TestAllocator> buddy(&allocator, 1ull << baseAllocKval, MinBlockSize);
+        ReferenceBuddyAllocator       reference(baseAllocKval, minKval);
+
+        ASSERT_EQ(buddy.Init(), Result::Success);
+
+        struct Allocation
+        {
+            Pal::gpusize offset;
+            Pal::gpusize size;
+            Pal::gpusize alignment;
+        };
+
+        std::vector<Allocation> live;
+
+        uint32 numFailures = 0;
+
+        for (uint32 op = 0; op < numOperations; ++op)
+        {
+            const uint64 random = NextRandom(&seed);
+
+            // Free more often as more blocks are live, so the pool keeps cycling between fragmented and nearly empty.
+            const bool doFree = ((random % 256) < live.size());
+
+            if (doFree)
+            {
+                const size_t      index      = NextRandom(&seed) % live.size();
+                const Allocation& allocation = live[index];
+
+                if ((random >> 8) % 2 == 0)
+                {
+                    buddy.Free(allocation.offset, allocation.size, allocation.alignment);
+                }
+                else
+                {
+                    buddy.Free(allocation.offset);
+                }
+
+                reference.Free(allocation.offset);
+
+                live[index] = live.back();
+                live.pop_back();
+            }
+            else
+            {
+                // Mostly small requests, with the occasional large one that needs several merged blocks.
+                const uint32 maxShift   = ((random >> 8) % 8 == 0) ? (baseAllocKval - minKval - 1) : 4;
+                const uint32 sizeShift  = (random >> 12) % (maxShift + 1);
+                const uint32 alignShift = ((random >> 20) % 4 == 0) ? ((random >> 24) % (maxShift + 1)) : 0;
+
+                // Sizes which aren't a power of two are padded up to one.
+                Pal::gpusize size = (MinBlockSize << sizeShift);
+                if ((sizeShift > 0) && ((random >> 28) % 2 == 0))
+                {
+                    size -= MinBlockSize / 2;
+                }
+
+                const Pal::gpusize alignment = (MinBlockSize << alignShift);
+
+                Pal::gpusize offset          = ~0ull;
+                Pal::gpusize referenceOffset = ~0ull;
+
+                const Result result       = buddy.Allocate(size, alignment, &offset);
+                const bool   referenceHit = reference.Allocate(size, alignment, &referenceOffset);
+
+                ASSERT_EQ(result, referenceHit ? Result::Success : Result::ErrorOutOfGpuMemory)
+                    << "size " << size << " alignment " << alignment;
+
+                if (referenceHit)
+                {
+                    ASSERT_EQ(offset, referenceOffset) << "size " << size << " alignment " << alignment;
+                    live.push_back({ offset, size, alignment });
+                }
+                else
+                {
+                    ++numFailures;
+                }
+            }
+
+            ASSERT_EQ(buddy.LargestFreeBlockSize(), reference.LargestFreeBlockSize());
+            ASSERT_EQ(buddy.IsEmpty(), reference.IsEmpty());
+        }
+
+        // Some requests must have been turned away, or the sizes never stressed the allocator.
+        EXPECT_GT(numFailures, 0u);
+
+        for (const Allocation& allocation : live)
+        {
+            buddy.Free(allocation.offset);
+        }
+
+        EXPECT_TRUE(buddy.IsEmpty());
+        EXPECT_EQ(buddy.LargestFreeBlockSize(), buddy.MaximumAllocationSize());
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Fills the whole pool with the smallest blocks, then frees them all, which must merge everything back together.
+TEST(BuddyAllocatorTest, FillWithSmallestBlocks)
+{
+    TestAllocator allocator;
+
+    {
+        constexpr uint32 NumBlocks = 1024;
+
+        BuddyAllocator<TestAllocator> buddy(&allocator, NumBlocks * MinBlockSize, MinBlockSize);
+        ASSERT_EQ(buddy.Init(), Result::Success);
+
+        for (uint32 block = 0; block < NumBlocks; ++block)
+        {
+            Pal::gpusize offset = ~0ull;
+            ASSERT_EQ(buddy.Allocate(MinBlockSize, 0, &offset), Result::Success);
+            EXPECT_EQ(offset, block * MinBlockSize);
+        }
+
+        Pal::gpusize offset = 0;
+        EXPECT_EQ(buddy.Allocate(MinBlockSize, 0, &offset), Result::ErrorOutOfGpuMemory);
+        EXPECT_EQ(buddy.LargestFreeBlockSize(), 0u);
+
+        // Free every other block first, so that no buddies can merge until the second pass.
+        for (uint32 block = 0; block < NumBlocks; block += 2)
+        {
+            buddy.Free(block * MinBlockSize);
+        }
+
+        EXPECT_EQ(buddy.LargestFreeBlockSize(), MinBlockSize);
+
+        for (uint32 block = 1; block < NumBlocks; block += 2)
+        {
+            buddy.Free(block * MinBlockSize);
+        }
+
+        EXPECT_TRUE(buddy.IsEmpty());
+        EXPECT_EQ(buddy.LargestFreeBlockSize(), buddy.MaximumAllocationSize());
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+TEST(BuddyAllocatorTest, RandomOperationsSmallPool)
+{
+    RunRandomOperations(Log2(MinBlockSize) + 6, 200000, 1);
+}
+
+// =====================================================================================================================
+TEST(BuddyAllocatorTest, RandomOperationsLargePool)
+{
+    RunRandomOperations(Log2(MinBlockSize) + 16, 200000, 2);
+}
+
+// =====================================================================================================================
+// Microbenchmark of mixed-size churn on a pool the size InternalMemMgr uses.  The time per operation is reported as a
+// test property, so it shows up in the XML output of a run with --gtest_output.
+TEST(BuddyAllocatorTest, MixedSizeChurnBenchmark)
+{
+    constexpr uint32 NumOperations = 4000000;
+
+    TestAllocator allocator;
+
+    {
+        BuddyAllocator<TestAllocator> buddy(&allocator, 256 * 1024 * 1024, MinBlockSize);
+        ASSERT_EQ(buddy.Init(), Result::Success);
+
+        std::vector<Pal::gpusize> live;
+        live.reserve(4096);
+
+        uint64 seed = 3;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32 op = 0; op < NumOperations; ++op)
+        {
+            const uint64 random = NextRandom(&seed);
+
+            if ((random % 4096) < live.size())
+            {
+                const size_t index = (random >> 12) % live.size();
+                buddy.Free(live[index]);
+                live[index] = live.back();
+                live.pop_back();
+            }
+            else
+            {
+                Pal::gpusize offset = 0;
+                if (buddy.Allocate(MinBlockSize << ((random >> 12) % 8), 0, &offset) == Result::Success)
+                {
+                    live.push_back(offset);
+                }
+            }
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        for (Pal::gpusize offset : live)
+        {
+            buddy.Free(offset);
+        }
+
+        EXPECT_TRUE(buddy.IsEmpty());
+
+        const double nsPerOp = std::chrono::duration<double, std::nano>(elapsed).count() / NumOperations;
+        RecordProperty("NanosecondsPerOperation", std::to_string(nsPerOp));
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
@@ -0,0 +1,215 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palConcurrentHashMapImpl.h"
+#include "palTestAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Util;
+using namespace PalTests;
+
+namespace
+{
+
+// Values carry a checksum of their key, so readers can tell a torn or mismatched value from a valid one.
+struct TestValue
+{
+    uint64 serial;
+    uint64 check;
+};
+
+TestValue MakeValue(uint64 key, uint64 serial) { return { serial, (serial * 3) + key }; }
+bool IsValidValue(uint64 key, const TestValue& value) { return (value.check == ((value.serial * 3) + key)); }
+
+typedef ConcurrentHashMap<uint64, TestValue, TestAllocator, JenkinsHashFunc> TestMap;
+
+// Simple linear congruential generator, so every thread gets a cheap, reproducible key sequence.
+uint64 NextRandom(uint64* pState)
+{
+    *pState = (*pState * 6364136223846793005ull) + 1442695040888963407ull;
+    return (*pState >> 33);
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Checks the results of every operation on a single thread, across enough keys to make every shard grow several times.
+TEST(ConcurrentHashMapTest, SingleThreadedOperations)
+{
+    TestAllocator allocator;
+
+    {
+        TestMap map(16, &allocator);
+        ASSERT_EQ(map.Init(), Result::Success);
+
+        constexpr uint64 NumKeys = 10000;
+
+        for (uint64 key = 0; key < NumKeys; ++key)
+        {
+            ASSERT_EQ(map.Insert(key, MakeValue(key, 0)), Result::Success);
+        }
+
+        EXPECT_EQ(map.GetNumEntries(), NumKeys);
+        EXPECT_EQ(map.Insert(0, MakeValue(0, 1)), Result::AlreadyExists);
+        EXPECT_EQ(map.Replace(NumKeys, MakeValue(NumKeys, 1)), Result::NotFound);
+
+        for (uint64 key = 0; key < NumKeys; key += 2)
+        {
+            ASSERT_EQ(map.Replace(key, MakeValue(key, 1)), Result::Success);
+        }
+
+        for (uint64 key = 0; key < NumKeys; ++key)
+        {
+            TestValue value = {};
+            ASSERT_TRUE(map.Find(key, &value));
+            EXPECT_TRUE(IsValidValue(key, value));
+            EXPECT_EQ(value.serial, ((key % 2) == 0) ? 1u : 0u);
+        }
+
+        for (uint64 key = 0; key < NumKeys; key += 3)
+        {
+            ASSERT_TRUE(map.Erase(key));
+        }
+
+        EXPECT_FALSE(map.Erase(0));
+        EXPECT_FALSE(map.Contains(NumKeys));
+
+        for (uint64 key = 0; key < NumKeys; ++key)
+        {
+            EXPECT_EQ(map.Contains(key), ((key % 3) != 0));
+        }
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Runs writers and lock-free readers against the same keys.  Each writer owns a disjoint set of keys and tracks which of
+// them must be present, so every result it gets back can be checked exactly.  Readers check that every value they find
+// is one which was written for its key.  Once the map is destroyed, all retired nodes and bucket arrays must have been
+// freed.
+TEST(ConcurrentHashMapTest, ConcurrentWritersAndReaders)
+{
+    constexpr uint32 NumWriters    = 4;
+    constexpr uint32 NumReaders    = 4;
+    constexpr uint32 KeysPerWriter = 1024;
+    constexpr uint32 OpsPerWriter  = 100000;
+
+    TestAllocator allocator;
+
+    {
+        TestMap map(16, &allocator);
+        ASSERT_EQ(map.Init(), Result::Success);
+
+        std::atomic<bool>   stop(false);
+        std::atomic<uint32> numErrors(0);
+
+        std::vector<std::thread> writers;
+        for (uint32 writer = 0; writer < NumWriters; ++writer)
+        {
+            writers.emplace_back([&, writer]()
+            {
+                std::vector<bool> present(KeysPerWriter, false);
+                uint64            random = writer + 1;
+
+                for (uint32 op = 0; op < OpsPerWriter; ++op)
+                {
+                    const uint64 rand  = NextRandom(&random);
+                    const uint32 index = static_cast<uint32>(rand % KeysPerWriter);
+                    const uint64 key   = (index * NumWriters) + writer;
+
+                    bool ok = true;
+                    switch ((rand >> 16) % 4)
+                    {
+                    case 0:
+                        ok = ((map.Insert(key, MakeValue(key, op)) == Result::Success) != present[index]);
+                        present[index] = true;
+                        break;
+                    case 1:
+                        ok = (map.Erase(key) == present[index]);
+                        present[index] = false;
+                        break;
+                    case 2:
+                        ok = ((map.Replace(key, MakeValue(key, op)) == Result::Success) == present[index]);
+                        break;
+                    default:
+                    {
+                        TestValue value = {};
+                        const bool found = map.Find(key, &value);
+                        ok = (found == present[index]) && ((found == false) || IsValidValue(key, value));
+                        break;
+                    }
+                    }
+
+                    if (ok == false)
+                    {
+                        ++numErrors;
+                    }
+                }
+            });
+        }
+
+        std::vector<std::thread> readers;
+        for (uint32 reader = 0; reader < NumReaders; ++reader)
+        {
+            readers.emplace_back([&, reader]()
+            {
+                uint64 random = reader + 1000;
+
+                while (stop.load() == false)
+                {
+                    const uint64 key   = NextRandom(&random) % (KeysPerWriter * NumWriters);
+                    TestValue    value = {};
+
+                    if (map.Find(key, &value) && (IsValidValue(key, value) == false))
+                    {
+                        ++numErrors;
+                    }
+                }
+            });
+        }
+
+        for (std::thread& writer : writers)
+        {
+            writer.join();
+        }
+
+        stop = true;
+
+        for (std::thread& reader : readers)
+        {
+            reader.join();
+        }
+
+        EXPECT_EQ(numErrors.load(), 0u);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
@@ -0,0 +1,305 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palFlatHashMapImpl.h"
+#include "palFlatHashSetImpl.h"
+#include "palTestAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace Util;
+using namespace PalTests;
+
+namespace
+{
+
+// Simple linear congruential generator, so every run sees the same sequence of keys.
+uint64 NextRandom(uint64* pState)
+{
+    *pState = (*pState * 6364136223846793005ull) + 1442695040888963407ull;
+    return (*pState >> 33);
+}
+
+// Hashes every key to one of four values, so most keys share their probe sequence and hash tag.
+template<typename Key>
+struct CollidingHashFunc
+{
+    uint32 operator()(const void* pVoidKey, uint32 keyLen) const
+    {
+        return static_cast<uint32>(*static_cast<const Key*>(pVoidKey) % 4);
+    }
+
+    void Init(uint32 minNumBits) const { }
+};
+
+// =====================================================================================================================
+// Checks that iterating the map visits exactly the entries of the reference map, once each.
+template<typename Map>
+void ExpectSameContents(
+    const Map&                                map,
+    const std::unordered_map<uint64, uint64>& reference)
+{
+    ASSERT_EQ(map.GetNumEntries(), reference.size());
+
+    std::unordered_set<uint64> seen;
+
+    for (auto iter = map.Begin(); iter.Get() != nullptr; iter.Next())
+    {
+        const auto found = reference.find(iter.Get()->key);
+
+        ASSERT_NE(found, reference.end()) << iter.Get()->key;
+        EXPECT_EQ(iter.Get()->value, found->second);
+        EXPECT_TRUE(seen.insert(iter.Get()->key).second) << "key " << iter.Get()->key << " visited twice";
+    }
+
+    EXPECT_EQ(seen.size(), reference.size());
+}
+
+// =====================================================================================================================
+// Applies the same random inserts, updates and erases to a FlatHashMap and an std::unordered_map.  The key range is a
+// few times the peak number of entries, so lookups hit and miss, and the map grows through several incremental
+// migrations and cycles back down.
+template<template<typename> class HashFunc>
+void RunRandomOperations(
+    uint32 keyRange,
+    uint32 numOperations,
+    uint64 seed)
+{
+    TestAllocator allocator;
+
+    {
+        FlatHashMap<uint64, uint64, TestAllocator, HashFunc> map(16, &allocator);
+        ASSERT_EQ(map.Init(), Result::Success);
+
+        std::unordered_map<uint64, uint64> reference;
+
+        for (uint32 op = 0; op < numOperations; ++op)
+        {
+            const uint64 random = NextRandom(&seed);
+            const uint64 key    = NextRandom(&seed) % keyRange;
+
+            // Favor inserts for the first half, and erases for the second, so the map grows and shrinks again.
+            const uint32 eraseChance = (op < (numOperations / 2)) ? 3 : 6;
+
+            switch (random % 10)
+            {
+            case 0:
+            case 1:
+            {
+                const Result result = map.Insert(key, random);
+                ASSERT_EQ(result, Result::Success);
+                reference.insert({ key, random });
+                break;
+            }
+            case 2:
+            case 3:
+            {
+                bool    existed = false;
+                uint64* pValue  = nullptr;
+                ASSERT_EQ(map.FindAllocate(key, &existed, &pValue), Result::Success);
+                ASSERT_NE(pValue, nullptr);
+                EXPECT_EQ(existed, reference.count(key) != 0);
+
+                if (existed == false)
+                {
+                    EXPECT_EQ(*pValue, 0u);
+                }
+
+                *pValue        = random;
+                reference[key] = random;
+                break;
+            }
+            default:
+                if ((random % 10) < (4 + eraseChance))
+                {
+                    EXPECT_EQ(map.Erase(key), (reference.erase(key) != 0));
+                }
+                else
+                {
+                    const uint64* pValue = map.FindKey(key);
+                    const auto    found  = reference.find(key);
+
+                    if (found == reference.end())
+                    {
+                        EXPECT_EQ(pValue, nullptr) << key;
+                    }
+                    else
+                    {
+                        ASSERT_NE(pValue, nullptr) << key;
+                        EXPECT_EQ(*pValue, found->second);
+                    }
+                }
+                break;
+            }
+
+            if ((op % 4096) == 0)
+            {
+                ExpectSameContents(map, reference);
+            }
+        }
+
+        ExpectSameContents(map, reference);
+
+        for (const auto& entry : reference)
+        {
+            const uint64* pValue = map.FindKey(entry.first);
+            ASSERT_NE(pValue, nullptr);
+            EXPECT_EQ(*pValue, entry.second);
+        }
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+TEST(FlatHashMapTest, RandomOperations)
+{
+    RunRandomOperations<JenkinsHashFunc>(1 << 16, 400000, 1);
+}
+
+// =====================================================================================================================
+// With nearly every key in one probe sequence, lookups must probe past full and deleted slots correctly.
+TEST(FlatHashMapTest, RandomOperationsCollidingHashes)
+{
+    RunRandomOperations<CollidingHashFunc>(512, 100000, 2);
+}
+
+// =====================================================================================================================
+// Inserting a key which already exists must keep its original value.
+TEST(FlatHashMapTest, InsertKeepsExistingValue)
+{
+    TestAllocator allocator;
+
+    {
+        FlatHashMap<uint64, uint64, TestAllocator, JenkinsHashFunc> map(8, &allocator);
+        ASSERT_EQ(map.Init(), Result::Success);
+
+        EXPECT_EQ(map.Insert(7, 1), Result::Success);
+        EXPECT_EQ(map.Insert(7, 2), Result::Success);
+
+        ASSERT_NE(map.FindKey(7), nullptr);
+        EXPECT_EQ(*map.FindKey(7), 1u);
+        EXPECT_EQ(map.GetNumEntries(), 1u);
+
+        EXPECT_TRUE(map.Erase(7));
+        EXPECT_FALSE(map.Erase(7));
+        EXPECT_EQ(map.FindKey(7), nullptr);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Reset() must empty the map, which then works as if freshly initialized.
+TEST(FlatHashMapTest, ResetEmptiesMap)
+{
+    constexpr uint32 NumKeys = 10000;
+
+    TestAllocator allocator;
+
+    {
+        FlatHashMap<uint64, uint64, TestAllocator, JenkinsHashFunc> map(8, &allocator);
+        ASSERT_EQ(map.Init(), Result::Success);
+
+        for (uint32 round = 0; round < 3; ++round)
+        {
+            for (uint64 key = 0; key < NumKeys; ++key)
+            {
+                ASSERT_EQ(map.Insert(key, key + round), Result::Success);
+            }
+
+            EXPECT_EQ(map.GetNumEntries(), NumKeys);
+            EXPECT_GE(map.GetCapacity(), NumKeys);
+
+            for (uint64 key = 0; key < NumKeys; ++key)
+            {
+                ASSERT_NE(map.FindKey(key), nullptr);
+                EXPECT_EQ(*map.FindKey(key), key + round);
+            }
+
+            map.Reset();
+
+            EXPECT_EQ(map.GetNumEntries(), 0u);
+            EXPECT_EQ(map.Begin().Get(), nullptr);
+            EXPECT_EQ(map.FindKey(0), nullptr);
+        }
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// FlatHashSet shares its table with FlatHashMap; check its own interface against std::unordered_set.
+TEST(FlatHashSetTest, RandomOperations)
+{
+    TestAllocator allocator;
+
+    {
+        FlatHashSet<uint64, TestAllocator, JenkinsHashFunc> set(16, &allocator);
+        ASSERT_EQ(set.Init(), Result::Success);
+
+        std::unordered_set<uint64> reference;
+
+        uint64 seed = 3;
+
+        for (uint32 op = 0; op < 200000; ++op)
+        {
+            const uint64 random = NextRandom(&seed);
+            const uint64 key    = NextRandom(&seed) % 8192;
+
+            switch (random % 3)
+            {
+            case 0:
+                ASSERT_EQ(set.Insert(key), Result::Success);
+                reference.insert(key);
+                break;
+            case 1:
+                EXPECT_EQ(set.Erase(key), (reference.erase(key) != 0));
+                break;
+            default:
+                EXPECT_EQ(set.Contains(key), (reference.count(key) != 0)) << key;
+                break;
+            }
+        }
+
+        EXPECT_EQ(set.GetNumEntries(), reference.size());
+
+        uint32 numVisited = 0;
+        for (auto iter = set.Begin(); iter.Get() != nullptr; iter.Next())
+        {
+            EXPECT_EQ(reference.count(iter.Get()->key), 1u);
+            ++numVisited;
+        }
+
+        EXPECT_EQ(numVisited, reference.size());
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
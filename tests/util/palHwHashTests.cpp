@@ -0,0 +1,287 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palHwHash.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace Util;
+
+namespace
+{
+
+// Simple linear congruential generator, so every run sees the same data.
+uint64 NextRandom(uint64* pState)
+{
+    *pState = (*pState * 6364136223846793005ull) + 1442695040888963407ull;
+    return (*pState >> 33);
+}
+
+// Bit-at-a-time CRC32C, straight from the definition of the reflected Castagnoli polynomial.
+uint32 ReferenceCrc32c(
+    const uint8* pData,
+    size_t       dataSize)
+{
+    uint32 crc = ~0u;
+
+    for (size_t i = 0; i < dataSize; ++i)
+    {
+        crc ^= pData[i];
+
+        for (uint32 bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78u : 0u);
+        }
+    }
+
+    return ~crc;
+}
+
+// The bytes hashed by the Hash128 known-answer tests.
+std::vector<uint8> KnownAnswerData()
+{
+    std::vector<uint8> data(256);
+
+    for (uint32 i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<uint8>((i * 7) + 3);
+    }
+
+    return data;
+}
+
+struct Hash128Vector
+{
+    size_t dataSize;
+    uint64 seed;
+    uint64 qwords[2];
+};
+
+// Hash128 of the first dataSize bytes of KnownAnswerData().  The AES-NI and portable paths were both checked to
+// produce these values, so a machine running either one must match them.
+constexpr Hash128Vector Hash128Vectors[] =
+{
+    {   0, 0x0000000000000000ull, { 0xE7B3D70EA1E16137ull, 0x53419A9F4CB6FB9Cull } },
+    {   1, 0x0000000000000000ull, { 0x71993967729CAB86ull, 0x2104EED0613480CFull } },
+    {   3, 0x0000000000000000ull, { 0x50942FB97D50C9DEull, 0x689551D47E40018Dull } },
+    {   8, 0x0000000000000000ull, { 0xEF7BCB22B71E05CDull, 0x6411D303BDEDCD94ull } },
+    {  15, 0x0000000000000000ull, { 0xCC779A44ECB41611ull, 0x721BF8E6D1B889A0ull } },
+    {  16, 0x0000000000000000ull, { 0x3A916B18F9DF08F0ull, 0x78771E4CE40CCEC9ull } },
+    {  17, 0x0000000000000000ull, { 0x5EEE5BD35181790Bull, 0x14EE0090669C5263ull } },
+    {  31, 0x0000000000000000ull, { 0x96291C386D86F9AEull, 0xB48F9E2981BEDF3Bull } },
+    {  32, 0x0000000000000000ull, { 0xB89E3BF2F2565CF4ull, 0x0DB8E4B7641CA830ull } },
+    {  33, 0x0000000000000000ull, { 0x116E4C5214EF00F2ull, 0xEF859A4152CA7E79ull } },
+    {  64, 0x0000000000000000ull, { 0x50AA935AC5C808F6ull, 0x99261B1273E0A85Aull } },
+    { 100, 0x0000000000000000ull, { 0x2D5D846D66A56D44ull, 0x5358588C841E7033ull } },
+    { 255, 0x0000000000000000ull, { 0x1B587DA19F0E547Bull, 0xFE716B15D64485C7ull } },
+    {   0, 0x0123456789ABCDEFull, { 0x350705ADB16BACC4ull, 0xBE4B7A5674E3F13Aull } },
+    {   1, 0x0123456789ABCDEFull, { 0x9D20B15FACF7BA25ull, 0x9202ADE782B38F5Aull } },
+    {   3, 0x0123456789ABCDEFull, { 0x9FB04B035AE25D4Cull, 0x4A8BA81236766315ull } },
+    {   8, 0x0123456789ABCDEFull, { 0xEDB1D442CDE336F8ull, 0xC88CD29FAF627135ull } },
+    {  15, 0x0123456789ABCDEFull, { 0x7906C7912DAD5A0Dull, 0x1097FCE6344B0FD5ull } },
+    {  16, 0x0123456789ABCDEFull, { 0x4DEFE525B5377D2Bull, 0x4DEFAFEE04CD4F94ull } },
+    {  17, 0x0123456789ABCDEFull, { 0xBDD64C82734608E2ull, 0x6A9491C404D551C3ull } },
+    {  31, 0x0123456789ABCDEFull, { 0x0C8FC8B66A3C852Bull, 0xA9427510CB6BACDBull } },
+    {  32, 0x0123456789ABCDEFull, { 0x0D551FEC2441A866ull, 0x1AFDE5708A7F4D78ull } },
+    {  33, 0x0123456789ABCDEFull, { 0x11D943ECE48FC0DEull, 0x18D6CFC1300F95FDull } },
+    {  64, 0x0123456789ABCDEFull, { 0xB0EAEA3FFAD075D1ull, 0xC6FD48BD45FC6EEAull } },
+    { 100, 0x0123456789ABCDEFull, { 0xCBFDE79EB70F5CABull, 0x47D4FB2E53B6126Cull } },
+    { 255, 0x0123456789ABCDEFull, { 0x77029BBBC61D6FB6ull, 0xDAB73ED03D2AA2E6ull } },
+};
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Check vectors from RFC 3720 (iSCSI) and the standard "123456789" check value.
+TEST(HwHashTest, Crc32cKnownAnswers)
+{
+    const char check[] = "123456789";
+    EXPECT_EQ(HwHash::Crc32c(check, 9), 0xE3069283u);
+
+    uint8 data[32] = {};
+    EXPECT_EQ(HwHash::Crc32c(data, sizeof(data)), 0x8A9136AAu);
+
+    memset(data, 0xFF, sizeof(data));
+    EXPECT_EQ(HwHash::Crc32c(data, sizeof(data)), 0x62A8AB43u);
+
+    for (uint32 i = 0; i < 32; ++i)
+    {
+        data[i] = static_cast<uint8>(i);
+    }
+    EXPECT_EQ(HwHash::Crc32c(data, sizeof(data)), 0x46DD794Eu);
+
+    for (uint32 i = 0; i < 32; ++i)
+    {
+        data[i] = static_cast<uint8>(31 - i);
+    }
+    EXPECT_EQ(HwHash::Crc32c(data, sizeof(data)), 0x113FDB5Cu);
+
+    EXPECT_EQ(HwHash::Crc32c(nullptr, 0), 0u);
+}
+
+// =====================================================================================================================
+// Every length and starting alignment must match the bitwise reference, which covers the head, body and tail loops of
+// whichever implementation this CPU runs.
+TEST(HwHashTest, Crc32cMatchesReference)
+{
+    std::vector<uint8> data(1024 + 16);
+
+    uint64 seed = 1;
+    for (uint8& byte : data)
+    {
+        byte = static_cast<uint8>(NextRandom(&seed));
+    }
+
+    for (size_t offset = 0; offset < 16; ++offset)
+    {
+        for (size_t size = 0; size <= 1024; size += ((size < 80) ? 1 : 37))
+        {
+            ASSERT_EQ(HwHash::Crc32c(&data[offset], size), ReferenceCrc32c(&data[offset], size))
+                << "offset " << offset << " size " << size;
+        }
+    }
+}
+
+// =====================================================================================================================
+// Checksumming a buffer in two pieces must give the same result as checksumming it at once.
+TEST(HwHashTest, Crc32cIncremental)
+{
+    std::vector<uint8> data(300);
+
+    uint64 seed = 2;
+    for (uint8& byte : data)
+    {
+        byte = static_cast<uint8>(NextRandom(&seed));
+    }
+
+    const uint32 whole = HwHash::Crc32c(data.data(), data.size());
+
+    for (size_t split = 0; split <= data.size(); ++split)
+    {
+        const uint32 first = HwHash::Crc32c(data.data(), split);
+        EXPECT_EQ(HwHash::Crc32c(&data[split], data.size() - split, first), whole) << split;
+    }
+}
+
+// =====================================================================================================================
+// Crc32cMulti interleaves buffers of different sizes three at a time; each result must match a single Crc32c.
+TEST(HwHashTest, Crc32cMultiMatchesSingle)
+{
+    constexpr uint32 MaxBuffers = 8;
+
+    std::vector<uint8> data(4096);
+
+    uint64 seed = 3;
+    for (uint8& byte : data)
+    {
+        byte = static_cast<uint8>(NextRandom(&seed));
+    }
+
+    for (uint32 trial = 0; trial < 200; ++trial)
+    {
+        const uint32 count = 1 + (NextRandom(&seed) % MaxBuffers);
+
+        const void* ppData[MaxBuffers] = {};
+        size_t      sizes[MaxBuffers]  = {};
+        uint32      crcs[MaxBuffers]   = {};
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            sizes[i]  = NextRandom(&seed) % 600;
+            ppData[i] = &data[NextRandom(&seed) % (data.size() - sizes[i])];
+        }
+
+        HwHash::Crc32cMulti(count, ppData, sizes, crcs);
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            EXPECT_EQ(crcs[i], HwHash::Crc32c(ppData[i], sizes[i])) << "trial " << trial << " buffer " << i;
+        }
+    }
+}
+
+// =====================================================================================================================
+TEST(HwHashTest, Hash128KnownAnswers)
+{
+    const std::vector<uint8> data = KnownAnswerData();
+
+    for (const Hash128Vector& vector : Hash128Vectors)
+    {
+        HwHash::Hash hash = {};
+        HwHash::Hash128(data.data(), vector.dataSize, vector.seed, &hash);
+
+        EXPECT_EQ(hash.qwords[0], vector.qwords[0]) << "size " << vector.dataSize << " seed " << vector.seed;
+        EXPECT_EQ(hash.qwords[1], vector.qwords[1]) << "size " << vector.dataSize << " seed " << vector.seed;
+        EXPECT_EQ(HwHash::Hash64(data.data(), vector.dataSize, vector.seed), vector.qwords[0] ^ vector.qwords[1]);
+    }
+}
+
+// =====================================================================================================================
+// The hash must depend on every byte, the length and the seed, but not on where the data lives in memory.
+TEST(HwHashTest, Hash128Sensitivity)
+{
+    constexpr size_t MaxSize = 96;
+
+    std::vector<uint8> data(MaxSize + 16);
+
+    uint64 seed = 4;
+    for (uint8& byte : data)
+    {
+        byte = static_cast<uint8>(NextRandom(&seed));
+    }
+
+    std::vector<uint8> copy(MaxSize + 16);
+
+    for (size_t size = 1; size <= MaxSize; ++size)
+    {
+        HwHash::Hash hash = {};
+        HwHash::Hash128(data.data(), size, 0, &hash);
+
+        // Same bytes at a different alignment.
+        memcpy(&copy[size % 16], data.data(), size);
+
+        HwHash::Hash moved = {};
+        HwHash::Hash128(&copy[size % 16], size, 0, &moved);
+        EXPECT_EQ(memcmp(&hash, &moved, sizeof(hash)), 0) << size;
+
+        HwHash::Hash other = {};
+        HwHash::Hash128(data.data(), size, 1, &other);
+        EXPECT_NE(memcmp(&hash, &other, sizeof(hash)), 0) << size;
+
+        HwHash::Hash128(data.data(), size - 1, 0, &other);
+        EXPECT_NE(memcmp(&hash, &other, sizeof(hash)), 0) << size;
+
+        for (size_t byte = 0; byte < size; ++byte)
+        {
+            data[byte] ^= 0x01;
+            HwHash::Hash128(data.data(), size, 0, &other);
+            data[byte] ^= 0x01;
+
+            EXPECT_NE(memcmp(&hash, &other, sizeof(hash)), 0) << "size " << size << " byte " << byte;
+        }
+    }
+}
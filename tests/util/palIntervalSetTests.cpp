@@ -0,0 +1,292 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palIntervalSetImpl.h"
+#include "palTestAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace Util;
+using namespace PalTests;
+
+namespace
+{
+
+// Simple linear congruential generator, so every run sees the same sequence of operations.
+uint64 NextRandom(uint64* pState)
+{
+    *pState = (*pState * 6364136223846793005ull) + 1442695040888963407ull;
+    return (*pState >> 33);
+}
+
+// Number of values the random tests draw interval bounds from.  Small enough to track every value in a bitmap.
+constexpr uint32 DomainSize = 2048;
+
+using TestIntervalSet = IntervalSet<uint32, TestAllocator>;
+using TestInterval    = Interval<uint32, uint32>;
+
+// =====================================================================================================================
+// Returns a random interval in the domain which is usually short, so that the set keeps plenty of separate ranges.
+TestInterval RandomInterval(
+    uint64* pSeed)
+{
+    const uint64 random = NextRandom(pSeed);
+    const uint32 low    = static_cast<uint32>(random % DomainSize);
+    const uint32 length = (((random >> 12) % 16) == 0) ? static_cast<uint32>((random >> 16) % 256)
+                                                        : static_cast<uint32>((random >> 16) % 4);
+
+    return { low, Min(low + length, DomainSize - 1), 0 };
+}
+
+// =====================================================================================================================
+// Checks that the set holds exactly the maximal runs of covered values in the reference bitmap, in increasing order.
+void ExpectMatchesReference(
+    const TestIntervalSet&   set,
+    const std::vector<bool>& covered)
+{
+    uint32 rangeIdx = 0;
+    uint32 value    = 0;
+
+    while (value < DomainSize)
+    {
+        if (covered[value])
+        {
+            const uint32 low = value;
+
+            while ((value < DomainSize) && covered[value])
+            {
+                ++value;
+            }
+
+            ASSERT_LT(rangeIdx, set.GetCount());
+            EXPECT_EQ(set.GetRange(rangeIdx).low, low);
+            EXPECT_EQ(set.GetRange(rangeIdx).high, value - 1);
+            ++rangeIdx;
+        }
+        else
+        {
+            ++value;
+        }
+    }
+
+    EXPECT_EQ(rangeIdx, set.GetCount());
+}
+
+// =====================================================================================================================
+// Inserts random intervals, singly and in batches, into an IntervalSet and a bitmap of covered values, and checks the
+// two agree on the merged ranges and on random overlap queries.
+void RunRandomOperations(
+    uint64 seed,
+    bool   sortedBatches)
+{
+    TestAllocator allocator;
+
+    {
+        TestIntervalSet   set(&allocator);
+        std::vector<bool> covered(DomainSize, false);
+
+        for (uint32 round = 0; round < 20; ++round)
+        {
+            const uint32 numInserts = 1 + static_cast<uint32>(NextRandom(&seed) % 200);
+
+            for (uint32 i = 0; i < numInserts; ++i)
+            {
+                std::vector<TestInterval> batch(1 + (NextRandom(&seed) % 8));
+
+                for (TestInterval& interval : batch)
+                {
+                    interval = RandomInterval(&seed);
+
+                    for (uint32 value = interval.low; value <= interval.high; ++value)
+                    {
+                        covered[value] = true;
+                    }
+                }
+
+                if (sortedBatches)
+                {
+                    std::sort(batch.begin(), batch.end(),
+                              [](const TestInterval& lhs, const TestInterval& rhs) { return lhs.low < rhs.low; });
+                }
+
+                if (batch.size() == 1)
+                {
+                    ASSERT_EQ(set.Insert(&batch[0]), Result::Success);
+                }
+                else
+                {
+                    ASSERT_EQ(set.Insert(batch.data(), static_cast<uint32>(batch.size())), Result::Success);
+                }
+
+                for (uint32 query = 0; query < 16; ++query)
+                {
+                    const TestInterval interval = RandomInterval(&seed);
+
+                    bool expected = false;
+                    for (uint32 value = interval.low; (expected == false) && (value <= interval.high); ++value)
+                    {
+                        expected = covered[value];
+                    }
+
+                    ASSERT_EQ(set.Overlap(&interval), expected) << interval.low << ", " << interval.high;
+                }
+            }
+
+            ExpectMatchesReference(set, covered);
+
+            if ((round % 5) == 4)
+            {
+                set.Clear();
+                covered.assign(DomainSize, false);
+                EXPECT_EQ(set.GetCount(), 0u);
+            }
+        }
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+TEST(IntervalSetTest, RandomOperations)
+{
+    RunRandomOperations(1, false);
+    RunRandomOperations(2, false);
+}
+
+// =====================================================================================================================
+// Sorted batches take the single-pass merge rather than one insert per interval.
+TEST(IntervalSetTest, RandomSortedBatches)
+{
+    RunRandomOperations(3, true);
+    RunRandomOperations(4, true);
+}
+
+// =====================================================================================================================
+// Adjacent intervals must merge, but an interval which only touches a range doesn't overlap it.
+TEST(IntervalSetTest, AdjacentIntervals)
+{
+    TestAllocator allocator;
+
+    {
+        TestIntervalSet set(&allocator);
+
+        // Consecutive query slots, the common case, must collapse into one range.
+        for (uint32 slot = 0; slot < 100; ++slot)
+        {
+            ASSERT_EQ(set.Insert(10 + (slot * 8), 17 + (slot * 8)), Result::Success);
+        }
+
+        ASSERT_EQ(set.GetCount(), 1u);
+        EXPECT_EQ(set.GetRange(0).low, 10u);
+        EXPECT_EQ(set.GetRange(0).high, 809u);
+
+        EXPECT_FALSE(set.Overlap(0, 9));
+        EXPECT_TRUE(set.Overlap(0, 10));
+        EXPECT_TRUE(set.Overlap(809, 900));
+        EXPECT_FALSE(set.Overlap(810, 900));
+
+        // Fill the gap between two ranges exactly, so all three merge.
+        ASSERT_EQ(set.Insert(900, 999), Result::Success);
+        ASSERT_EQ(set.Insert(810, 899), Result::Success);
+
+        ASSERT_EQ(set.GetCount(), 1u);
+        EXPECT_EQ(set.GetRange(0).high, 999u);
+
+        // Ranges which are one value apart stay separate.
+        ASSERT_EQ(set.Insert(1001, 1001), Result::Success);
+        EXPECT_EQ(set.GetCount(), 2u);
+        EXPECT_FALSE(set.Overlap(1000, 1000));
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Grows the set well past the linear search limit so both the linear and binary search paths are used, inserting in
+// decreasing order so every insert lands in front of the existing ranges.
+TEST(IntervalSetTest, ManyRangesInReverseOrder)
+{
+    TestAllocator allocator;
+
+    {
+        TestIntervalSet set(&allocator);
+
+        for (uint32 i = 1000; i > 0; --i)
+        {
+            ASSERT_EQ(set.Insert(i * 4, (i * 4) + 1), Result::Success);
+            ASSERT_EQ(set.GetCount(), 1001u - i);
+        }
+
+        for (uint32 i = 1; i <= 1000; ++i)
+        {
+            EXPECT_EQ(set.GetRange(i - 1).low, i * 4);
+            EXPECT_TRUE(set.Overlap((i * 4) + 1, (i * 4) + 3));
+            EXPECT_FALSE(set.Overlap((i * 4) + 2, (i * 4) + 3));
+        }
+
+        // One interval spanning everything merges all of the ranges.
+        ASSERT_EQ(set.Insert(0, 5000), Result::Success);
+        ASSERT_EQ(set.GetCount(), 1u);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Bounds at the ends of the value range mustn't wrap around when checking whether ranges touch.
+TEST(IntervalSetTest, ExtremeBounds)
+{
+    constexpr gpusize MaxValue = std::numeric_limits<gpusize>::max();
+
+    TestAllocator allocator;
+
+    {
+        IntervalSet<gpusize, TestAllocator> set(&allocator);
+
+        ASSERT_EQ(set.Insert(MaxValue - 1, MaxValue), Result::Success);
+        ASSERT_EQ(set.Insert(0, 0), Result::Success);
+        ASSERT_EQ(set.Insert(2, 3), Result::Success);
+
+        ASSERT_EQ(set.GetCount(), 3u);
+        EXPECT_TRUE(set.Overlap(MaxValue, MaxValue));
+        EXPECT_FALSE(set.Overlap(1, 1));
+        EXPECT_FALSE(set.Overlap(4, MaxValue - 2));
+
+        ASSERT_EQ(set.Insert(1, 1), Result::Success);
+        ASSERT_EQ(set.Insert(4, MaxValue - 2), Result::Success);
+
+        ASSERT_EQ(set.GetCount(), 1u);
+        EXPECT_EQ(set.GetRange(0).low, 0u);
+        EXPECT_EQ(set.GetRange(0).high, MaxValue);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
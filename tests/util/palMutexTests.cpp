@@ -0,0 +1,240 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palConditionVariable.h"
+#include "palMutex.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Util;
+
+namespace
+{
+
+constexpr uint32 NumThreads = 8;
+
+// =====================================================================================================================
+// Runs the given function on NumThreads threads at once and waits for all of them.
+template <typename Func>
+void RunOnThreads(
+    Func func)
+{
+    std::vector<std::thread> threads;
+
+    for (uint32 i = 0; i < NumThreads; ++i)
+    {
+        threads.emplace_back(func, i);
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+TEST(MutexTest, TryLock)
+{
+    Mutex mutex;
+
+    EXPECT_TRUE(mutex.TryLock());
+    EXPECT_FALSE(mutex.TryLock());
+    mutex.Unlock();
+
+    EXPECT_TRUE(mutex.TryLock());
+    mutex.Unlock();
+}
+
+// =====================================================================================================================
+// Threads hammer a plain counter under the mutex, holding it long enough that the contended (spinning and sleeping)
+// paths are taken.  Any lost update means two threads were in the critical section at once.
+TEST(MutexTest, MutualExclusion)
+{
+    constexpr uint32 IterationsPerThread = 50000;
+
+    Mutex  mutex;
+    uint32 counter = 0;
+
+    RunOnThreads([&](uint32 thread)
+    {
+        for (uint32 i = 0; i < IterationsPerThread; ++i)
+        {
+            if (((i + thread) % 2) == 0)
+            {
+                MutexAuto lock(&mutex);
+                counter++;
+            }
+            else
+            {
+                while (mutex.TryLock() == false)
+                {
+                    std::this_thread::yield();
+                }
+
+                counter++;
+                mutex.Unlock();
+            }
+        }
+    });
+
+    EXPECT_EQ(counter, NumThreads * IterationsPerThread);
+
+#if (PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 692) && PAL_DEVELOPER_BUILD
+    EXPECT_EQ(mutex.GetContentionStats().acquireCount, static_cast<uint64>(NumThreads) * IterationsPerThread);
+#endif
+}
+
+// =====================================================================================================================
+TEST(RWLockTest, TryLock)
+{
+    RWLock lock;
+
+    EXPECT_TRUE(lock.TryLockForRead());
+    EXPECT_TRUE(lock.TryLockForRead());
+    EXPECT_FALSE(lock.TryLockForWrite());
+    lock.UnlockForRead();
+    lock.UnlockForRead();
+
+    EXPECT_TRUE(lock.TryLockForWrite());
+    EXPECT_FALSE(lock.TryLockForRead());
+    EXPECT_FALSE(lock.TryLockForWrite());
+    lock.UnlockForWrite();
+
+    EXPECT_TRUE(lock.TryLockForRead());
+    lock.UnlockForRead();
+}
+
+// =====================================================================================================================
+// Writers keep two fields in a fixed relationship which is only broken inside the write lock, while readers check the
+// relationship under the read lock.  A reader overlapping a writer, or two writers overlapping, shows up as a broken
+// relationship or a lost update.
+TEST(RWLockTest, ReadersAndWriters)
+{
+    constexpr uint32 IterationsPerThread = 50000;
+
+    RWLock              lock;
+    uint64              first  = 0;
+    uint64              second = 0;
+    std::atomic<uint32> numErrors(0);
+    std::atomic<uint32> numWrites(0);
+
+    RunOnThreads([&](uint32 thread)
+    {
+        for (uint32 i = 0; i < IterationsPerThread; ++i)
+        {
+            // One operation in eight is a write.
+            if (((i + thread) % 8) == 0)
+            {
+                RWLockAuto<RWLock::ReadWrite> writeLock(&lock);
+
+                first++;
+                second = first * 2;
+                numWrites++;
+            }
+            else
+            {
+                RWLockAuto<RWLock::ReadOnly> readLock(&lock);
+
+                if (second != (first * 2))
+                {
+                    numErrors++;
+                }
+            }
+        }
+    });
+
+    EXPECT_EQ(numErrors.load(), 0u);
+    EXPECT_EQ(first, numWrites.load());
+    EXPECT_EQ(second, first * 2);
+}
+
+// =====================================================================================================================
+TEST(ConditionVariableTest, WaitTimesOut)
+{
+    Mutex             mutex;
+    ConditionVariable condVar;
+
+    // Waking with nobody waiting must be harmless.
+    condVar.WakeOne();
+    condVar.WakeAll();
+
+    MutexAuto lock(&mutex);
+    EXPECT_FALSE(condVar.Wait(&mutex, 10));
+}
+
+// =====================================================================================================================
+// Producers hand items to consumers through a counter guarded by the mutex, each side waiting on its own condition
+// variable.  Every item must be consumed exactly once.  A lost wakeup leaves a thread asleep, which hangs the test.
+TEST(ConditionVariableTest, ProducersAndConsumers)
+{
+    constexpr uint32 ItemsPerProducer = 20000;
+    constexpr uint32 MaxPending       = 4;
+    constexpr uint32 Infinite         = 0xFFFFFFFF;
+
+    Mutex             mutex;
+    ConditionVariable notEmpty;
+    ConditionVariable notFull;
+    uint32            numPending  = 0;
+    uint32            numConsumed = 0;
+
+    RunOnThreads([&](uint32 thread)
+    {
+        MutexAuto lock(&mutex);
+
+        for (uint32 i = 0; i < ItemsPerProducer; ++i)
+        {
+            if ((thread % 2) == 0)
+            {
+                while (numPending == MaxPending)
+                {
+                    notFull.Wait(&mutex, Infinite);
+                }
+
+                numPending++;
+                notEmpty.WakeOne();
+            }
+            else
+            {
+                while (numPending == 0)
+                {
+                    notEmpty.Wait(&mutex, Infinite);
+                }
+
+                numPending--;
+                numConsumed++;
+                notFull.WakeOne();
+            }
+        }
+    });
+
+    EXPECT_EQ(numPending, 0u);
+    EXPECT_EQ(numConsumed, (NumThreads / 2) * ItemsPerProducer);
+}
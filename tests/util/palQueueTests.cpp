@@ -0,0 +1,325 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palEventCount.h"
+#include "palMpmcQueueImpl.h"
+#include "palSpscQueueImpl.h"
+#include "palTestAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Util;
+using namespace PalTests;
+
+namespace
+{
+
+// Values sent through the queues identify their producer and their position in that producer's sequence.
+constexpr uint64 StopValue = ~0ull;
+
+uint64 MakeItem(uint32 producer, uint32 serial) { return (static_cast<uint64>(producer) << 32) | serial; }
+uint32 ItemProducer(uint64 item) { return static_cast<uint32>(item >> 32); }
+uint32 ItemSerial(uint64 item) { return static_cast<uint32>(item); }
+
+// =====================================================================================================================
+// Runs numProducers producers which each push itemsPerProducer items through the queue and numConsumers consumers which
+// pop them.  Checks that every item arrives exactly once and that each consumer sees every producer's items in order.
+// In blocking mode, each consumer stops when it pops a StopValue; otherwise consumers poll until all items arrived.
+template <typename Queue>
+void RunProducersAndConsumers(
+    Queue* pQueue,
+    uint32 numProducers,
+    uint32 numConsumers,
+    uint32 itemsPerProducer,
+    bool   blocking)
+{
+    std::atomic<uint64> numReceived(0);
+    std::atomic<uint64> serialSum(0);
+    std::atomic<uint32> numErrors(0);
+
+    std::vector<std::thread> threads;
+
+    for (uint32 producer = 0; producer < numProducers; ++producer)
+    {
+        threads.emplace_back([=, &numErrors]()
+        {
+            for (uint32 serial = 0; serial < itemsPerProducer; ++serial)
+            {
+                const uint64 item = MakeItem(producer, serial);
+
+                if (blocking)
+                {
+                    if (pQueue->Enqueue(item, EventCount::Infinite) != Result::Success)
+                    {
+                        ++numErrors;
+                    }
+                }
+                else
+                {
+                    while (pQueue->TryEnqueue(item) == false)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        });
+    }
+
+    const uint64 numItems = static_cast<uint64>(numProducers) * itemsPerProducer;
+
+    for (uint32 consumer = 0; consumer < numConsumers; ++consumer)
+    {
+        threads.emplace_back([=, &numReceived, &serialSum, &numErrors]()
+        {
+            std::vector<int64> lastSerial(numProducers, -1);
+            uint64             sum = 0;
+
+            while (true)
+            {
+                uint64 item = 0;
+
+                if (blocking)
+                {
+                    if (pQueue->Dequeue(&item, EventCount::Infinite) != Result::Success)
+                    {
+                        ++numErrors;
+                        break;
+                    }
+
+                    if (item == StopValue)
+                    {
+                        break;
+                    }
+                }
+                else if (pQueue->TryDequeue(&item) == false)
+                {
+                    if (numReceived.load() == numItems)
+                    {
+                        break;
+                    }
+
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                const uint32 producer = ItemProducer(item);
+
+                if ((producer >= numProducers) || (static_cast<int64>(ItemSerial(item)) <= lastSerial[producer]))
+                {
+                    ++numErrors;
+                }
+                else
+                {
+                    lastSerial[producer] = ItemSerial(item);
+                }
+
+                sum += ItemSerial(item);
+                ++numReceived;
+            }
+
+            serialSum += sum;
+        });
+    }
+
+    for (uint32 producer = 0; producer < numProducers; ++producer)
+    {
+        threads[producer].join();
+    }
+
+    if (blocking)
+    {
+        for (uint32 consumer = 0; consumer < numConsumers; ++consumer)
+        {
+            EXPECT_EQ(pQueue->Enqueue(StopValue, EventCount::Infinite), Result::Success);
+        }
+    }
+
+    for (uint32 consumer = 0; consumer < numConsumers; ++consumer)
+    {
+        threads[numProducers + consumer].join();
+    }
+
+    const uint64 expectedSum = numProducers * ((static_cast<uint64>(itemsPerProducer) * (itemsPerProducer - 1)) / 2);
+
+    EXPECT_EQ(numErrors.load(), 0u);
+    EXPECT_EQ(numReceived.load(), numItems);
+    EXPECT_EQ(serialSum.load(), expectedSum);
+}
+
+// =====================================================================================================================
+// Checks the capacity, ordering and non-blocking results of a queue on a single thread.
+template <typename Queue>
+void CheckSingleThreadedSemantics(
+    Queue* pQueue)
+{
+    const uint32 capacity = pQueue->Capacity();
+    uint64       value    = 0;
+
+    EXPECT_FALSE(pQueue->TryDequeue(&value));
+    EXPECT_EQ(pQueue->Dequeue(&value, 0), Result::NotReady);
+    EXPECT_EQ(pQueue->Dequeue(&value, 10), Result::Timeout);
+
+    for (uint32 i = 0; i < capacity; ++i)
+    {
+        EXPECT_EQ(pQueue->Enqueue(i, 0), Result::Success);
+    }
+
+    EXPECT_FALSE(pQueue->TryEnqueue(capacity));
+    EXPECT_EQ(pQueue->Enqueue(capacity, 0), Result::NotReady);
+    EXPECT_EQ(pQueue->Enqueue(capacity, 10), Result::Timeout);
+
+    for (uint32 i = 0; i < capacity; ++i)
+    {
+        EXPECT_TRUE(pQueue->TryDequeue(&value));
+        EXPECT_EQ(value, i);
+    }
+
+    EXPECT_FALSE(pQueue->TryDequeue(&value));
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+TEST(MpmcQueueTest, SingleThreadedSemantics)
+{
+    TestAllocator allocator;
+
+    {
+        MpmcQueue<uint64, TestAllocator> queue(5, true, &allocator);
+        ASSERT_EQ(queue.Init(), Result::Success);
+        EXPECT_EQ(queue.Capacity(), 8u);
+
+        CheckSingleThreadedSemantics(&queue);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+TEST(MpmcQueueTest, PollingProducersAndConsumers)
+{
+    TestAllocator                    allocator;
+    MpmcQueue<uint64, TestAllocator> queue(64, false, &allocator);
+    ASSERT_EQ(queue.Init(), Result::Success);
+
+    RunProducersAndConsumers(&queue, 4, 4, 50000, false);
+}
+
+// =====================================================================================================================
+// A small queue keeps both sides going to sleep on their EventCounts, which exercises the wakeup paths.
+TEST(MpmcQueueTest, BlockingProducersAndConsumers)
+{
+    TestAllocator                    allocator;
+    MpmcQueue<uint64, TestAllocator> queue(4, true, &allocator);
+    ASSERT_EQ(queue.Init(), Result::Success);
+
+    RunProducersAndConsumers(&queue, 4, 4, 50000, true);
+}
+
+// =====================================================================================================================
+TEST(SpscQueueTest, SingleThreadedSemantics)
+{
+    TestAllocator allocator;
+
+    {
+        SpscQueue<uint64, TestAllocator> queue(3, true, &allocator);
+        ASSERT_EQ(queue.Init(), Result::Success);
+        EXPECT_EQ(queue.Capacity(), 4u);
+
+        CheckSingleThreadedSemantics(&queue);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+TEST(SpscQueueTest, PollingProducerAndConsumer)
+{
+    TestAllocator                    allocator;
+    SpscQueue<uint64, TestAllocator> queue(64, false, &allocator);
+    ASSERT_EQ(queue.Init(), Result::Success);
+
+    RunProducersAndConsumers(&queue, 1, 1, 200000, false);
+}
+
+// =====================================================================================================================
+TEST(SpscQueueTest, BlockingProducerAndConsumer)
+{
+    TestAllocator                    allocator;
+    SpscQueue<uint64, TestAllocator> queue(2, true, &allocator);
+    ASSERT_EQ(queue.Init(), Result::Success);
+
+    RunProducersAndConsumers(&queue, 1, 1, 200000, true);
+}
+
+// =====================================================================================================================
+// Two threads hand a token back and forth, each sleeping on an EventCount until it's their turn.  A lost wakeup would
+// leave a thread asleep until its (generous) deadline passes, which counts as a failure.
+TEST(EventCountTest, NoLostWakeups)
+{
+    constexpr uint32 NumRounds = 20000;
+    constexpr uint32 WaitMs    = 10000;
+
+    EventCount          eventCount;
+    std::atomic<uint32> turn(0);
+    std::atomic<uint32> numTimeouts(0);
+
+    auto player = [&](uint32 parity)
+    {
+        for (uint32 round = parity; round < NumRounds; round += 2)
+        {
+            const int64 deadline = EventCount::ComputeDeadline(WaitMs);
+
+            eventCount.BeginWait();
+
+            while (turn.load() != round)
+            {
+                const uint32 key = eventCount.PrepareWait();
+
+                if ((turn.load() != round) && (eventCount.Wait(key, deadline) == Result::Timeout))
+                {
+                    ++numTimeouts;
+                    break;
+                }
+            }
+
+            eventCount.EndWait();
+
+            turn = round + 1;
+            eventCount.Notify(true);
+        }
+    };
+
+    std::thread other(player, 1u);
+    player(0u);
+    other.join();
+
+    EXPECT_EQ(numTimeouts.load(), 0u);
+    EXPECT_EQ(turn.load(), NumRounds);
+}
@@ -0,0 +1,72 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "palSysMemory.h"
+
+#include <atomic>
+
+namespace PalTests
+{
+
+// =====================================================================================================================
+// Allocator for the utility tests which counts its live allocations, so that tests can check that a container returns
+// all of its memory when it's destroyed.
+class TestAllocator
+{
+public:
+    TestAllocator() : m_numLiveAllocs(0) { }
+
+    void* Alloc(const Util::AllocInfo& allocInfo)
+    {
+        void* pMemory = m_allocator.Alloc(allocInfo);
+
+        if (pMemory != nullptr)
+        {
+            ++m_numLiveAllocs;
+        }
+
+        return pMemory;
+    }
+
+    void Free(const Util::FreeInfo& freeInfo)
+    {
+        if (freeInfo.pClientMem != nullptr)
+        {
+            --m_numLiveAllocs;
+        }
+
+        m_allocator.Free(freeInfo);
+    }
+
+    int NumLiveAllocs() const { return m_numLiveAllocs.load(); }
+
+private:
+    Util::GenericAllocator m_allocator;
+    std::atomic<int>       m_numLiveAllocs;
+};
+
+} // PalTests
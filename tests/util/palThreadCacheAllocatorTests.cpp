@@ -0,0 +1,386 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palInlineFuncs.h"
+#include "palTestAllocator.h"
+#include "palThreadCacheAllocatorImpl.h"
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Util;
+using namespace PalTests;
+
+namespace
+{
+
+typedef ThreadCacheAllocator<TestAllocator> CacheAllocator;
+
+// Simple linear congruential generator, so every run sees the same sequence of requests.
+uint64 NextRandom(uint64* pState)
+{
+    *pState = (*pState * 6364136223846793005ull) + 1442695040888963407ull;
+    return (*pState >> 33);
+}
+
+void* Alloc(CacheAllocator* pAllocator, size_t bytes, size_t alignment, SystemAllocType type, bool zeroMem)
+{
+#if PAL_MEMTRACK
+    return pAllocator->Alloc(AllocInfo(bytes, alignment, zeroMem, type, MemBlkType::Malloc, __FILE__, __LINE__));
+#else
+    return pAllocator->Alloc(AllocInfo(bytes, alignment, zeroMem, type));
+#endif
+}
+
+void Free(CacheAllocator* pAllocator, void* pMem)
+{
+#if PAL_MEMTRACK
+    pAllocator->Free(FreeInfo(pMem, MemBlkType::Malloc));
+#else
+    pAllocator->Free(FreeInfo(pMem));
+#endif
+}
+
+ThreadCacheStats GetStats(const CacheAllocator& allocator)
+{
+    ThreadCacheStats stats = {};
+    allocator.GetStats(&stats);
+    return stats;
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// A small block freed on a thread must be handed out again by the next allocation of its type and size class.
+TEST(ThreadCacheAllocatorTest, ReusesFreedBlocks)
+{
+    TestAllocator allocator;
+
+    {
+        CacheAllocator cache(&allocator);
+
+        void*const pFirst = Alloc(&cache, 100, PAL_DEFAULT_MEM_ALIGN, AllocInternal, false);
+        ASSERT_NE(pFirst, nullptr);
+        EXPECT_TRUE(IsPow2Aligned(reinterpret_cast<uint64>(pFirst), PAL_DEFAULT_MEM_ALIGN));
+        Free(&cache, pFirst);
+
+        // Same size class (65 to 128 bytes), same type.
+        void*const pSecond = Alloc(&cache, 128, PAL_DEFAULT_MEM_ALIGN, AllocInternal, false);
+        EXPECT_EQ(pSecond, pFirst);
+
+        // A different type or size class can't use the cached block.
+        void*const pOtherType  = Alloc(&cache, 100, PAL_DEFAULT_MEM_ALIGN, AllocInternalTemp, false);
+        void*const pOtherClass = Alloc(&cache, 200, PAL_DEFAULT_MEM_ALIGN, AllocInternal, false);
+        EXPECT_NE(pOtherType, pFirst);
+        EXPECT_NE(pOtherClass, pFirst);
+
+        ThreadCacheStats stats = GetStats(cache);
+        EXPECT_EQ(stats.numAllocs, 4u);
+        EXPECT_EQ(stats.numFrees, 1u);
+        EXPECT_EQ(stats.numClientAllocs, 3u);
+        EXPECT_EQ(stats.numClientFrees, 0u);
+        EXPECT_EQ(stats.cachedBytes, 0u);
+
+        Free(&cache, pSecond);
+        Free(&cache, pOtherType);
+        Free(&cache, pOtherClass);
+
+        stats = GetStats(cache);
+        EXPECT_EQ(stats.numClientFrees, 0u);
+        EXPECT_EQ(stats.cachedBytes, 128u + 128u + 256u);
+        EXPECT_EQ(allocator.NumLiveAllocs(), 3);
+    }
+
+    // Destroying the allocator must return the cached blocks.
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// A reused block must be cleared when the allocation asks for zeroed memory.
+TEST(ThreadCacheAllocatorTest, ZeroesReusedBlocks)
+{
+    TestAllocator allocator;
+
+    {
+        CacheAllocator cache(&allocator);
+
+        uint8*const pFirst = static_cast<uint8*>(Alloc(&cache, 64, PAL_DEFAULT_MEM_ALIGN, AllocObject, false));
+        ASSERT_NE(pFirst, nullptr);
+        memset(pFirst, 0xAB, 64);
+        Free(&cache, pFirst);
+
+        uint8*const pSecond = static_cast<uint8*>(Alloc(&cache, 64, PAL_DEFAULT_MEM_ALIGN, AllocObject, true));
+        ASSERT_EQ(pSecond, pFirst);
+
+        for (uint32 i = 0; i < 64; ++i)
+        {
+            EXPECT_EQ(pSecond[i], 0) << i;
+        }
+
+        Free(&cache, pSecond);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Large, over-aligned and client-typed allocations must go straight to the underlying allocator and back.
+TEST(ThreadCacheAllocatorTest, UncachedAllocationsPassThrough)
+{
+    TestAllocator allocator;
+
+    {
+        CacheAllocator cache(&allocator);
+
+        const SystemAllocType clientType = static_cast<SystemAllocType>(0);
+
+        void*const pLarge      = Alloc(&cache, 8192, PAL_DEFAULT_MEM_ALIGN, AllocInternal, false);
+        void*const pAligned    = Alloc(&cache, 64, 256, AllocInternal, false);
+        void*const pClientType = Alloc(&cache, 64, PAL_DEFAULT_MEM_ALIGN, clientType, false);
+
+        ASSERT_NE(pLarge, nullptr);
+        ASSERT_NE(pAligned, nullptr);
+        ASSERT_NE(pClientType, nullptr);
+        EXPECT_TRUE(IsPow2Aligned(reinterpret_cast<uint64>(pAligned), 256));
+
+        Free(&cache, pLarge);
+        Free(&cache, pAligned);
+        Free(&cache, pClientType);
+
+        const ThreadCacheStats stats = GetStats(cache);
+        EXPECT_EQ(stats.numClientAllocs, 3u);
+        EXPECT_EQ(stats.numClientFrees, 3u);
+        EXPECT_EQ(stats.cachedBytes, 0u);
+        EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// A thread caches blocks for one allocator at a time, so a second allocator used on the same thread must pass every
+// request through.
+TEST(ThreadCacheAllocatorTest, SecondAllocatorIsUncached)
+{
+    TestAllocator allocator;
+
+    {
+        CacheAllocator first(&allocator);
+        CacheAllocator second(&allocator);
+
+        Free(&first, Alloc(&first, 32, PAL_DEFAULT_MEM_ALIGN, AllocInternal, false));
+
+        for (uint32 i = 0; i < 4; ++i)
+        {
+            Free(&second, Alloc(&second, 32, PAL_DEFAULT_MEM_ALIGN, AllocInternal, false));
+        }
+
+        const ThreadCacheStats stats = GetStats(second);
+        EXPECT_EQ(stats.numAllocs, 4u);
+        EXPECT_EQ(stats.numClientAllocs, 4u);
+        EXPECT_EQ(stats.numClientFrees, 4u);
+        EXPECT_EQ(stats.cachedBytes, 0u);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// A thread must not keep more than 256 KiB of freed blocks.
+TEST(ThreadCacheAllocatorTest, CachedBytesAreCapped)
+{
+    constexpr uint32 NumBlocks = 256;
+
+    TestAllocator allocator;
+
+    {
+        CacheAllocator cache(&allocator);
+
+        std::vector<void*> blocks;
+        for (uint32 i = 0; i < NumBlocks; ++i)
+        {
+            blocks.push_back(Alloc(&cache, 4096, PAL_DEFAULT_MEM_ALIGN, AllocInternal, false));
+            ASSERT_NE(blocks.back(), nullptr);
+        }
+
+        for (void* pBlock : blocks)
+        {
+            Free(&cache, pBlock);
+        }
+
+        const ThreadCacheStats stats = GetStats(cache);
+        EXPECT_EQ(stats.cachedBytes, 256u * 1024u);
+        EXPECT_EQ(stats.numClientFrees, NumBlocks - 64u);
+        EXPECT_EQ(allocator.NumLiveAllocs(), 64);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Several threads allocate and free mixed sizes, alignments and types, and hand some blocks to other threads to free.
+// Every block must keep its contents while it's live, and every byte must be returned once the threads have exited.
+TEST(ThreadCacheAllocatorTest, MultiThreadedStress)
+{
+    constexpr uint32 NumThreads    = 4;
+    constexpr uint32 NumOperations = 100000;
+
+    TestAllocator allocator;
+
+    {
+        CacheAllocator cache(&allocator);
+
+        struct Block
+        {
+            uint8* pMem;
+            size_t bytes;
+            uint8  pattern;
+        };
+
+        std::mutex         sharedLock;
+        std::vector<Block> sharedBlocks; // Blocks waiting to be freed by another thread.
+
+        auto check = [](const Block& block)
+        {
+            bool intact = true;
+            for (size_t i = 0; i < block.bytes; ++i)
+            {
+                intact &= (block.pMem[i] == block.pattern);
+            }
+            return intact;
+        };
+
+        auto worker = [&](uint32 threadIndex)
+        {
+            uint64             seed = threadIndex + 1;
+            std::vector<Block> live;
+
+            for (uint32 op = 0; op < NumOperations; ++op)
+            {
+                const uint64 random = NextRandom(&seed);
+
+                if ((random % 64) < live.size())
+                {
+                    const size_t index = (random >> 6) % live.size();
+                    const Block  block = live[index];
+
+                    live[index] = live.back();
+                    live.pop_back();
+
+                    EXPECT_TRUE(check(block));
+
+                    if ((random >> 20) % 8 == 0)
+                    {
+                        std::lock_guard<std::mutex> lock(sharedLock);
+                        sharedBlocks.push_back(block);
+                    }
+                    else
+                    {
+                        Free(&cache, block.pMem);
+                    }
+                }
+                else
+                {
+                    const size_t          bytes     = ((random >> 6) % 8 == 0) ? (4097 + ((random >> 9) % 4096))
+                                                                               : (1 + ((random >> 9) % 512));
+                    const size_t          alignment = ((random >> 21) % 16 == 0) ? 64 : PAL_DEFAULT_MEM_ALIGN;
+                    const SystemAllocType type      = static_cast<SystemAllocType>(AllocObject + ((random >> 23) % 4));
+                    const bool            zeroMem   = ((random >> 25) % 2 == 0);
+
+                    Block block = {};
+                    block.pMem    = static_cast<uint8*>(Alloc(&cache, bytes, alignment, type, zeroMem));
+                    block.bytes   = bytes;
+                    block.pattern = static_cast<uint8>(random >> 26);
+
+                    ASSERT_NE(block.pMem, nullptr);
+                    EXPECT_TRUE(IsPow2Aligned(reinterpret_cast<uint64>(block.pMem), alignment));
+
+                    if (zeroMem)
+                    {
+                        EXPECT_TRUE(check({ block.pMem, bytes, 0 }));
+                    }
+
+                    memset(block.pMem, block.pattern, bytes);
+                    live.push_back(block);
+                }
+
+                // Free a block some other thread gave up.
+                if ((random >> 30) % 4 == 0)
+                {
+                    Block block   = {};
+                    bool  haveOne = false;
+                    {
+                        std::lock_guard<std::mutex> lock(sharedLock);
+                        if (sharedBlocks.empty() == false)
+                        {
+                            block   = sharedBlocks.back();
+                            haveOne = true;
+                            sharedBlocks.pop_back();
+                        }
+                    }
+
+                    if (haveOne)
+                    {
+                        EXPECT_TRUE(check(block));
+                        Free(&cache, block.pMem);
+                    }
+                }
+            }
+
+            for (const Block& block : live)
+            {
+                EXPECT_TRUE(check(block));
+                Free(&cache, block.pMem);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (uint32 i = 0; i < NumThreads; ++i)
+        {
+            threads.emplace_back(worker, i);
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const Block& block : sharedBlocks)
+        {
+            Free(&cache, block.pMem);
+        }
+
+        // The worker threads have exited, so only this thread's cache may still hold blocks.
+        const ThreadCacheStats stats = GetStats(cache);
+        EXPECT_EQ(stats.numAllocs, stats.numFrees);
+        EXPECT_LT(stats.numClientAllocs, stats.numAllocs / 4);
+        EXPECT_EQ(stats.numClientAllocs - stats.numClientFrees, static_cast<uint64>(allocator.NumLiveAllocs()));
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
@@ -0,0 +1,374 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palBestFitAllocatorImpl.h"
+#include "palInlineFuncs.h"
+#include "palTestAllocator.h"
+#include "palTlsfAllocatorImpl.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+
+using namespace Util;
+using namespace PalTests;
+
+namespace
+{
+
+constexpr Pal::gpusize MinBlockSize = 64 * 1024;
+
+// Simple linear congruential generator, so every run sees the same sequence of requests.
+uint64 NextRandom(uint64* pState)
+{
+    *pState = (*pState * 6364136223846793005ull) + 1442695040888963407ull;
+    return (*pState >> 33);
+}
+
+// =====================================================================================================================
+// Mirrors the blocks an allocator has handed out, checks each new one against the others and tells whether a failed
+// request could have been placed in one of the gaps between them.
+class AllocationModel
+{
+public:
+    explicit AllocationModel(Pal::gpusize totalBytes) : m_totalBytes(totalBytes) { }
+
+    // Records a new allocation, and returns false if it's misaligned, out of range or overlaps another one.
+    bool Add(Pal::gpusize offset, Pal::gpusize size, Pal::gpusize alignment)
+    {
+        bool valid = IsPow2Aligned(offset, alignment) && ((offset + size) <= m_totalBytes);
+
+        auto next = m_blocks.lower_bound(offset);
+
+        if (valid && (next != m_blocks.end()))
+        {
+            valid = ((offset + size) <= next->first);
+        }
+
+        if (valid && (next != m_blocks.begin()))
+        {
+            auto prev = next;
+            --prev;
+            valid = ((prev->first + prev->second) <= offset);
+        }
+
+        if (valid)
+        {
+            m_blocks[offset] = size;
+        }
+
+        return valid;
+    }
+
+    void Remove(Pal::gpusize offset) { m_blocks.erase(offset); }
+
+    // Tells whether any gap could hold the request.  If startAligned is set, the request must start at the beginning of
+    // the gap, which is how BestFitAllocator places blocks.
+    bool Fits(Pal::gpusize size, Pal::gpusize alignment, bool startAligned) const
+    {
+        bool         fits    = false;
+        Pal::gpusize gapBase = 0;
+
+        for (auto it = m_blocks.begin(); (fits == false); ++it)
+        {
+            const Pal::gpusize gapEnd = (it != m_blocks.end()) ? it->first : m_totalBytes;
+            const Pal::gpusize base   = Pow2Align(gapBase, alignment);
+
+            fits = ((startAligned == false) || (base == gapBase)) && ((base + size) <= gapEnd);
+
+            if (it == m_blocks.end())
+            {
+                break;
+            }
+
+            gapBase = it->first + it->second;
+        }
+
+        return fits;
+    }
+
+    // Returns the size of the largest gap between allocations.
+    Pal::gpusize LargestGap() const
+    {
+        Pal::gpusize largest = 0;
+        Pal::gpusize gapBase = 0;
+
+        for (const auto& block : m_blocks)
+        {
+            largest = Max(largest, block.first - gapBase);
+            gapBase = block.first + block.second;
+        }
+
+        return Max(largest, m_totalBytes - gapBase);
+    }
+
+private:
+    const Pal::gpusize                   m_totalBytes;
+    std::map<Pal::gpusize, Pal::gpusize> m_blocks;    // Size of every live allocation, by offset
+};
+
+// =====================================================================================================================
+// Sends the same random requests and frees to a TlsfAllocator and a BestFitAllocator, each checked against its own
+// model.  BestFitAllocator only places blocks at the start of a free range, so it's the reference for that case: TLSF
+// must succeed whenever BestFitAllocator's rule would on TLSF's own layout, and whenever any free range can hold the
+// request once its start is aligned.  Sizes are drawn from small requests and from requests just below the largest
+// free range, which are the ones TLSF's size rounding can miss.
+void RunRandomOperations(
+    uint32 totalBlocks,
+    uint32 numOperations,
+    uint64 seed)
+{
+    TestAllocator allocator;
+
+    {
+        const Pal::gpusize totalBytes = totalBlocks * MinBlockSize;
+
+        TlsfAllocator<TestAllocator>    tlsf(&allocator, totalBytes, MinBlockSize);
+        BestFitAllocator<TestAllocator> bestFit(&allocator, totalBytes, MinBlockSize);
+
+        ASSERT_EQ(tlsf.Init(), Result::Success);
+        ASSERT_EQ(bestFit.Init(), Result::Success);
+
+        AllocationModel tlsfModel(totalBytes);
+        AllocationModel bestFitModel(totalBytes);
+
+        std::vector<Pal::gpusize> tlsfLive;
+        std::vector<Pal::gpusize> bestFitLive;
+
+        uint32 numTlsfFailures    = 0;
+        uint32 numBestFitFailures = 0;
+
+        for (uint32 op = 0; op < numOperations; ++op)
+        {
+            const uint64 random = NextRandom(&seed);
+
+            // Free more often as more blocks are live, so the heaps keep cycling between fragmented and nearly empty.
+            const bool doFree = ((random % 64) < (tlsfLive.size() + bestFitLive.size()));
+
+            if (doFree)
+            {
+                const uint64 pick = NextRandom(&seed);
+
+                if (tlsfLive.empty() == false)
+                {
+                    const size_t index = pick % tlsfLive.size();
+                    tlsf.Free(tlsfLive[index]);
+                    tlsfModel.Remove(tlsfLive[index]);
+                    tlsfLive[index] = tlsfLive.back();
+                    tlsfLive.pop_back();
+                }
+
+                if (bestFitLive.empty() == false)
+                {
+                    const size_t index = pick % bestFitLive.size();
+                    bestFit.Free(bestFitLive[index]);
+                    bestFitModel.Remove(bestFitLive[index]);
+                    bestFitLive[index] = bestFitLive.back();
+                    bestFitLive.pop_back();
+                }
+            }
+            else
+            {
+                const uint32       alignShift = ((random >> 8) % 4 == 0) ? ((random >> 10) % 6) : 0;
+                const Pal::gpusize alignment  = MinBlockSize << alignShift;
+
+                const uint32 largestGap = static_cast<uint32>(tlsfModel.LargestGap() / MinBlockSize);
+                const uint32 slack      = (random >> 28) % 16;
+
+                uint32 blocks = 1 + ((random >> 16) % 16);
+
+                switch ((random >> 24) % 8)
+                {
+                case 0:
+                    blocks = totalBlocks - slack;
+                    break;
+                case 1:
+                case 2:
+                    blocks = (largestGap > slack) ? (largestGap - slack) : 1;
+                    break;
+                case 3:
+                    blocks = 1 + ((random >> 28) % totalBlocks);
+                    break;
+                default:
+                    break;
+                }
+
+                const Pal::gpusize size = blocks * MinBlockSize;
+
+                const bool tlsfCanFit    = tlsfModel.Fits(size, alignment, false);
+                const bool bestFitCanFit = bestFitModel.Fits(size, alignment, true);
+
+                Pal::gpusize offset = 0;
+                Result       result = tlsf.Allocate(size, alignment, &offset);
+
+                if (result == Result::Success)
+                {
+                    ASSERT_TRUE(tlsfModel.Add(offset, size, alignment)) << "offset " << offset << " size " << size;
+                    tlsfLive.push_back(offset);
+                }
+                else
+                {
+                    ASSERT_EQ(result, Result::ErrorOutOfGpuMemory);
+                    ASSERT_FALSE(tlsfCanFit) << "size " << size << " alignment " << alignment << " failed";
+                    ASSERT_FALSE(tlsfModel.Fits(size, alignment, true));
+                    ++numTlsfFailures;
+                }
+
+                result = bestFit.Allocate(size, alignment, &offset);
+
+                if (result == Result::Success)
+                {
+                    ASSERT_TRUE(bestFitModel.Add(offset, size, alignment));
+                    bestFitLive.push_back(offset);
+                }
+                else
+                {
+                    ASSERT_EQ(result, Result::ErrorOutOfGpuMemory);
+                    ASSERT_FALSE(bestFitCanFit);
+                    ++numBestFitFailures;
+                }
+            }
+        }
+
+        // Both allocators must have turned some requests away, or the sizes never stressed them.
+        EXPECT_GT(numTlsfFailures, 0u);
+        EXPECT_GT(numBestFitFailures, 0u);
+
+        for (Pal::gpusize offset : tlsfLive)
+        {
+            tlsf.Free(offset);
+        }
+
+        for (Pal::gpusize offset : bestFitLive)
+        {
+            bestFit.Free(offset);
+        }
+
+        EXPECT_TRUE(tlsf.IsEmpty());
+
+        // Everything must have merged back into a single block.
+        Pal::gpusize offset = ~0ull;
+        EXPECT_EQ(tlsf.Allocate(totalBytes, MinBlockSize, &offset), Result::Success);
+        EXPECT_EQ(offset, 0u);
+        tlsf.Free(offset);
+
+        offset = ~0ull;
+        EXPECT_EQ(bestFit.Allocate(totalBytes, MinBlockSize, &offset), Result::Success);
+        EXPECT_EQ(offset, 0u);
+        bestFit.Free(offset);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Every size up to the whole heap must fit an empty heap, including those which round up past the heap's size.
+TEST(TlsfAllocatorTest, EmptyHeapFitsEverySize)
+{
+    TestAllocator allocator;
+
+    {
+        constexpr uint32 TotalBlocks = 256;
+
+        TlsfAllocator<TestAllocator> tlsf(&allocator, TotalBlocks * MinBlockSize, MinBlockSize);
+        ASSERT_EQ(tlsf.Init(), Result::Success);
+
+        for (uint32 blocks = 1; blocks <= TotalBlocks; ++blocks)
+        {
+            Pal::gpusize offset = ~0ull;
+            ASSERT_EQ(tlsf.Allocate(blocks * MinBlockSize, MinBlockSize, &offset), Result::Success) << blocks;
+            EXPECT_EQ(offset, 0u);
+
+            tlsf.Free(offset);
+            EXPECT_TRUE(tlsf.IsEmpty());
+        }
+
+        Pal::gpusize offset = 0;
+        EXPECT_EQ(tlsf.Allocate((TotalBlocks + 1) * MinBlockSize, MinBlockSize, &offset),
+                  Result::ErrorOutOfGpuMemory);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// With the first block taken, every aligned request that still fits the rest of the heap must succeed.
+TEST(TlsfAllocatorTest, AlignedRequestsFitRemainder)
+{
+    TestAllocator allocator;
+
+    {
+        constexpr uint32 TotalBlocks = 256;
+
+        TlsfAllocator<TestAllocator> tlsf(&allocator, TotalBlocks * MinBlockSize, MinBlockSize);
+        ASSERT_EQ(tlsf.Init(), Result::Success);
+
+        Pal::gpusize first = ~0ull;
+        ASSERT_EQ(tlsf.Allocate(MinBlockSize, MinBlockSize, &first), Result::Success);
+        ASSERT_EQ(first, 0u);
+
+        for (uint32 alignBlocks = 1; alignBlocks < TotalBlocks; alignBlocks *= 2)
+        {
+            // The first aligned offset past the taken block.
+            const uint32 baseBlocks = (alignBlocks == 1) ? 1 : alignBlocks;
+
+            for (uint32 blocks = 1; blocks <= TotalBlocks; ++blocks)
+            {
+                const bool   fits   = ((baseBlocks + blocks) <= TotalBlocks);
+                Pal::gpusize offset = ~0ull;
+                const Result result = tlsf.Allocate(blocks * MinBlockSize, alignBlocks * MinBlockSize, &offset);
+
+                ASSERT_EQ(result, fits ? Result::Success : Result::ErrorOutOfGpuMemory)
+                    << blocks << " blocks aligned to " << alignBlocks;
+
+                if (result == Result::Success)
+                {
+                    EXPECT_TRUE(IsPow2Aligned(offset, alignBlocks * MinBlockSize));
+                    tlsf.Free(offset);
+                }
+            }
+        }
+
+        tlsf.Free(first);
+        EXPECT_TRUE(tlsf.IsEmpty());
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+TEST(TlsfAllocatorTest, RandomOperationsSmallHeap)
+{
+    RunRandomOperations(256, 200000, 1);
+}
+
+// =====================================================================================================================
+TEST(TlsfAllocatorTest, RandomOperationsLargeHeap)
+{
+    RunRandomOperations(64 * 1024, 200000, 2);
+}
@@ -0,0 +1,455 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palDequeImpl.h"
+#include "palTestAllocator.h"
+#include "palVectorImpl.h"
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Util;
+using namespace PalTests;
+
+namespace
+{
+
+// Simple linear congruential generator, so every run sees the same sequence of operations.
+uint64 NextRandom(uint64* pState)
+{
+    *pState = (*pState * 6364136223846793005ull) + 1442695040888963407ull;
+    return (*pState >> 33);
+}
+
+// Element which counts its live instances and how often it was copied, and poisons itself when destroyed so that a
+// use after destruction shows up as a wrong value.
+struct Tracked
+{
+    static int s_numLive;
+    static int s_numCopies;
+
+    explicit Tracked(uint32 value) : value(value) { ++s_numLive; }
+    Tracked(const Tracked& other) : value(other.value) { ++s_numLive; ++s_numCopies; }
+    Tracked(Tracked&& other) : value(other.value) { ++s_numLive; other.value = 0xDEAD; }
+    ~Tracked() { --s_numLive; value = 0xDEAD; }
+
+    Tracked& operator=(const Tracked& other) { value = other.value; ++s_numCopies; return *this; }
+    Tracked& operator=(Tracked&& other) { value = other.value; other.value = 0xDEAD; return *this; }
+
+    uint32 value;
+};
+
+int Tracked::s_numLive   = 0;
+int Tracked::s_numCopies = 0;
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Pushes far past the local buffer, and checks every element survives each reallocation.
+TEST(VectorTest, GrowsPastLocalBuffer)
+{
+    TestAllocator allocator;
+
+    {
+        Vector<uint32, 4, TestAllocator> vector(&allocator);
+
+        for (uint32 i = 0; i < 10000; ++i)
+        {
+            ASSERT_EQ(vector.PushBack(i * 3), Result::Success);
+        }
+
+        ASSERT_EQ(vector.NumElements(), 10000u);
+
+        for (uint32 i = 0; i < 10000; ++i)
+        {
+            ASSERT_EQ(vector[i], i * 3);
+        }
+
+        ASSERT_EQ(vector.Resize(20, 7), Result::Success);
+        EXPECT_EQ(vector.NumElements(), 20u);
+        EXPECT_EQ(vector.Back(), 19u * 3);
+
+        ASSERT_EQ(vector.Resize(30, 7), Result::Success);
+        EXPECT_EQ(vector.Back(), 7u);
+
+        uint32 popped = 0;
+        vector.PopBack(&popped);
+        EXPECT_EQ(popped, 7u);
+        EXPECT_EQ(vector.NumElements(), 29u);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Pushing a copy of an element of the vector itself must work when the push reallocates the buffer.
+TEST(VectorTest, PushBackOwnElement)
+{
+    TestAllocator allocator;
+
+    {
+        Vector<std::string, 2, TestAllocator> vector(&allocator);
+
+        ASSERT_EQ(vector.PushBack(std::string(64, 'a')), Result::Success);
+
+        for (uint32 i = 1; i < 100; ++i)
+        {
+            ASSERT_EQ(vector.PushBack(vector[0]), Result::Success);
+            ASSERT_EQ(vector.PushBack(vector.Back()), Result::Success);
+        }
+
+        for (const std::string& value : vector)
+        {
+            EXPECT_EQ(value, std::string(64, 'a'));
+        }
+
+        Vector<uint64, 1, TestAllocator> trivial(&allocator);
+        ASSERT_EQ(trivial.PushBack(42), Result::Success);
+
+        for (uint32 i = 1; i < 100; ++i)
+        {
+            ASSERT_EQ(trivial.PushBack(trivial[i - 1] + 1), Result::Success);
+        }
+
+        EXPECT_EQ(trivial.Back(), 141u);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Move-only elements must be movable in, through reallocations, and back out.
+TEST(VectorTest, MoveOnlyElements)
+{
+    TestAllocator allocator;
+
+    {
+        Vector<std::unique_ptr<uint32>, 2, TestAllocator> vector(&allocator);
+
+        for (uint32 i = 0; i < 50; ++i)
+        {
+            if ((i % 2) == 0)
+            {
+                ASSERT_EQ(vector.PushBack(std::unique_ptr<uint32>(new uint32(i))), Result::Success);
+            }
+            else
+            {
+                ASSERT_EQ(vector.EmplaceBack(new uint32(i)), Result::Success);
+            }
+        }
+
+        for (uint32 i = 50; i > 0; --i)
+        {
+            std::unique_ptr<uint32> popped;
+            vector.PopBack(&popped);
+
+            ASSERT_NE(popped, nullptr);
+            EXPECT_EQ(*popped, i - 1);
+        }
+
+        EXPECT_TRUE(vector.IsEmpty());
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Growth must move nontrivial elements rather than copy them, and every element must be destroyed exactly once.
+TEST(VectorTest, ElementLifetimes)
+{
+    TestAllocator allocator;
+
+    Tracked::s_numLive   = 0;
+    Tracked::s_numCopies = 0;
+
+    {
+        Vector<Tracked, 4, TestAllocator> vector(&allocator);
+
+        for (uint32 i = 0; i < 1000; ++i)
+        {
+            ASSERT_EQ(vector.EmplaceBack(i), Result::Success);
+        }
+
+        EXPECT_EQ(Tracked::s_numLive, 1000);
+        EXPECT_EQ(Tracked::s_numCopies, 0);
+
+        for (uint32 i = 0; i < 1000; ++i)
+        {
+            ASSERT_EQ(vector[i].value, i);
+        }
+
+        Tracked popped(0);
+        vector.PopBack(&popped);
+        EXPECT_EQ(popped.value, 999u);
+        EXPECT_EQ(Tracked::s_numLive, 1000);
+
+        vector.Clear();
+        EXPECT_EQ(Tracked::s_numLive, 1);
+    }
+
+    EXPECT_EQ(Tracked::s_numLive, 0);
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Moving a vector must steal its heap buffer or copy its local one, and leave it usable.
+TEST(VectorTest, MoveConstructor)
+{
+    TestAllocator allocator;
+
+    {
+        Vector<uint32, 4, TestAllocator> local(&allocator);
+        Vector<uint32, 4, TestAllocator> heap(&allocator);
+
+        for (uint32 i = 0; i < 3; ++i)
+        {
+            ASSERT_EQ(local.PushBack(i), Result::Success);
+        }
+
+        for (uint32 i = 0; i < 100; ++i)
+        {
+            ASSERT_EQ(heap.PushBack(i), Result::Success);
+        }
+
+        const int numAllocs = allocator.NumLiveAllocs();
+
+        Vector<uint32, 4, TestAllocator> movedLocal(Move(local));
+        Vector<uint32, 4, TestAllocator> movedHeap(Move(heap));
+
+        EXPECT_EQ(allocator.NumLiveAllocs(), numAllocs);
+        ASSERT_EQ(movedLocal.NumElements(), 3u);
+        ASSERT_EQ(movedHeap.NumElements(), 100u);
+
+        for (uint32 i = 0; i < 100; ++i)
+        {
+            EXPECT_EQ(movedHeap[i], i);
+        }
+
+        // The moved-from vectors are empty and can be filled again.
+        EXPECT_TRUE(local.IsEmpty());
+        EXPECT_TRUE(heap.IsEmpty());
+
+        for (uint32 i = 0; i < 100; ++i)
+        {
+            ASSERT_EQ(heap.PushBack(i + 1), Result::Success);
+        }
+
+        EXPECT_EQ(heap.Back(), 100u);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// Applies the same random pushes and pops at both ends to a Deque with small blocks and to an std::deque.
+TEST(DequeTest, RandomOperations)
+{
+    TestAllocator allocator;
+
+    Tracked::s_numLive   = 0;
+    Tracked::s_numCopies = 0;
+
+    {
+        Deque<Tracked, TestAllocator> deque(&allocator, 4);
+        std::deque<uint32>            reference;
+
+        uint64 seed = 1;
+
+        for (uint32 op = 0; op < 200000; ++op)
+        {
+            const uint64 random = NextRandom(&seed);
+            const uint32 value  = static_cast<uint32>(random >> 8) & 0xFFFF;
+
+            // Drift between growing and shrinking every few thousand operations.
+            const bool grow = ((op / 4096) % 2 == 0) ? ((random % 8) < 5) : ((random % 8) < 3);
+
+            if (grow)
+            {
+                switch ((random >> 4) % 4)
+                {
+                case 0:
+                    ASSERT_EQ(deque.PushFront(Tracked(value)), Result::Success);
+                    reference.push_front(value);
+                    break;
+                case 1:
+                    ASSERT_EQ(deque.PushBack(Tracked(value)), Result::Success);
+                    reference.push_back(value);
+                    break;
+                case 2:
+                    ASSERT_EQ(deque.EmplaceFront(value), Result::Success);
+                    reference.push_front(value);
+                    break;
+                default:
+                    ASSERT_EQ(deque.EmplaceBack(value), Result::Success);
+                    reference.push_back(value);
+                    break;
+                }
+            }
+            else
+            {
+                Tracked      popped(0);
+                const bool   front  = ((random >> 4) % 2 == 0);
+                const Result result = front ? deque.PopFront(&popped) : deque.PopBack(&popped);
+
+                if (reference.empty())
+                {
+                    EXPECT_EQ(result, Result::ErrorUnavailable);
+                }
+                else
+                {
+                    ASSERT_EQ(result, Result::Success);
+                    EXPECT_EQ(popped.value, front ? reference.front() : reference.back());
+
+                    if (front)
+                    {
+                        reference.pop_front();
+                    }
+                    else
+                    {
+                        reference.pop_back();
+                    }
+                }
+            }
+
+            ASSERT_EQ(deque.NumElements(), reference.size());
+            ASSERT_EQ(static_cast<size_t>(Tracked::s_numLive), reference.size());
+
+            if (reference.empty() == false)
+            {
+                ASSERT_EQ(deque.Front().value, reference.front());
+                ASSERT_EQ(deque.Back().value, reference.back());
+            }
+
+            if ((op % 1024) == 0)
+            {
+                size_t index = 0;
+                for (auto iter = deque.Begin(); iter.Get() != nullptr; iter.Next())
+                {
+                    ASSERT_LT(index, reference.size());
+                    ASSERT_EQ(iter.Get()->value, reference[index]);
+                    ++index;
+                }
+                ASSERT_EQ(index, reference.size());
+            }
+        }
+
+        EXPECT_EQ(Tracked::s_numCopies, 0);
+    }
+
+    EXPECT_EQ(Tracked::s_numLive, 0);
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+// A deque which is repeatedly filled and drained must reuse its empty blocks, keeping at most four of them.
+TEST(DequeTest, ReusesEmptyBlocks)
+{
+    constexpr uint32 ElementsPerBlock = 8;
+
+    TestAllocator allocator;
+
+    {
+        Deque<uint32, TestAllocator> deque(&allocator, ElementsPerBlock);
+
+        // Three blocks' worth of elements, which can straddle four blocks.
+        for (uint32 i = 0; i < 3 * ElementsPerBlock; ++i)
+        {
+            ASSERT_EQ(deque.PushBack(i), Result::Success);
+        }
+
+        const int numBlocks = allocator.NumLiveAllocs();
+
+        for (uint32 round = 0; round < 100; ++round)
+        {
+            uint32 value = 0;
+            while (deque.PopFront(&value) == Result::Success)
+            {
+            }
+
+            EXPECT_LE(allocator.NumLiveAllocs(), numBlocks);
+
+            for (uint32 i = 0; i < 3 * ElementsPerBlock; ++i)
+            {
+                ASSERT_EQ(((round % 2) == 0) ? deque.PushFront(i) : deque.PushBack(i), Result::Success);
+            }
+
+            EXPECT_LE(allocator.NumLiveAllocs(), numBlocks + 1);
+        }
+
+        // Draining many blocks at once keeps only four of them.
+        for (uint32 i = 0; i < 64 * ElementsPerBlock; ++i)
+        {
+            ASSERT_EQ(deque.PushBack(i), Result::Success);
+        }
+
+        uint32 value = 0;
+        while (deque.PopBack(&value) == Result::Success)
+        {
+        }
+
+        EXPECT_LE(allocator.NumLiveAllocs(), 4);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
+
+// =====================================================================================================================
+TEST(DequeTest, MoveOnlyElements)
+{
+    TestAllocator allocator;
+
+    {
+        Deque<std::unique_ptr<uint32>, TestAllocator> deque(&allocator, 4);
+
+        for (uint32 i = 0; i < 20; ++i)
+        {
+            ASSERT_EQ(deque.PushBack(std::unique_ptr<uint32>(new uint32(i))), Result::Success);
+            ASSERT_EQ(deque.EmplaceFront(new uint32(100 + i)), Result::Success);
+        }
+
+        for (uint32 i = 20; i > 0; --i)
+        {
+            std::unique_ptr<uint32> front;
+            std::unique_ptr<uint32> back;
+
+            ASSERT_EQ(deque.PopFront(&front), Result::Success);
+            ASSERT_EQ(deque.PopBack(&back), Result::Success);
+
+            EXPECT_EQ(*front, 100 + i - 1);
+            EXPECT_EQ(*back, i - 1);
+        }
+
+        EXPECT_EQ(deque.NumElements(), 0u);
+
+        // Elements still in the deque when it's destroyed must be destroyed with it.
+        ASSERT_EQ(deque.PushBack(std::unique_ptr<uint32>(new uint32(1))), Result::Success);
+    }
+
+    EXPECT_EQ(allocator.NumLiveAllocs(), 0);
+}
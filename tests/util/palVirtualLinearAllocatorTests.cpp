@@ -0,0 +1,217 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palLinearAllocator.h"
+#include "palSysMemory.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+using namespace Util;
+
+namespace
+{
+
+void* Alloc(VirtualLinearAllocator* pAllocator, size_t bytes)
+{
+#if PAL_MEMTRACK
+    return pAllocator->Alloc(AllocInfo(bytes, 16, false, AllocInternal, MemBlkType::Malloc, __FILE__, __LINE__));
+#else
+    return pAllocator->Alloc(AllocInfo(bytes, 16, false, AllocInternal));
+#endif
+}
+
+// =====================================================================================================================
+// Allocates the given number of pages one page at a time and writes to all of them, so that a page which isn't
+// actually committed faults.
+void AllocPages(
+    VirtualLinearAllocator* pAllocator,
+    size_t                  numPages)
+{
+    const size_t pageSize = VirtualPageSize();
+
+    for (size_t page = 0; page < numPages; ++page)
+    {
+        void* pMem = Alloc(pAllocator, pageSize);
+        ASSERT_NE(pMem, nullptr);
+
+        memset(pMem, static_cast<int>(page), pageSize);
+    }
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Growing a page at a time must double the committed size on each commit rather than commit one page per allocation.
+TEST(VirtualLinearAllocatorTest, CommitsGrowGeometrically)
+{
+    const size_t pageSize = VirtualPageSize();
+
+    VirtualLinearAllocator allocator(256 * pageSize);
+    ASSERT_EQ(allocator.Init(), Result::Success);
+
+    EXPECT_EQ(allocator.NumCommits(), 1u);
+    EXPECT_EQ(allocator.BytesCommitted(), pageSize);
+
+    // The first page holds the first allocation, then commits of 1, 2, 4, ... 64 pages follow.
+    AllocPages(&allocator, 128);
+
+    EXPECT_EQ(allocator.NumCommits(), 8u);
+    EXPECT_EQ(allocator.BytesCommitted(), 128 * pageSize);
+    EXPECT_EQ(allocator.BytesAllocated(), 128 * pageSize);
+
+    // A single large allocation commits what it needs in one go.
+    ASSERT_NE(Alloc(&allocator, 100 * pageSize), nullptr);
+
+    EXPECT_EQ(allocator.NumCommits(), 9u);
+    EXPECT_EQ(allocator.BytesCommitted(), 256 * pageSize);
+    EXPECT_EQ(allocator.NumDecommits(), 0u);
+}
+
+// =====================================================================================================================
+// Commits must never run past the reservation, and an allocation which doesn't fit must fail without side effects.
+TEST(VirtualLinearAllocatorTest, CommitsCappedAtReservation)
+{
+    const size_t pageSize = VirtualPageSize();
+
+    VirtualLinearAllocator allocator(5 * pageSize);
+    ASSERT_EQ(allocator.Init(), Result::Success);
+
+    // Commits of 1 and 2 pages, then the third is capped from 4 pages to the 1 page left.
+    AllocPages(&allocator, 5);
+
+    EXPECT_EQ(allocator.NumCommits(), 4u);
+    EXPECT_EQ(allocator.BytesCommitted(), 5 * pageSize);
+    EXPECT_EQ(allocator.Remaining(), 0u);
+
+    void*const pCurrent = allocator.Current();
+
+    EXPECT_EQ(Alloc(&allocator, 1), nullptr);
+    EXPECT_EQ(allocator.Current(), pCurrent);
+    EXPECT_EQ(allocator.NumCommits(), 4u);
+
+    allocator.Rewind(allocator.Start(), false);
+
+    EXPECT_EQ(Alloc(&allocator, 6 * pageSize), nullptr);
+    EXPECT_EQ(allocator.Current(), allocator.Start());
+}
+
+// =====================================================================================================================
+// An allocator whose usage is the same every frame must keep its pages across Trim() calls.
+TEST(VirtualLinearAllocatorTest, TrimKeepsSteadyUsage)
+{
+    const size_t pageSize = VirtualPageSize();
+
+    VirtualLinearAllocator allocator(256 * pageSize);
+    ASSERT_EQ(allocator.Init(), Result::Success);
+
+    AllocPages(&allocator, 40);
+    allocator.Rewind(allocator.Start(), false);
+    EXPECT_EQ(allocator.Trim(), 0u);
+
+    const uint32 numCommits = allocator.NumCommits();
+    EXPECT_EQ(allocator.BytesCommitted(), 64 * pageSize);
+
+    for (uint32 frame = 0; frame < 10; ++frame)
+    {
+        AllocPages(&allocator, 40);
+        allocator.Rewind(allocator.Start(), false);
+        EXPECT_EQ(allocator.Trim(), 0u);
+    }
+
+    EXPECT_EQ(allocator.NumCommits(), numCommits);
+    EXPECT_EQ(allocator.NumDecommits(), 0u);
+    EXPECT_EQ(allocator.BytesCommitted(), 64 * pageSize);
+
+    // A frame which allocates nothing leaves only the first page committed.
+    EXPECT_EQ(allocator.Trim(), 63 * pageSize);
+    EXPECT_EQ(allocator.BytesCommitted(), pageSize);
+    EXPECT_EQ(allocator.NumDecommits(), 1u);
+
+    // Decommitted pages must be committed again when they're next needed.
+    AllocPages(&allocator, 40);
+    EXPECT_GE(allocator.BytesCommitted(), 40 * pageSize);
+}
+
+// =====================================================================================================================
+// After a spike in usage, Trim() must shrink back to what was used since the previous trim, and must never release a
+// page which the current pointer is still in.
+TEST(VirtualLinearAllocatorTest, TrimReleasesSpike)
+{
+    const size_t pageSize = VirtualPageSize();
+
+    VirtualLinearAllocator allocator(256 * pageSize);
+    ASSERT_EQ(allocator.Init(), Result::Success);
+
+    AllocPages(&allocator, 100);
+    allocator.Rewind(allocator.Start(), false);
+
+    // The spike itself was used since the last trim, so it's kept this time.
+    EXPECT_EQ(allocator.Trim(), 0u);
+    EXPECT_EQ(allocator.BytesCommitted(), 128 * pageSize);
+
+    AllocPages(&allocator, 4);
+    allocator.Rewind(allocator.Start(), false);
+
+    EXPECT_EQ(allocator.Trim(), 124 * pageSize);
+    EXPECT_EQ(allocator.BytesCommitted(), 4 * pageSize);
+
+    // Trimming without rewinding keeps everything up to the end of the current page.
+    AllocPages(&allocator, 2);
+    ASSERT_NE(Alloc(&allocator, 16), nullptr);
+
+    EXPECT_EQ(allocator.Trim(), 0u);
+    EXPECT_EQ(allocator.BytesCommitted(), 4 * pageSize);
+}
+
+// =====================================================================================================================
+// Rewinding with decommit must release every committed page past the rewind point, including pages which the
+// geometric growth committed ahead of the current pointer.
+TEST(VirtualLinearAllocatorTest, RewindDecommit)
+{
+    const size_t pageSize = VirtualPageSize();
+
+    VirtualLinearAllocator allocator(256 * pageSize);
+    ASSERT_EQ(allocator.Init(), Result::Success);
+
+    ASSERT_NE(Alloc(&allocator, 16), nullptr);
+    void*const pMark = allocator.Current();
+
+    AllocPages(&allocator, 20);
+    EXPECT_EQ(allocator.BytesCommitted(), 32 * pageSize);
+
+    allocator.Rewind(pMark, true);
+
+    EXPECT_EQ(allocator.Current(), pMark);
+    EXPECT_EQ(allocator.BytesCommitted(), pageSize);
+    EXPECT_EQ(allocator.NumDecommits(), 1u);
+
+    // Nothing is left above the first page for Trim() to release.
+    EXPECT_EQ(allocator.Trim(), 0u);
+
+    AllocPages(&allocator, 20);
+    EXPECT_GE(allocator.BytesCommitted(), 21 * pageSize);
+}